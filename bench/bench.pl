@@ -0,0 +1,220 @@
+#!/usr/bin/env perl
+##*****************************************************************************
+##
+##  This file is part of BibTool.
+##  It is distributed under the GNU General Public License.
+##  See the file COPYING for details.
+##
+##  (c) 2020 Gerd Neugebauer
+##
+##  Net: gene@gerd-neugebauer.de
+##
+##  This program is free software; you can redistribute it and/or modify
+##  it under the terms of the GNU General Public License as published by
+##  the Free Software Foundation; either version 2, or (at your option)
+##  any later version.
+##
+##  This program is distributed in the hope that it will be useful,
+##  but WITHOUT ANY WARRANTY; without even the implied warranty of
+##  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+##  GNU General Public License for more details.
+##
+##  You should have received a copy of the GNU General Public License
+##  along with this program; if not, write to the Free Software
+##  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+##
+##*****************************************************************************
+
+=head1 NAME
+
+bench.pl - Run the benchmarks of BibTool.
+
+=head1 SYNOPSIS
+
+bench.pl [options] [scenario...]
+
+=head1 DESCRIPTION
+
+This program runs BibTool on synthetic BibTeX files of several sizes
+and measures the resources used. The files are generated with
+F<gen_bib.pl> when they do not exist yet. The measurement is made by
+F<rusage>. It has to be compiled before; C<make bench> does this.
+
+The scenarios are:
+
+=over 4
+
+=item parse
+
+Read the file and write it unchanged.
+
+=item keys
+
+Generate keys with C<-k>.
+
+=item sort
+
+Sort the entries with C<-s>.
+
+=item double
+
+Look for double entries with C<check.double>.
+
+=item iso2tex
+
+Rewrite ISO-8859-1 characters with F<lib/iso2tex.rsc>.
+
+=item keep_biblatex
+
+Filter the fields with F<lib/keep_biblatex.rsc>.
+
+=item aux
+
+Extract the entries cited in an aux file with C<-x>.
+
+=item macros
+
+Dump the used macros with C<-M>.
+
+=back
+
+All scenarios are run if none is given as argument.
+
+For each run a line is printed. It is a JSON object with the name of
+the scenario, the number of entries, the seed, the number of the run,
+the elapsed time, the user time, and the system time in seconds, the
+peak resident set size in kilobytes, the exit status, the version of
+BibTool, and the time of the run. Thus the results of several runs
+can be collected in a file and compared later.
+
+=head1 OPTIONS
+
+=over 4
+
+=item -b I<program>
+
+Use the given BibTool program. The default is F<./bibtool>.
+
+=item -d I<directory>
+
+Keep the generated files in the given directory. The default is
+F<bench/corpus>.
+
+=item -n I<n>,...
+
+Use files with the given numbers of entries. The default is
+C<1000,10000,100000>.
+
+=item -o I<file>
+
+Append the results to the given file instead of printing them.
+
+=item -r I<n>
+
+Repeat each run I<n> times. The default is 3.
+
+=item -s I<seed>
+
+Use the given seed for the generation of the files. The default is 1.
+
+=back
+
+=head1 AUTHOR
+
+Gerd Neugebauer
+
+=cut
+
+use strict;
+use warnings;
+use Getopt::Std;
+use File::Basename;
+use POSIX qw(strftime);
+
+my $dir = dirname($0);
+my %opt = (b => './bibtool',
+	   d => "$dir/corpus",
+	   n => '1000,10000,100000',
+	   r => 3,
+	   s => 1);
+getopts('b:d:n:o:r:s:', \%opt)
+    or die "usage: $0 [-b bibtool] [-d dir] [-n n,...] [-o file] [-r n] [-s seed] [scenario...]\n";
+
+my $lib	   = "$dir/../lib";
+my $rusage = "$dir/rusage";
+die "*** $rusage not found. Run make bench\n" if not -x $rusage;
+die "*** $opt{b} not found\n" if not -x $opt{b};
+
+#------------------------------------------------------------------------------
+# Variable:	%scenario
+# Description:	The arguments of BibTool for the scenarios. The name of
+#		the aux file is inserted for %a.
+#
+my %scenario = (parse	      => [],
+		keys	      => ['-k'],
+		sort	      => ['-s'],
+		double	      => ['--', 'check.double=on'],
+		iso2tex	      => ['-r', "$lib/iso2tex.rsc"],
+		keep_biblatex => ['-r', "$lib/keep_biblatex.rsc"],
+		aux	      => ['-x', '%a'],
+		macros	      => ['-M', '-']);
+my @scenarios = (@ARGV ? @ARGV
+		 : qw(parse keys sort double iso2tex keep_biblatex aux macros));
+foreach (@scenarios) {
+  die "*** Unknown scenario $_\n" if not $scenario{$_};
+}
+
+my $version = `$opt{b} -V 2>&1`;
+$version    =~ s/\n.*//s;
+$version    =~ s/["\\]//g;
+
+my $out = \*STDOUT;
+if ($opt{o}) {
+  open($out, '>>', $opt{o}) or die "$opt{o}: $!\n";
+}
+$out->autoflush(1);
+
+#------------------------------------------------------------------------------
+# Function:	corpus
+# Arguments:	the number of entries
+# Description:	Generate the BibTeX file and the aux file unless they
+#		exist already. Return their names.
+#
+sub corpus {
+  my $n	  = shift;
+  my $bib = "$opt{d}/bench_${n}_$opt{s}.bib";
+  my $aux = "$opt{d}/bench_${n}_$opt{s}.aux";
+  return ($bib, $aux) if -e $bib and -e $aux;
+
+  mkdir($opt{d}) if not -d $opt{d};
+  print STDERR "--- generating $bib\n";
+  system("perl $dir/gen_bib.pl -n $n -s $opt{s} -a $aux > $bib.tmp") == 0
+      or die "*** $dir/gen_bib.pl failed\n";
+  rename("$bib.tmp", $bib) or die "$bib: $!\n";
+  return ($bib, $aux);
+}
+
+foreach my $n (split(/,/, $opt{n})) {
+  my ($bib, $aux) = corpus($n);
+  foreach my $sc (@scenarios) {
+    my @args = map { $_ eq '%a' ? $aux : $_ } @{$scenario{$sc}};
+    for (my $run = 1; $run <= $opt{r}; $run++) {
+      open(my $fd, '-|', $rusage, $opt{b}, '-q', @args, '-i', $bib)
+	  or die "$rusage: $!\n";
+      my $line = <$fd>;
+      close($fd);
+      die "*** $rusage failed for $sc\n" if not defined $line;
+      my ($wall, $user, $sys, $rss, $status) = split(' ', $line);
+      printf($out '{"scenario":"%s","entries":%d,"seed":%d,"run":%d,'
+	     . '"wall":%s,"user":%s,"sys":%s,"max_rss_kb":%s,"status":%s,'
+	     . '"version":"%s","date":"%s"}' . "\n",
+	     $sc, $n, $opt{s}, $run, $wall, $user, $sys, $rss, $status,
+	     $version, strftime('%Y-%m-%dT%H:%M:%SZ', gmtime));
+    }
+  }
+}
+
+#------------------------------------------------------------------------------
+# Local Variables:
+# mode: perl
+# End:
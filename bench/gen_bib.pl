@@ -0,0 +1,297 @@
+#!/usr/bin/env perl
+##*****************************************************************************
+##
+##  This file is part of BibTool.
+##  It is distributed under the GNU General Public License.
+##  See the file COPYING for details.
+##
+##  (c) 2020 Gerd Neugebauer
+##
+##  Net: gene@gerd-neugebauer.de
+##
+##  This program is free software; you can redistribute it and/or modify
+##  it under the terms of the GNU General Public License as published by
+##  the Free Software Foundation; either version 2, or (at your option)
+##  any later version.
+##
+##  This program is distributed in the hope that it will be useful,
+##  but WITHOUT ANY WARRANTY; without even the implied warranty of
+##  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+##  GNU General Public License for more details.
+##
+##  You should have received a copy of the GNU General Public License
+##  along with this program; if not, write to the Free Software
+##  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+##
+##*****************************************************************************
+
+=head1 NAME
+
+gen_bib.pl - Generate a BibTeX file for benchmarks.
+
+=head1 SYNOPSIS
+
+gen_bib.pl [options]
+
+=head1 DESCRIPTION
+
+This program writes a synthetic BibTeX file to the standard output.
+The contents is determined by the number of entries and the seed
+only. The program uses a random number generator of its own. Thus the
+same file is produced on every platform and with every version of
+Perl.
+
+The file resembles a real bibliography:
+
+=over 4
+
+=item *
+
+It starts with C<@string> definitions for journals and publishers.
+Articles and books refer to them and to the predefined month macros.
+
+=item *
+
+Every block of 50 entries contains some C<@inproceedings> with a
+C<crossref> to a C<@proceedings> entry at the end of the block.
+
+=item *
+
+About a third of the entries has a long abstract.
+
+=item *
+
+The names and titles contain TeX accents like C<{\"u}>, UTF-8
+characters, and ISO-8859-1 characters.
+
+=item *
+
+About 1% of the entries are copies of earlier entries with another
+key and about 0.5% reuse the key of an earlier entry.
+
+=back
+
+=head1 OPTIONS
+
+=over 4
+
+=item -n I<n>
+
+Generate I<n> entries. The default is 1000.
+
+=item -s I<seed>
+
+Use the given seed. The default is 1.
+
+=item -a I<file>
+
+Write an aux file to I<file>. It cites about 10% of the keys.
+
+=back
+
+=head1 AUTHOR
+
+Gerd Neugebauer
+
+=cut
+
+use strict;
+use warnings;
+use Getopt::Std;
+
+my %opt = (n => 1000, s => 1);
+getopts('n:s:a:', \%opt) or die "usage: $0 [-n entries] [-s seed] [-a aux_file]\n";
+
+#------------------------------------------------------------------------------
+# Variable:	$rnd
+# Description:	The state of the xorshift random number generator.
+#
+my $rnd = ($opt{s} * 2654435761 + 1) & 0xffffffff;
+$rnd	= 1 if $rnd == 0;
+
+#------------------------------------------------------------------------------
+# Function:	rnd
+# Description:	Get a random number in the range 0 to n-1.
+#
+sub rnd {
+  my $n = shift;
+  $rnd ^= ($rnd << 13) & 0xffffffff;
+  $rnd ^= $rnd >> 17;
+  $rnd ^= ($rnd << 5) & 0xffffffff;
+  return $rnd % $n;
+}
+
+#------------------------------------------------------------------------------
+# Function:	pick
+# Description:	Get a random element of a list.
+#
+sub pick {
+  return $_[rnd(scalar @_)];
+}
+
+my @first = ('Anna', 'Bert', 'Claire', 'David', 'Eva', 'Frank', 'Greta',
+	     'Hans', 'Ingrid', 'Jan', 'Karin', 'Lars', 'Maria', 'Niels',
+	     'Olga', 'Paul', 'Rosa', 'Sven', 'Tanja', 'Ulf', 'Vera',
+	     'Walter', 'Xaver', 'Yvonne', 'Zoltan', 'J{\"o}rg', 'Ren{\'e}',
+	     'Fran{\c{c}}ois', "Ma\xc3\xaflis", "J\xfcrgen", 'A. B.', 'C.');
+my @last  = ('Adams', 'Brown', 'Clark', 'Davis', 'Evans', 'Fischer',
+	     'Garcia', 'Hoffmann', 'Ito', 'Jensen', 'Kowalski', 'Lee',
+	     'Meyer', 'Nguyen', 'Olsen', 'Petrov', 'Quinn', 'Rossi',
+	     'Schmidt', 'Tanaka', 'Ueda', 'Vogel', 'Weber', 'Young',
+	     'Zimmermann', 'M{\"u}ller', 'Erd{\H{o}}s', '{\v{C}}ech',
+	     'Schr{\"o}dinger', 'Garc{\\\'\i}a', "M\xc3\xbcller",
+	     "\xc3\x85ngstr\xc3\xb6m", "G\xf6del", "Fa\xdf", 'van der Berg',
+	     'de la Cruz', '{Barnes and Noble}');
+my @words = qw(analysis algorithm approach automatic bibliography
+	       calculus complexity computation constraint data database
+	       design distributed dynamic efficient evaluation framework
+	       functional graph hierarchical index inference language
+	       learning linear logic management method model network
+	       optimization parallel probabilistic program query random
+	       reasoning recursive retrieval search semantic sequential
+	       structure system theory type verification);
+push @words, ('{\"u}ber', 'na{\"\i}ve', 'r{\^o}le', "caf\xc3\xa9",
+	      "se\xf1or", '{TeX}', '{BibTeX}', '$O(n \log n)$');
+my @months = qw(jan feb mar apr may jun jul aug sep oct nov dec);
+my @cities = ('Berlin', 'Boston', 'Paris', 'Tokyo', "Z\xc3\xbcrich",
+	      'S{\~a}o Paulo', "K\xf6ln");
+
+my $journals   = 200;
+my $publishers = 50;
+
+#------------------------------------------------------------------------------
+# Function:	words
+# Description:	Get a sequence of n random words.
+#
+sub words {
+  my $n = shift;
+  return join(' ', map { pick(@words) } 1 .. $n);
+}
+
+#------------------------------------------------------------------------------
+# Function:	pages
+# Description:	Get a random page range.
+#
+sub pages {
+  my ($max, $len) = @_;
+  my $p = 1 + rnd($max);
+  return "{$p--" . ($p + rnd($len)) . '}';
+}
+
+#------------------------------------------------------------------------------
+# Function:	authors
+# Description:	Get a random list of names.
+#
+sub authors {
+  return join(' and ',
+	      map { pick(@first) . ' ' . pick(@last) } 0 .. rnd(4));
+}
+
+#------------------------------------------------------------------------------
+# Function:	entry
+# Description:	Format an entry. The fields are given as list of pairs.
+#
+sub entry {
+  my ($type, $key, @fields) = @_;
+  my $s = "\@$type\{$key,\n";
+  while (@fields) {
+    my ($name, $value) = splice(@fields, 0, 2);
+    $s .= "  $name = $value,\n";
+  }
+  $s =~ s/,\n$/\n/;
+  return $s . "}\n\n";
+}
+
+binmode(STDOUT);
+for (my $i = 0; $i < $journals; $i++) {
+  print "\@String{j$i = {Journal of ", ucfirst(words(2)), "}}\n";
+}
+for (my $i = 0; $i < $publishers; $i++) {
+  print "\@String{p$i = {", pick(@last), " Press}}\n";
+}
+print "\n";
+
+my @keys;
+my @entries;
+my @cited;
+my $block = 50;
+my $proc;
+
+for (my $i = 0; $i < $opt{n}; $i++) {
+  my $r = rnd(1000);
+  my $entry;
+  my $key;
+  if ($r < 10 && @entries) {
+    $key   = "dup$i";
+    $entry = $entries[rnd(scalar @entries)];
+    $entry =~ s/^(\@\w+\{)[^,]*,/$1$key,/;
+  } else {
+    my $year = 1950 + rnd(75);
+    $key = ($r < 15 && @keys ? $keys[rnd(scalar @keys)] : "k$i:$year");
+    my @f = (author => '{' . authors() . '}',
+	     title  => '{' . ucfirst(words(4 + rnd(9))) . '}',
+	     year   => $year);
+    push @f, (abstract => '{' . words(80 + rnd(220)) . '}')
+	if rnd(3) == 0;
+    my $t = rnd(10);
+    if ($t < 4) {
+      $entry = entry('Article', $key, @f,
+		     journal => 'j' . rnd($journals),
+		     volume  => 1 + rnd(60),
+		     number  => 1 + rnd(12),
+		     pages   => pages(900, 40),
+		     month   => pick(@months));
+    } elsif ($t < 7) {
+      $proc = 'proc' . int($i / $block);
+      $entry = entry('InProceedings', $key, @f,
+		     crossref => "{$proc}",
+		     pages    => pages(500, 20));
+    } elsif ($t < 8) {
+      $entry = entry('Book', $key, @f,
+		     publisher => 'p' . rnd($publishers),
+		     address   => '{' . pick(@cities) . '}',
+		     isbn      => '{978-' . rnd(10) . '-' . (1000 + rnd(9000))
+				  . '-' . (100 + rnd(900)) . '-' . rnd(10) . '}');
+    } elsif ($t < 9) {
+      $entry = entry('TechReport', $key, @f,
+		     institution => '{University of ' . pick(@cities) . '}',
+		     number	 => '{TR-' . rnd(10000) . '}');
+    } else {
+      $entry = entry('Misc', $key, @f,
+		     howpublished => '{\url{http://example.org/' . $i . '}}',
+		     note	  => '{' . words(3) . '}');
+    }
+    push @keys, $key;
+    push @entries, $entry if @entries < 10000;
+  }
+  print $entry;
+  push @cited, $key if rnd(10) == 0;
+
+  if (($i + 1) % $block == 0 || $i + 1 == $opt{n}) {
+    if (defined $proc) {
+      print entry('Proceedings', $proc,
+		  title	    => '{Proceedings of the ' . ucfirst(words(3)) . ' Conference}',
+		  booktitle => '{Proceedings of the ' . ucfirst(words(3)) . ' Conference}',
+		  editor    => '{' . authors() . '}',
+		  publisher => 'p' . rnd($publishers),
+		  address   => '{' . pick(@cities) . '}',
+		  year	    => 1950 + rnd(75),
+		  month	    => pick(@months));
+      push @cited, $proc if rnd(10) == 0;
+      undef $proc;
+    }
+  }
+}
+
+if ($opt{a}) {
+  open(my $aux, '>', $opt{a}) or die "$opt{a}: $!\n";
+  print $aux "\\relax\n";
+  print $aux "\\citation{$_}\n" foreach @cited;
+  print $aux "\\bibstyle{plain}\n";
+  close($aux);
+}
+
+#------------------------------------------------------------------------------
+# Local Variables:
+# mode: perl
+# End:
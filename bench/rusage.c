@@ -0,0 +1,141 @@
+/*** rusage.c *****************************************************************
+**
+** This file is part of BibTool.
+** It is distributed under the GNU General Public License.
+** See the file COPYING for details.
+**
+** (c) 2020 Gerd Neugebauer
+**
+** Net: gene@gerd-neugebauer.de
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+**-----------------------------------------------------------------------------
+** Description:
+**	This program runs a command and measures the resources used
+**	by it. It is used by the benchmarks in |bench.pl|.
+**
+**	Usage: |rusage| \textit{command} \textit{arg}\dots
+**
+**	The standard output and the error output of the command are
+**	discarded. Afterwards a single line is printed. It contains
+**	the elapsed time, the user time, and the system time in
+**	seconds, the peak resident set size in kilobytes, and the exit
+**	status of the command. The values are separated by spaces.
+**
+**	The program needs |fork()| and |wait4()|. Thus it is meant for
+**	UN*X like systems only.
+**
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+/*****************************************************************************/
+/* Internal Programs							     */
+/*===========================================================================*/
+
+#ifdef __STDC__
+#define _ARG(A) A
+#else
+#define _ARG(A) ()
+#endif
+ int main _ARG((int argc,char *argv[]));	   /* rusage.c               */
+ static double seconds _ARG((struct timeval *tv)); /* rusage.c               */
+
+/*****************************************************************************/
+/* External Programs							     */
+/*===========================================================================*/
+
+/*---------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Macro*:	RSS_UNIT
+** Purpose:	The number of bytes in the unit of |ru_maxrss|. Linux
+**		reports kilobytes, Mac OS X reports bytes.
+**___________________________________________________			     */
+#ifdef __APPLE__
+#define RSS_UNIT 1024L
+#else
+#define RSS_UNIT 1L
+#endif
+
+/*-----------------------------------------------------------------------------
+** Function*:	seconds()
+** Purpose:	Convert a time value into seconds.
+** Arguments:
+**	tv	the time value
+** Returns:	the number of seconds
+**___________________________________________________			     */
+static double seconds(tv)			   /*                        */
+  struct timeval *tv;				   /*                        */
+{ return (double)tv->tv_sec + (double)tv->tv_usec / 1e6;/*                   */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	main()
+** Purpose:	Main function of the program.
+** Arguments:
+**	argc	the number of arguments
+**	argv	the arguments
+** Returns:	|0| upon success and |1| if the command could not be run
+**___________________________________________________			     */
+int main(argc, argv)				   /*                        */
+  int	argc;					   /*                        */
+  char	*argv[];				   /*                        */
+{ struct timeval start, end;			   /*                        */
+  struct rusage	 ru;				   /*                        */
+  pid_t		 pid;				   /*                        */
+  int		 status, fd;			   /*                        */
+ 						   /*                        */
+  if (argc < 2)					   /*                        */
+  { fprintf(stderr, "Usage: %s command [arg...]\n", argv[0]);/*              */
+    return 1;					   /*                        */
+  }						   /*                        */
+ 						   /*                        */
+  (void)gettimeofday(&start, NULL);		   /*                        */
+  switch (pid = fork())				   /*                        */
+  { case -1:					   /*                        */
+      perror("fork");				   /*                        */
+      return 1;					   /*                        */
+    case 0:					   /* The child discards its */
+      if ((fd = open("/dev/null", O_RDWR)) >= 0)   /*  output and runs the   */
+      { (void)dup2(fd, 0);			   /*  command.              */
+	(void)dup2(fd, 1);			   /*                        */
+	(void)dup2(fd, 2);			   /*                        */
+      }						   /*                        */
+      (void)execvp(argv[1], argv + 1);		   /*                        */
+      _exit(127);				   /*                        */
+  }						   /*                        */
+  if (wait4(pid, &status, 0, &ru) < 0)		   /*                        */
+  { perror("wait4");				   /*                        */
+    return 1;					   /*                        */
+  }						   /*                        */
+  (void)gettimeofday(&end, NULL);		   /*                        */
+ 						   /*                        */
+  printf("%.3f %.3f %.3f %ld %d\n",		   /*                        */
+	 seconds(&end) - seconds(&start),	   /*                        */
+	 seconds(&ru.ru_utime),			   /*                        */
+	 seconds(&ru.ru_stime),			   /*                        */
+	 (long)ru.ru_maxrss / RSS_UNIT,		   /*                        */
+	 WIFEXITED(status) ? WEXITSTATUS(status) : -1);/*                    */
+  return WIFEXITED(status) && WEXITSTATUS(status) == 127 ? 1 : 0;/*          */
+}						   /*------------------------*/
@@ -0,0 +1,141 @@
+#!/usr/bin/env perl
+##*****************************************************************************
+## 
+##  This file is part of BibTool.
+##  It is distributed under the GNU General Public License.
+##  See the file COPYING for details.
+## 
+##  (c) 2020 Gerd Neugebauer
+## 
+##  Net: gene@gerd-neugebauer.de
+## 
+##  This program is free software; you can redistribute it and/or modify
+##  it under the terms of the GNU General Public License as published by
+##  the Free Software Foundation; either version 2, or (at your option)
+##  any later version.
+##
+##  This program is distributed in the hope that it will be useful,
+##  but WITHOUT ANY WARRANTY; without even the implied warranty of
+##  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+##  GNU General Public License for more details.
+##
+##  You should have received a copy of the GNU General Public License
+##  along with this program; if not, write to the Free Software
+##  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+##
+##*****************************************************************************
+
+=head1 NAME
+
+server_load.pl - Load test for the BibTool server.
+
+=head1 SYNOPSIS
+
+server_load.pl [options] socket bib_file
+
+=head1 DESCRIPTION
+
+This program connects a number of clients to a BibTool server started
+with the resource C<server> set to the name of a socket. Each client
+sends requests for entries by their keys. The keys are taken from the
+given BibTeX file, which should be the one loaded by the server. The
+keys are chosen at random with a fixed seed. Thus the runs are
+reproducible.
+
+A summary is printed at the end. It contains the number of requests,
+the elapsed time, the throughput and percentiles of the latency of a
+single request.
+
+=head1 OPTIONS
+
+=over 4
+
+=item -c I<n>
+
+Use I<n> clients in parallel. The default is 4.
+
+=item -n I<n>
+
+Send I<n> requests from each client. The default is 1000.
+
+=item -r I<request>
+
+Send the given request instead of a request for a random key.
+
+=back
+
+=head1 AUTHOR
+
+Gerd Neugebauer
+
+=cut
+
+use strict;
+use warnings;
+use Getopt::Std;
+use IO::Socket::UNIX;
+use Time::HiRes qw(time);
+
+my %opt = (c => 4, n => 1000);
+getopts('c:n:r:', \%opt) or die "usage: $0 [-c n] [-n n] [-r request] socket bib_file\n";
+my ($socket, $bib) = @ARGV;
+die "usage: $0 [-c n] [-n n] [-r request] socket bib_file\n" if not $bib;
+
+my @keys;
+open(my $fd, '<', $bib) or die "$bib: $!\n";
+while (<$fd>) {
+  push @keys, $1 if m/^\s*@\s*(?!string|preamble|comment)\w+\s*[{(]\s*([^\s,]+)\s*,/i;
+}
+close($fd);
+die "*** No keys found in $bib\n" if not @keys;
+
+#------------------------------------------------------------------------------
+# Function:	client
+# Arguments:	the number of the client and the pipe to the parent
+# Description:	Send the requests and report the latencies in milliseconds.
+#
+sub client {
+  my ($id, $out) = @_;
+  my $sock = IO::Socket::UNIX->new(Type => SOCK_STREAM, Peer => $socket)
+      or die "$socket: $!\n";
+  srand(42 + $id);
+  for (my $i = 0; $i < $opt{n}; $i++) {
+    my $req = $opt{r} || 'key ' . $keys[int(rand(@keys))];
+    my $t   = time;
+    print $sock "$req\n";
+    $sock->flush();
+    while (my $line = <$sock>) {
+      last if $line eq ".\n";
+    }
+    printf $out "%.3f\n", 1000 * (time - $t);
+  }
+  print $sock "quit\n";
+  close($sock);
+}
+
+my $start = time;
+my @pids;
+pipe(my $in, my $out) or die "pipe: $!\n";
+for (my $id = 0; $id < $opt{c}; $id++) {
+  my $pid = fork();
+  die "fork: $!\n" if not defined $pid;
+  if ($pid == 0) {
+    close($in);
+    $out->autoflush(1);
+    client($id, $out);
+    exit(0);
+  }
+  push @pids, $pid;
+}
+close($out);
+my @lat = sort { $a <=> $b } map { chomp; $_ } <$in>;
+waitpid($_, 0) foreach @pids;
+my $elapsed = time - $start;
+
+die "*** No request has been served\n" if not @lat;
+sub percentile { $lat[int($_[0] * $#lat)] }
+
+printf("clients=%d requests=%d seconds=%.3f requests_per_second=%.1f"
+       . " p50_ms=%.3f p95_ms=%.3f p99_ms=%.3f max_ms=%.3f\n",
+       $opt{c}, scalar(@lat), $elapsed, @lat / $elapsed,
+       percentile(0.5), percentile(0.95), percentile(0.99), $lat[-1]);
@@ -0,0 +1,719 @@
+/*** bundle.c *****************************************************************
+**
+** This file is part of BibTool.
+** It is distributed under the GNU General Public License.
+** See the file COPYING for details.
+**
+** (c) 2020 Gerd Neugebauer
+**
+** Net: gene@gerd-neugebauer.de
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+**-----------------------------------------------------------------------------
+** Description:
+**	This module contains functions to write and read resource
+**	bundles. While the resource |resource.bundle| names a file
+**	the instructions of the resource files read are recorded.
+**	After each resource file the bundle is written. It contains
+**	the names, the sizes, and the hashes of the resource files,
+**	the instructions, the compiled regular expressions of the
+**	rules, and the compiled table of the keep rules.
+**
+**	The bundle records the version of \BibTool{} which has written
+**	it, since the compiled regular expressions and the keep table
+**	depend on it. A bundle written by another version is treated
+**	like a bundle with a changed resource file.
+**
+**	A bundle is read with |read_rsc()| like a resource file. The
+**	instructions are passed to |set_rsc()| without searching and
+**	parsing the resource files again. Thus the rules, the formats,
+**	and the entry types are created as usual. But the regular
+**	expressions are not compiled again and the keep table is
+**	taken as it is. If one of the resource files has been changed
+**	then the bundle is ignored and the resource files are read
+**	instead.
+**
+**	All numbers are stored as 4 byte big endian words. Strings
+**	are stored as their length and the characters including the
+**	terminating null character. The bundle ends with the hash of
+**	all data after the magic string.
+**
+******************************************************************************/
+
+#include <bibtool/general.h>
+#include <bibtool/symbols.h>
+#include <bibtool/context.h>
+#include <bibtool/error.h>
+#include <bibtool/rsc.h>
+#include <bibtool/parse.h>
+#include <bibtool/rewrite.h>
+#include <bibtool/version.h>
+#include <bibtool/bundle.h>
+
+/*****************************************************************************/
+/* Internal Programs							     */
+/*===========================================================================*/
+
+#ifdef __STDC__
+#define _ARG(A) A
+#else
+#define _ARG(A) ()
+#endif
+ static String bundle_string _ARG((BundleCursor c));/* bundle.c              */
+ static bool file_sum _ARG((String path,unsigned long *sizep,unsigned long *hashp));/**/
+ static int add_source _ARG((Symbol name,Symbol path,bool top,unsigned long size,unsigned long hash));/**/
+ static void bundle_free _ARG((void *state));	   /* bundle.c               */
+ static void write_bundle _ARG((char *fname));	   /* bundle.c               */
+
+/*****************************************************************************/
+/* External Programs							     */
+/*===========================================================================*/
+
+/*---------------------------------------------------------------------------*/
+
+#define BUNDLE_VERSION 2
+
+/*-----------------------------------------------------------------------------
+** Typedef*:	SBundleSource
+** Purpose:	A resource file contained in a bundle. The name is the
+**		one given to |read_rsc()|. The path is the file found
+**		on the resource search path. Files read directly are
+**		read again by name if the bundle is out of date.
+**___________________________________________________			     */
+ typedef struct					   /*                        */
+ { Symbol	 bs_name;			   /* the name given         */
+   Symbol	 bs_path;			   /* the file found         */
+   unsigned long bs_size;			   /* its size               */
+   unsigned long bs_hash;			   /* its hash               */
+   bool		 bs_top;			   /* read directly          */
+ } SBundleSource;				   /*                        */
+
+/*-----------------------------------------------------------------------------
+** Typedef*:	SBundleInstr
+** Purpose:	A resource instruction contained in a bundle together
+**		with its location.
+**___________________________________________________			     */
+ typedef struct					   /*                        */
+ { Symbol	 bi_name;			   /* the resource           */
+   Symbol	 bi_value;			   /* its value              */
+   int		 bi_source;			   /* the index of the file  */
+   int		 bi_line;			   /* the line               */
+ } SBundleInstr;				   /*                        */
+
+/*-----------------------------------------------------------------------------
+** Typedef*:	SBundleState
+** Purpose:	The state of the bundle module in a context. It
+**		contains the resource files and the instructions
+**		recorded so far.
+**___________________________________________________			     */
+ typedef struct					   /*                        */
+ { int		 bu_depth;			   /* the nesting of files   */
+   int		 bu_top;			   /* the depth of the first */
+ 						   /*  recorded file or -1   */
+   SBundleSource *bu_src;			   /* the resource files     */
+   int		 bu_nsrc;			   /*                        */
+   int		 bu_ssize;			   /*                        */
+   SBundleInstr	 *bu_ins;			   /* the instructions       */
+   int		 bu_nins;			   /*                        */
+   int		 bu_isize;			   /*                        */
+   unsigned long bu_hash;			   /* the hash while writing */
+ } SBundleState;				   /*                        */
+
+/*-----------------------------------------------------------------------------
+** Variable*:	bundle_state0
+** Type:	SBundleState
+** Purpose:	The template for the state of the bundle module.
+**		Nothing is recorded initially.
+**___________________________________________________			     */
+ static SBundleState bundle_state0 =		   /*                        */
+ { 0,						   /* bu_depth               */
+   -1,						   /* bu_top                 */
+   NULL, 0, 0,					   /* bu_src                 */
+   NULL, 0, 0,					   /* bu_ins                 */
+   0L						   /* bu_hash                */
+ };						   /*                        */
+
+#define BundleState ((SBundleState*)CtxGet(CTX_BUNDLE,			\
+				      ctx_state(CTX_BUNDLE,		\
+					      (void*)&bundle_state0,	\
+					      sizeof(bundle_state0),	\
+					      bundle_free)))
+
+#define Recording (rsc_bundle != StringNULL && *rsc_bundle != '\0')
+
+/*-----------------------------------------------------------------------------
+** Function*:	bundle_free()
+** Type:	void
+** Purpose:	Release the memory held by the state of the bundle
+**		module.
+** Arguments:
+**	state	the state
+** Returns:	nothing
+**___________________________________________________			     */
+static void bundle_free(state)			   /*                        */
+  void *state;					   /*                        */
+{ SBundleState *bs = (SBundleState*)state;	   /*                        */
+ 						   /*                        */
+  if (bs->bu_src) free(bs->bu_src);		   /*                        */
+  if (bs->bu_ins) free(bs->bu_ins);		   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	bundle_hash()
+** Type:	unsigned long
+** Purpose:	Continue a 32 bit FNV-1a hash with some bytes. The
+**		hash starts with |BUNDLE_HASH_INIT|.
+** Arguments:
+**	h	the hash so far
+**	s	the bytes
+**	n	the number of bytes
+** Returns:	The new hash value.
+**___________________________________________________			     */
+unsigned long bundle_hash(h, s, n)		   /*                        */
+  unsigned long h;				   /*                        */
+  unsigned char *s;				   /*                        */
+  size_t	n;				   /*                        */
+{						   /*                        */
+  while (n-- > 0)				   /*                        */
+  { h = ((h ^ *s++) * 16777619UL) & 0xffffffffUL; }/*                        */
+  return h;					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	file_sum()
+** Type:	bool
+** Purpose:	Determine the size and the hash of the contents of a
+**		file.
+** Arguments:
+**	path	the name of the file
+**	sizep	pointer to the size
+**	hashp	pointer to the hash
+** Returns:	|false| iff the file can not be read.
+**___________________________________________________			     */
+static bool file_sum(path, sizep, hashp)	   /*                        */
+  String	path;				   /*                        */
+  unsigned long *sizep;				   /*                        */
+  unsigned long *hashp;				   /*                        */
+{ FILE		*f;				   /*                        */
+  unsigned char buf[4096];			   /*                        */
+  size_t	n;				   /*                        */
+ 						   /*                        */
+  if ((f = fopen((char*)path, "rb")) == NULL) return false;/*                */
+  *sizep = 0;					   /*                        */
+  *hashp = BUNDLE_HASH_INIT;			   /*                        */
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0)  /*                        */
+  { *sizep += n;				   /*                        */
+    *hashp  = bundle_hash(*hashp, buf, n);	   /*                        */
+  }						   /*                        */
+  (void)fclose(f);				   /*                        */
+  return true;					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	add_source()
+** Type:	int
+** Purpose:	Add a resource file to the files recorded.
+** Arguments:
+**	name	the name given
+**	path	the file found
+**	top	indicator whether the file is read directly
+**	size	the size of the file
+**	hash	the hash of the file
+** Returns:	The index of the file.
+**___________________________________________________			     */
+static int add_source(name, path, top, size, hash) /*                        */
+  Symbol	name;				   /*                        */
+  Symbol	path;				   /*                        */
+  bool		top;				   /*                        */
+  unsigned long size;				   /*                        */
+  unsigned long hash;				   /*                        */
+{ SBundleState	*bs = BundleState;		   /*                        */
+  SBundleSource *src;				   /*                        */
+  size_t	n;				   /*                        */
+ 						   /*                        */
+  if (bs->bu_nsrc >= bs->bu_ssize)		   /*                        */
+  { bs->bu_ssize += 8;				   /*                        */
+    n	       = bs->bu_ssize * sizeof(SBundleSource);/*                     */
+    bs->bu_src = (bs->bu_src == NULL		   /*                        */
+		  ? (SBundleSource*)malloc(n)	   /*                        */
+		  : (SBundleSource*)realloc(bs->bu_src, n));/*               */
+    if (bs->bu_src == NULL) { OUT_OF_MEMORY("bundle"); }/*                   */
+  }						   /*                        */
+  src	       = &bs->bu_src[bs->bu_nsrc];	   /*                        */
+  src->bs_name = name;				   /*                        */
+  src->bs_path = path;				   /*                        */
+  src->bs_size = size;				   /*                        */
+  src->bs_hash = hash;				   /*                        */
+  src->bs_top  = top;				   /*                        */
+  LinkSymbol(name);				   /*                        */
+  LinkSymbol(path);				   /*                        */
+  return bs->bu_nsrc++;				   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	bundle_begin()
+** Type:	void
+** Purpose:	Note that |read_rsc()| starts to read a resource file.
+**		If the resource |resource.bundle| is set then the file
+**		is recorded. The first file recorded determines the
+**		level of the files which are read directly.
+** Arguments:
+**	name	the name given to |read_rsc()|
+**	path	the file found
+** Returns:	nothing
+**___________________________________________________			     */
+void bundle_begin(name, path)			   /*                        */
+  String	name;				   /*                        */
+  Symbol	path;				   /*                        */
+{ SBundleState	*bs = BundleState;		   /*                        */
+  unsigned long size = 0;			   /*                        */
+  unsigned long hash = 0;			   /*                        */
+ 						   /*                        */
+  if (Recording)				   /*                        */
+  { if (bs->bu_top < 0) bs->bu_top = bs->bu_depth; /*                        */
+    (void)file_sum(SymbolValue(path), &size, &hash);/*                       */
+    (void)add_source(symbol(name),		   /*                        */
+		     path,			   /*                        */
+		     bs->bu_depth == bs->bu_top,   /*                        */
+		     size,			   /*                        */
+		     hash);			   /*                        */
+  }						   /*                        */
+  bs->bu_depth++;				   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	bundle_end()
+** Type:	void
+** Purpose:	Note that |read_rsc()| has finished a resource file.
+**		When a file read directly is finished then the bundle
+**		is written.
+** Arguments:	none
+** Returns:	nothing
+**___________________________________________________			     */
+void bundle_end()				   /*                        */
+{ SBundleState *bs = BundleState;		   /*                        */
+ 						   /*                        */
+  if (--bs->bu_depth == bs->bu_top && Recording)   /*                        */
+  { write_bundle((char*)rsc_bundle); }		   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	bundle_record()
+** Type:	void
+** Purpose:	Record a resource instruction read from a resource
+**		file if a bundle is requested. The instructions to
+**		read a resource file are not recorded since the
+**		instructions of the file are recorded instead.
+** Arguments:
+**	name	the resource
+**	value	its value
+**	path	the file containing the instruction
+**	line	the line of the instruction
+** Returns:	nothing
+**___________________________________________________			     */
+void bundle_record(name, value, path, line)	   /*                        */
+  Symbol	name;				   /*                        */
+  Symbol	value;				   /*                        */
+  Symbol	path;				   /*                        */
+  int		line;				   /*                        */
+{ SBundleState	*bs = BundleState;		   /*                        */
+  SBundleInstr	*ins;				   /*                        */
+  size_t	n;				   /*                        */
+  int		i;				   /*                        */
+ 						   /*                        */
+  if (bs->bu_top < 0 || !Recording) return;	   /*                        */
+  if (strcmp((char*)SymbolValue(name), "resource") == 0 ||/*                 */
+      strcmp((char*)SymbolValue(name), "resource.bundle") == 0)/*            */
+  { return; }					   /*                        */
+ 						   /*                        */
+  for (i = bs->bu_nsrc - 1; i >= 0 && bs->bu_src[i].bs_path != path; i--) {}
+ 						   /*                        */
+  if (bs->bu_nins >= bs->bu_isize)		   /*                        */
+  { bs->bu_isize += 256;			   /*                        */
+    n	       = bs->bu_isize * sizeof(SBundleInstr);/*                      */
+    bs->bu_ins = (bs->bu_ins == NULL		   /*                        */
+		  ? (SBundleInstr*)malloc(n)	   /*                        */
+		  : (SBundleInstr*)realloc(bs->bu_ins, n));/*                */
+    if (bs->bu_ins == NULL) { OUT_OF_MEMORY("bundle"); }/*                   */
+  }						   /*                        */
+  ins		 = &bs->bu_ins[bs->bu_nins++];	   /*                        */
+  ins->bi_name	 = name;			   /*                        */
+  ins->bi_value	 = value;			   /*                        */
+  ins->bi_source = i;				   /*                        */
+  ins->bi_line	 = line;			   /*                        */
+  LinkSymbol(name);				   /*                        */
+  LinkSymbol(value);				   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	bundle_put()
+** Type:	void
+** Purpose:	Write a word to a bundle.
+** Arguments:
+**	v	the value
+**	file	the output stream
+** Returns:	nothing
+**___________________________________________________			     */
+void bundle_put(v, file)			   /*                        */
+  unsigned long v;				   /*                        */
+  FILE		*file;				   /*                        */
+{ unsigned char buf[4];				   /*                        */
+ 						   /*                        */
+  buf[0] = (unsigned char)((v >> 24) & 0xff);	   /*                        */
+  buf[1] = (unsigned char)((v >> 16) & 0xff);	   /*                        */
+  buf[2] = (unsigned char)((v >> 8) & 0xff);	   /*                        */
+  buf[3] = (unsigned char)(v & 0xff);		   /*                        */
+  (void)fwrite(buf, 1, 4, file);		   /*                        */
+  BundleState->bu_hash = bundle_hash(BundleState->bu_hash, buf, 4);/*        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	bundle_put_bytes()
+** Type:	void
+** Purpose:	Write a sequence of bytes and its length to a bundle.
+** Arguments:
+**	s	the bytes
+**	n	the number of bytes
+**	file	the output stream
+** Returns:	nothing
+**___________________________________________________			     */
+void bundle_put_bytes(s, n, file)		   /*                        */
+  unsigned char *s;				   /*                        */
+  size_t	n;				   /*                        */
+  FILE		*file;				   /*                        */
+{						   /*                        */
+  bundle_put((unsigned long)n, file);		   /*                        */
+  (void)fwrite(s, 1, n, file);			   /*                        */
+  BundleState->bu_hash = bundle_hash(BundleState->bu_hash, s, n);/*          */
+}						   /*------------------------*/
+
+#define PutString(S,F) \
+  bundle_put_bytes(SymbolValue(S), strlen((char*)SymbolValue(S)) + 1, F)
+
+/*-----------------------------------------------------------------------------
+** Function*:	write_bundle()
+** Type:	void
+** Purpose:	Write the resource files and the instructions recorded,
+**		the compiled regular expressions, and the keep table
+**		to a bundle. The file is written under a temporary
+**		name first and renamed afterwards.
+** Arguments:
+**	fname	the name of the bundle
+** Returns:	nothing
+**___________________________________________________			     */
+static void write_bundle(fname)			   /*                        */
+  char		*fname;				   /*                        */
+{ SBundleState	*bs = BundleState;		   /*                        */
+  FILE		*f;				   /*                        */
+  char		*tmp;				   /*                        */
+  unsigned char buf[4];				   /*                        */
+  unsigned long h;				   /*                        */
+  int		i;				   /*                        */
+  bool		ok;				   /*                        */
+ 						   /*                        */
+  if ((tmp = malloc(strlen(fname) + 5)) == NULL)   /*                        */
+  { OUT_OF_MEMORY("bundle"); }			   /*                        */
+  (void)sprintf(tmp, "%s.tmp", fname);		   /*                        */
+  if ((f = fopen(tmp, "wb")) == NULL)		   /*                        */
+  { ERROR2("Resource bundle could not be written: ", fname);/*               */
+    free(tmp);					   /*                        */
+    return;					   /*                        */
+  }						   /*                        */
+ 						   /*                        */
+  (void)fwrite(BUNDLE_MAGIC, 1, BUNDLE_MAGIC_LEN, f);/*                      */
+  bs->bu_hash = BUNDLE_HASH_INIT;		   /*                        */
+  bundle_put(BUNDLE_VERSION, f);		   /*                        */
+  bundle_put_bytes((unsigned char*)bibtool_version,/*                        */
+		   strlen(bibtool_version) + 1,	   /*                        */
+		   f);				   /*                        */
+  bundle_put((unsigned long)bs->bu_nsrc, f);	   /*                        */
+  for (i = 0; i < bs->bu_nsrc; i++)		   /*                        */
+  { bundle_put(bs->bu_src[i].bs_top ? 1UL : 0UL, f);/*                       */
+    bundle_put(bs->bu_src[i].bs_size, f);	   /*                        */
+    bundle_put(bs->bu_src[i].bs_hash, f);	   /*                        */
+    PutString(bs->bu_src[i].bs_name, f);	   /*                        */
+    PutString(bs->bu_src[i].bs_path, f);	   /*                        */
+  }						   /*                        */
+  bundle_put((unsigned long)bs->bu_nins, f);	   /*                        */
+  for (i = 0; i < bs->bu_nins; i++)		   /*                        */
+  { bundle_put((unsigned long)(bs->bu_ins[i].bi_source + 1), f);/*           */
+    bundle_put((unsigned long)bs->bu_ins[i].bi_line, f);/*                   */
+    PutString(bs->bu_ins[i].bi_name, f);	   /*                        */
+    PutString(bs->bu_ins[i].bi_value, f);	   /*                        */
+  }						   /*                        */
+  write_patterns(f);				   /*                        */
+  write_keep_table(f);				   /*                        */
+ 						   /*                        */
+  h	 = bs->bu_hash;				   /*                        */
+  buf[0] = (unsigned char)((h >> 24) & 0xff);	   /*                        */
+  buf[1] = (unsigned char)((h >> 16) & 0xff);	   /*                        */
+  buf[2] = (unsigned char)((h >> 8) & 0xff);	   /*                        */
+  buf[3] = (unsigned char)(h & 0xff);		   /*                        */
+  (void)fwrite(buf, 1, 4, f);			   /*                        */
+ 						   /*                        */
+  ok = !ferror(f);				   /*                        */
+  if (fclose(f) != 0) ok = false;		   /*                        */
+  if (!ok || rename(tmp, fname) != 0)		   /*                        */
+  { (void)remove(tmp);				   /*                        */
+    ERROR2("Resource bundle could not be written: ", fname);/*               */
+  }						   /*                        */
+  free(tmp);					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	bundle_get()
+** Type:	unsigned long
+** Purpose:	Read a word of a bundle.
+** Arguments:
+**	c	the cursor
+** Returns:	The word or |0| if the end of the data is exceeded.
+**___________________________________________________			     */
+unsigned long bundle_get(c)			   /*                        */
+  BundleCursor	c;				   /*                        */
+{ unsigned char *p = c->bc_p;			   /*                        */
+ 						   /*                        */
+  if (c->bc_end - p < 4)			   /*                        */
+  { c->bc_ok = false;				   /*                        */
+    return 0UL;					   /*                        */
+  }						   /*                        */
+  c->bc_p += 4;					   /*                        */
+  return ((unsigned long)p[0] << 24) |		   /*                        */
+	 ((unsigned long)p[1] << 16) |		   /*                        */
+	 ((unsigned long)p[2] << 8)  |		   /*                        */
+	 (unsigned long)p[3];			   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	bundle_bytes()
+** Type:	unsigned char *
+** Purpose:	Read a sequence of bytes of a bundle.
+** Arguments:
+**	c	the cursor
+**	np	pointer to the number of bytes
+** Returns:	The start of the bytes in the bundle or |NULL| if the
+**		end of the data is exceeded.
+**___________________________________________________			     */
+unsigned char * bundle_bytes(c, np)		   /*                        */
+  BundleCursor	c;				   /*                        */
+  size_t	*np;				   /*                        */
+{ unsigned long n = bundle_get(c);		   /*                        */
+  unsigned char *p;				   /*                        */
+ 						   /*                        */
+  if (!c->bc_ok || n > (unsigned long)(c->bc_end - c->bc_p))/*               */
+  { c->bc_ok = false;				   /*                        */
+    return NULL;				   /*                        */
+  }						   /*                        */
+  p	   = c->bc_p;				   /*                        */
+  c->bc_p += n;					   /*                        */
+  *np	   = (size_t)n;				   /*                        */
+  return p;					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	bundle_string()
+** Type:	String
+** Purpose:	Read a string of a bundle.
+** Arguments:
+**	c	the cursor
+** Returns:	The string in the bundle or the empty string if the
+**		data are corrupt.
+**___________________________________________________			     */
+static String bundle_string(c)			   /*                        */
+  BundleCursor	c;				   /*                        */
+{ size_t	n;				   /*                        */
+  unsigned char *p = bundle_bytes(c, &n);	   /*                        */
+ 						   /*                        */
+  if (p == NULL || n == 0 || p[n-1] != '\0')	   /*                        */
+  { c->bc_ok = false;				   /*                        */
+    return (String)"";				   /*                        */
+  }						   /*                        */
+  return (String)p;				   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	is_bundle()
+** Type:	bool
+** Purpose:	Check whether a file opened for reading is a bundle.
+**		The first character is inspected and pushed back.
+** Arguments:
+**	file	the input stream
+** Returns:	|true| iff the file starts like a bundle.
+**___________________________________________________			     */
+bool is_bundle(file)				   /*                        */
+  FILE *file;					   /*                        */
+{ int c = getc(file);				   /*                        */
+ 						   /*                        */
+  if (c == EOF) return false;			   /*                        */
+  (void)ungetc(c, file);			   /*                        */
+  return c == (BUNDLE_MAGIC[0] & 0xff);		   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	read_bundle()
+** Type:	bool
+** Purpose:	Read a bundle. If all resource files contained in it
+**		are unchanged then the compiled regular expressions
+**		are made known, the instructions are evaluated, and
+**		the keep table is installed. Otherwise the resource
+**		files read directly when the bundle has been written
+**		are read again.
+**
+**		If a bundle is requested then the contents of the
+**		bundle read is recorded.
+** Arguments:
+**	path	the name of the bundle
+** Returns:	|false| iff the bundle can not be read.
+**___________________________________________________			     */
+bool read_bundle(path)				   /*                        */
+  Symbol	path;				   /*                        */
+{ FILE		*f;				   /*                        */
+  unsigned char *buf;				   /*                        */
+  long		size;				   /*                        */
+  SBundleCursor c, files, keep;			   /*                        */
+  unsigned long i, n, nsrc, top, sz, h;		   /*                        */
+  Symbol	*paths, name, value, file;	   /*                        */
+  bool		valid = true;			   /*                        */
+  int		line, src;			   /*                        */
+  int		s_line = 0;			   /*                        */
+  Symbol	s_file;				   /*                        */
+  String	p;				   /*                        */
+  SBundleState	*bs = BundleState;		   /*                        */
+ 						   /*                        */
+  if (Recording && bs->bu_top < 0) bs->bu_top = bs->bu_depth;/*              */
+  if ((f = fopen((char*)SymbolValue(path), "rb")) == NULL) return false;/*   */
+  if (fseek(f, 0L, SEEK_END) != 0 ||		   /*                        */
+      (size = ftell(f)) < BUNDLE_MAGIC_LEN + 8 ||  /*                        */
+      fseek(f, 0L, SEEK_SET) != 0 ||		   /*                        */
+      (buf = (unsigned char*)malloc((size_t)size)) == NULL)/*                */
+  { (void)fclose(f);				   /*                        */
+    ERROR2("Resource bundle is corrupt: ", SymbolValue(path));/*             */
+    return true;				   /*                        */
+  }						   /*                        */
+  n = fread(buf, 1, (size_t)size, f);		   /*                        */
+  (void)fclose(f);				   /*                        */
+ 						   /*                        */
+  c.bc_p   = buf + size - 4;			   /*                        */
+  c.bc_end = buf + size;			   /*                        */
+  c.bc_ok  = true;				   /*                        */
+  if (n != (unsigned long)size ||		   /*                        */
+      memcmp(buf, BUNDLE_MAGIC, BUNDLE_MAGIC_LEN) != 0 ||/*                  */
+      bundle_get(&c) != bundle_hash(BUNDLE_HASH_INIT,/*                      */
+			    buf + BUNDLE_MAGIC_LEN,/*                        */
+			    (size_t)size - BUNDLE_MAGIC_LEN - 4))/*          */
+  { free(buf);					   /*                        */
+    ERROR2("Resource bundle is corrupt: ", SymbolValue(path));/*             */
+    return true;				   /*                        */
+  }						   /*                        */
+ 						   /*                        */
+  c.bc_p   = buf + BUNDLE_MAGIC_LEN;		   /*                        */
+  c.bc_end = buf + size - 4;			   /*                        */
+  if (bundle_get(&c) != BUNDLE_VERSION)		   /*                        */
+  { free(buf);					   /*                        */
+    ERROR2("Resource bundle has an unknown version: ", SymbolValue(path));/* */
+    return true;				   /*                        */
+  }						   /*                        */
+  p = bundle_string(&c);			   /* The version of BibTool */
+  if (c.bc_ok && strcmp((char*)p, bibtool_version) != 0)/*                  */
+  { valid = false; }				   /*                        */
+  nsrc = bundle_get(&c);			   /*                        */
+  if (!c.bc_ok || nsrc > (unsigned long)(c.bc_end - c.bc_p) / 20)/*          */
+  { free(buf);					   /*                        */
+    ERROR2("Resource bundle is corrupt: ", SymbolValue(path));/*             */
+    return true;				   /*                        */
+  }						   /*                        */
+  if ((paths = (Symbol*)malloc((nsrc + 1) * sizeof(Symbol))) == NULL)/*      */
+  { OUT_OF_MEMORY("bundle"); }			   /*                        */
+ 						   /*                        */
+  files = c;					   /* Check the files.       */
+  for (i = 0; i < nsrc && c.bc_ok; i++)		   /*                        */
+  { (void)bundle_get(&c);			   /*                        */
+    n = bundle_get(&c);				   /*                        */
+    h = bundle_get(&c);				   /*                        */
+    (void)bundle_string(&c);			   /*                        */
+    p = bundle_string(&c);			   /*                        */
+    if (c.bc_ok && (!file_sum(p, &sz, &top) || sz != n || top != h))/*       */
+    { valid = false; }				   /*                        */
+  }						   /*                        */
+ 						   /*                        */
+  if (c.bc_ok && !valid)			   /* Read the files instead.*/
+  { WARNING2("Resource bundle is out of date: ", SymbolValue(path));/*       */
+    c = files;					   /*                        */
+    for (i = 0; i < nsrc; i++)			   /*                        */
+    { top = bundle_get(&c);			   /*                        */
+      (void)bundle_get(&c);			   /*                        */
+      (void)bundle_get(&c);			   /*                        */
+      p = bundle_string(&c);			   /*                        */
+      (void)bundle_string(&c);			   /*                        */
+      if (top) { (void)resource(p); }		   /*                        */
+    }						   /*                        */
+    free(paths);				   /*                        */
+    free(buf);					   /*                        */
+    return true;				   /*                        */
+  }						   /*                        */
+ 						   /*                        */
+  n = bundle_get(&c);				   /* Skip the instructions  */
+  for (i = 0; i < n && c.bc_ok; i++)		   /*  and make the patterns */
+  { (void)bundle_get(&c);			   /*  known.                */
+    (void)bundle_get(&c);			   /*                        */
+    (void)bundle_string(&c);			   /*                        */
+    (void)bundle_string(&c);			   /*                        */
+  }						   /*                        */
+  if (!c.bc_ok || !read_patterns(&c))		   /*                        */
+  { free(paths);				   /*                        */
+    free(buf);					   /*                        */
+    ERROR2("Resource bundle is corrupt: ", SymbolValue(path));/*             */
+    return true;				   /*                        */
+  }						   /*                        */
+ 						   /*                        */
+  keep = c;					   /*                        */
+  c    = files;					   /* Record the files.      */
+  for (i = 0; i < nsrc; i++)			   /*                        */
+  { top	     = bundle_get(&c);			   /*                        */
+    n	     = bundle_get(&c);			   /*                        */
+    h	     = bundle_get(&c);			   /*                        */
+    name     = symbol(bundle_string(&c));	   /*                        */
+    paths[i] = symbol(bundle_string(&c));	   /*                        */
+    if (Recording)				   /*                        */
+    { (void)add_source(name,			   /*                        */
+		       paths[i],		   /*                        */
+		       top && bs->bu_depth == bs->bu_top,/*                  */
+		       n,			   /*                        */
+		       h);			   /*                        */
+    }						   /*                        */
+  }						   /*                        */
+ 						   /*                        */
+  s_file = rsc_source(&s_line);			   /* Evaluate the           */
+  n	 = bundle_get(&c);			   /*  instructions.         */
+  for (i = 0; i < n; i++)			   /*                        */
+  { src	  = (int)bundle_get(&c) - 1;		   /*                        */
+    line  = (int)bundle_get(&c);		   /*                        */
+    name  = symbol(bundle_string(&c));		   /*                        */
+    value = symbol(bundle_string(&c));		   /*                        */
+    file  = (src >= 0 && (unsigned long)src < nsrc ? paths[src] : NO_SYMBOL);
+    bundle_record(name, value, file, line);	   /*                        */
+    set_rsc_source(file, line);			   /*                        */
+    (void)set_rsc(name, value);			   /*                        */
+  }						   /*                        */
+  set_rsc_source(s_file, s_line);		   /*                        */
+  if (!read_keep_table(&keep) || keep.bc_p != keep.bc_end)/*                 */
+  { ERROR2("Resource bundle is corrupt: ", SymbolValue(path)); }/*           */
+  if (Recording && bs->bu_depth == bs->bu_top)	   /*                        */
+  { write_bundle((char*)rsc_bundle); }		   /*                        */
+ 						   /*                        */
+  free(paths);					   /*                        */
+  free(buf);					   /*                        */
+  return true;					   /*                        */
+}						   /*------------------------*/
@@ -34,6 +34,7 @@
 #include <bibtool/check.h>
 #include <bibtool/wordlist.h>
 #include <bibtool/sbuffer.h>
+#include <bibtool/parse.h>
 #include "config.h"
 
 /*****************************************************************************/
@@ -46,6 +47,7 @@
 #define _ARG(A) ()
 #endif
  static bool do_checks _ARG((DB db,Record rec));
+ bool report_double _ARG((Record rec, int lineno, Symbol source, Symbol key));
 
 /*****************************************************************************/
 /* External Programs and Variables					     */
@@ -53,9 +55,33 @@
 
 /*---------------------------------------------------------------------------*/
 
- static WordList unique_fields = WordNULL;	   /*                        */
+/*-----------------------------------------------------------------------------
+** Variable*:	check_state0
+** Type:	SCheckState
+** Purpose:	The initial state of the check module in a context.
+**___________________________________________________			     */
+ static SCheckState check_state0 =		   /*                        */
+ { WordNULL,					   /* unique_fields          */
+   false					   /* need_sort_key          */
+ };						   /*                        */
+
+#define unique_fields (CheckState->unique_fields)
 
- bool need_sort_key = false;
+/*-----------------------------------------------------------------------------
+** Function:	check_state()
+** Type:	SCheckState*
+** Purpose:	Create the state of the check module in the current
+**		context. This function is used by the macro
+**		|CheckState| when the state does not exist yet.
+** Arguments:	none
+** Returns:	the state
+**___________________________________________________			     */
+SCheckState * check_state()			   /*                        */
+{ return (SCheckState*)ctx_state(CTX_CHECK,	   /*                        */
+				 (void*)&check_state0,/*                     */
+				 sizeof(check_state0),/*                     */
+				 NULL);		   /*                        */
+}						   /*------------------------*/
 
 /*-----------------------------------------------------------------------------
 ** Function:	add_unique_field()
@@ -72,10 +98,23 @@ void add_unique_field(key)			   /*                        */
   sbputs((char*)SymbolValue(key), sb);		   /*                        */
   key = symbol(lower((String)sbflush(sb)));	   /*                        */
   add_word(key, &unique_fields);		   /*                        */
+  demand_field(key);				   /* values are compared    */
   (void)sbclose(sb);				   /*                        */
   if (key == sym_sortkey) { need_sort_key = true; }/*                        */
 }						   /*------------------------*/
 
+/*-----------------------------------------------------------------------------
+** Function:	have_unique_fields()
+** Type:	bool
+** Purpose:	Check whether |apply_checks()| has to check unique
+**		fields.
+** Arguments:	none
+** Returns:	|true| iff unique fields are checked.
+**___________________________________________________			     */
+bool have_unique_fields()			   /*                        */
+{ return unique_fields != WordNULL;		   /*                        */
+}						   /*------------------------*/
+
 /*-----------------------------------------------------------------------------
 ** Function:	apply_checks()
 ** Type:	void
@@ -94,6 +133,44 @@ void apply_checks(db)				   /*                        */
 
 #define equal_records(R1,R2) RecordSortkey(R1) == RecordSortkey(R2)
 
+/*-----------------------------------------------------------------------------
+** Function:	report_double()
+** Type:	bool
+** Purpose:	Report that a record is a possible double of another
+**		one with the same sort key. The record is marked as
+**		deleted unless it should be removed altogether.
+** Arguments:
+**	rec	the record
+**	lineno	the line number of the other record
+**	source	the source of the other record
+**	key	the reference key of the other record
+** Returns:	|true| iff the record should be removed.
+**___________________________________________________			     */
+bool report_double(rec, lineno, source, key)	   /*                        */
+  Record rec;					   /*                        */
+  int	 lineno;				   /*                        */
+  Symbol source;				   /*                        */
+  Symbol key;					   /*                        */
+{						   /*                        */
+  if (!rsc_quiet)				   /*                        */
+  { ErrPrint("*** BibTool WARNING");		   /*                        */
+    err_location(RecordLineno(rec),		   /*                        */
+		 RecordSource(rec),		   /*                        */
+		 ": Possible double entry discovered to");/*                 */
+    err_location(lineno, source, NULL);		   /*                        */
+    ErrPrintF(" `%s'\n", (char*)key);		   /*                        */
+ 						   /*                        */
+    DebugPrintF3("***\t%s =?= %s\n",		   /*                        */
+		 (char*)SymbolValue(key),	   /*                        */
+		 (char*)SymbolValue(*RecordHeap(rec)));/*                    */
+    DebugPrintF2("***\tsort key: %s\n",		   /*                        */
+		 (char*)SymbolValue(RecordSortkey(rec)));/*                  */
+  }						   /*                        */
+  if (rsc_del_dbl) return true;			   /*                        */
+  SetRecordDELETED(rec);			   /*                        */
+  return false;					   /*                        */
+}						   /*------------------------*/
+
 /*-----------------------------------------------------------------------------
 ** Function*:	do_checks()
 ** Purpose:	Check whether the given record has a double.
@@ -121,26 +198,13 @@ static bool do_checks(db,rec)			   /*                        */
     prev = PrevRecord(rec2);			   /*                        */
 						   /*                        */
     if (rsc_double_check && equal_records(rec,rec2))/*			     */
-    {						   /*                        */
-      if (!rsc_quiet)				   /*                        */
-      {	ErrPrint("*** BibTool WARNING");	   /*                        */
-	err_location(RecordLineno(rec),		   /*                        */
-		     RecordSource(rec),		   /*                        */
-		     ": Possible double entry discovered to");/*             */
-	err_location(RecordLineno(rec2),	   /*                        */
-		     RecordSource(rec2), NULL);	   /*                        */
-	ErrPrintF(" `%s'\n", (char*)k2);	   /*                        */
-						   /*                        */
-	DebugPrintF3("***\t%s =?= %s\n",	   /*                        */
-		     (char*)SymbolValue(k2),	   /*                        */
-		     (char*)SymbolValue(k1));	   /*                        */
-	DebugPrintF2("***\tsort key: %s\n",	   /*                        */
-		     (char*)SymbolValue(RecordSortkey(rec))); /*             */
+    { if (report_double(rec,			   /*                        */
+			RecordLineno(rec2),	   /*                        */
+			RecordSource(rec2),	   /*                        */
+			k2))			   /*                        */
+      { delete_record(db,rec);	   		   /*                        */
+	return false;				   /* rec has been freed     */
       }						   /*                        */
-      if (rsc_del_dbl)				   /*                        */
-      { delete_record(db,rec); }	   	   /*                        */
-      else 					   /*                        */
-      { SetRecordDELETED(rec); }		   /*                        */
     }						   /*			     */
  						   /*                        */
     for (wl = unique_fields; wl; wl = NextWord(wl))/*                        */
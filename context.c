@@ -0,0 +1,204 @@
+/*** context.c ****************************************************************
+**
+** This file is part of BibTool.
+** It is distributed under the GNU General Public License.
+** See the file COPYING for details.
+**
+** (c) 2020 Gerd Neugebauer
+**
+** Net: gene@gerd-neugebauer.de
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+**-----------------------------------------------------------------------------
+** Description:
+**	This module contains functions to create, select, and release
+**	contexts. A context carries the state of the library. See
+**	|context.h| for details.
+**
+******************************************************************************/
+
+#include <bibtool/general.h>
+#include <bibtool/error.h>
+#include <bibtool/context.h>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
+/*****************************************************************************/
+/* Internal Programs							     */
+/*===========================================================================*/
+
+#ifdef __STDC__
+#define _ARG(A) A
+#else
+#define _ARG(A) ()
+#endif
+
+/*****************************************************************************/
+/* External Programs							     */
+/*===========================================================================*/
+
+/*---------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Variable:	ctx_this
+** Type:	Context
+** Purpose:	The current context of the thread or |NULL| if the
+**		thread has not used the library yet.
+**___________________________________________________			     */
+ THREAD_LOCAL Context ctx_this = ContextNULL;	   /*                        */
+
+/*-----------------------------------------------------------------------------
+** Variable*:	ctx_default
+** Type:	SContext
+** Purpose:	The default context. It is used by all threads which
+**		have not selected another context.
+**___________________________________________________			     */
+ static SContext ctx_default;			   /*                        */
+
+/*-----------------------------------------------------------------------------
+** Variable*:	ctx_lock
+** Type:	pthread_mutex_t
+** Purpose:	The lock guarding the creation of module states. Several
+**		threads may use the default context for the first time
+**		at once.
+**___________________________________________________			     */
+#ifdef HAVE_PTHREAD_H
+ static pthread_mutex_t ctx_lock = PTHREAD_MUTEX_INITIALIZER;/*              */
+#endif
+
+/*-----------------------------------------------------------------------------
+** Function:	ctx_new()
+** Type:	Context
+** Purpose:	Allocate a new context. The context is empty. It has
+**		to be initialized like the default context with
+**		|init_bibtool()| after it has been made the current
+**		context with |ctx_use()|.
+**
+**		If no more memory is available then an error is raised
+**		and the program is terminated.
+** Arguments:	none
+** Returns:	the new context
+**___________________________________________________			     */
+Context ctx_new()				   /*                        */
+{ Context ctx;					   /*                        */
+ 						   /*                        */
+  if ((ctx = (Context)calloc(1, sizeof(SContext))) == ContextNULL)/*         */
+  { OUT_OF_MEMORY("Context"); }			   /*                        */
+  return ctx;					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	ctx_use()
+** Type:	Context
+** Purpose:	Make a context the current context of the calling
+**		thread. All functions of the library called afterwards
+**		in this thread work on this context.
+** Arguments:
+**	ctx	the context or |ContextNULL| for the default context
+** Returns:	the previous context of the thread
+**___________________________________________________			     */
+Context ctx_use(ctx)				   /*                        */
+  Context ctx;					   /*                        */
+{ Context old = ctx_current();			   /*                        */
+  ctx_this    = (ctx ? ctx : &ctx_default);	   /*                        */
+  return old;					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	ctx_current()
+** Type:	Context
+** Purpose:	Getter for the current context of the calling thread.
+** Arguments:	none
+** Returns:	the current context
+**___________________________________________________			     */
+Context ctx_current()				   /*                        */
+{						   /*                        */
+  if (ctx_this == ContextNULL) ctx_this = &ctx_default;/*                    */
+  return ctx_this;				   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	ctx_free()
+** Type:	void
+** Purpose:	Release a context and the states of its modules. The
+**		destructors of the modules release the memory held by
+**		the states. Records and databases are not part of the
+**		context. They have to be released with |free_db()|
+**		before. The default context can not be released.
+** Arguments:
+**	ctx	the context
+** Returns:	nothing
+**___________________________________________________			     */
+void ctx_free(ctx)				   /*                        */
+  Context ctx;					   /*                        */
+{ Context old;					   /*                        */
+  int	  i;					   /*                        */
+ 						   /*                        */
+  if (ctx == ContextNULL || ctx == &ctx_default) return;/*                   */
+ 						   /*                        */
+  old = ctx_use(ctx);				   /* The destructors work on*/
+  for (i = CTX_MODULES - 1; i >= 0; i--)	   /*  the current context.  */
+  { if (ctx->cx_state[i] && ctx->cx_free[i])	   /*                        */
+    { (*ctx->cx_free[i])(ctx->cx_state[i]); }	   /*                        */
+  }						   /*                        */
+  for (i = 0; i < CTX_MODULES; i++)		   /*                        */
+  { if (ctx->cx_state[i]) free(ctx->cx_state[i]); }/*                        */
+  (void)ctx_use(old == ctx ? ContextNULL : old);   /*                        */
+  free(ctx);					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	ctx_state()
+** Type:	void*
+** Purpose:	Get the state of a module in the current context. If it
+**		does not exist yet then it is created as a copy of a
+**		template. This function is used by the macro
+**		|CtxState()| when the state is not found.
+**
+**		If no more memory is available then an error is raised
+**		and the program is terminated.
+** Arguments:
+**	id	the index of the module
+**	init	the template of the state
+**	size	the size of the state
+**	destroy	the function releasing the memory held by the state
+**		or |NULL|
+** Returns:	the state of the module
+**___________________________________________________			     */
+void * ctx_state(id, init, size, destroy)	   /*                        */
+  int	 id;					   /*                        */
+  void	 *init;					   /*                        */
+  size_t size;					   /*                        */
+  void	 (*destroy)_ARG((void*));		   /*                        */
+{ Context ctx = ctx_current();			   /*                        */
+  void	  *state;				   /*                        */
+ 						   /*                        */
+#ifdef HAVE_PTHREAD_H
+  (void)pthread_mutex_lock(&ctx_lock);		   /*                        */
+#endif
+  if ((state = ctx->cx_state[id]) == NULL)	   /*                        */
+  { if ((state = malloc(size)) == NULL)		   /*                        */
+    { OUT_OF_MEMORY("Context"); }		   /*                        */
+    (void)memcpy(state, init, size);		   /*                        */
+    ctx->cx_free[id]  = destroy;		   /*                        */
+    CtxStore(ctx, id, state);			   /* publish after the copy */
+  }						   /*                        */
+#ifdef HAVE_PTHREAD_H
+  (void)pthread_mutex_unlock(&ctx_lock);	   /*                        */
+#endif
+  return state;					   /*                        */
+}						   /*------------------------*/
@@ -37,11 +37,20 @@
 #include <bibtool/sbuffer.h>
 #include <bibtool/rsc.h>
 #include <bibtool/entry.h>
+#include <bibtool/expand.h>
+#include <bibtool/key.h>
 
 /*****************************************************************************/
 /* Internal Programs                                                         */
 /*===========================================================================*/
 
+#ifdef __STDC__
+#define _ARG(A) A
+#else
+#define _ARG(A) ()
+#endif
+ static void xref_free _ARG((void *state));	   /*                        */
+
 /*****************************************************************************/
 /* External Programs                                                         */
 /*===========================================================================*/
@@ -56,6 +65,40 @@
    struct mAP * next_map;			   /*                        */
  } *Map, SMap;					   /*                        */
 
+#define MAP_SIZE 101
+
+/*-----------------------------------------------------------------------------
+** Typedef*:	SXrefState
+** Purpose:	The state of the crossref module in a context. It
+**		contains the crossref map and the crossref graph.
+**___________________________________________________			     */
+ typedef struct					   /*                        */
+ { Map		map[MAP_SIZE];			   /* the crossref map       */
+   struct xNODE *x_node;			   /* the nodes              */
+   int		x_nodes;			   /* the number of nodes    */
+   int		*x_index;			   /* key -> node hash table */
+   int		x_index_size;			   /*                        */
+   int		*x_edge;			   /* the parent node indices*/
+   int		x_edges;			   /*                        */
+   int		x_edge_size;			   /*                        */
+   int		*x_stack;			   /* the active nodes       */
+   StringBuffer *x_sb;				   /*                        */
+ } SXrefState;					   /*                        */
+
+/*-----------------------------------------------------------------------------
+** Variable*:	xref_state0
+** Type:	SXrefState
+** Purpose:	The initial state of the crossref module in a
+**		context. The map and the graph are empty.
+**___________________________________________________			     */
+ static SXrefState xref_state0;			   /*                        */
+
+#define XrefState ((SXrefState*)CtxGet(CTX_CROSSREF,			\
+				       ctx_state(CTX_CROSSREF,		\
+						 (void*)&xref_state0,	\
+						 sizeof(xref_state0),	\
+						 xref_free)))
+
 #define SourceRecord(M)      ((M)->src_rec)
 #define SourceField(M)       ((M)->src_field)
 #define DestinationRecord(M) ((M)->dest_rec)
@@ -108,9 +151,7 @@ static void free_map(m)				   /*                        */
   }						   /*                        */
 }						   /*------------------------*/
 
-#define MAP_SIZE 101
-
- static Map map[MAP_SIZE];			   /*                        */
+#define map (XrefState->map)
 
 #define MAP_INDEX(SR,SF,DR)				\
   (int)((((SR) % 73) +					\
@@ -260,6 +301,37 @@ void crossref_map(spec)				   /*                        */
 
  static Symbol NONE = (Symbol)"x";		   /* TODO                   */
 
+/*-----------------------------------------------------------------------------
+** Function*:	inherit_fields()
+** Type:	void
+** Purpose:	Provide the fields of a referenced record to a record.
+**		Fields already present in the record are not overwritten.
+**		The field names are subject to the crossref map.
+** Arguments:
+**	rec	the record
+**	r	the referenced record
+** Returns:	nothing
+**___________________________________________________			     */
+static void inherit_fields(rec, r)		   /*                        */
+  Record rec;					   /*                        */
+  Record r;					   /*                        */
+{ register Symbol *hp;				   /*                        */
+  Symbol s, t, ms;				   /*                        */
+  int    i;					   /*                        */
+ 						   /*                        */
+  for (i = RecordFree(r), hp = RecordHeap(r);	   /* visit all fields       */
+       i > 0;					   /*                        */
+       i -= 2)					   /*                        */
+  { s = *hp++;					   /*                        */
+    t = *hp++;					   /*                        */
+    if (s != NO_SYMBOL && t != NO_SYMBOL)	   /*                        */
+    { ms = map_get(RecordType(r), s,		   /*                        */
+		   RecordType(rec));		   /*                        */
+      provide_to_record(rec, ms ? ms : s, t);	   /*                        */
+    }						   /*                        */
+  }						   /*                        */
+}						   /*------------------------*/
+
 /*-----------------------------------------------------------------------------
 ** Function*:	insert_record()
 ** Type:	bool
@@ -267,38 +339,23 @@ void crossref_map(spec)				   /*                        */
 ** Arguments:
 **	db	the database
 **	rec	the record
-**	hp	the heap pointer
 **	s	the key of the entry
 **	msg	the message prefix for an unknown entry message
 ** Returns:	|true| iff the record could be inserted
 **___________________________________________________			     */
-static bool insert_record(db, rec, hp, s, msg)	   /*                        */
+static bool insert_record(db, rec, s, msg)	   /*                        */
   DB     db;					   /*                        */
   Record rec;					   /*                        */
-  register Symbol *hp;				   /*			     */
   Symbol s;					   /*                        */
   String msg;					   /*                        */
 { Record r;					   /*                        */
-  Symbol t, ms;					   /*                        */
-  int    i;					   /*                        */
  						   /*                        */
-  if ((r = db_find(db, s)) == RecordNULL)	   /*			     */
+  if ((r = db_find(db, s)) == RecordNULL)	   /*                        */
   { ERROR3(msg," entry not found: ",		   /*                        */
-	   (char*)SymbolValue(s)); 	   	   /*		             */
-    return false;				   /*			     */
-  }						   /*			     */
-    						   /*                        */
-  for (i = RecordFree(r), hp = RecordHeap(r);  	   /* visit all fields       */
-       i > 0;				   	   /*			     */
-       i -= 2)			   	   	   /*			     */
-  { s = *hp++;			   	   	   /*                        */
-    t = *hp++;			   	   	   /*                        */
-    if (t != NO_SYMBOL)			   	   /*                        */
-    { ms = map_get(RecordType(r), s,	   	   /*                        */
-		   RecordType(rec));	   	   /*                        */
-      provide_to_record(rec, ms ? ms : s, t);  	   /*                        */
-    }	   				   	   /*                        */
+	   (char*)SymbolValue(s));		   /*                        */
+    return false;				   /*                        */
   }						   /*                        */
+  inherit_fields(rec, r);			   /*                        */
   return true;					   /*                        */
 }						   /*------------------------*/
 
@@ -342,18 +399,22 @@ bool expand_crossref(db, rec)		   	   /*                        */
     }						   /*                        */
     else if (*hp == sym_crossref)		   /* ---------------------- */
     {						   /*                        */
-      if (rec == r) { *hp = NULL; }		   /* Delete the first xref  */
+      if (rec == r)				   /* Delete the first xref  */
+      { *hp = NULL;				   /*                        */
+	SetRecordDIRTY(r);			   /*                        */
+      }						   /*                        */
       x = SymbolValue(*++hp);			   /*                        */
       x++;				   	   /*			     */
       sp_open(x);		   		   /* Try to extract	     */
       if ((s = SParseSymbol(&x)) ==  NO_SYMBOL)	   /*  the crossref as symbol*/
       { return false; }				   /*			     */
 						   /*			     */
-      insert_record(db, rec, hp, s, "Crossref");   /*                        */
+      insert_record(db, rec, s, "Crossref");	   /*                        */
     }						   /*			     */
     else if (*hp == sym_xdata)			   /* ---------------------- */
     {						   /*                        */
       *hp = NULL;		   		   /* Delete the first xref  */
+      SetRecordDIRTY(r);			   /*                        */
       x = SymbolValue(*++hp);			   /*                        */
       x++;				   	   /*			     */
       sp_open(x);		   		   /* Try to extract	     */
@@ -364,7 +425,7 @@ bool expand_crossref(db, rec)		   	   /*                        */
       { if ((s = SParseSymbol(&x)) == NO_SYMBOL)   /*                        */
 	{ return true; }			   /*                        */
  						   /*                        */
-	insert_record(db, rec, hp, s, "XData");	   /*                        */
+	insert_record(db, rec, s, "XData");	   /*                        */
  						   /*                        */
 	if (sp_expect(&x, (String)"}", 0) ) break; /*                        */
 	sp_expect(&x, (String)",", 1);		   /*                        */
@@ -373,3 +434,390 @@ bool expand_crossref(db, rec)		   	   /*                        */
   }						   /*                        */
   return false;	   				   /*			     */
 }						   /*------------------------*/
+
+/*****************************************************************************/
+/***			     Crossref Graph				   ***/
+/*****************************************************************************/
+
+ typedef struct xNODE				   /*                        */
+ { Record xn_rec;				   /* the record             */
+   int	  xn_first;				   /* index of the first edge*/
+   int	  xn_count;				   /* number of edges        */
+   int	  xn_next;				   /* next edge to visit     */
+   int	  xn_state;				   /*                        */
+ } SXNode, *XNode;				   /*                        */
+
+#define XNodeRecord(N)	((N)->xn_rec)
+#define XNodeFirst(N)	((N)->xn_first)
+#define XNodeCount(N)	((N)->xn_count)
+#define XNodeNext(N)	((N)->xn_next)
+#define XNodeState(N)	((N)->xn_state)
+
+#define X_NEW		0
+#define X_ACTIVE	1
+#define X_DONE		2
+
+#define x_node	     (XrefState->x_node)
+#define x_nodes	     (XrefState->x_nodes)
+#define x_index	     (XrefState->x_index)
+#define x_index_size (XrefState->x_index_size)
+#define x_edge	     (XrefState->x_edge)
+#define x_edges	     (XrefState->x_edges)
+#define x_edge_size  (XrefState->x_edge_size)
+#define x_stack	     (XrefState->x_stack)
+#define x_sb	     (XrefState->x_sb)
+
+#define XKey(R)		(RecordOldKey(R) != NO_SYMBOL	\
+			 ? RecordOldKey(R)		\
+			 : *RecordHeap(R))
+#define XNodeKey(N)	XKey(XNodeRecord(&x_node[N]))
+#define XHash(S)	((int)(((unsigned long)(S) >> 3)	\
+			       & (x_index_size - 1)))
+
+/*-----------------------------------------------------------------------------
+** Function*:	x_add_node()
+** Type:	void
+** Purpose:	Add a record to the graph and register its key unless
+**		the key is already known.
+** Arguments:
+**	rec	the record
+** Returns:	nothing
+**___________________________________________________			     */
+static void x_add_node(rec)			   /*                        */
+  Record rec;					   /*                        */
+{ Symbol key = XKey(rec);			   /*                        */
+  int    i;					   /*                        */
+ 						   /*                        */
+  XNodeRecord(&x_node[x_nodes]) = rec;		   /*                        */
+  XNodeFirst(&x_node[x_nodes])  = 0;		   /*                        */
+  XNodeCount(&x_node[x_nodes])  = 0;		   /*                        */
+  XNodeNext(&x_node[x_nodes])   = 0;		   /*                        */
+  XNodeState(&x_node[x_nodes])  = X_NEW;	   /*                        */
+ 						   /*                        */
+  for (i = XHash(key);				   /*                        */
+       x_index[i] >= 0;				   /*                        */
+       i = (i + 1) & (x_index_size - 1))	   /*                        */
+  { if (XKey(XNodeRecord(&x_node[x_index[i]])) == key)/* first one wins      */
+    { x_nodes++;				   /*                        */
+      return;					   /*                        */
+    }						   /*                        */
+  }						   /*                        */
+  x_index[i] = x_nodes++;			   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	x_open()
+** Type:	void
+** Purpose:	Create the nodes of the crossref graph for the records
+**		of a database. The records are visited in the same
+**		order as |db_find()| does. Thus the same record is
+**		found for a key.
+** Arguments:
+**	db	the database
+**	deleted	indicator whether deleted records should be included
+** Returns:	nothing
+**___________________________________________________			     */
+static void x_open(db, deleted)			   /*                        */
+  DB   db;					   /*                        */
+  bool deleted;					   /*                        */
+{ Record rec;					   /*                        */
+  int    n = 0;					   /*                        */
+ 						   /*                        */
+  x_nodes = 0;					   /*                        */
+  x_edges = 0;					   /*                        */
+  if (DBnormal(db) == RecordNULL) return;	   /*                        */
+ 						   /*                        */
+  for (rec = DBnormal(db); rec; rec = NextRecord(rec))/*                     */
+  { n++; }					   /*                        */
+  for (rec = PrevRecord(DBnormal(db)); rec; rec = PrevRecord(rec))/*         */
+  { n++; }					   /*                        */
+ 						   /*                        */
+  for (x_index_size = 64; x_index_size < 2 * n; x_index_size *= 2) {}/*      */
+  if ((x_node = (XNode)malloc(n * sizeof(SXNode))) == (XNode)NULL ||/*       */
+      (x_stack = (int*)malloc(n * sizeof(int))) == (int*)NULL ||/*           */
+      (x_index = (int*)malloc(x_index_size * sizeof(int))) == (int*)NULL)/*  */
+  { OUT_OF_MEMORY("crossref graph"); }		   /*                        */
+  memset(x_index, 0xff, x_index_size * sizeof(int));/* all entries -1        */
+ 						   /*                        */
+  for (rec = DBnormal(db); rec; rec = NextRecord(rec))/*                     */
+  { if (deleted || !RecordIsDELETED(rec)) x_add_node(rec); }/*               */
+  for (rec = PrevRecord(DBnormal(db)); rec; rec = PrevRecord(rec))/*         */
+  { if (deleted || !RecordIsDELETED(rec)) x_add_node(rec); }/*               */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	x_close()
+** Type:	void
+** Purpose:	Release the crossref graph.
+** Arguments:	none
+** Returns:	nothing
+**___________________________________________________			     */
+static void x_close()				   /*                        */
+{						   /*                        */
+  if (x_node)  { free(x_node);  x_node  = (XNode)NULL; }/*                   */
+  if (x_index) { free(x_index); x_index = (int*)NULL; }/*                    */
+  if (x_stack) { free(x_stack); x_stack = (int*)NULL; }/*                    */
+  if (x_edge)  { free(x_edge);  x_edge  = (int*)NULL; }/*                    */
+  x_nodes = x_edges = x_edge_size = x_index_size = 0;/*                      */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	xref_free()
+** Type:	void
+** Purpose:	Release the crossref map and graph of a context. This
+**		function is called when the context is released. It
+**		is the current context then.
+** Arguments:
+**	state	the state of the crossref module
+** Returns:	nothing
+**___________________________________________________			     */
+static void xref_free(state)			   /*                        */
+  void *state;					   /*                        */
+{						   /*                        */
+  POSSIBLY_UNUSED(state);			   /*                        */
+  clear_map();					   /*                        */
+  x_close();					   /*                        */
+  if (x_sb) (void)sbclose(x_sb);		   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	x_find()
+** Type:	int
+** Purpose:	Find the node of a record with a given key.
+** Arguments:
+**	key	the key
+** Returns:	the index of the node or -1
+**___________________________________________________			     */
+static int x_find(key)				   /*                        */
+  Symbol key;					   /*                        */
+{ int i;					   /*                        */
+ 						   /*                        */
+  if (x_nodes == 0) return -1;			   /*                        */
+  for (i = XHash(key);				   /*                        */
+       x_index[i] >= 0;				   /*                        */
+       i = (i + 1) & (x_index_size - 1))	   /*                        */
+  { if (XKey(XNodeRecord(&x_node[x_index[i]])) == key)/*                     */
+    { return x_index[i]; }			   /*                        */
+  }						   /*                        */
+  return -1;					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	x_add_edge()
+** Type:	void
+** Purpose:	Add an edge from the last node with edges to the node
+**		of the given key.
+** Arguments:
+**	key	the key of the referenced record
+**	msg	the message prefix for an unknown entry message
+** Returns:	nothing
+**___________________________________________________			     */
+static void x_add_edge(key, msg)		   /*                        */
+  Symbol key;					   /*                        */
+  String msg;					   /*                        */
+{ int n = x_find(key);				   /*                        */
+ 						   /*                        */
+  if (n < 0)					   /*                        */
+  { ERROR3(msg," entry not found: ",		   /*                        */
+	   (char*)SymbolValue(key));		   /*                        */
+    return;					   /*                        */
+  }						   /*                        */
+  if (x_edges >= x_edge_size)			   /*                        */
+  { x_edge_size = (x_edge_size ? 2 * x_edge_size : 256);/*                   */
+    if ((x_edge = (x_edge			   /*                        */
+		   ? (int*)realloc(x_edge, x_edge_size * sizeof(int))/*      */
+		   : (int*)malloc(x_edge_size * sizeof(int))))/*             */
+	== (int*)NULL)				   /*                        */
+    { OUT_OF_MEMORY("crossref graph"); }	   /*                        */
+  }						   /*                        */
+  x_edge[x_edges++] = n;			   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	x_parents()
+** Type:	void
+** Purpose:	Collect the edges of a node. The edges point to the
+**		records named in the crossref and xdata fields if the
+**		respective expansion is enabled. Those fields are
+**		removed from the record.
+** Arguments:
+**	xn	the node
+** Returns:	nothing
+**___________________________________________________			     */
+static void x_parents(xn)			   /*                        */
+  XNode xn;					   /*                        */
+{ Record rec = XNodeRecord(xn);			   /*                        */
+  Symbol *hp, s;				   /*                        */
+  String x;					   /*                        */
+  int    i;					   /*                        */
+ 						   /*                        */
+  XNodeFirst(xn) = x_edges;			   /*                        */
+  if (!RecordIsXREF(rec)) return;		   /*                        */
+ 						   /*                        */
+  for (i = RecordFree(rec), hp = RecordHeap(rec); i > 0; i -= 2, hp += 2)/*  */
+  { if (*hp == NO_SYMBOL || hp[1] == NO_SYMBOL) continue;/*                 */
+    if (*hp == sym_crossref && rsc_expand_crossref)/*                        */
+    { *hp = NO_SYMBOL;				   /* Delete the xref        */
+      SetRecordDIRTY(rec);			   /*                        */
+      x = SymbolValue(hp[1]) + 1;		   /*                        */
+      sp_open(x);				   /*                        */
+      if ((s = SParseSymbol(&x)) != NO_SYMBOL)	   /*                        */
+      { x_add_edge(s, (String)"Crossref"); }	   /*                        */
+    }						   /*                        */
+    else if (*hp == sym_xdata && rsc_expand_xdata) /*                        */
+    { *hp = NO_SYMBOL;				   /* Delete the xdata       */
+      SetRecordDIRTY(rec);			   /*                        */
+      x = SymbolValue(hp[1]) + 1;		   /*                        */
+      sp_open(x);				   /*                        */
+      if (sp_expect(&x, (String)"}", 0)) continue; /*                        */
+      while ((s = SParseSymbol(&x)) != NO_SYMBOL)  /*                        */
+      { x_add_edge(s, (String)"XData");		   /*                        */
+	if (sp_expect(&x, (String)"}", 0)) break;  /*                        */
+	sp_expect(&x, (String)",", 1);		   /*                        */
+      }						   /*                        */
+    }						   /*                        */
+  }						   /*                        */
+  XNodeCount(xn) = x_edges - XNodeFirst(xn);	   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	x_cycle()
+** Type:	void
+** Purpose:	Report a cycle. The cycle consists of the nodes on the
+**		stack starting at the given node.
+** Arguments:
+**	n	the index of the node closing the cycle
+**	sp	the stack pointer
+** Returns:	nothing
+**___________________________________________________			     */
+static void x_cycle(n, sp)			   /*                        */
+  int n;					   /*                        */
+  int sp;					   /*                        */
+{ int i;					   /*                        */
+ 						   /*                        */
+  if (x_sb == (StringBuffer*)NULL) x_sb = sbopen();/*                        */
+  sbrewind(x_sb);				   /*                        */
+  for (i = sp - 1; i > 0 && x_stack[i] != n; i--) {}/*                       */
+  for (; i < sp; i++)				   /*                        */
+  { (void)sbputs((char*)SymbolValue(XNodeKey(x_stack[i])), x_sb);/*          */
+    (void)sbputs(" -> ", x_sb);			   /*                        */
+  }						   /*                        */
+  (void)sbputs((char*)SymbolValue(XNodeKey(n)), x_sb);/*                     */
+  ERROR2("Crossref cycle: ", sbflush(x_sb));	   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	expand_crossrefs()
+** Type:	void
+** Purpose:	Expand all items inherited via crossref or xdata fields
+**		in all records of a database. The graph of references
+**		is built once and resolved in topological order. Thus
+**		each referenced record is expanded before its fields
+**		are inherited and it is expanded only once. Cycles are
+**		reported and broken. The record closing a cycle
+**		inherits the own fields of its parent on the cycle but
+**		not those the parent inherits itself.
+** Arguments:
+**	db	the database
+** Returns:	nothing
+**___________________________________________________			     */
+void expand_crossrefs(db)			   /*                        */
+  DB db;					   /*                        */
+{ XNode xn;					   /*                        */
+  int   i, n, p, sp;				   /*                        */
+ 						   /*                        */
+  DebugPrint1("expand_crossrefs");		   /*                        */
+  x_open(db, false);				   /*                        */
+ 						   /*                        */
+  for (i = 0; i < x_nodes; i++)			   /*                        */
+  { if (XNodeState(&x_node[i]) != X_NEW ||	   /*                        */
+	!RecordIsXREF(XNodeRecord(&x_node[i]))) continue;/*                  */
+ 						   /*                        */
+    sp = 0;					   /* Depth first search     */
+    x_stack[sp++] = i;				   /*                        */
+    XNodeState(&x_node[i]) = X_ACTIVE;		   /*                        */
+    x_parents(&x_node[i]);			   /*                        */
+ 						   /*                        */
+    while (sp > 0)				   /*                        */
+    { xn = &x_node[n = x_stack[sp - 1]];	   /*                        */
+      if (XNodeNext(xn) < XNodeCount(xn))	   /* Visit the next parent  */
+      { p = x_edge[XNodeFirst(xn) + XNodeNext(xn)++];/*                      */
+	switch (XNodeState(&x_node[p]))		   /*                        */
+	{ case X_NEW:				   /*                        */
+	    XNodeState(&x_node[p]) = X_ACTIVE;	   /*                        */
+	    x_stack[sp++] = p;			   /*                        */
+	    x_parents(&x_node[p]);		   /*                        */
+	    break;				   /*                        */
+	  case X_ACTIVE:			   /*                        */
+	    x_cycle(p, sp);			   /*                        */
+	    break;				   /*                        */
+	}					   /*                        */
+	continue;				   /*                        */
+      }						   /*                        */
+ 						   /*                        */
+      for (p = 0; p < XNodeCount(xn); p++)	   /* Inherit from parents.  */
+      { XNode xp = &x_node[x_edge[XNodeFirst(xn) + p]];/* An active parent   */
+	inherit_fields(XNodeRecord(xn), XNodeRecord(xp));/* closes a cycle.  */
+      }						   /* It has only its own    */
+ 						   /*  fields yet.           */
+      XNodeState(xn) = X_DONE;			   /*                        */
+      sp--;					   /*                        */
+    }						   /*                        */
+  }						   /*                        */
+  x_close();					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	db_xref_undelete()
+** Type:	void
+** Purpose:	Scan through the database and undelete all entries
+**		which are in the transitive closure wrt the crossref
+**		relation. Initially all not deleted entries are in the
+**		set to consider. Each record is visited only once and
+**		cycles are reported.
+** Arguments:
+**	db	Database to treat
+** Returns:	nothing
+**___________________________________________________			     */
+void db_xref_undelete(db)			   /*                        */
+  DB db;					   /*                        */
+{ Symbol key;					   /*                        */
+  int    i, n, p, sp;				   /*                        */
+ 						   /*                        */
+  x_open(db, true);				   /*                        */
+ 						   /*                        */
+  for (i = 0; i < x_nodes; i++)			   /*                        */
+  { if (XNodeState(&x_node[i]) != X_NEW ||	   /*                        */
+	RecordIsDELETED(XNodeRecord(&x_node[i])))  /*                        */
+    { continue; }				   /*                        */
+ 						   /*                        */
+    sp = 0;					   /* Follow the crossref    */
+    for (n = i; n >= 0; n = p)			   /* chain                  */
+    { XNodeState(&x_node[n]) = X_ACTIVE;	   /*                        */
+      x_stack[sp++] = n;			   /*                        */
+      p = -1;					   /*                        */
+      if (!RecordIsXREF(XNodeRecord(&x_node[n])) ||/*                        */
+	  (key = get_field(db,			   /*                        */
+			   XNodeRecord(&x_node[n]),/*                        */
+			   sym_crossref)) == NO_SYMBOL)/*                    */
+      { break; }				   /*                        */
+ 						   /*                        */
+      key = expand_rhs(key, sym_empty, sym_empty, db, true);/*               */
+      if ((p = x_find(key)) < 0)		   /*                        */
+      { ErrPrintF("*** BibTool: Crossref `%s' not found.\n",/*               */
+		  SymbolValue(key));		   /*                        */
+      }						   /*                        */
+      else if (XNodeState(&x_node[p]) == X_ACTIVE) /*                        */
+      { x_cycle(p, sp);				   /*                        */
+	p = -1;					   /*                        */
+      }						   /*                        */
+      else if (XNodeState(&x_node[p]) == X_DONE)   /*                        */
+      { p = -1; }				   /*                        */
+      else					   /*                        */
+      { ClearRecordDELETED(XNodeRecord(&x_node[p])); }/*                     */
+    }						   /*                        */
+    while (sp > 0)				   /*                        */
+    { XNodeState(&x_node[x_stack[--sp]]) = X_DONE; }/*                       */
+  }						   /*                        */
+  x_close();					   /*                        */
+}						   /*------------------------*/
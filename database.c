@@ -42,6 +42,212 @@
 #include <bibtool/entry.h>
 #include <bibtool/key.h>
 #include <bibtool/rsc.h>
+#include <bibtool/tex_aux.h>
+#include <bibtool/check.h>
+#include <bibtool/sbuffer.h>
+#include <bibtool/stats.h>
+#include "config.h"
+#ifdef HAVE_SYS_STAT_H
+#include <sys/types.h>
+#include <sys/stat.h>
+#endif
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define CACHE_NONE  0
+#define CACHE_READ  1
+#define CACHE_WRITE 2
+
+#define CACHE_MAGIC	"BibTool cache 2\n"
+#define CACHE_MAGIC_LEN 16
+#define CACHE_REC	5
+
+/*-----------------------------------------------------------------------------
+** Typedef*:	SIndex
+** Purpose:	The index of a bib file. It holds the byte offset, the
+**		length, the line number, the type, and the key of each
+**		entry. It allows to read only the wanted entries of a
+**		large file.
+**___________________________________________________			     */
+ typedef struct iNDEX
+ { bool		 i_read;			   /* the entries are read   */
+   bool		 i_write;			   /* the entries are collected*/
+   char		 *i_name;			   /* the index file         */
+   unsigned long i_head[3];			   /* size, mtime, rsc       */
+   long		 *i_ent;			   /* 4 numbers per entry    */
+   Symbol	 *i_key;			   /* the keys               */
+   int		 i_used;			   /* the number of entries  */
+   int		 i_size;			   /* the allocated size     */
+   int		 i_next;			   /* the next entry         */
+ } SIndex, *Index;
+
+/*-----------------------------------------------------------------------------
+** Typedef*:	SCache
+** Purpose:	The state of the cache for one file read by |read_db()|.
+**
+**		A cache file is an image which does not contain
+**		pointers. All numbers are stored as 4 byte big endian
+**		words. After the magic string, the header, and the
+**		path of the bib file it has four sections: the offsets
+**		of the symbols in the string pool, the record table
+**		with |CACHE_REC| words per record, the field array,
+**		and the string pool. A record consists of its type,
+**		line number, comment, the index of its first word in
+**		the field array, and the size of its heap. Symbols
+**		are referenced by their index plus one.
+**
+**		When reading, the image is mapped into memory and used
+**		in place. The strings of the pool become symbols
+**		without being copied when they are needed first. When
+**		writing, the symbols referenced are collected in a
+**		table and the records are kept as a stream of integers
+**		which refer to this table.
+**___________________________________________________			     */
+ typedef struct cACHE
+ { int		 c_mode;			   /* none, read, or write   */
+   char		 *c_name;			   /* the cache file         */
+   unsigned long c_head[4];			   /* size, mtime, hash, rsc */
+   String	 c_path;			   /* the bib file           */
+   bool		 (*c_filter)_ARG((Symbol key));	   /* the key filter or NULL */
+   Symbol	 *c_syms;			   /* the symbol table       */
+   int		 c_nsyms;			   /* its used size          */
+   int		 *c_tab;			   /* symbol -> index        */
+   int		 c_tsize;			   /* the size of c_tab      */
+   unsigned char *c_buf;			   /* the image read         */
+   size_t	 c_size;			   /* its size               */
+   bool		 c_mapped;			   /* is c_buf mapped?       */
+   bool		 c_adopted;			   /* are strings in use?    */
+   unsigned char *c_offs;			   /* the symbol offsets     */
+   unsigned char *c_recs;			   /* the record table       */
+   unsigned char *c_fields;			   /* the field array        */
+   unsigned char *c_pool;			   /* the string pool        */
+   int		 c_nrecs;			   /* the number of records  */
+   int		 c_next;			   /* the next record        */
+   int		 *c_rec;			   /* the records to write   */
+   int		 c_used;			   /* its used size          */
+   int		 c_rsize;			   /* its allocated size     */
+   SIndex	 c_idx;				   /* the index              */
+ } SCache, *Cache;
+
+/*-----------------------------------------------------------------------------
+** Macro*:	CacheWord()
+** Type:	unsigned long
+** Purpose:	Decode a word of a cache image.
+** Arguments:
+**	P	pointer to the start of an array of words
+**	I	index of the word
+** Returns:	The value of the word.
+**___________________________________________________			     */
+/*-----------------------------------------------------------------------------
+** Typedef*:	SRun
+** Purpose:	A sorted run of normal records while the runs are
+**		merged. The records are read one at a time from a
+**		temporary file. The last run is the list of normal
+**		records of the database itself which is not written.
+**
+**		In a file each record consists of its type, flags,
+**		line number, the size of the heap, the byte offset
+**		plus one, the length of the source text, and the
+**		number of bytes of all its strings. Then the source,
+**		the comment, the sort key, and the heap follow as
+**		strings. Each string is stored as its length plus
+**		one and the characters. The length 0 denotes
+**		|NO_SYMBOL|.
+**___________________________________________________			     */
+ typedef struct rUN
+ { FILE		 *r_file;			   /* the file or NULL       */
+   Record	 r_rec;				   /* the current record     */
+   char		 *r_buf;			   /* its strings            */
+ } SRun, *Run;
+
+/*-----------------------------------------------------------------------------
+** Typedef*:	Same
+** Purpose:	The location and the key of a record printed by
+**		|print_runs()|. The record itself may be freed already
+**		when a double of it is reported.
+**___________________________________________________			     */
+ typedef struct sAME
+ { int		 s_line;			   /* the line number        */
+   Symbol	 s_source;			   /* the file name          */
+   Symbol	 s_key;				   /* the reference key      */
+ } SSame, *Same;
+
+/*-----------------------------------------------------------------------------
+** Typedef*:	SDbState
+** Purpose:	The state of the database module in a context.
+**
+**		|runs| are the temporary files holding the sorted runs
+**		written by |db_spill()|. |runs_less| is the comparison
+**		used to sort them and |runs_tail| a record carrying the
+**		sort key of the last record written.
+**
+**		|cache_writing| indicates that the records of the file
+**		read are collected for a cache file. Then the values
+**		of the fields can not be released by |db_spill()|.
+**
+**		|record_hook| is the function called by |read_db()|
+**		after each record has been inserted into the database
+**		or |NULL|.
+**
+**		|master_record| is the record filled by the parser and
+**		|db_count| the array returned by |db_count()|.
+**___________________________________________________			     */
+ typedef struct
+ { FILE		 **runs;
+   int		 runs_used;
+   int		 runs_size;
+   int		 (*runs_less)_ARG((Record, Record));
+   Record	 runs_tail;
+   bool		 cache_writing;
+   void		 (*record_hook)_ARG((DB db));
+   Record	 master_record;
+   int		 *db_count;
+   int		 db_count_len;
+ } SDbState;
+
+/*-----------------------------------------------------------------------------
+** Variable*:	db_state0
+** Type:	SDbState
+** Purpose:	The initial state of the database module in a context.
+**___________________________________________________			     */
+ static SDbState db_state0 =
+ { (FILE**)NULL,
+   0,
+   0,
+   NULL,
+   RecordNULL,
+   false,
+   NULL,
+   RecordNULL,
+   (int*)NULL,
+   0
+ };
+
+#define DbState ((SDbState*)CtxGet(CTX_DATABASE,			\
+				   ctx_state(CTX_DATABASE,		\
+					     (void*)&db_state0,		\
+					     sizeof(db_state0),		\
+					     db_free)))
+
+#define runs	      (DbState->runs)
+#define runs_used     (DbState->runs_used)
+#define runs_size     (DbState->runs_size)
+#define runs_less     (DbState->runs_less)
+#define runs_tail     (DbState->runs_tail)
+#define cache_writing (DbState->cache_writing)
+#define record_hook   (DbState->record_hook)
+#define master_record (DbState->master_record)
+
+
+#define RUN_BATCH 256
+
+#define CacheWord(P,I) ((unsigned long)(P)[4*(I)] << 24	  |		\
+			(unsigned long)(P)[4*(I)+1] << 16 |		\
+			(unsigned long)(P)[4*(I)+2] << 8  |		\
+			(unsigned long)(P)[4*(I)+3])
 
 /*****************************************************************************/
 /* Internal Programs                                                         */
@@ -52,10 +258,59 @@
 #else
 #define _ARG(A) ()
 #endif
- static Record insert_record _ARG((Record rec, Record ptr,int (*less)_ARG((Record, Record))));/**/
+ static Record rec__merge _ARG((Record p,Record q,int (*less)_ARG((Record, Record))));/**/
  static Record rec__sort _ARG((Record rec,int (*less)_ARG((Record, Record))));/**/
  static int cmp_heap _ARG((Record r1, Record r2)); /*                        */
  static void mark_string _ARG((Record rec, String s));/*                     */
+ static void copy_list _ARG((DB db, Record rec));  /*                        */
+ static unsigned long fnv _ARG((unsigned long h, unsigned char *s, size_t n));/* */
+ static unsigned long cache_fingerprint _ARG((void));/*                      */
+ static void cache_init _ARG((Cache cache, String path, bool (*filter)_ARG((Symbol key))));/* */
+ static bool cache_map _ARG((Cache cache));	   /*                        */
+ static bool cache_load _ARG((Cache cache));	   /*                        */
+ static Symbol cache_symbol _ARG((Cache cache, unsigned long i));/*          */
+ static int cache_next _ARG((Cache cache, Record rec));/*                    */
+ static void cache_int _ARG((Cache cache, int n)); /*                        */
+ static void cache_sym _ARG((Cache cache, Symbol s));/*                      */
+ static int cache_record _ARG((Cache cache, Record rec));/*                  */
+ static void cache_put _ARG((unsigned long v, int n, FILE *f));/*            */
+ static void cache_done _ARG((Cache cache));	   /*                        */
+ static void index_init _ARG((Index idx, String path, bool skip));/*         */
+ static void index_add _ARG((Index idx, int type, Symbol key, long from, long to, int lineno));/* */
+ static bool index_load _ARG((Index idx));	   /*                        */
+ static int index_next _ARG((Index idx, Record rec, bool (*filter)_ARG((Symbol key))));/* */
+ static void index_done _ARG((Index idx));	   /*                        */
+ static unsigned long run_get _ARG((int n, FILE *f));/*                      */
+ static void run_string _ARG((Symbol s, FILE *f)); /*                        */
+ static void run_write _ARG((Record rec, FILE *f));/*                        */
+ static bool run_read _ARG((Run run));		   /*                        */
+ static bool run_before _ARG((Run run, int a, int b));/*                     */
+ static void run_sift _ARG((Run run, int *heap, int n, int i));/*            */
+ static void run_flush _ARG((FILE *file, DB db, Record *recs, char **bufs, int n));/* */
+ static void print_runs _ARG((FILE *file, DB db));  /*                        */
+ static void db_free _ARG((void *state));	   /*                        */
+
+/*-----------------------------------------------------------------------------
+** Function*:	db_free()
+** Type:	void
+** Purpose:	Release the state of the database module when a
+**		context is released.
+** Arguments:
+**	state	the state
+** Returns:	nothing
+**___________________________________________________			     */
+static void db_free(state)			   /*                        */
+  void *state;					   /*                        */
+{ int i;					   /*                        */
+ 						   /*                        */
+  POSSIBLY_UNUSED(state);			   /*                        */
+  for (i = 0; i < runs_used; i++)		   /*                        */
+  { (void)fclose(runs[i]); }			   /*                        */
+  if (runs) free(runs);				   /*                        */
+  free_record(runs_tail);			   /*                        */
+  free_record(master_record);			   /*                        */
+  if (DbState->db_count) free(DbState->db_count);  /*                        */
+}						   /*------------------------*/
 
 /*****************************************************************************/
 /* External Programs                                                         */
@@ -105,6 +360,21 @@ DB new_db()				   	   /*                        */
 **___________________________________________________			     */
 void free_db(db)				   /*                        */
   DB db;					   /*                        */
+{						   /*                        */
+  db_clear(db);					   /*                        */
+  free(db);					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	db_clear()
+** Purpose:	Release all records of a database. The database is
+**		empty afterwards but can still be used.
+** Arguments:
+**	db	Database to clear.
+** Returns:	nothing
+**___________________________________________________			     */
+void db_clear(db)				   /*                        */
+  DB db;					   /*                        */
 {						   /*                        */
   free_record(DBnormal(db));			   /*                        */
   free_record(DBstring(db));			   /*                        */
@@ -113,7 +383,62 @@ void free_db(db)				   /*                        */
   free_record(DBalias(db));			   /*                        */
   free_record(DBinclude(db));			   /*                        */
   free_record(DBmodify(db));			   /*                        */
-  free(db);					   /*                        */
+  DBnormal(db)   = RecordNULL;			   /*                        */
+  DBstring(db)   = RecordNULL;			   /*                        */
+  DBpreamble(db) = RecordNULL;			   /*                        */
+  DBcomment(db)  = RecordNULL;			   /*                        */
+  DBalias(db)    = RecordNULL;			   /*                        */
+  DBinclude(db)  = RecordNULL;			   /*                        */
+  DBmodify(db)   = RecordNULL;			   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	copy_list()
+** Purpose:	Insert copies of a list of records into a database.
+**		The list may be given by any of its records. The
+**		copies keep the sort keys already computed.
+** Arguments:
+**	db	the database to insert into
+**	rec	a record of the list or |RecordNULL|
+** Returns:	nothing
+**___________________________________________________			     */
+static void copy_list(db, rec)			   /*                        */
+  DB	 db;					   /*                        */
+  Record rec;					   /*                        */
+{ Record copy;					   /*                        */
+ 						   /*                        */
+  if (rec == RecordNULL) return;		   /*                        */
+  while (PrevRecord(rec) != RecordNULL)		   /* rewind                 */
+  { rec = PrevRecord(rec); }			   /*                        */
+  for (; rec != RecordNULL; rec = NextRecord(rec)) /*                        */
+  { copy = copy_record(rec);			   /*                        */
+    RecordSortkey(copy) = RecordSortkey(rec);	   /*                        */
+    LinkSymbol(RecordSortkey(copy));		   /*                        */
+    db_insert(db, copy, false);			   /*                        */
+  }						   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	db_copy()
+** Purpose:	Insert copies of all records of a database into
+**		another one. The records keep their order. The
+**		database copied from is not modified.
+** Arguments:
+**	db	the database to insert into
+**	from	the database to copy
+** Returns:	nothing
+**___________________________________________________			     */
+void db_copy(db, from)				   /*                        */
+  DB db;					   /*                        */
+  DB from;					   /*                        */
+{						   /*                        */
+  copy_list(db, DBstring(from));		   /*                        */
+  copy_list(db, DBpreamble(from));		   /*                        */
+  copy_list(db, DBcomment(from));		   /*                        */
+  copy_list(db, DBinclude(from));		   /*                        */
+  copy_list(db, DBalias(from));			   /*                        */
+  copy_list(db, DBnormal(from));		   /*                        */
+  copy_list(db, DBmodify(from));		   /* after their targets    */
 }						   /*------------------------*/
 
 /*-----------------------------------------------------------------------------
@@ -275,6 +600,813 @@ void db_insert(db, rec, verbose)		   /*                        */
   }					   	   /*                        */
 }						   /*------------------------*/
 
+/*-----------------------------------------------------------------------------
+** Function:	set_record_hook()
+** Purpose:	Install a function which is called by |read_db()|
+**		whenever a record has been inserted into the
+**		database. The function gets the database as
+**		argument. It may process and remove the records
+**		found there. This allows to handle records one at a
+**		time without keeping all of them. The argument
+**		|NULL| disables the hook.
+** Arguments:
+**	fct	the function
+** Returns:	nothing
+**___________________________________________________			     */
+void set_record_hook(fct)			   /*                        */
+  void (*fct)_ARG((DB db));			   /*                        */
+{ record_hook = fct;				   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	fnv()
+** Purpose:	Continue a 32 bit FNV-1a hash with some bytes.
+** Arguments:
+**	h	the hash so far
+**	s	the bytes
+**	n	the number of bytes
+** Returns:	The new hash value.
+**___________________________________________________			     */
+static unsigned long fnv(h, s, n)		   /*                        */
+  unsigned long h;				   /*                        */
+  unsigned char *s;				   /*                        */
+  size_t	n;				   /*                        */
+{						   /*                        */
+  while (n-- > 0)				   /*                        */
+  { h = ((h ^ *s++) * 16777619UL) & 0xffffffffUL; }/*                        */
+  return h;					   /*                        */
+}						   /*------------------------*/
+
+#define FNV_INIT 2166136261UL
+
+/*-----------------------------------------------------------------------------
+** Function*:	cache_fingerprint()
+** Purpose:	Compute a hash of the resources which influence the
+**		parser. These are the known entry types and whether
+**		comments are passed through.
+** Arguments:	none
+** Returns:	The hash value.
+**___________________________________________________			     */
+static unsigned long cache_fingerprint()	   /*                        */
+{ unsigned long h = FNV_INIT;			   /*                        */
+  unsigned char c;				   /*                        */
+  Symbol	s;				   /*                        */
+  int		i;				   /*                        */
+ 						   /*                        */
+  c = rsc_pass_comment ? 1 : 0;			   /*                        */
+  h = fnv(h, &c, 1);				   /*                        */
+  for (i = 0; (s = get_entry_type(i)) != NO_SYMBOL; i++)/*                   */
+  { h = fnv(h,					   /*                        */
+	    SymbolValue(s),			   /*                        */
+	    strlen((char*)SymbolValue(s)) + 1);	   /*                        */
+  }						   /*                        */
+  return h;					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	index_init()
+** Purpose:	Prepare the index of a bib file. The index is stored
+**		next to the bib file with the suffix |.idx|. It is
+**		used when only some keys are wanted and the size, the
+**		modification time, and the resource fingerprint
+**		recorded in it match. It is collected while parsing
+**		if \rsc{index.write} is on.
+**
+**		The index is not used if comments are passed through
+**		since the text between the entries is not indexed.
+** Arguments:
+**	idx	the index
+**	path	the path of the bib file or |NULL|
+**	skip	indicator that only some keys are wanted
+** Returns:	nothing
+**___________________________________________________			     */
+static void index_init(idx, path, skip)		   /*                        */
+  Index	 idx;					   /*                        */
+  String path;					   /*                        */
+  bool	 skip;					   /*                        */
+{						   /*                        */
+#ifdef HAVE_SYS_STAT_H
+  struct stat st;				   /*                        */
+#endif
+ 						   /*                        */
+  idx->i_read  = false;				   /*                        */
+  idx->i_write = false;				   /*                        */
+  idx->i_name  = NULL;				   /*                        */
+  idx->i_ent   = NULL;				   /*                        */
+  idx->i_key   = NULL;				   /*                        */
+  idx->i_used  = idx->i_size = idx->i_next = 0;	   /*                        */
+#ifdef HAVE_SYS_STAT_H
+  if (path == NULL ||				   /*                        */
+      (!skip && !rsc_index_write) ||		   /*                        */
+      stat((char*)path, &st) != 0)		   /*                        */
+  { return; }					   /*                        */
+ 						   /*                        */
+  idx->i_head[0] = (unsigned long)st.st_size;	   /*                        */
+  idx->i_head[1] = (unsigned long)st.st_mtime;	   /*                        */
+  idx->i_head[2] = cache_fingerprint();		   /*                        */
+  if ((idx->i_name = malloc(strlen((char*)path) + 5)) == NULL)/*             */
+  { OUT_OF_MEMORY("index"); }			   /*                        */
+  (void)sprintf(idx->i_name, "%s.idx", (char*)path);/*                       */
+ 						   /*                        */
+  if (skip && !rsc_pass_comment && index_load(idx))/*                        */
+  { idx->i_read = true;				   /*                        */
+    if (rsc_verbose)				   /*                        */
+    { VerbosePrint2("Using index ", idx->i_name); }/*                        */
+  }						   /*                        */
+  else if (rsc_index_write)			   /*                        */
+  { idx->i_used	 = 0;				   /*                        */
+    idx->i_write = true;			   /*                        */
+  }						   /*                        */
+#endif
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	index_add()
+** Purpose:	Add an entry to the index.
+** Arguments:
+**	idx	the index
+**	type	the type of the entry
+**	key	the key of the entry or |NO_SYMBOL|
+**	from	the offset of the entry
+**	to	the offset after the entry
+**	lineno	the line number of the entry
+** Returns:	nothing
+**___________________________________________________			     */
+static void index_add(idx, type, key, from, to, lineno)/*                    */
+  Index	 idx;					   /*                        */
+  int	 type;					   /*                        */
+  Symbol key;					   /*                        */
+  long	 from;					   /*                        */
+  long	 to;					   /*                        */
+  int	 lineno;				   /*                        */
+{ long	 *e;					   /*                        */
+ 						   /*                        */
+  if (idx->i_used >= idx->i_size)		   /*                        */
+  { idx->i_size = (idx->i_size ? 2 * idx->i_size : 256);/*                   */
+    idx->i_ent	= (long*)realloc(idx->i_ent,	   /*                        */
+				 4 * idx->i_size * sizeof(long));/*          */
+    idx->i_key	= (Symbol*)realloc(idx->i_key,	   /*                        */
+				   idx->i_size * sizeof(Symbol));/*          */
+    if (idx->i_ent == NULL || idx->i_key == NULL)  /*                        */
+    { OUT_OF_MEMORY("index"); }			   /*                        */
+  }						   /*                        */
+  e    = idx->i_ent + 4 * idx->i_used;		   /*                        */
+  e[0] = from;					   /*                        */
+  e[1] = to - from;				   /*                        */
+  e[2] = lineno;				   /*                        */
+  e[3] = type;					   /*                        */
+  idx->i_key[idx->i_used++] = key;		   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	index_load()
+** Purpose:	Read the index file. The first line contains the size
+**		and the modification time of the bib file and the
+**		resource fingerprint. Each further line describes an
+**		entry by its offset, length, line number, type, and
+**		key. Special entries have the key |-|.
+** Arguments:
+**	idx	the index
+** Returns:	|true| iff the index file is valid.
+**___________________________________________________			     */
+static bool index_load(idx)			   /*                        */
+  Index		idx;				   /*                        */
+{ FILE		*f;				   /*                        */
+  char		line[1100];			   /*                        */
+  char		key[1025];			   /*                        */
+  unsigned long h[3];				   /*                        */
+  long		from, len;			   /*                        */
+  int		lineno, type;			   /*                        */
+  bool		ok;				   /*                        */
+ 						   /*                        */
+  if ((f = fopen(idx->i_name, "r")) == NULL) return false;/*                 */
+  ok = (fgets(line, sizeof(line), f) != NULL &&	   /*                        */
+	sscanf(line, "%% BibTool index 1 %lu %lu %lx",/*                     */
+	       &h[0], &h[1], &h[2]) == 3 &&	   /*                        */
+	h[0] == idx->i_head[0] &&		   /*                        */
+	h[1] == idx->i_head[1] &&		   /*                        */
+	h[2] == idx->i_head[2]);		   /*                        */
+  while (ok && fgets(line, sizeof(line), f) != NULL)/*                       */
+  { if (sscanf(line, "%ld %ld %d %d %1024s",	   /*                        */
+	       &from, &len, &lineno, &type, key) != 5 ||/*                   */
+	from < 0 || len <= 0 ||			   /*                        */
+	get_entry_type(type) == NO_SYMBOL)	   /*                        */
+    { ok = false; }				   /*                        */
+    else					   /*                        */
+    { index_add(idx,				   /*                        */
+		type,				   /*                        */
+		IsSpecialRecord(type) ? NO_SYMBOL : symbol((String)key),/*   */
+		from,				   /*                        */
+		from + len,			   /*                        */
+		lineno);			   /*                        */
+    }						   /*                        */
+  }						   /*                        */
+  (void)fclose(f);				   /*                        */
+  return ok;					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	index_next()
+** Purpose:	Read the next wanted entry with the help of the index.
+**		The special entries are always read. Normal entries
+**		are read if the key filter accepts their key. The
+**		parser continues at the offset of the entry. An entry
+**		which does not have the expected key indicates that
+**		the index is out of date. It is ignored with a
+**		warning.
+** Arguments:
+**	idx	the index
+**	rec	the record to fill
+**	filter	the key filter
+** Returns:	The type of the entry or |BIB_EOF|.
+**___________________________________________________			     */
+static int index_next(idx, rec, filter)		   /*                        */
+  Index	 idx;					   /*                        */
+  Record rec;					   /*                        */
+  bool	 (*filter)_ARG((Symbol key));		   /*                        */
+{ long	 *e;					   /*                        */
+  Symbol key;					   /*                        */
+  int	 type;					   /*                        */
+ 						   /*                        */
+  while (idx->i_next < idx->i_used)		   /*                        */
+  { e	= idx->i_ent + 4 * idx->i_next;		   /*                        */
+    key = idx->i_key[idx->i_next++];		   /*                        */
+    if (key != NO_SYMBOL && !(*filter)(key)) continue;/*                     */
+    if (!seek_bib(e[0], (int)e[2])) return BIB_EOF;/*                        */
+    type = parse_bib(rec);			   /*                        */
+    if (type != e[3] ||				   /*                        */
+	(key != NO_SYMBOL && *RecordHeap(rec) != key))/*                     */
+    { WARNING3("Index ", idx->i_name, " is out of date.");/*                 */
+      continue;					   /*                        */
+    }						   /*                        */
+    return type;				   /*                        */
+  }						   /*                        */
+  return BIB_EOF;				   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	index_done()
+** Purpose:	Write the index file if entries have been collected
+**		and release the index. The file is written under a
+**		temporary name first and renamed afterwards.
+** Arguments:
+**	idx	the index
+** Returns:	nothing
+**___________________________________________________			     */
+static void index_done(idx)			   /*                        */
+  Index	idx;					   /*                        */
+{ FILE	*f;					   /*                        */
+  char	*tmp;					   /*                        */
+  long	*e;					   /*                        */
+  int	i;					   /*                        */
+  bool	ok;					   /*                        */
+ 						   /*                        */
+  if (idx->i_write &&				   /*                        */
+      (tmp = malloc(strlen(idx->i_name) + 5)) != NULL)/*                     */
+  { (void)sprintf(tmp, "%s.tmp", idx->i_name);	   /*                        */
+    if ((f = fopen(tmp, "w")) != NULL)		   /*                        */
+    { (void)fprintf(f,				   /*                        */
+		    "%% BibTool index 1 %lu %lu %lx\n",/*                    */
+		    idx->i_head[0],		   /*                        */
+		    idx->i_head[1],		   /*                        */
+		    idx->i_head[2]);		   /*                        */
+      for (i = 0; i < idx->i_used; i++)		   /*                        */
+      { e = idx->i_ent + 4 * i;			   /*                        */
+	(void)fprintf(f,			   /*                        */
+		      "%ld %ld %ld %ld %s\n",	   /*                        */
+		      e[0], e[1], e[2], e[3],	   /*                        */
+		      (idx->i_key[i] == NO_SYMBOL  /*                        */
+		       ? "-"			   /*                        */
+		       : (char*)SymbolValue(idx->i_key[i])));/*              */
+      }						   /*                        */
+      ok = !ferror(f);				   /*                        */
+      if (fclose(f) != 0) ok = false;		   /*                        */
+      if (!ok || rename(tmp, idx->i_name) != 0)	   /*                        */
+      { (void)remove(tmp); }			   /*                        */
+    }						   /*                        */
+    free(tmp);					   /*                        */
+  }						   /*                        */
+  if (idx->i_name) free(idx->i_name);		   /*                        */
+  if (idx->i_ent)  free(idx->i_ent);		   /*                        */
+  if (idx->i_key)  free(idx->i_key);		   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	cache_init()
+** Purpose:	Prepare the cache for a bib file. The cache file name
+**		is derived from the path of the bib file. The header
+**		of the cache file has to match the size, the
+**		modification time, and the hash of the contents of
+**		the bib file as well as the fingerprint of the
+**		resources. If the cache file is valid then the
+**		records are taken from it. Otherwise they are
+**		collected to write a new cache file.
+**
+**		If only some keys are wanted then the filter is applied
+**		to the records of a valid cache file. No cache file is
+**		written in this case since the parser skips the other
+**		entries.
+**
+**		The cache is not used if \rsc{cache.dir} is empty, for
+**		the standard input, or if the case of the keys is
+**		preserved.
+** Arguments:
+**	cache	the cache
+**	path	the path of the bib file or |NULL|
+**	filter	the key filter or |NULL|
+** Returns:	nothing
+**___________________________________________________			     */
+static void cache_init(cache, path, filter)	   /*                        */
+  Cache  cache;					   /*                        */
+  String path;					   /*                        */
+  bool	 (*filter)_ARG((Symbol key));		   /*                        */
+{						   /*                        */
+#ifdef HAVE_SYS_STAT_H
+  struct stat	st;				   /*                        */
+  FILE		*f;				   /*                        */
+  unsigned char buf[8192];			   /*                        */
+  size_t	n;				   /*                        */
+#endif
+ 						   /*                        */
+  cache->c_mode	   = CACHE_NONE;		   /*                        */
+  cache->c_name	   = NULL;			   /*                        */
+  cache->c_filter  = filter;			   /*                        */
+  cache->c_syms	   = NULL;			   /*                        */
+  cache->c_nsyms   = 0;				   /*                        */
+  cache->c_tab	   = NULL;			   /*                        */
+  cache->c_tsize   = 0;				   /*                        */
+  cache->c_buf	   = NULL;			   /*                        */
+  cache->c_mapped  = false;			   /*                        */
+  cache->c_adopted = false;			   /*                        */
+  cache->c_nrecs   = cache->c_next = 0;		   /*                        */
+  cache->c_rec	   = NULL;			   /*                        */
+  cache->c_used	   = cache->c_rsize = 0;	   /*                        */
+  index_init(&cache->c_idx, path, filter != NULL); /*                        */
+#ifdef HAVE_SYS_STAT_H
+  if (path == NULL ||				   /*                        */
+      cache->c_idx.i_read ||			   /*                        */
+      *rsc_cache_dir == '\0' ||			   /*                        */
+      rsc_key_case ||				   /*                        */
+      rsc_print_verbatim ||			   /* images have no source  */
+      stat((char*)path, &st) != 0 ||		   /*                        */
+      (f = fopen((char*)path, "rb")) == NULL)	   /*                        */
+  { return; }					   /*                        */
+ 						   /*                        */
+  cache->c_path	   = path;			   /*                        */
+  cache->c_head[0] = (unsigned long)st.st_size;	   /*                        */
+  cache->c_head[1] = (unsigned long)st.st_mtime;   /*                        */
+  cache->c_head[2] = FNV_INIT;			   /*                        */
+  while ((n = fread(buf, 1, sizeof(buf), f)) > 0)  /*                        */
+  { cache->c_head[2] = fnv(cache->c_head[2], buf, n); }/*                    */
+  (void)fclose(f);				   /*                        */
+  cache->c_head[3] = cache_fingerprint();	   /*                        */
+ 						   /*                        */
+  cache->c_name = malloc(strlen((char*)rsc_cache_dir) + 16);/*               */
+  if (cache->c_name == NULL)			   /*                        */
+  { OUT_OF_MEMORY("cache"); }			   /*                        */
+  (void)sprintf(cache->c_name,			   /*                        */
+		"%s%c%08lx.btc",		   /*                        */
+		(char*)rsc_cache_dir,		   /*                        */
+		*rsc_dir_file_sep,		   /*                        */
+		fnv(FNV_INIT, path, strlen((char*)path)));/*                 */
+ 						   /*                        */
+  if (!cache->c_idx.i_write && cache_load(cache))  /*                        */
+  { cache->c_mode = CACHE_READ;			   /*                        */
+    if (rsc_verbose)				   /*                        */
+    { VerbosePrint2("Using cache ", cache->c_name); }/*                      */
+  }						   /*                        */
+  else if (filter == NULL)			   /*                        */
+  { cache->c_mode = CACHE_WRITE; }		   /*                        */
+#endif
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	cache_map()
+** Purpose:	Make the contents of the cache file available in
+**		memory. If possible the file is mapped. The mapping is
+**		private. Thus the pages are shared with other
+**		processes as long as they are not modified.
+** Arguments:
+**	cache	the cache
+** Returns:	|true| iff the file could be read.
+**___________________________________________________			     */
+static bool cache_map(cache)			   /*                        */
+  Cache	cache;					   /*                        */
+{ FILE	*f;					   /*                        */
+  long	size;					   /*                        */
+#ifdef HAVE_SYS_MMAN_H
+  int	fd;					   /*                        */
+  struct stat st;				   /*                        */
+  void	*p;					   /*                        */
+ 						   /*                        */
+  if ((fd = open(cache->c_name, O_RDONLY)) < 0) return false;/*              */
+  if (fstat(fd, &st) == 0 && st.st_size > 0)	   /*                        */
+  { p = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE,/*             */
+	     MAP_PRIVATE, fd, 0);		   /*                        */
+    if (p != MAP_FAILED)			   /*                        */
+    { (void)close(fd);				   /*                        */
+      cache->c_buf    = (unsigned char*)p;	   /*                        */
+      cache->c_size   = (size_t)st.st_size;	   /*                        */
+      cache->c_mapped = true;			   /*                        */
+      return true;				   /*                        */
+    }						   /*                        */
+  }						   /*                        */
+  (void)close(fd);				   /*                        */
+#endif
+  if ((f = fopen(cache->c_name, "rb")) == NULL) return false;/*              */
+  if (fseek(f, 0L, SEEK_END) != 0 ||		   /*                        */
+      (size = ftell(f)) <= 0 ||			   /*                        */
+      fseek(f, 0L, SEEK_SET) != 0 ||		   /*                        */
+      (cache->c_buf = malloc((size_t)size)) == NULL ||/*                     */
+      fread(cache->c_buf, 1, (size_t)size, f) != (size_t)size)/*             */
+  { (void)fclose(f);				   /*                        */
+    return false;				   /*                        */
+  }						   /*                        */
+  (void)fclose(f);				   /*                        */
+  cache->c_size = (size_t)size;			   /*                        */
+  return true;					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	cache_load()
+** Purpose:	Map the cache file and check its header. Then the
+**		sections are located and all indices in them are
+**		checked. Thus the records can be read later without
+**		further checks.
+** Arguments:
+**	cache	the cache
+** Returns:	|true| iff the cache file can be used.
+**___________________________________________________			     */
+static bool cache_load(cache)			   /*                        */
+  Cache		cache;				   /*                        */
+{ unsigned char *p;				   /*                        */
+  unsigned long nsyms, nrecs, nfields, npool, v, n;/*                        */
+  unsigned long i, j;				   /*                        */
+  size_t	pos;				   /*                        */
+ 						   /*                        */
+  if (!cache_map(cache)) return false;		   /*                        */
+  p   = cache->c_buf;				   /*                        */
+  pos = CACHE_MAGIC_LEN + 4 * 8 + 4;		   /*                        */
+  if (cache->c_size < pos ||			   /*                        */
+      memcmp(p, CACHE_MAGIC, CACHE_MAGIC_LEN) != 0)/*                        */
+  { return false; }				   /*                        */
+  p += CACHE_MAGIC_LEN;				   /*                        */
+  for (i = 0; i < 4; i++)			   /* the header             */
+  { v = (CacheWord(p, 2 * i) << 16) << 16 | CacheWord(p, 2 * i + 1);/*       */
+    if (v != cache->c_head[i]) return false;	   /*                        */
+  }						   /*                        */
+  n    = CacheWord(p, 8);			   /* the path               */
+  pos += (n + 3) & ~3UL;			   /*                        */
+  if (n != strlen((char*)cache->c_path) ||	   /*                        */
+      cache->c_size < pos + 4 * 4 ||		   /*                        */
+      memcmp(p + 4 * 9, cache->c_path, n) != 0)	   /*                        */
+  { return false; }				   /*                        */
+ 						   /*                        */
+  p	  = cache->c_buf + pos;			   /*                        */
+  nsyms	  = CacheWord(p, 0);			   /*                        */
+  nrecs	  = CacheWord(p, 1);			   /*                        */
+  nfields = CacheWord(p, 2);			   /*                        */
+  npool	  = CacheWord(p, 3);			   /*                        */
+  pos	 += 4 * (4 + nsyms + CACHE_REC * nrecs + nfields);/*                 */
+  if (nsyms > 0x7fffffffUL || nrecs > 0x7fffffffUL ||/*                      */
+      cache->c_size != pos + npool ||		   /*                        */
+      (npool > 0 && cache->c_buf[pos + npool - 1] != '\0'))/*                */
+  { return false; }				   /*                        */
+  cache->c_offs	  = p + 4 * 4;			   /*                        */
+  cache->c_recs	  = cache->c_offs + 4 * nsyms;	   /*                        */
+  cache->c_fields = cache->c_recs + 4 * CACHE_REC * nrecs;/*                 */
+  cache->c_pool	  = cache->c_buf + pos;		   /*                        */
+ 						   /*                        */
+  for (i = 0; i < nsyms; i++)			   /* the symbols            */
+  { if (CacheWord(cache->c_offs, i) >= npool) return false; }/*              */
+  for (i = 0; i < nrecs; i++)			   /* the records            */
+  { p = cache->c_recs + 4 * CACHE_REC * i;	   /*                        */
+    v = CacheWord(p, 3);			   /*                        */
+    n = CacheWord(p, 4);			   /*                        */
+    if (get_entry_type((int)CacheWord(p, 0)) == NO_SYMBOL ||/*               */
+	CacheWord(p, 2) > nsyms ||		   /*                        */
+	n % 2 != 0 || v > nfields || n > nfields - v)/*                      */
+    { return false; }				   /*                        */
+  }						   /*                        */
+  for (j = 0; j < nfields; j++)			   /* the fields             */
+  { if (CacheWord(cache->c_fields, j) > nsyms) return false; }/*             */
+ 						   /*                        */
+  cache->c_nsyms = (int)nsyms;			   /*                        */
+  cache->c_nrecs = (int)nrecs;			   /*                        */
+  if ((cache->c_syms = (Symbol*)calloc(nsyms + 1, sizeof(Symbol))) == NULL)/* */
+  { OUT_OF_MEMORY("cache"); }			   /*                        */
+  if (cache->c_filter == NULL) sym_reserve((int)nsyms);/*                    */
+  return true;					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	cache_symbol()
+** Purpose:	Get the symbol for an index of the cache file. The
+**		string is entered into the symbol table when it is
+**		needed for the first time. It is not copied but used
+**		in place.
+** Arguments:
+**	cache	the cache
+**	i	the index plus one or 0
+** Returns:	The symbol or |NO_SYMBOL|.
+**___________________________________________________			     */
+static Symbol cache_symbol(cache, i)		   /*                        */
+  Cache		cache;				   /*                        */
+  unsigned long i;				   /*                        */
+{						   /*                        */
+  if (i == 0) return NO_SYMBOL;			   /*                        */
+  if (cache->c_syms[i] == NO_SYMBOL)		   /*                        */
+  { cache->c_syms[i] = sym_adopt(cache->c_pool	   /*                        */
+				 + CacheWord(cache->c_offs, i - 1));/*       */
+    cache->c_adopted = true;			   /*                        */
+  }						   /*                        */
+  return cache->c_syms[i];			   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	cache_next()
+** Purpose:	Fill a record with the next entry from the cache. The
+**		fields are stored as |parse_bib()| would have done.
+**		Normal records whose key is not accepted by the
+**		filter are skipped.
+** Arguments:
+**	cache	the cache
+**	rec	the record to fill
+** Returns:	The type of the entry, |BIB_SKIP|, or |BIB_EOF|.
+**___________________________________________________			     */
+static int cache_next(cache, rec)		   /*                        */
+  Cache		cache;				   /*                        */
+  Record	rec;				   /*                        */
+{ unsigned char *p, *f;				   /*                        */
+  unsigned long i, n;				   /*                        */
+  int		type;				   /*                        */
+  Symbol	key;				   /*                        */
+ 						   /*                        */
+  if (cache->c_next >= cache->c_nrecs) return BIB_EOF;/*                     */
+  p    = cache->c_recs + 4 * CACHE_REC * cache->c_next++;/*                  */
+  type = (int)CacheWord(p, 0);			   /*                        */
+  f    = cache->c_fields + 4 * CacheWord(p, 3);	   /*                        */
+  n    = CacheWord(p, 4);			   /*                        */
+ 						   /*                        */
+  if (cache->c_filter && !IsSpecialRecord(type) && n > 0)/*                  */
+  { key = cache_symbol(cache, CacheWord(f, 0));	   /*                        */
+    if (key != sym_empty && !(*cache->c_filter)(key))/*                      */
+    { return BIB_SKIP; }			   /*                        */
+  }						   /*                        */
+ 						   /*                        */
+  RecordOldKey(rec)  = NULL;			   /*                        */
+  RecordFree(rec)    = 0;			   /*                        */
+  RecordClear(rec, RecordFlagINDEXED);		   /*                        */
+  RecordSet(rec, RecordFlagPACKED);		   /*                        */
+  RecordType(rec)    = type;			   /*                        */
+  RecordLineno(rec)  = (int)CacheWord(p, 1);	   /*                        */
+  RecordOffset(rec)  = -1L;			   /*                        */
+  RecordComment(rec) = cache_symbol(cache, CacheWord(p, 2));/*               */
+  for (i = 0; i < n; i += 2)			   /*                        */
+  { push_to_record(rec,				   /*                        */
+		   cache_symbol(cache, CacheWord(f, i)),/*                   */
+		   cache_symbol(cache, CacheWord(f, i + 1)),/*               */
+		   false);			   /*                        */
+  }						   /*                        */
+  return type;					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	cache_int()
+** Purpose:	Append an integer to the records to be written.
+** Arguments:
+**	cache	the cache
+**	n	the integer
+** Returns:	nothing
+**___________________________________________________			     */
+static void cache_int(cache, n)			   /*                        */
+  Cache cache;					   /*                        */
+  int	n;					   /*                        */
+{						   /*                        */
+  if (cache->c_used >= cache->c_rsize)		   /*                        */
+  { cache->c_rsize = (cache->c_rsize ? 2 * cache->c_rsize : 1024);/*         */
+    cache->c_rec   = (int*)realloc(cache->c_rec,   /*                        */
+				   cache->c_rsize * sizeof(int));/*          */
+    if (cache->c_rec == NULL)			   /*                        */
+    { OUT_OF_MEMORY("cache"); }			   /*                        */
+  }						   /*                        */
+  cache->c_rec[cache->c_used++] = n;		   /*                        */
+}						   /*------------------------*/
+
+#define CacheHash(C,S) ((int)(((unsigned long)(S) >> 3) & ((C)->c_tsize - 1)))
+
+/*-----------------------------------------------------------------------------
+** Function*:	cache_sym()
+** Purpose:	Append a symbol to the records to be written. Each
+**		symbol is entered into the symbol table once.
+** Arguments:
+**	cache	the cache
+**	s	the symbol or |NO_SYMBOL|
+** Returns:	nothing
+**___________________________________________________			     */
+static void cache_sym(cache, s)			   /*                        */
+  Cache  cache;					   /*                        */
+  Symbol s;					   /*                        */
+{ int	 i, j;					   /*                        */
+ 						   /*                        */
+  if (s == NO_SYMBOL) { cache_int(cache, 0); return; }/*                     */
+ 						   /*                        */
+  if (2 * (cache->c_nsyms + 1) > cache->c_tsize)   /* rehash                 */
+  { cache->c_tsize = (cache->c_tsize ? 2 * cache->c_tsize : 1024);/*         */
+    cache->c_tab   = (int*)realloc(cache->c_tab,   /*                        */
+				   cache->c_tsize * sizeof(int));/*          */
+    cache->c_syms  = (Symbol*)realloc(cache->c_syms,/*                       */
+				      cache->c_tsize * sizeof(Symbol));/*    */
+    if (cache->c_tab == NULL || cache->c_syms == NULL)/*                     */
+    { OUT_OF_MEMORY("cache"); }			   /*                        */
+    for (i = 0; i < cache->c_tsize; i++) cache->c_tab[i] = -1;/*             */
+    for (j = 0; j < cache->c_nsyms; j++)	   /*                        */
+    { for (i = CacheHash(cache, cache->c_syms[j]); /*                        */
+	   cache->c_tab[i] >= 0;		   /*                        */
+	   i = (i + 1) & (cache->c_tsize - 1)) {}  /*                        */
+      cache->c_tab[i] = j;			   /*                        */
+    }						   /*                        */
+  }						   /*                        */
+  for (i = CacheHash(cache, s);			   /*                        */
+       (j = cache->c_tab[i]) >= 0;		   /*                        */
+       i = (i + 1) & (cache->c_tsize - 1))	   /*                        */
+  { if (cache->c_syms[j] == s)			   /*                        */
+    { cache_int(cache, j + 1);			   /*                        */
+      return;					   /*                        */
+    }						   /*                        */
+  }						   /*                        */
+  cache->c_tab[i] = cache->c_nsyms;		   /*                        */
+  cache->c_syms[cache->c_nsyms++] = s;		   /*                        */
+  cache_int(cache, cache->c_nsyms);		   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	cache_record()
+** Purpose:	Get the next record. It is taken from the cache, read
+**		at the offsets of the index, or read with
+**		|parse_bib()|. In the latter case the record is
+**		remembered for the cache file and its position for the
+**		index. An error of the parser prevents the cache file
+**		and the index from being written.
+** Arguments:
+**	cache	the cache
+**	rec	the record to fill
+** Returns:	The type of the entry, |BIB_EOF|, |BIB_NOOP|, or
+**		|BIB_SKIP|.
+**___________________________________________________			     */
+static int cache_record(cache, rec)		   /*                        */
+  Cache	 cache;					   /*                        */
+  Record rec;					   /*                        */
+{ int	 type, i;				   /*                        */
+  long	 from, to;				   /*                        */
+ 						   /*                        */
+  if (cache->c_mode == CACHE_READ)		   /*                        */
+  { return cache_next(cache, rec); }		   /*                        */
+  if (cache->c_idx.i_read)			   /*                        */
+  { return index_next(&cache->c_idx, rec, cache->c_filter); }/*              */
+ 						   /*                        */
+  type = parse_bib(rec);			   /*                        */
+  if (cache->c_idx.i_write && type != BIB_EOF)	   /*                        */
+  { if (type == BIB_NOOP)			   /*                        */
+    { cache->c_idx.i_write = false; }		   /*                        */
+    else if (RecordFree(rec) > 0)		   /*                        */
+    { seen_bib_span(&from, &to);		   /*                        */
+      index_add(&cache->c_idx,			   /*                        */
+		RecordType(rec),		   /*                        */
+		(IsSpecialRecord(RecordType(rec))  /*                        */
+		 ? NO_SYMBOL			   /*                        */
+		 : *RecordHeap(rec)),		   /*                        */
+		from,				   /*                        */
+		to,				   /*                        */
+		RecordLineno(rec));		   /*                        */
+    }						   /*                        */
+  }						   /*                        */
+  if (cache->c_mode != CACHE_WRITE || type == BIB_EOF) return type;/*        */
+  if (type < 0 || type == BIB_SKIP)		   /*                        */
+  { cache->c_mode = CACHE_NONE;			   /*                        */
+    return type;				   /*                        */
+  }						   /*                        */
+  cache_int(cache, type);			   /*                        */
+  cache_int(cache, RecordLineno(rec));		   /*                        */
+  cache_sym(cache, RecordComment(rec));		   /*                        */
+  cache_int(cache, RecordFree(rec));		   /*                        */
+  for (i = 0; i < RecordFree(rec); i++)		   /*                        */
+  { cache_sym(cache, RecordHeap(rec)[i]); }	   /*                        */
+  return type;					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	cache_put()
+** Purpose:	Write a number to the cache file.
+** Arguments:
+**	v	the number
+**	n	the number of bytes
+**	f	the file
+** Returns:	nothing
+**___________________________________________________			     */
+static void cache_put(v, n, f)			   /*                        */
+  unsigned long v;				   /*                        */
+  int		n;				   /*                        */
+  FILE		*f;				   /*                        */
+{ unsigned char buf[8];				   /*                        */
+  int		i;				   /*                        */
+ 						   /*                        */
+  for (i = n - 1; i >= 0; i--)			   /*                        */
+  { buf[i] = (unsigned char)(v & 0xff);		   /*                        */
+    v >>= 8;					   /*                        */
+  }						   /*                        */
+  (void)fwrite(buf, 1, n, f);			   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	cache_done()
+** Purpose:	Write the cache file if the records have been
+**		collected successfully and release the cache. The
+**		file is written under a temporary name first and
+**		renamed afterwards. Thus processes which have mapped
+**		the old file are not disturbed.
+**
+**		The image read is kept if strings from it have become
+**		symbols.
+** Arguments:
+**	cache	the cache
+** Returns:	nothing
+**___________________________________________________			     */
+static void cache_done(cache)			   /*                        */
+  Cache	cache;					   /*                        */
+{ FILE	*f;					   /*                        */
+  char	*tmp;					   /*                        */
+  int	i, j, n, nrecs, nfields;		   /*                        */
+  unsigned long pos;				   /*                        */
+  bool	ok;					   /*                        */
+ 						   /*                        */
+  if (cache->c_mode == CACHE_WRITE &&		   /*                        */
+      (tmp = malloc(strlen(cache->c_name) + 5)) != NULL)/*                   */
+  { (void)sprintf(tmp, "%s.tmp", cache->c_name);   /*                        */
+    if ((f = fopen(tmp, "wb")) != NULL)		   /*                        */
+    { for (i = nrecs = nfields = 0; i < cache->c_used; nrecs++)/*            */
+      { nfields += cache->c_rec[i + 3];		   /*                        */
+	i += 4 + cache->c_rec[i + 3];		   /*                        */
+      }						   /*                        */
+      (void)fputs(CACHE_MAGIC, f);		   /*                        */
+      for (i = 0; i < 4; i++)			   /*                        */
+      { cache_put(cache->c_head[i], 8, f); }	   /*                        */
+      n = strlen((char*)cache->c_path);		   /*                        */
+      cache_put((unsigned long)n, 4, f);	   /*                        */
+      (void)fwrite(cache->c_path, 1, n, f);	   /*                        */
+      cache_put(0UL, (4 - n % 4) % 4, f);	   /*                        */
+ 						   /*                        */
+      for (i = 0, pos = 0; i < cache->c_nsyms; i++)/*                        */
+      { pos += strlen((char*)SymbolValue(cache->c_syms[i])) + 1; }/*         */
+      cache_put((unsigned long)cache->c_nsyms, 4, f);/*                      */
+      cache_put((unsigned long)nrecs, 4, f);	   /*                        */
+      cache_put((unsigned long)nfields, 4, f);	   /*                        */
+      cache_put(pos, 4, f);			   /*                        */
+ 						   /*                        */
+      for (i = 0, pos = 0; i < cache->c_nsyms; i++)/* the symbol offsets     */
+      { cache_put(pos, 4, f);			   /*                        */
+	pos += strlen((char*)SymbolValue(cache->c_syms[i])) + 1;/*           */
+      }						   /*                        */
+      for (i = 0, j = 0; i < cache->c_used; i += 4 + cache->c_rec[i + 3])/*  */
+      { cache_put((unsigned long)cache->c_rec[i], 4, f);/* the record table  */
+	cache_put((unsigned long)cache->c_rec[i + 1], 4, f);/*               */
+	cache_put((unsigned long)cache->c_rec[i + 2], 4, f);/*               */
+	cache_put((unsigned long)j, 4, f);	   /*                        */
+	cache_put((unsigned long)cache->c_rec[i + 3], 4, f);/*               */
+	j += cache->c_rec[i + 3];		   /*                        */
+      }						   /*                        */
+      for (i = 0; i < cache->c_used; i += 4 + cache->c_rec[i + 3])/*         */
+      { for (j = 0; j < cache->c_rec[i + 3]; j++)  /* the field array        */
+	{ cache_put((unsigned long)cache->c_rec[i + 4 + j], 4, f); }/*       */
+      }						   /*                        */
+      for (i = 0; i < cache->c_nsyms; i++)	   /* the string pool        */
+      { (void)fputs((char*)SymbolValue(cache->c_syms[i]), f);/*              */
+	(void)fputc('\0', f);			   /*                        */
+      }						   /*                        */
+      ok = !ferror(f);				   /*                        */
+      if (fclose(f) != 0) ok = false;		   /*                        */
+      if (!ok || rename(tmp, cache->c_name) != 0)  /*                        */
+      { (void)remove(tmp); }			   /*                        */
+    }						   /*                        */
+    free(tmp);					   /*                        */
+  }						   /*                        */
+ 						   /*                        */
+  if (cache->c_buf && !cache->c_adopted)	   /*                        */
+  {						   /*                        */
+#ifdef HAVE_SYS_MMAN_H
+    if (cache->c_mapped)			   /*                        */
+    { (void)munmap(cache->c_buf, cache->c_size); } /*                        */
+    else					   /*                        */
+#endif
+    { free(cache->c_buf); }			   /*                        */
+  }						   /*                        */
+  if (cache->c_name) free(cache->c_name);	   /*                        */
+  if (cache->c_syms) free(cache->c_syms);	   /*                        */
+  if (cache->c_tab)  free(cache->c_tab);	   /*                        */
+  if (cache->c_rec)  free(cache->c_rec);	   /*                        */
+  index_done(&cache->c_idx);			   /*                        */
+}						   /*------------------------*/
+
 /*-----------------------------------------------------------------------------
 ** Function:	read_db()
 ** Purpose:	Read records from a file and add them to a database.
@@ -296,9 +1428,11 @@ bool read_db(db, file, verbose)		   	   /*                        */
   String	  file;			   	   /*                        */
   bool		  verbose;			   /*                        */
 { register int	  type;				   /*			     */
-  static Record	  master_record = RecordNULL;	   /*			     */
   Record	  rec;				   /*			     */
   register Record dbn;				   /*                        */
+  bool		  skip = aux_skipping();	   /*                        */
+  bool		  rescanning = aux_rescanning();   /*                        */
+  SCache	  cache;			   /*                        */
 						   /*                        */
   if (!see_bib(file)) return 1;		   	   /*                        */
   if (master_record == RecordNULL)		   /*                        */
@@ -323,26 +1457,41 @@ bool read_db(db, file, verbose)		   	   /*                        */
     { dbn = NextRecord(dbn); }			   /*                        */
   }						   /*                        */
   DBnormal(db) = dbn;				   /*                        */
+  if (skip) { set_key_filter(aux_wanted); }	   /* Pass over uncited keys */
+  cache_init(&cache, seen_bib_file(), skip ? aux_wanted : NULL);/*                 */
+  cache_writing = (cache.c_mode == CACHE_WRITE);   /*                        */
+  suspend_lazy(cache_writing);			   /* the image keeps values */
  						   /*                        */
-  for (type = parse_bib(master_record);		   /*                        */
+  for (type = cache_record(&cache, master_record); /*                        */
        type != BIB_EOF;				   /*		             */
-       type = parse_bib(master_record))		   /*                        */
+       type = cache_record(&cache, master_record)) /*                        */
   {						   /*                        */
-    if (type < 0)				   /* Errors give rise to    */
+    if (type == BIB_SKIP)			   /* Not requested by the   */
+    { continue; }				   /* aux file.              */
+    else if (type < 0)				   /* Errors give rise to    */
     { SkipWarning; }				   /*  a warning.	     */
     else if (IsSpecialRecord(type))		   /* STRING/PREAMBLE/COMMENT*/
-    { db_insert(db,				   /*                        */
+    { if (rescanning) continue;			   /* already read before    */
+      db_insert(db,				   /*                        */
 		copy_record(master_record),	   /*                        */
 		verbose);			   /*                        */
+      if (record_hook) (*record_hook)(db);	   /*                        */
     }						   /*			     */
     else					   /*                        */
     { rec = copy_record(master_record);	   	   /* Make a private copy.   */
+      adopt_lazy_values(rec);			   /*                        */
       RecordOldKey(rec) = *RecordHeap(rec);	   /*                        */
       db_insert(db,rec, verbose);		   /*                        */
+      if (skip) { aux_follow(db, rec); }	   /*                        */
       if (verbose) { ErrC('+'); FlushErr; }	   /*			     */
+      if (record_hook) (*record_hook)(db);	   /*                        */
     }						   /*			     */
   }						   /*			     */
  						   /*                        */
+  set_key_filter(NULL);				   /*                        */
+  cache_done(&cache);				   /*                        */
+  cache_writing = false;			   /*                        */
+  suspend_lazy(false);				   /*                        */
   if (verbose)			   	   	   /* If desired print a     */
   { VerbosePrint2("Done with ",file); }	   	   /*	close message.	     */
  						   /*                        */
@@ -412,8 +1561,10 @@ static void mark_string(rec, s)			   /*                        */
 /*-----------------------------------------------------------------------------
 ** Function*:	print_segment()
 ** Type:	void
-** Purpose:	
-**		
+** Purpose:	Print the records of a segment of the database. The
+**		records to be printed are collected first and passed
+**		to |fput_records()| which may distribute the formatting
+**		over several threads.
 ** Arguments:
 **	file	the file
 **	 db	the database
@@ -426,22 +1577,31 @@ static void print_segment(file, db, rec, allp)	   /*                        */
   DB     db;					   /*                        */
   Record rec;					   /*                        */
   bool   allp;					   /*                        */
-{						   /*                        */
+{ Record *recs;					   /*                        */
+  Record r;					   /*                        */
+  int    n;					   /*                        */
+ 						   /*                        */
   if (rec == RecordNULL) return;		   /*                        */
  						   /*                        */
   while (PrevRecord(rec) != RecordNULL)		   /* Rewind to beginning.   */
   { rec = PrevRecord(rec); }		   	   /*                        */
  						   /*                        */
-  for ( ; rec != RecordNULL; rec = NextRecord(rec))/*                        */
+  for (n = 0, r = rec; r != RecordNULL; r = NextRecord(r)) { n++; }/*        */
+  if ( (recs = (Record*)malloc(n * sizeof(Record))) == NULL )/*              */
+  { OUT_OF_MEMORY("print"); }			   /*                        */
+ 						   /*                        */
+  for (n = 0; rec != RecordNULL; rec = NextRecord(rec))/*                    */
   {						   /*                        */
     if (!RecordIsDELETED(rec))		   	   /*                        */
     { if (allp || RecordIsMARKED(rec))	   	   /*                        */
-      { fput_record(file, rec, db, (String)"@");   /*                        */
+      { recs[n++] = rec;			   /*                        */
       }					   	   /*                        */
     }					   	   /*                        */
     else if (rsc_del_q)			   	   /*                        */
-    { fput_record(file, rec,db, rsc_del_pre); }	   /*                        */
+    { recs[n++] = rec; }			   /*                        */
   }						   /*                        */
+  fput_records(file, recs, n, db, (String)"@", rsc_del_pre);/*               */
+  free(recs);					   /*                        */
 }						   /*------------------------*/
 
 /*-----------------------------------------------------------------------------
@@ -632,6 +1792,9 @@ static void print_strings(file, db, allp)	   /*                        */
 **		\item [a] The aliases.
 **		\item [m] The modifies.
 **		\end{description}
+**		If runs have been written with |db_spill()| then they
+**		are merged with the normal records for [n]. The runs
+**		are removed afterwards.
 **		Upper-case letters which are not mentioned are silently folded
 **		to their lower-case counterparts.
 ** Arguments:
@@ -651,7 +1814,8 @@ void print_db(file,db,spec)			   /*                        */
 	print_segment(file, db, DBpreamble(db), true);/*                     */
 	break;					   /*                        */
       case 'n': case 'N':			   /*                        */
-	print_segment(file, db, DBnormal(db), true);/*                       */
+	if (runs_used > 0) print_runs(file, db);   /*                        */
+	else print_segment(file, db, DBnormal(db), true);/*                  */
 	break;					   /*                        */
       case 's':					   /*                        */
 	print_strings(file, db, rsc_all_macs);	   /*                        */
@@ -776,6 +1940,7 @@ Record db_find(db,key)				   /*                        */
 { register Record rec;				   /*                        */
 						   /*                        */
   DebugPrint2("Finding... ", SymbolValue(key));	   /*                        */
+  StatCount(st_finds, 1);			   /*                        */
  						   /*                        */
   if (DBnormal(db) == RecordNULL) return RecordNULL;/*                       */
 						   /*                        */
@@ -899,117 +2064,106 @@ void db_rewind(db)				   /*                        */
   { DBnormal(db) = PrevRecord(DBnormal(db)); }	   /*                        */
 }						   /*------------------------*/
 
+/*-----------------------------------------------------------------------------
+** Function*:	rec__merge()
+** Purpose:	Merge two sorted lists of records. The lists are
+**		linked by their next pointers only and end in
+**		|RecordNULL|. On equal keys the records of the first
+**		list come first.
+** Arguments:
+**	p	the first list
+**	q	the second list
+**	less	the comparator
+** Returns:	the first record of the merged list.
+**___________________________________________________			     */
+static Record rec__merge(p,q,less)		   /*                        */
+  Record p;					   /*                        */
+  Record q;					   /*                        */
+  int	 (*less)_ARG((Record,Record));	   	   /* Function pointer	     */
+{ Record head = RecordNULL;			   /*                        */
+  Record tail = RecordNULL;			   /*                        */
+  Record e;					   /*                        */
+ 						   /*                        */
+  while (p != RecordNULL && q != RecordNULL)	   /*                        */
+  { if ((*less)(q, p))				   /*                        */
+    { e = q; q = NextRecord(q); }		   /*                        */
+    else					   /*                        */
+    { e = p; p = NextRecord(p); }		   /*                        */
+    if (tail == RecordNULL) head = e;		   /*                        */
+    else NextRecord(tail) = e;			   /*                        */
+    tail = e;					   /*                        */
+  }						   /*                        */
+  e = (p != RecordNULL ? p : q);		   /*                        */
+  if (tail == RecordNULL) head = e;		   /*                        */
+  else NextRecord(tail) = e;			   /*                        */
+  return head;					   /*                        */
+}						   /*------------------------*/
+
 /*-----------------------------------------------------------------------------
 ** Function*:	rec__sort()
-** Purpose:	
-**		
+** Purpose:	Sort a double linked list of records. The list may be
+**		given by any of its records.
+**
+**		The sorting uses a natural merge sort. The list is cut
+**		into runs of records which are already in order. Then
+**		neighbouring runs are merged until a single run is
+**		left. Thus sorted input needs a linear number of
+**		comparisons and the concatenation of $k$ sorted lists
+**		of $n$ records in total needs about $n\log k$
+**		comparisons. In the worst case about $n\log n$
+**		comparisons are needed.
+**
+**		The sorting is stable: records with the same key keep
+**		their relative order.
 ** Arguments:
 **	rec	the record
 **	less	the comparator
-** Returns:	
+** Returns:	the first record of the sorted list.
 **___________________________________________________			     */
 static Record rec__sort(rec,less)		   /*                        */
   Record rec;					   /*                        */
   int	 (*less)_ARG((Record,Record));	   	   /* Function pointer	     */
-{ Record r;				   	   /*                        */
-  Record new;		   		   	   /*                        */
+{ Record *heads;				   /*                        */
+  Record next;					   /*                        */
+  size_t n, i, j;				   /*                        */
+  size_t size = 64;				   /*                        */
  						   /*                        */
   if (rec == RecordNULL) return rec;	  	   /*                        */
-  r = RecordNULL ;				   /*                        */
  						   /*                        */
   while (PrevRecord(rec) != RecordNULL)		   /*                        */
   { rec = PrevRecord(rec); }			   /*                        */
  						   /*                        */
-  while (rec != RecordNULL)			   /*                        */
-  { new = rec;					   /*                        */
-    rec = NextRecord(rec);			   /*                        */
-    r   = insert_record(new,r,less);		   /*                        */
+  if ((heads = (Record*)malloc(size * sizeof(Record))) == NULL)/*            */
+  { OUT_OF_MEMORY("sort"); }			   /*                        */
+  heads[0] = rec;				   /*                        */
+  n	  = 1;					   /*                        */
+  for (; (next = NextRecord(rec)) != RecordNULL; rec = next)/*               */
+  { if ((*less)(next, rec))			   /* a new run starts       */
+    { NextRecord(rec) = RecordNULL;		   /*                        */
+      if (n >= size)				   /*                        */
+      { size *= 2;				   /*                        */
+	if ((heads = (Record*)realloc(heads, size * sizeof(Record))) == NULL)/**/
+	{ OUT_OF_MEMORY("sort"); }		   /*                        */
+      }						   /*                        */
+      heads[n++] = next;			   /*                        */
+    }						   /*                        */
   }						   /*                        */
-  return r;				   	   /*                        */
-}						   /*------------------------*/
-
-/*-----------------------------------------------------------------------------
-** The sorting uses a variant of insertion sort.
-** Thus the major task is performed in this function, which is called to store
-** a record.
-** The Record structure contains two pointers to the same type. With those
-** pointers a double linked list is established. sort_rec is either NULL ---
-** if no record is stored --- or it is a pointer to some element in the
-** ORDERED list:
-** 
-**    +------+	 +------+   +------+   +------+	  +------+   +------+	
-** -->|Record|-->|Record|-->|Record|-->|Record|-->|Record|-->|Record|-->
-** <--|	     |<--|	|<--|	   |<--|      |<--|	 |<--|	    |<--
-**    +------+	 +------+   +------+   +------+	  +------+   +------+	
-**			       ^
-**		      db_______|
-** 
-** With this picture in mind it's obvious what's to be done.
-** There are two major cases. To find the right position to insert the new
-** record
-** - either the pointer has to be moved leftward
-** - or	    the pointer has to be moved rightward
-** 
-** Special cases have to be considered if the new record is to be inserted
-** before the first or after the last element in the list.
-** 
-** The rest is simply leg work.
-**
-** Well, a word on the complexity.
-** If the input is almost sorted (correct or in reverse order) then the 
-** algorithm is linear.
-** In the worst case the algorithm is quadratic. This worst case looks as
-** follows:
-** A record has to be inserted which is smaller than the least element in the
-** list. Afterwards one which is greater than the largest.
-** 
-** NOTE: CURRENTLY THE ALGORITHM IS NOT STABLE:
-**	 Records with the same key may get mixed in the sorted list.
-**___________________________________________________			     */
-static Record insert_record(rec,ptr,less)	   /*			     */
-  register Record rec;				   /*			     */
-  register Record ptr;				   /*			     */
-  int		  (*less)_ARG((Record,Record));	   /* Function pointer	     */
-{					   	   /*			     */
-  if (ptr == RecordNULL) {	   		   /* List is empty	     */
-    PrevRecord(rec) = RecordNULL;		   /*		             */
-    NextRecord(rec) = RecordNULL;		   /*			     */
-    return rec;					   /*                        */
+ 						   /*                        */
+  while (n > 1)					   /*                        */
+  { for (i = 0, j = 0; i < n; i += 2)		   /*                        */
+    { heads[j++] = (i + 1 < n			   /*                        */
+		   ? rec__merge(heads[i], heads[i + 1], less)/*               */
+		   : heads[i]);			   /*                        */
+    }						   /*                        */
+    n = j;					   /*                        */
   }						   /*                        */
-						   /*			     */
-  if ((*less)(rec,ptr))			   	   /*			     */
-  {						   /*                        */
-    while (PrevRecord(ptr) != RecordNULL)	   /* Move leftward.	     */
-    { ptr = PrevRecord(ptr);			   /*			     */
-      if (!(*less)(rec,ptr))			   /*			     */
-      { PrevRecord(rec)		   = ptr;	   /* Insert		     */
-	NextRecord(rec)		   = NextRecord(ptr);/*			     */
-	PrevRecord(NextRecord(rec))= rec;	   /*			     */
-	NextRecord(ptr)		   = rec;	   /*			     */
-	return rec;				   /*			     */
-      }						   /*			     */
-    }						   /*			     */
-    PrevRecord(ptr) = rec;			   /* Insert before the first*/
-    NextRecord(rec) = ptr;			   /*			     */
-    PrevRecord(rec) = RecordNULL;		   /*			     */
-  }						   /*			     */
-  else						   /*			     */
-  {						   /*                        */
-    while (NextRecord(ptr) != RecordNULL)	   /* Move rightward.	     */
-    { ptr = NextRecord(ptr);			   /*			     */
-      if ((*less)(rec,ptr))			   /*			     */
-      { NextRecord(rec)		   = ptr;	   /* Insert		     */
-	PrevRecord(rec)		   = PrevRecord(ptr);/*			     */
-	NextRecord(PrevRecord(rec))= rec;	   /*			     */
-	PrevRecord(ptr)		   = rec;	   /*			     */
-	return rec;				   /*			     */
-      }						   /*			     */
-    }						   /*			     */
-    NextRecord(ptr) = rec;			   /* Insert after the last. */
-    PrevRecord(rec) = ptr;			   /*			     */
-    NextRecord(rec) = RecordNULL;		   /*			     */
-  }						   /*			     */
-  return rec;					   /*                        */
+  rec = heads[0];				   /*                        */
+  free(heads);					   /*                        */
+ 						   /*                        */
+  PrevRecord(rec) = RecordNULL;			   /* restore the back links */
+  for (next = rec; NextRecord(next) != RecordNULL; next = NextRecord(next))/**/
+  { PrevRecord(NextRecord(next)) = next; }	   /*                        */
+  return rec;				   	   /*                        */
 }						   /*------------------------*/
 
 /*-----------------------------------------------------------------------------
@@ -1067,6 +2221,394 @@ void db_sort(db,less)				   /*                        */
   DBnormal(db) = rec__sort(DBnormal(db), less);	   /*                        */
 }						   /*------------------------*/
 
+/*-----------------------------------------------------------------------------
+** Function:	db_spill()
+** Purpose:	Sort the normal records of a database and write them
+**		as a run to a temporary file. The normal records are
+**		removed from the database afterwards. The runs are
+**		merged by |print_db()|. Thus the normal records can be
+**		sorted without keeping all of them in memory. The
+**		database has to be sorted with the same comparison
+**		before it is printed.
+**
+**		If the first record is not less than the last record
+**		written then the records are appended to the last run
+**		instead. Thus sorted input yields a single run. The
+**		comparison may only look at the sort keys of the
+**		records.
+**
+**		The private copies of the field values made by the
+**		parser are released as well unless a cache file is
+**		being written.
+** Arguments:
+**	db	Database to sort.
+**	less	Comparison function to use.
+** Returns:	nothing
+**___________________________________________________			     */
+void db_spill(db, less)				   /*                        */
+  DB  db;					   /*                        */
+  int (*less)_ARG((Record,Record));	   	   /* Function pointer	     */
+{ Record rec;					   /*                        */
+  FILE	 *f;					   /*                        */
+ 						   /*                        */
+  if (DBnormal(db) == RecordNULL) return;	   /*                        */
+  db_sort(db, less);				   /*                        */
+  db_rewind(db);				   /*                        */
+  if (runs_tail == RecordNULL) runs_tail = new_record(0, 1);/*               */
+ 						   /*                        */
+  if (runs_used > 0 &&				   /* The records continue   */
+      !(*less)(DBnormal(db), runs_tail))	   /*  the last run.         */
+  { f = runs[runs_used - 1]; }			   /*                        */
+  else						   /*                        */
+  { if ((f = tmpfile()) == NULL)		   /*                        */
+    { ERROR_EXIT("Temporary file for sorting could not be opened."); }/*     */
+    if (runs_used >= runs_size)			   /*                        */
+    { runs_size += 16;				   /*                        */
+      runs = (runs == (FILE**)NULL		   /*                        */
+	      ? (FILE**)malloc(runs_size * sizeof(FILE*))/*                  */
+	      : (FILE**)realloc(runs, runs_size * sizeof(FILE*)));/*         */
+      if (runs == (FILE**)NULL) { OUT_OF_MEMORY("sort"); }/*                 */
+    }						   /*                        */
+    runs[runs_used++] = f;			   /*                        */
+  }						   /*                        */
+  for (rec = DBnormal(db); rec != RecordNULL; rec = NextRecord(rec))/*       */
+  { run_write(rec, f);				   /*                        */
+    RecordSortkey(runs_tail) = RecordSortkey(rec); /*                        */
+  }						   /*                        */
+  if (ferror(f))				   /*                        */
+  { ERROR_EXIT("Temporary file for sorting could not be written."); }/*      */
+  runs_less = less;				   /*                        */
+ 						   /*                        */
+  free_record(DBnormal(db));			   /*                        */
+  DBnormal(db) = RecordNULL;			   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	run_get()
+** Purpose:	Read a number from a run file.
+** Arguments:
+**	n	the number of bytes
+**	f	the file
+** Returns:	The number.
+**___________________________________________________			     */
+static unsigned long run_get(n, f)		   /*                        */
+  int		n;				   /*                        */
+  FILE		*f;				   /*                        */
+{ unsigned long v = 0;				   /*                        */
+ 						   /*                        */
+  while (n-- > 0) { v = (v << 8) | (getc(f) & 0xff); }/*                     */
+  return v;					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	run_string()
+** Purpose:	Write a string to a run file.
+** Arguments:
+**	s	the string or |NO_SYMBOL|
+**	f	the file
+** Returns:	nothing
+**___________________________________________________			     */
+static void run_string(s, f)			   /*                        */
+  Symbol s;					   /*                        */
+  FILE	 *f;					   /*                        */
+{ size_t n;					   /*                        */
+ 						   /*                        */
+  if (s == NO_SYMBOL) { cache_put(0UL, 4, f); return; }/*                    */
+  n = strlen((char*)SymbolValue(s));		   /*                        */
+  cache_put((unsigned long)n + 1, 4, f);	   /*                        */
+  (void)fwrite(SymbolValue(s), 1, n, f);	   /*                        */
+}						   /*------------------------*/
+
+#define RunSize(S) ((S) == NO_SYMBOL ? 0UL : strlen((char*)SymbolValue(S)) + 1)
+
+/*-----------------------------------------------------------------------------
+** Function*:	run_write()
+** Purpose:	Append a record to a run file.
+** Arguments:
+**	rec	the record
+**	f	the file
+** Returns:	nothing
+**___________________________________________________			     */
+static void run_write(rec, f)			   /*                        */
+  Record rec;					   /*                        */
+  FILE	 *f;					   /*                        */
+{ unsigned long size;				   /*                        */
+  int		i;				   /*                        */
+ 						   /*                        */
+  size = (RunSize(RecordSource(rec)) +		   /*                        */
+	  RunSize(RecordComment(rec)) +		   /*                        */
+	  RunSize(RecordSortkey(rec)));		   /*                        */
+  for (i = 0; i < RecordFree(rec); i++)		   /*                        */
+  { size += RunSize(RecordHeap(rec)[i]); }	   /*                        */
+ 						   /*                        */
+  cache_put((unsigned long)RecordType(rec), 4, f); /*                        */
+  cache_put((unsigned long)RecordFlags(rec), 4, f);/*                        */
+  cache_put((unsigned long)RecordLineno(rec), 4, f);/*                       */
+  cache_put((unsigned long)RecordFree(rec), 4, f); /*                        */
+  cache_put((unsigned long)(RecordOffset(rec) + 1), 8, f);/*                 */
+  cache_put((unsigned long)RecordLength(rec), 8, f);/*                       */
+  cache_put(size, 4, f);			   /*                        */
+  run_string(RecordSource(rec), f);		   /*                        */
+  run_string(RecordComment(rec), f);		   /*                        */
+  run_string(RecordSortkey(rec), f);		   /*                        */
+  for (i = 0; i < RecordFree(rec); i++)		   /*                        */
+  { run_string(RecordHeap(rec)[i], f); }	   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	run_read()
+** Purpose:	Read the next record of a run file. The field names,
+**		the key, and the source are symbols. The other strings
+**		are kept in a buffer which has to be freed together
+**		with the record.
+** Arguments:
+**	run	the run
+** Returns:	|false| at the end of the file.
+**___________________________________________________			     */
+static bool run_read(run)			   /*                        */
+  Run		run;				   /*                        */
+{ Record	rec;				   /*                        */
+  int		c, i, type, flags, lineno, n;	   /*                        */
+  long		offset, length;			   /*                        */
+  unsigned long len, size;			   /*                        */
+  char		*p;				   /*                        */
+  Symbol	s[3];				   /*                        */
+ 						   /*                        */
+  run->r_rec = RecordNULL;			   /*                        */
+  run->r_buf = NULL;				   /*                        */
+  if ((c = getc(run->r_file)) == EOF) return false;/*                        */
+  (void)ungetc(c, run->r_file);			   /*                        */
+ 						   /*                        */
+  type	 = (int)run_get(4, run->r_file);	   /*                        */
+  flags	 = (int)run_get(4, run->r_file);	   /*                        */
+  lineno = (int)run_get(4, run->r_file);	   /*                        */
+  n	 = (int)run_get(4, run->r_file);	   /*                        */
+  offset = (long)run_get(8, run->r_file) - 1L;	   /*                        */
+  length = (long)run_get(8, run->r_file);	   /*                        */
+  size	 = run_get(4, run->r_file);		   /*                        */
+  if ((p = malloc(size + 1)) == NULL) { OUT_OF_MEMORY("sort"); }/*           */
+  run->r_buf = p;				   /*                        */
+  rec	     = new_record(type, n);		   /*                        */
+ 						   /*                        */
+  for (i = -3; i < n; i++)			   /*                        */
+  { Symbol sym = NO_SYMBOL;			   /*                        */
+    if ((len = run_get(4, run->r_file)) > 0)	   /*                        */
+    { if (fread(p, 1, len - 1, run->r_file) != len - 1)/*                    */
+      { ERROR_EXIT("Temporary file for sorting could not be read."); }/*     */
+      p[len - 1] = '\0';			   /*                        */
+      sym = ((i == -3 || (i >= 0 && i % 2 == 0))   /* names, keys, and the   */
+	     ? symbol((String)p)		   /*  source are symbols    */
+	     : (Symbol)p);			   /*                        */
+      p += len;					   /*                        */
+    }						   /*                        */
+    if (i < 0) s[i + 3] = sym;			   /*                        */
+    else RecordHeap(rec)[i] = sym;		   /*                        */
+  }						   /*                        */
+ 						   /*                        */
+  RecordSource(rec)  = s[0] ? s[0] : sym_empty;	   /*                        */
+  RecordComment(rec) = s[1] ? s[1] : sym_empty;	   /*                        */
+  RecordSortkey(rec) = s[2] ? s[2] : sym_empty;	   /*                        */
+  RecordOldKey(rec)  = *RecordHeap(rec);	   /*                        */
+  RecordFlags(rec)   = flags & ~RecordFlagINDEXED; /*                        */
+  RecordLineno(rec)  = lineno;			   /*                        */
+  RecordOffset(rec)  = offset;			   /*                        */
+  RecordLength(rec)  = length;			   /*                        */
+  run->r_rec	     = rec;			   /*                        */
+  return true;					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	run_before()
+** Purpose:	Compare the current records of two runs. Records with
+**		equal keys are taken from the earlier run first.
+** Arguments:
+**	run	the runs
+**	a	the index of the first run
+**	b	the index of the second run
+** Returns:	|true| iff the record of the first run comes first.
+**___________________________________________________			     */
+static bool run_before(run, a, b)		   /*                        */
+  Run run;					   /*                        */
+  int a;					   /*                        */
+  int b;					   /*                        */
+{						   /*                        */
+  if ((*runs_less)(run[a].r_rec, run[b].r_rec)) return true;/*               */
+  if ((*runs_less)(run[b].r_rec, run[a].r_rec)) return false;/*              */
+  return a < b;					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	run_sift()
+** Purpose:	Restore the heap property below an element of the heap
+**		of runs which has been replaced.
+** Arguments:
+**	run	the runs
+**	heap	the heap of run indices
+**	n	the size of the heap
+**	i	the position of the element
+** Returns:	nothing
+**___________________________________________________			     */
+static void run_sift(run, heap, n, i)		   /*                        */
+  Run run;					   /*                        */
+  int *heap;					   /*                        */
+  int n;					   /*                        */
+  int i;					   /*                        */
+{ int j, t;					   /*                        */
+ 						   /*                        */
+  while ((j = 2 * i + 1) < n)			   /*                        */
+  { if (j + 1 < n && run_before(run, heap[j + 1], heap[j])) j++;/*           */
+    if (!run_before(run, heap[j], heap[i])) return;/*                        */
+    t	    = heap[i];				   /*                        */
+    heap[i] = heap[j];				   /*                        */
+    heap[j] = t;				   /*                        */
+    i	    = j;				   /*                        */
+  }						   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	run_flush()
+** Purpose:	Print a batch of merged records. The records read from
+**		run files are freed afterwards.
+** Arguments:
+**	file	the output file
+**	db	the database
+**	recs	the records
+**	bufs	the buffers of the records or |NULL|
+**	n	the number of records
+** Returns:	nothing
+**___________________________________________________			     */
+static void run_flush(file, db, recs, bufs, n)	   /*                        */
+  FILE	 *file;					   /*                        */
+  DB	 db;					   /*                        */
+  Record *recs;					   /*                        */
+  char	 **bufs;				   /*                        */
+  int	 n;					   /*                        */
+{ int	 i;					   /*                        */
+ 						   /*                        */
+  fput_records(file, recs, n, db, (String)"@", rsc_del_pre);/*               */
+  for (i = 0; i < n; i++)			   /*                        */
+  { if (bufs[i] != NULL)			   /*                        */
+    { free_1_record(recs[i]);			   /*                        */
+      free(bufs[i]);				   /*                        */
+    }						   /*                        */
+  }						   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	print_runs()
+** Purpose:	Merge the runs written by |db_spill()| and the normal
+**		records of the database and print them. A heap of the
+**		runs yields the next record. Thus only one record per
+**		run is kept in memory. The run files are closed
+**		afterwards.
+**
+**		Double entries have the same sort key. Thus they are
+**		adjacent and each record is only compared with the
+**		records kept before with the same sort key.
+** Arguments:
+**	file	the output file
+**	db	the database
+** Returns:	nothing
+**___________________________________________________			     */
+static void print_runs(file, db)		   /*                        */
+  FILE	 *file;					   /*                        */
+  DB	 db;					   /*                        */
+{ Run	 run;					   /*                        */
+  int	 *heap;					   /*                        */
+  int	 i, n, k;				   /*                        */
+  Record rec;					   /*                        */
+  Record recs[RUN_BATCH];			   /*                        */
+  char	 *bufs[RUN_BATCH];			   /*                        */
+  bool	 drop;					   /*                        */
+  StringBuffer *prev = sbopen();		   /* the previous sort key  */
+  Same	 same = (Same)NULL;			   /* records with this key  */
+  int	 same_used = 0;				   /*                        */
+  int	 same_size = 0;				   /*                        */
+  int	 j;					   /*                        */
+ 						   /*                        */
+  n    = runs_used + 1;				   /*                        */
+  run  = (Run)malloc(n * sizeof(SRun));		   /*                        */
+  heap = (int*)malloc(n * sizeof(int));		   /*                        */
+  if (run == NULL || heap == NULL) { OUT_OF_MEMORY("sort"); }/*              */
+ 						   /*                        */
+  for (i = k = 0; i < runs_used; i++)		   /*                        */
+  { run[i].r_file = runs[i];			   /*                        */
+    rewind(runs[i]);				   /*                        */
+    if (run_read(&run[i])) heap[k++] = i;	   /*                        */
+  }						   /*                        */
+  db_rewind(db);				   /*                        */
+  run[i].r_file = NULL;				   /*                        */
+  run[i].r_buf	= NULL;				   /*                        */
+  run[i].r_rec	= DBnormal(db);			   /*                        */
+  if (run[i].r_rec != RecordNULL) heap[k++] = i;   /*                        */
+ 						   /*                        */
+  for (i = k / 2 - 1; i >= 0; i--)		   /* build the heap         */
+  { run_sift(run, heap, k, i); }		   /*                        */
+ 						   /*                        */
+  for (n = 0; k > 0; )				   /*                        */
+  { i	 = heap[0];				   /*                        */
+    rec	 = run[i].r_rec;			   /*                        */
+    drop = false;				   /*                        */
+    if (rsc_double_check)			   /* Doubles are adjacent.  */
+    { if (same_used > 0 &&			   /*                        */
+	  strcmp((char*)SymbolValue(RecordSortkey(rec)),/*                   */
+		 sbflush(prev)) == 0)		   /*                        */
+      { for (j = same_used - 1; j >= 0; j--)	   /*                        */
+	{ if (report_double(rec,		   /*                        */
+			    same[j].s_line,	   /*                        */
+			    same[j].s_source,	   /*                        */
+			    same[j].s_key))	   /*                        */
+	  { drop = true;			   /*                        */
+	    break;				   /*                        */
+	  }					   /*                        */
+	}					   /*                        */
+      } else					   /*                        */
+      { same_used = 0;				   /*                        */
+	sbrewind(prev);				   /*                        */
+	(void)sbputs((char*)SymbolValue(RecordSortkey(rec)), prev);/*        */
+      }						   /*                        */
+      if (!drop)				   /*                        */
+      { if (same_used >= same_size)		   /*                        */
+	{ same_size += 16;			   /*                        */
+	  same = (same == (Same)NULL		   /*                        */
+		  ? (Same)malloc(same_size*sizeof(SSame))/*                  */
+		  : (Same)realloc(same, same_size*sizeof(SSame)));/*         */
+	  if (same == (Same)NULL) { OUT_OF_MEMORY("sort"); }/*               */
+	}					   /*                        */
+	same[same_used].s_line	 = RecordLineno(rec);/*                      */
+	same[same_used].s_source = RecordSource(rec);/*                      */
+	same[same_used++].s_key	 = (*RecordHeap(rec) == NO_SYMBOL/*          */
+				    ? sym_empty	   /*                        */
+				    : *RecordHeap(rec));/*                   */
+      }						   /*                        */
+    }						   /*                        */
+    if (!drop && (!RecordIsDELETED(rec) || rsc_del_q))/*                     */
+    { recs[n]	= rec;				   /*                        */
+      bufs[n++] = run[i].r_buf;			   /*                        */
+      if (n == RUN_BATCH)			   /*                        */
+      { run_flush(file, db, recs, bufs, n);	   /*                        */
+	n = 0;					   /*                        */
+      }						   /*                        */
+    }						   /*                        */
+    else if (run[i].r_buf != NULL)		   /*                        */
+    { free_1_record(rec);			   /*                        */
+      free(run[i].r_buf);			   /*                        */
+    }						   /*                        */
+    if (run[i].r_file != NULL ? !run_read(&run[i]) /*                        */
+	: (run[i].r_rec = NextRecord(rec)) == RecordNULL)/*                  */
+    { heap[0] = heap[--k]; }			   /*                        */
+    run_sift(run, heap, k, 0);			   /*                        */
+  }						   /*                        */
+  run_flush(file, db, recs, bufs, n);		   /*                        */
+ 						   /*                        */
+  for (i = 0; i < runs_used; i++) { (void)fclose(runs[i]); }/*               */
+  runs_used = 0;				   /*                        */
+  (void)sbclose(prev);				   /*                        */
+  if (same != (Same)NULL) free(same);		   /*                        */
+  free(heap);					   /*                        */
+  free(run);					   /*                        */
+}						   /*------------------------*/
+
 /*-----------------------------------------------------------------------------
 ** Function:	db_string()
 ** Purpose:	Try to find the definition of a macro.
@@ -1125,8 +2667,9 @@ Symbol db_string(db, sym, localp)		   /*                        */
 int * db_count(db,lp)				   /*                        */
   DB         db;				   /*                        */
   int        *lp;				   /*                        */
-{ static int *count;				   /*                        */
-  static int len = 0;				   /*                        */
+{ SDbState   *st   = DbState;			   /*                        */
+  int        *count = st->db_count;		   /*                        */
+  int        len   = st->db_count_len;		   /*                        */
   int        i;					   /*                        */
   Record     rec;				   /*                        */
  						   /*                        */
@@ -1144,6 +2687,8 @@ int * db_count(db,lp)				   /*                        */
   }						   /*                        */
   if (count == NULL)				   /*                        */
   { OUT_OF_MEMORY("count"); }		   	   /*                        */
+  st->db_count	   = count;			   /*                        */
+  st->db_count_len = len;			   /*                        */
 						   /*                        */
   for (i = 0; i < len; i++) count[i] = 0;	   /*                        */
   count[len-1] = -1;				   /*                        */
@@ -1202,68 +2747,3 @@ int * db_count(db,lp)				   /*                        */
 						   /*                        */
   return count;					   /*                        */
 }						   /*------------------------*/
-
-/*-----------------------------------------------------------------------------
-** Function:	db_xref_undelete()
-** Type:	void
-** Purpose:	Scan through the database and undelete all entries
-**		which are in the transitive closure wrt the crossref
-**		relation. Initially all not deleted entries are in the
-**		set to consider.
-** Arguments:
-**	db	Database to treat
-** Returns:	nothing
-**___________________________________________________			     */
-void db_xref_undelete(db)			   /*                        */
-  DB db;					   /*                        */
-{ Record rec = DBnormal(db);			   /*                        */
-  if (rec == RecordNULL) return;		   /* No entries left anyhow.*/
- 						   /*                        */
-  while (PrevRecord(rec) != RecordNULL)	   	   /* Rewind                 */
-  { rec = PrevRecord(rec); }			   /*                        */
- 						   /*                        */
-  for (;				   	   /* Phase:                 */
-       rec != RecordNULL;			   /*  For all marked entries*/
-       rec = NextRecord(rec))		   	   /*  which have a xref and */
-  {						   /*  mark all xrefs.       */
-    if (RecordIsXREF(rec)   &&		   	   /*                        */
-	!RecordIsDELETED(rec))			   /*                        */
-    { Symbol key = sym_qqq;	   		   /*                        */
-      int    count;				   /*                        */
-      Record r = rec;				   /*                        */
- 						   /*                        */
-      for (count=rsc_xref_limit;		   /* Prevent infinite loop  */
-	   count >= 0 && RecordIsXREF(r);	   /*                        */
-	   count--)				   /*                        */
-      {					   	   /*                        */
-	if ((key = get_field(db,	   	   /*                        */
-			     r,		   	   /*                        */
-			     sym_crossref)) == NULL)/*                       */
-	{ count = -1;				   /*                        */
-	}			   	   	   /*                        */
-	else					   /*                        */
-	{					   /*                        */
-	  key = expand_rhs(key,	   		   /*                        */
-			   sym_empty, 		   /*                        */
-			   sym_empty, 		   /*                        */
-			   db,			   /*                        */
-			   true);     	   	   /*                        */
-	  if ((r=db_search(db,key)) == RecordNULL) /*                        */
-	  { ErrPrintF("*** BibTool: Crossref `%s' not found.\n",/*           */
-		      SymbolValue(key));	   /*                        */
-	    count = -1;			   	   /*                        */
-	  }					   /*                        */
-	  else if (!RecordIsDELETED(r))	   	   /*                        */
-	  { count = -1; }			   /*                        */
-	  else					   /*                        */
-	  { ClearRecordDELETED(r);		   /*                        */
-	  }					   /*                        */
-	}			   		   /*                        */
-      }			   		   	   /*                        */
-      if (count == -1)				   /*                        */
-      { ErrPrintF("*** BibTool: Crossref limit exceeded; `%s' possibly looped.\n",
-		  SymbolValue(key));		   /*                        */
-      }						   /*                        */
-    }    					   /*                        */
-  }						   /*                        */
-}						   /*------------------------*/
@@ -59,6 +59,7 @@
 #define _ARG(A) ()
 #endif
  static bool match _ARG((String s, String t));	   /* entry.c                */
+ static void entry_free _ARG((void *state));	   /* entry.c                */
 
 /*****************************************************************************/
 /* External Programs							     */
@@ -68,13 +69,54 @@
 /***									   ***/
 /*****************************************************************************/
 
- int type_xdata = -1;				   /*                        */
-
 #define EntrySizeIncrement 8
 
- Symbol	    *entry_type;
- static int entry_ptr	= 0;
- static int entry_size  = 0;
+/*-----------------------------------------------------------------------------
+** Variable*:	entry_state0
+** Type:	SEntries
+** Purpose:	The initial state of the entry module in a context. No
+**		entry types are defined.
+**___________________________________________________			     */
+ static SEntries entry_state0 =			   /*                        */
+ { (Symbol*)NULL,				   /*                        */
+   0,						   /*                        */
+   0,						   /*                        */
+   -1						   /*                        */
+ };						   /*                        */
+
+#define entry_ptr  (EntryState->entry_ptr)
+#define entry_size (EntryState->entry_size)
+
+/*-----------------------------------------------------------------------------
+** Function*:	entry_free()
+** Type:	void
+** Purpose:	Release the entry types of a context. This function is
+**		called when the context is released.
+** Arguments:
+**	state	the state
+** Returns:	nothing
+**___________________________________________________			     */
+static void entry_free(state)			   /*                        */
+  void *state;					   /*                        */
+{ POSSIBLY_UNUSED(state);			   /*                        */
+  if (entry_type) free(entry_type);		   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	entry_state()
+** Type:	SEntries*
+** Purpose:	Create the state of the entry module in the current
+**		context. This function is used by the macro
+**		|EntryState| when the state does not exist yet.
+** Arguments:	none
+** Returns:	the state
+**___________________________________________________			     */
+SEntries * entry_state()			   /*                        */
+{ return (SEntries*)ctx_state(CTX_ENTRY,	   /*                        */
+			      (void*)&entry_state0,/*                        */
+			      sizeof(entry_state0),/*                        */
+			      entry_free);	   /*                        */
+}						   /*------------------------*/
 
 /*-----------------------------------------------------------------------------
 ** Function:	init_entries()
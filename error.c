@@ -37,6 +37,7 @@
 
 #include <bibtool/general.h>
 #include <bibtool/error.h>
+#include <bibtool/rsc.h>
 
 /*****************************************************************************/
 /* Internal Programs							     */
@@ -46,8 +47,6 @@
 /* External Programs							     */
 /*===========================================================================*/
 
- extern bool rsc_quiet;
-
 /*---------------------------------------------------------------------------*/
 
  char  *err_format = "*** BibTool: %s";
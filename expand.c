@@ -48,6 +48,7 @@
 #endif
  Symbol expand_rhs _ARG((Symbol s,Symbol pre,Symbol post,DB db, bool lowercase));/* expand.c*/
  static bool expand _ARG((String s,StringBuffer *sb,int brace,int first,String q_open,String q_close,DB db));/* expand.c*/
+ static void expand_free _ARG((void *state));	   /*                        */
  static void expand__ _ARG((String s,StringBuffer *sb,String q_open,String q_close,DB db));/* expand.c*/
 
 /*****************************************************************************/
@@ -56,6 +57,43 @@
 
 /*---------------------------------------------------------------------------*/
 
+/*-----------------------------------------------------------------------------
+** Typedef*:	SExpandState
+** Purpose:	The state of the expand module in a context. It
+**		contains the buffer for the expanded strings.
+**___________________________________________________			     */
+ typedef struct					   /*                        */
+ { StringBuffer *expand_sb;			   /*                        */
+ } SExpandState;				   /*                        */
+
+/*-----------------------------------------------------------------------------
+** Variable*:	expand_state0
+** Type:	SExpandState
+** Purpose:	The initial state of the expand module in a context.
+**___________________________________________________			     */
+ static SExpandState expand_state0;		   /*                        */
+
+#define ExpandState ((SExpandState*)CtxGet(CTX_EXPAND,			\
+					   ctx_state(CTX_EXPAND,	\
+						     (void*)&expand_state0,\
+						     sizeof(expand_state0),\
+						     expand_free)))
+
+/*-----------------------------------------------------------------------------
+** Function*:	expand_free()
+** Type:	void
+** Purpose:	Release the buffer of the expand module when a context
+**		is released.
+** Arguments:
+**	state	the state
+** Returns:	nothing
+**___________________________________________________			     */
+static void expand_free(state)			   /*                        */
+  void *state;					   /*                        */
+{ SExpandState *st = (SExpandState*)state;	   /*                        */
+  if (st->expand_sb) (void)sbclose(st->expand_sb); /*                        */
+}						   /*------------------------*/
+
 /*-----------------------------------------------------------------------------
 ** Function:	expand_rhs()
 ** Purpose:	Expand the right hand side of an item. Each macro
@@ -82,11 +120,12 @@ Symbol expand_rhs(sym,pre,post,db,lowercase)	   /*                        */
   Symbol post;					   /*                        */
   DB   db;					   /*                        */
   bool lowercase;				   /*                        */
-{ static StringBuffer *sb = NULL;		   /*                        */
+{ SExpandState *st = ExpandState;		   /*                        */
+  StringBuffer *sb = st->expand_sb;		   /*                        */
   String s;					   /*                        */
 						   /*                        */
   DebugPrint1("expand_rhs");			   /*                        */
-  if ( sb == NULL && (sb = sbopen()) == NULL )	   /*                        */
+  if ( sb == NULL && (sb = st->expand_sb = sbopen()) == NULL )/*             */
   { OUT_OF_MEMORY("string expansion");}		   /*                        */
  						   /*                        */
   DebugPrint2("Expanding ",SymbolValue(sym));	   /*                        */
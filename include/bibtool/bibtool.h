@@ -39,6 +39,8 @@
 ******************************************************************************/
 
 #include <bibtool/general.h>
+#include <bibtool/bundle.h>
+#include <bibtool/context.h>
 #include <bibtool/symbols.h>
 
 #include <bibtool/entry.h>
@@ -56,6 +58,7 @@
 #include <bibtool/rsc.h>
 #include <bibtool/s_parse.h>
 #include <bibtool/stack.h>
+#include <bibtool/stats.h>
 #include <bibtool/tex_aux.h>
 #include <bibtool/tex_read.h>
 #include <bibtool/version.h>
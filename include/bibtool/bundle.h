@@ -0,0 +1,92 @@
+/*** bundle.h *****************************************************************
+**
+** This file is part of BibTool.
+** It is distributed under the GNU General Public License.
+** See the file COPYING for details.
+**
+** (c) 2020 Gerd Neugebauer
+**
+** Net: gene@gerd-neugebauer.de
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+**-----------------------------------------------------------------------------
+** Description:
+**	This header file provides the resource bundles. A bundle is a
+**	binary file which contains the instructions of a set of
+**	resource files already parsed, the regular expressions of
+**	their rules already compiled, and the compiled keep table. It
+**	is read with |read_rsc()| like a resource file.
+**
+**	This header file provides also access to the functions and
+**	variables defined in |bundle.c|. Consult the documentation
+**	of this file for details.
+**
+******************************************************************************/
+
+#ifndef BUNDLE_H_LOADED
+#define BUNDLE_H_LOADED
+
+#include <stdio.h>
+#include <bibtool/general.h>
+#include <bibtool/symbols.h>
+
+#ifdef __STDC__
+#define _ARG(A) A
+#else
+#define _ARG(A) ()
+#endif
+
+/*-----------------------------------------------------------------------------
+** Constant*:	BUNDLE_MAGIC
+** Type:	char*
+** Purpose:	The first bytes of a bundle. The first character can
+**		not start a resource file.
+**___________________________________________________			     */
+#define BUNDLE_MAGIC	 "\177BibTool bundle\n"
+#define BUNDLE_MAGIC_LEN 16
+
+/*-----------------------------------------------------------------------------
+** Constant*:	BUNDLE_HASH_INIT
+** Type:	unsigned long
+** Purpose:	The initial value of the hashes computed with
+**		|bundle_hash()|.
+**___________________________________________________			     */
+#define BUNDLE_HASH_INIT 2166136261UL
+
+/*-----------------------------------------------------------------------------
+** Typedef*:	SBundleCursor
+** Purpose:	The position while a bundle is decoded. The indicator
+**		|bc_ok| is cleared when the end is exceeded.
+**___________________________________________________			     */
+ typedef struct					   /*                        */
+ { unsigned char *bc_p;				   /* the next byte          */
+   unsigned char *bc_end;			   /* the end of the data    */
+   bool		 bc_ok;				   /* no error so far        */
+ } SBundleCursor, *BundleCursor;		   /*                        */
+
+ bool is_bundle _ARG((FILE *file));		   /* bundle.c               */
+ bool read_bundle _ARG((Symbol path));		   /* bundle.c               */
+ unsigned char * bundle_bytes _ARG((BundleCursor c,size_t *np));/* bundle.c  */
+ unsigned long bundle_get _ARG((BundleCursor c));  /* bundle.c               */
+ unsigned long bundle_hash _ARG((unsigned long h,unsigned char *s,size_t n));/**/
+ void bundle_begin _ARG((String name,Symbol path)); /* bundle.c              */
+ void bundle_end _ARG((void));			   /* bundle.c               */
+ void bundle_put _ARG((unsigned long v,FILE *file)); /* bundle.c             */
+ void bundle_put_bytes _ARG((unsigned char *s,size_t n,FILE *file));/* bundle.c*/
+ void bundle_record _ARG((Symbol name,Symbol value,Symbol path,int line));/* bundle.c */
+
+/*---------------------------------------------------------------------------*/
+#endif
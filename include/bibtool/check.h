@@ -37,5 +37,20 @@
 #endif
  void add_unique_field _ARG((Symbol key));
  void apply_checks _ARG((DB db));
+ bool have_unique_fields _ARG((void));
+ bool report_double _ARG((Record rec, int lineno, Symbol source, Symbol key));
 
- extern bool need_sort_key;
+/*-----------------------------------------------------------------------------
+** Typedef*:	SCheckState
+** Purpose:	The state of the check module in a context.
+**___________________________________________________			     */
+ typedef struct					   /*                        */
+ { WordList unique_fields;			   /* the unique fields      */
+   bool	    need_sort_key;			   /* a sort key is checked  */
+ } SCheckState;					   /*                        */
+
+ SCheckState * check_state _ARG((void));	   /* check.c                */
+
+#define CheckState ((SCheckState*)CtxGet(CTX_CHECK, check_state()))
+
+#define need_sort_key (CheckState->need_sort_key)
@@ -0,0 +1,183 @@
+/*** context.h ****************************************************************
+**
+** This file is part of BibTool.
+** It is distributed under the GNU General Public License.
+** See the file COPYING for details.
+**
+** (c) 2020 Gerd Neugebauer
+**
+** Net: gene@gerd-neugebauer.de
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+**-----------------------------------------------------------------------------
+** Description:
+**	This module provides the contexts of the library. A context
+**	carries the state of all modules: the resources, the symbol
+**	table, the rules, the key generation, the parser, and the
+**	buffers used internally.
+**
+**	Each thread has a current context. Initially this is the
+**	default context. Thus a program which does not use contexts
+**	explicitly works as before. Different threads can work with
+**	different contexts at the same time. A context must not be
+**	used by several threads at the same time.
+**
+**	Each module keeps its state in a structure. The initial values
+**	are taken from a template in the module when the state is
+**	accessed for the first time in a context. The variables of
+**	the module are macros referring to the fields of the state in
+**	the current context.
+**
+******************************************************************************/
+
+#ifndef ContextNULL
+
+#include <stddef.h>
+
+#ifdef __STDC__
+#define _ARG(A) A
+#else
+#define _ARG(A) ()
+#endif
+
+/*-----------------------------------------------------------------------------
+** Constant*:	CTX_MODULES
+** Type:	int
+** Purpose:	The indices of the module states in a context. The
+**		states are released in the reverse order. Thus modules
+**		used by other modules come first.
+**___________________________________________________			     */
+#define CTX_SYMBOLS	0
+#define CTX_RECORD	1
+#define CTX_STACK	2
+#define CTX_RESOURCES	3
+#define CTX_RSC		4
+#define CTX_TYPE	5
+#define CTX_CHECK	6
+#define CTX_CROSSREF	7
+#define CTX_DATABASE	8
+#define CTX_ENTRY	9
+#define CTX_EXPAND	10
+#define CTX_IO		11
+#define CTX_KEY		12
+#define CTX_MACROS	13
+#define CTX_NAMES	14
+#define CTX_PARSE	15
+#define CTX_PRINT	16
+#define CTX_PXFILE	17
+#define CTX_REWRITE	18
+#define CTX_S_PARSE	19
+#define CTX_TEX_AUX	20
+#define CTX_TEX_READ	21
+#define CTX_STATS	22
+#define CTX_BUNDLE	23
+#define CTX_MODULES	24
+
+/*-----------------------------------------------------------------------------
+** Typedef:	Context
+** Purpose:	This data type represents the state of the
+**		library. Each module has a slot for its state. It is
+**		|NULL| until the module is used in the context.
+**___________________________________________________			     */
+ typedef struct cONTEXT				   /*                        */
+ { void *cx_state[CTX_MODULES];			   /* the module states      */
+   void (*cx_free[CTX_MODULES])_ARG((void*));	   /* their destructors      */
+ } SContext, *Context;				   /*                        */
+
+/*-----------------------------------------------------------------------------
+** Constant:	ContextNULL
+** Type:	Context
+** Purpose:	This is the |NULL| value for a |Context|. As argument
+**		of |ctx_use()| it denotes the default context.
+**___________________________________________________			     */
+#define ContextNULL ((Context)0)
+
+/*-----------------------------------------------------------------------------
+** Macro*:	THREAD_LOCAL
+** Purpose:	The storage class of a variable with a separate value
+**		in each thread.
+**___________________________________________________			     */
+#ifndef THREAD_LOCAL
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L && !defined(__STDC_NO_THREADS__)
+#define THREAD_LOCAL _Thread_local
+#else
+#if defined(__GNUC__)
+#define THREAD_LOCAL __thread
+#else
+#define THREAD_LOCAL
+#endif
+#endif
+#endif
+
+ extern THREAD_LOCAL Context ctx_this;
+
+/*-----------------------------------------------------------------------------
+** Macro*:	CtxLoad()
+** Type:	void*
+** Purpose:	Read the state of a module in a context. The state is
+**		published by |ctx_state()| under a lock. Thus the
+**		read outside of the lock has to be an acquiring load
+**		which pairs with the releasing store there.
+** Arguments:
+**	CTX	the context
+**	ID	the index of the module
+** Returns:	the state of the module or |NULL|
+**___________________________________________________			     */
+#if defined(__GNUC__)
+#define CtxLoad(CTX,ID) __atomic_load_n(&(CTX)->cx_state[ID], __ATOMIC_ACQUIRE)
+#define CtxStore(CTX,ID,S)						\
+  __atomic_store_n(&(CTX)->cx_state[ID], (S), __ATOMIC_RELEASE)
+#else
+#define CtxLoad(CTX,ID)    ((CTX)->cx_state[ID])
+#define CtxStore(CTX,ID,S) ((CTX)->cx_state[ID] = (S))
+#endif
+
+/*-----------------------------------------------------------------------------
+** Macro*:	CtxGet()
+** Type:	void*
+** Purpose:	Get the state of a module in the current context. The
+**		state is created by evaluating the second argument if
+**		it does not exist yet.
+** Arguments:
+**	ID	the index of the module
+**	NEW	the expression creating the state
+** Returns:	the state of the module
+**___________________________________________________			     */
+#define CtxGet(ID,NEW)							\
+  ((ctx_this && CtxLoad(ctx_this, ID)) ? CtxLoad(ctx_this, ID) : (NEW))
+
+/*-----------------------------------------------------------------------------
+** Macro*:	CtxState()
+** Type:	void*
+** Purpose:	Get the state of a module in the current context. The
+**		state is initialized with a copy of a template if it
+**		does not exist yet.
+** Arguments:
+**	ID	the index of the module
+**	INIT	the template of the state
+** Returns:	the state of the module
+**___________________________________________________			     */
+#define CtxState(ID,INIT)						\
+  CtxGet(ID, ctx_state(ID, (void*)&(INIT), sizeof(INIT), NULL))
+
+ Context ctx_new _ARG((void));			   /* context.c              */
+ Context ctx_use _ARG((Context ctx));		   /* context.c              */
+ Context ctx_current _ARG((void));		   /* context.c              */
+ void ctx_free _ARG((Context ctx));		   /* context.c              */
+ void * ctx_state _ARG((int id,void *init,size_t size,void (*destroy)_ARG((void*))));/* context.c*/
+
+/*---------------------------------------------------------------------------*/
+#endif
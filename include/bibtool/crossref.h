@@ -39,6 +39,8 @@
 #define _ARG(A) ()
 #endif
  bool expand_crossref _ARG((DB db,Record rec));	   /*                        */
+ void expand_crossrefs _ARG((DB db));		   /*                        */
+ void db_xref_undelete _ARG((DB db));		   /*                        */
  void clear_map();				   /*                        */
  void crossref_map _ARG((String spec));		   /*                        */
 
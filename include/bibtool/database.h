@@ -166,15 +166,19 @@
  Symbol db_string _ARG((DB db, Symbol sym, bool localp));/*                  */
  bool read_db _ARG((DB db,String file, bool verbose));/*                     */
  int *db_count _ARG((DB db, int *lp));		   /*                        */
+ void db_clear _ARG((DB db));			   /*                        */
+ void db_copy _ARG((DB db, DB from));		   /*                        */
  void db_insert _ARG((DB db,Record rec, bool verbose));/*                    */
  void db_forall _ARG((DB db,bool (*fct)_ARG((DB, Record))));/*               */
  void db_mac_sort _ARG((DB db));		   /*                        */
  void db_rewind _ARG((DB db));			   /*                        */
  void db_sort _ARG((DB db,int (*less)_ARG((Record, Record))));/*             */
  void db_xref_undelete _ARG((DB db));		   /*                        */
+ void db_spill _ARG((DB db,int (*less)_ARG((Record, Record))));/*            */
  void delete_record _ARG((DB db, Record rec));	   /*                        */
  void free_db _ARG((DB db));			   /*                        */
  void print_db _ARG((FILE *file, DB db, char *spec));/*                      */
+ void set_record_hook _ARG((void (*fct)_ARG((DB db))));/*                    */
 
 /*---------------------------------------------------------------------------*/
 
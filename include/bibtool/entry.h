@@ -36,6 +36,27 @@
 #include <bibtool/type.h>
 #include <bibtool/record.h>
 
+#include <bibtool/context.h>
+
+/*-----------------------------------------------------------------------------
+** Typedef*:	SEntries
+** Purpose:	The state of the entry module in a context. It
+**		contains the entry types defined.
+**___________________________________________________			     */
+ typedef struct					   /*                        */
+ { Symbol *entry_type;				   /* the entry types        */
+   int	  entry_ptr;				   /* the number of types    */
+   int	  entry_size;				   /* the size of the array  */
+   int	  type_xdata;				   /* the index of xdata     */
+ } SEntries;					   /*                        */
+
+/*-----------------------------------------------------------------------------
+** Macro*:	EntryState
+** Type:	SEntries*
+** Purpose:	The state of the entry module in the current context.
+**___________________________________________________			     */
+#define EntryState ((SEntries*)CtxGet(CTX_ENTRY, entry_state()))
+
 /*-----------------------------------------------------------------------------
 ** Variable:	entry_type
 ** Type:	Symbol *
@@ -45,7 +66,7 @@
 **		entry type and the function |get_entry_type()| to find
 **		a certain entry type.
 **___________________________________________________			     */
- extern Symbol *entry_type;
+#define entry_type (EntryState->entry_type)
 
 /*-----------------------------------------------------------------------------
 ** Macro:	EntryName()
@@ -79,6 +100,16 @@
 **___________________________________________________			     */
 #define BIB_NOOP	-1
 
+/*-----------------------------------------------------------------------------
+** Constant:	BIB_SKIP
+** Type:	int
+** Purpose:	This symbolic constant is returned when a record has
+**		been passed over since its key has been rejected by
+**		the key filter. It is some negative value for which no
+**		entry type is defined.
+**___________________________________________________			     */
+#define BIB_SKIP	-3
+
 /*-----------------------------------------------------------------------------
 ** Constant:	BIB_STRING
 ** Type:	int
@@ -159,13 +190,14 @@
 **___________________________________________________			     */
 #define IsNormalRecord(Type)  ( Type > 5 )
 
-extern int type_xdata;
+#define type_xdata (EntryState->type_xdata)
 
 #ifdef __STDC__
 #define _ARG(A) A
 #else
 #define _ARG(A) ()
 #endif
+ SEntries * entry_state _ARG((void));		   /* entry.c                */
  Symbol get_entry_type _ARG((int i));		   /* entry.c                */
  rec_type find_entry_type _ARG((String s));	   /* entry.c                */
  void def_entry_type _ARG((Symbol s));		   /* entry.c                */
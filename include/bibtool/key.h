@@ -48,6 +48,7 @@
  bool foreach_ignored_word _ARG((bool (*fct)_ARG((Symbol))));/* key.c        */
  bool mark_key _ARG((DB db,Record rec));	   /* key.c                  */
  bool set_field _ARG((DB db,Record rec,Symbol name,Symbol value));/* key.c   */
+ bool sort_key_inherits _ARG((void));		   /* key.c                  */
  int apply_fmt _ARG((StringBuffer *sb,char *fmt,Record rec,DB db));/* key.c  */
  void add_format _ARG((char *s));		   /* key.c                  */
  void add_ignored_word _ARG((Symbol s));	   /* key.c                  */
@@ -38,8 +38,19 @@
 #define _ARG(A) ()
 #endif
  bool read_rsc _ARG((String name));		   /* parse.c                */
+ Symbol rsc_source _ARG((int *linep));		   /* parse.c                */
+ void set_rsc_source _ARG((Symbol fname,int line));/* parse.c                */
  bool see_bib _ARG((String fname));		   /* parse.c                */
  bool seen _ARG((void));			   /* parse.c                */
+ String seen_bib_file _ARG((void));		   /* parse.c                */
+ void seen_bib_span _ARG((long *fromp, long *top));/* parse.c                */
+ bool seek_bib _ARG((long offset, int lineno));	   /* parse.c                */
+ String bib_source _ARG((Symbol name, long offset, long length));/* parse.c   */
  int parse_bib _ARG((Record rec));		   /* parse.c                */
  void init_read _ARG((void));			   /* parse.c                */
  void set_rsc_path _ARG((String val));		   /* parse.c                */
+ void set_key_filter _ARG((bool (*fct)(Symbol)));  /* parse.c                */
+ void demand_field _ARG((Symbol field));	   /* parse.c                */
+ void release_lazy_values _ARG((void));		   /* parse.c                */
+ void adopt_lazy_values _ARG((Record rec));	   /* parse.c                */
+ void suspend_lazy _ARG((bool on));		   /* parse.c                */
@@ -42,6 +42,7 @@
 #endif
  char *sput_record _ARG((Record rec,DB db,String start));/* print.c          */
  void fput_record _ARG((FILE *file,Record rec,DB db,String start));/* print.c*/
+ void fput_records _ARG((FILE *file,Record *recs,int n,DB db,String start,String del_start));/* print.c*/
  void put_record _ARG((int (*fct)_ARG((int)),Record rec,DB db, String start));/* print.c*/
  void rsc_align _ARG((String s));	   	   /* print.c                */
  void set_key_type _ARG((String s));		   /* print.c                */
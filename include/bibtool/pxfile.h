@@ -33,8 +33,44 @@
 ******************************************************************************/
 
 #include <stdio.h>
+#include <bibtool/context.h>
 
-extern char * px_filename;
+/*-----------------------------------------------------------------------------
+** Typedef*:	SPxState
+** Purpose:	The state of the pxfile module in a context. It
+**		contains the file name found last and the directory of
+**		an absolute file name.
+**___________________________________________________			     */
+ typedef struct					   /*                        */
+ { char	  *px_filename;				   /* the file name found    */
+   size_t px_len;				   /* its usable length      */
+   char	  *px_abs_path[2];			   /* the absolute path      */
+ } SPxState;					   /*                        */
+
+/*-----------------------------------------------------------------------------
+** Macro*:	PxState
+** Type:	SPxState*
+** Purpose:	The state of the pxfile module in the current context.
+**___________________________________________________			     */
+#define PxState ((SPxState*)CtxGet(CTX_PXFILE, px_state()))
+
+/*-----------------------------------------------------------------------------
+** Variable:	px_filename
+** Type:	char*
+** Purpose:	This variable contains the file name actually used by
+**		the last |px_fopen()| call. The memory is automatically
+**		managed and will be reused by the next call to
+**		|px_fopen()|.  Thus if you need to use it make a
+**		private copy immediately after the call to the
+**		function |px_fopen()|.
+**___________________________________________________			     */
+#define px_filename (PxState->px_filename)
+
+extern SPxState * px_state(
+#ifdef __STDC__
+	void
+#endif
+	);
 
 extern FILE * px_fopen(
 #ifdef __STDC__
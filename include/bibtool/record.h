@@ -49,7 +49,12 @@ typedef int rec_type;
 **		
 **		If a field is deleted then the name is replaced by a
 **		|NULL|. The structure member |rc_free| contains the
-**		size of the heap.
+**		used size of the heap. The heap grows geometrically;
+**		|rc_size| contains the allocated size.
+**
+**		Records with many fields get an index which maps a
+**		field name to its position on the heap. The index is
+**		built on demand and dropped when fields are moved.
 **
 **		The type of the record is determined by the integer
 **		|rc_type|. 
@@ -66,12 +71,22 @@ typedef struct rECORD				/*                           */
  						/*  is purely internal and   */
  						/*  must not be modified.    */
   Symbol	*rc_heap;			/* The heap.                 */
+  int		rc_size;			/* The allocated size of the */
+ 						/*  heap.                    */
+  int		*rc_index;			/* The field index or NULL.  */
+  int		rc_index_size;			/* The size of the index.    */
+  int		rc_index_used;			/* The entries in the index. */
   Symbol	rc_comment;			/* The comment following     */
  						/*  the given record.        */
   Symbol	rc_source;			/* The source of the record. */
  						/*  I.e. the file name it    */
  						/*  has been read from.      */
   int           rc_lineno;			/* Line number or -1.        */
+  long		rc_offset;			/* Byte offset of the source */
+ 						/*  text or -1.              */
+  long		rc_length;			/* Length of the source text.*/
+  String	*rc_lazy;			/* The private values owned  */
+ 						/*  by the record or NULL.   */
   struct rECORD *rc_next;			/* Pointer to the next       */
  						/*  record.                  */
   struct rECORD *rc_prev;			/* Pointer to the previous   */
@@ -157,6 +172,60 @@ typedef struct rECORD				/*                           */
 **___________________________________________________			     */
 #define RecordFlagDELETED	0x04
 
+/*-----------------------------------------------------------------------------
+** Constant:	RecordFlagSORTED
+** Type:	int
+** Purpose:	Bit mask for the |SORTED| flag of a record. This flag
+**		is set by |sort_record()| and cleared when a field is
+**		added or renamed. It is used to avoid sorting a record
+**		twice.
+**
+**		This macro is usually not used directly but implicitly
+**		with other macros from this header file. 
+**___________________________________________________			     */
+#define RecordFlagSORTED	0x08
+
+/*-----------------------------------------------------------------------------
+** Constant:	RecordFlagINDEXED
+** Type:	int
+** Purpose:	Bit mask for the |INDEXED| flag of a record. This flag
+**		indicates that the field index of the record is up to
+**		date. It has to be cleared when fields are moved on the
+**		heap or renamed. Deleting a field does not invalidate
+**		the index.
+**
+**		This macro is usually not used directly but implicitly
+**		with other macros from this header file. 
+**___________________________________________________			     */
+#define RecordFlagINDEXED	0x10
+
+/*-----------------------------------------------------------------------------
+** Constant:	RecordFlagPACKED
+** Type:	int
+** Purpose:	Bit mask for the |PACKED| flag of a record. This flag
+**		indicates that the heap contains no deleted
+**		fields. Thus a new field can be appended without
+**		searching for a free slot. It is set by the parser
+**		only and not inherited by copies.
+**
+**		This macro is usually not used directly but implicitly
+**		with other macros from this header file. 
+**___________________________________________________			     */
+#define RecordFlagPACKED	0x20
+
+/*-----------------------------------------------------------------------------
+** Constant:	RecordFlagDIRTY
+** Type:	int
+** Purpose:	Bit mask for the |DIRTY| flag of a record. This flag
+**		indicates that the record has been modified since it
+**		has been read. Thus its source text does not
+**		represent it any more. The parser clears the flag.
+**
+**		This macro is usually not used directly but implicitly
+**		with other macros from this header file. 
+**___________________________________________________			     */
+#define RecordFlagDIRTY		0x40
+
 /*-----------------------------------------------------------------------------
 ** Macro:	SetRecordXREF()
 ** Type:	int
@@ -192,6 +261,29 @@ typedef struct rECORD				/*                           */
 **___________________________________________________			     */
 #define RecordIsXREF(R)		(RecordFlags(R) & RecordFlagXREF)
 
+/*-----------------------------------------------------------------------------
+** Macro:	SetRecordDIRTY()
+** Type:	int
+** Purpose:	Mark the record as modified. It is called by all
+**		functions which change the fields or the key of a
+**		record.
+** Arguments:
+**	R	The record to consider.
+** Returns:	The new value of the record flags.
+**___________________________________________________			     */
+#define SetRecordDIRTY(R)	(RecordFlags(R) |= RecordFlagDIRTY)
+
+/*-----------------------------------------------------------------------------
+** Macro:	RecordIsDIRTY()
+** Type:	int
+** Purpose:	Check whether the record has been modified since it
+**		has been read.
+** Arguments:
+**	R	Record to consider.
+** Returns:	|FALSE| iff the |DIRTY| flag is not set.
+**___________________________________________________			     */
+#define RecordIsDIRTY(R)	(RecordFlags(R) & RecordFlagDIRTY)
+
 /*-----------------------------------------------------------------------------
 ** Macro:	SetRecordDELETED()
 ** Type:	int
@@ -308,6 +400,28 @@ typedef struct rECORD				/*                           */
 **___________________________________________________			     */
 #define RecordFree(R)		((R)->rc_free)
 
+/*-----------------------------------------------------------------------------
+** Macro*:	RecordSize()
+** Type:	int
+** Purpose:	This is the functional representation of the allocated
+**		size of the heap. It is at least |RecordFree()|.
+** Arguments:
+**	R	Record to consider
+**___________________________________________________			     */
+#define RecordSize(R)		((R)->rc_size)
+
+/*-----------------------------------------------------------------------------
+** Macro*:	RecordIndex()
+** Type:	int *
+** Purpose:	This is the functional representation of the field
+**		index of a record. It is an open addressed hash table
+**		of heap positions. Unused entries are |-1|. The index
+**		is only valid if the flag |RecordFlagINDEXED| is set.
+** Arguments:
+**	R	Record to consider
+**___________________________________________________			     */
+#define RecordIndex(R)		((R)->rc_index)
+
 /*-----------------------------------------------------------------------------
 ** Macro:	RecordHeap()
 ** Type:	String *
@@ -379,6 +493,43 @@ typedef struct rECORD				/*                           */
 **___________________________________________________			     */
 #define RecordLineno(R)	((R)->rc_lineno)
 
+/*-----------------------------------------------------------------------------
+** Macro:	RecordOffset()
+** Type:	long
+** Purpose:	This is the byte offset of the source text of the
+**		record in the file it has been read from. The source
+**		text starts with the |@| and ends with the closing
+**		delimiter. The value -1 is used if the source text is
+**		not available.
+** Arguments:
+**	R	Record to consider
+** Returns:	
+**___________________________________________________			     */
+#define RecordOffset(R)	((R)->rc_offset)
+
+/*-----------------------------------------------------------------------------
+** Macro:	RecordLength()
+** Type:	long
+** Purpose:	This is the number of bytes of the source text of the
+**		record.
+** Arguments:
+**	R	Record to consider
+** Returns:	
+**___________________________________________________			     */
+#define RecordLength(R)	((R)->rc_length)
+
+/*-----------------------------------------------------------------------------
+** Macro:	RecordLazy()
+** Type:	String *
+** Purpose:	The private copies of field values made by the parser
+**		with \rsc{parse.lazy}. They are not in the symbol table
+**		and are owned by the record. The array is terminated
+**		by |NULL|. The value |NULL| is used if there are none.
+** Arguments:
+**	R	Record to consider
+**___________________________________________________			     */
+#define RecordLazy(R)	((R)->rc_lazy)
+
 /*-----------------------------------------------------------------------------
 ** Macro:	RecordFlags()
 ** Type:	int
@@ -403,6 +554,7 @@ typedef struct rECORD				/*                           */
  Record record_gc _ARG((Record rec));		   /* record.c               */
  Record unlink_record _ARG((Record rec));	   /* record.c               */
  Symbol record_get _ARG((Record rec, Symbol key)); /* record.c               */
+ int record_slot _ARG((Record rec, Symbol key));   /* record.c               */
  WordList new_wordlist _ARG((Symbol s));	   /* record.c               */
  int count_record _ARG((Record rec));		   /* record.c               */
  void add_sort_order _ARG((Symbol val));	   /* record.c               */
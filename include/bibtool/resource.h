@@ -65,6 +65,7 @@ RSC_NEXT('b')
   RscString(  "bibtex.search.path"    , r_bsp ,rsc_v_bibtex 
 	    					     ,RSC_BIBINPUTS_DEFAULT ) 
 RSC_NEXT('c')
+  RscString(  "cache.dir"	      , r_cad ,rsc_cache_dir	  , ""      )
   RscBoolean( "check.double"	      , r_cd  ,rsc_double_check	  , false   )
   RscBoolean( "check.double.delete"   , r_cdd ,rsc_del_dbl	  , false   )
   RscByFct(   "check.rule"	      , r_cr  ,add_check_rule(SymbolValue(val),RULE_NONE))
@@ -86,6 +87,7 @@ RSC_NEXT('e')
   RscString(  "env.separator"	      , r_es  ,rsc_env_sep	  , ENV_SEP ) 
   RscByFct(   "extract.file"	      , r_ef  ,read_aux(val,save_input_file,false))
   RscByFct(   "extract.regex"	      , r_er  ,save_regex(SymbolValue(val)) )
+  RscBoolean( "extract.fast"	      , r_efa ,rsc_extract_fast   , false   )
   RscBoolean( "expand.macros"	      , r_em  ,rsc_expand_macros  , false   )
   RscBoolean( "expand.crossref"	      , r_ex  ,rsc_expand_crossref, false   )
   RscBoolean( "expand.xdata"	      , r_ed  ,rsc_expand_xdata,    false   )
@@ -103,6 +105,7 @@ RSC_NEXT('i')
   RscByFct(   "input"		      , r_i   ,save_input_file(val)         )
   RscByFct(   "ignored.word"	      , r_iw  ,add_ignored_word(val)	    )
   RscTerm(    "ilike"		      , RSC_INIT_ILIKE			    )
+  RscBoolean( "index.write"	      , r_ixw ,rsc_index_write	  , false   )
 RSC_NEXT('k')
   RscByFct(   "keep.field"            , r_kef ,keep_field(val)              )
   RscBoolean( "key.generation"	      , r_kg  ,rsc_make_key	  , false   ) 
@@ -128,6 +131,7 @@ RSC_NEXT('o')
 RSC_NEXT('p')
   RscBoolean( "pass.comments"	      , r_pc  ,rsc_pass_comment	  , false   )
   RscBoolean( "parse.exit.on.error"   , r_peoe,rsc_parse_exit	  , false   )
+  RscBoolean( "parse.lazy"	      , r_plz ,rsc_parse_lazy	  , false   )
   RscBoolean( "preserve.key.case"     , r_pkc ,rsc_key_case	  , false   )
   RscBoolean( "preserve.keys"         , r_pk  ,rsc_key_preserve	  , false   )
   RscByFct(   "print"		      , r_p   ,rsc_print(SymbolValue(val))  )
@@ -147,8 +151,12 @@ RSC_NEXT('p')
   RscNumeric( "print.line.length"     , r_pll ,rsc_linelen	  ,    77   )
   RscNumeric( "print.newline"         , r_pnl ,rsc_newlines	  ,     1   )
   RscBoolean( "print.parentheses"     , r_pp  ,rsc_parentheses	  , false   )
+  RscNumeric( "print.statistics.rules",r_psr ,rsc_print_rules    ,     0   )
+  RscString(  "print.statistics.timing",r_pst ,rsc_print_timing   , ""      )
   RscBoolean( "print.terminal.comma"  , r_ptc ,rsc_print_tc	  , false   )
+  RscNumeric( "print.threads"	      , r_pth ,rsc_print_threads  ,     1   )
   RscBoolean( "print.use.tab"	      , r_put ,rsc_use_tabs	  ,  true   )
+  RscBoolean( "print.verbatim"	      , r_pvb ,rsc_print_verbatim , false   )
   RscBoolean( "print.wide.equal"      , r_pwe ,rsc_print_we	  ,  true   )
 RSC_NEXT('q')
   RscBoolean( "quiet"		      , r_q   ,rsc_quiet	  , false   )
@@ -156,6 +164,7 @@ RSC_NEXT('r')
   RscByFct(   "regexp.syntax"	      , r_rs  ,set_regex_syntax((char*)SymbolValue(val)) )
   RscByFct(   "rename.field"	      , r_rf  ,rename_field(val)            )
   RscByFct(   "resource"	      , r_r   ,resource(SymbolValue(val))   )
+  RscString(  "resource.bundle"	      , r_rb  ,rsc_bundle	  , ""      )
   RscByFct(   "resource.search.path"  , r_rsp ,set_rsc_path(SymbolValue(val)))
   RscByFct(   "rewrite.rule"	      , r_rr  ,add_rewrite_rule(SymbolValue(val)))
   RscBoolean( "rewrite.case.sensitive", r_rcs ,rsc_case_rewrite	  ,  true   )
@@ -168,13 +177,18 @@ RSC_NEXT('s')
   RscBoolean( "select.case.sensitive" , r_scs ,rsc_case_select	  , false   )
   RscString(  "select.fields"	      , r_self,rsc_sel_fields     , "$key"  )
   RscByFct(   "select.non"	      , r_seln,add_extract(val,true,true)   )
+  RscNumeric( "select.threads"	      , r_selt,rsc_sel_threads    ,     1   )
   RscBoolean( "select.crossrefs"      , r_sxc ,rsc_xref_select	  , false   )
+  RscString(  "server"		      , r_srv ,rsc_server	  , ""      )
   RscBoolean( "sort"		      , r_s   ,rsc_sort		  , false   )
   RscBoolean( "sort.cased"	      , r_sc  ,rsc_sort_cased     , false   )
   RscBoolean( "sort.macros"	      , r_sm  ,rsc_srt_macs	  , true    )
+  RscNumeric( "sort.memory.limit"     , r_sml ,rsc_sort_memory	  ,     0   )
+  RscBoolean( "sort.merge"	      , r_smg ,rsc_sort_merge	  , false   )
   RscBoolean( "sort.reverse"	      , r_sr  ,rsc_sort_reverse   , false   )
   RscByFct(   "sort.order"	      , r_so  ,add_sort_order(val)          )
   RscByFct(   "sort.format"	      , r_sf  ,add_sort_format((char*)SymbolValue(val)))
+  RscBoolean( "stream"		      , r_str ,rsc_stream	  , false   )
   RscBoolean( "suppress.initial.newline", r_sin ,rsc_no_nl	  , false   )
   RscByFct(   "symbol.type"	      , r_st  ,set_symbol_type(SymbolValue(val)))
 RSC_NEXT('t')
@@ -185,6 +199,8 @@ RSC_NEXT('u')
 RSC_NEXT('v')
   RscBoolean( "verbose"		      , r_v   ,rsc_verbose	  , false   ) 
   RscByFct(   "version"		      , r_ver ,show_version()		    ) 
+RSC_NEXT('w')
+  RscBoolean( "watch"		      , r_wat ,rsc_watch	  , false   )
 
 #undef RSC_FIRST
 #undef RSC_NEXT
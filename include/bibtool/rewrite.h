@@ -25,13 +25,18 @@
 ******************************************************************************/
 
 #include <bibtool/database.h>
+#include <bibtool/bundle.h>
 
 #ifdef __STDC__
 #define _ARG(A) A
 #else
 #define _ARG(A) ()
 #endif
+ bool have_extract _ARG((void));		   /*                        */
+ bool read_keep_table _ARG((BundleCursor c));	   /* rewrite.c              */
+ bool read_patterns _ARG((BundleCursor c));	   /* rewrite.c              */
  bool is_selected _ARG((DB db, Record rec));	   /*                        */
+ bool select_parallel _ARG((DB db));		   /*                        */
  bool foreach_addlist _ARG((bool (*fct)(Symbol,Symbol)));/* rewrite.c        */
  int set_regex_syntax _ARG((char* name));	   /*                        */
  void add_check_rule _ARG((String s,int flags));   /*                        */
@@ -39,11 +44,15 @@
  void add_field _ARG((String spec));		   /*                        */
  void add_rewrite_rule _ARG((String s));	   /*                        */
  void clear_addlist _ARG((void));		   /*                        */
+ void clear_extract _ARG((void));		   /*                        */
  void keep_field _ARG((Symbol spec));		   /*                        */
+ void print_rule_profile _ARG((FILE *file,int n)); /*                        */
  void remove_field _ARG((Symbol field, Record rec));/*                       */
  void rename_field _ARG((Symbol spec));		   /*                        */
  void rewrite_record _ARG((DB db, Record rec));	   /*                        */
  void save_regex _ARG((String s));		   /*                        */
+ void write_keep_table _ARG((FILE *file));	   /* rewrite.c              */
+ void write_patterns _ARG((FILE *file));	   /* rewrite.c              */
  char* get_regex_syntax();			   /*                        */
 
 /*---------------------------------------------------------------------------*/
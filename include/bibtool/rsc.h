@@ -32,28 +32,112 @@
 **	accessible to those modules including this header file.
 ******************************************************************************/
 
+#ifndef RSC_H_LOADED
+#define RSC_H_LOADED
+
 #include <bibtool/symbols.h>
+#include <bibtool/context.h>
 
-#ifdef RSC_INIT
-#define RscNumeric(SYM,S,V,I) int    V = I;
-#define RscString(SYM,S,V,I)  String V = (String)I;
-#define RscBoolean(SYM,S,V,I) bool   V = I;
-#define RscByFct(SYM,S,FCT)   
-#define DECLARE(TYPE,VAR,VAL) TYPE VAR = VAL
-#else
-#define RscNumeric(SYM,S,V,I) extern int    V;
-#define RscString(SYM,S,V,I)  extern String V;
-#define RscBoolean(SYM,S,V,I) extern bool   V;
+/*-----------------------------------------------------------------------------
+** Typedef*:	SResources
+** Purpose:	The values of the resources in a context. The fields
+**		are generated from the definitions in |resource.h|.
+**		The initial values are the defaults given there.
+**___________________________________________________			     */
+ typedef struct					   /*                        */
+ {						   /*                        */
+#define RscNumeric(SYM,S,V,I) int    V;
+#define RscString(SYM,S,V,I)  String V;
+#define RscBoolean(SYM,S,V,I) bool   V;
 #define RscByFct(SYM,S,FCT)   
-#define DECLARE(TYPE,VAR,VAL) extern TYPE VAR
-#endif
-
 #include <bibtool/resource.h>
+   int	  rsc_select;				   /*                        */
+   char	  *rsc_e_rsc;				   /*                        */
+   String rsc_v_rsc;				   /*                        */
+ } SResources;					   /*                        */
 
-DECLARE( int   , rsc_select        , FALSE  			);
+/*-----------------------------------------------------------------------------
+** Macro*:	Resources
+** Type:	SResources*
+** Purpose:	The values of the resources in the current context.
+**		The resource variables are macros referring to its
+**		fields. Thus they can be used as before.
+**___________________________________________________			     */
+#define Resources ((SResources*)CtxGet(CTX_RESOURCES, rsc_state()))
 
-DECLARE( char* , rsc_e_rsc         , RSC_BIBTOOL		);
-DECLARE( String, rsc_v_rsc , (String)(RSC_BIBTOOL_DEFAULT)	);
+#define rsc_apply_alias       (Resources->rsc_apply_alias)
+#define rsc_apply_modify      (Resources->rsc_apply_modify)
+#define rsc_apply_include     (Resources->rsc_apply_include)
+#define rsc_e_bibtex          (Resources->rsc_e_bibtex)
+#define rsc_v_bibtex          (Resources->rsc_v_bibtex)
+#define rsc_cache_dir         (Resources->rsc_cache_dir)
+#define rsc_double_check      (Resources->rsc_double_check)
+#define rsc_del_dbl           (Resources->rsc_del_dbl)
+#define rsc_case_check        (Resources->rsc_case_check)
+#define rsc_cnt_all           (Resources->rsc_cnt_all)
+#define rsc_cnt_used          (Resources->rsc_cnt_used)
+#define rsc_xref_limit        (Resources->rsc_xref_limit)
+#define rsc_dir_file_sep      (Resources->rsc_dir_file_sep)
+#define rsc_dump_symbols      (Resources->rsc_dump_symbols)
+#define rsc_env_sep           (Resources->rsc_env_sep)
+#define rsc_extract_fast      (Resources->rsc_extract_fast)
+#define rsc_expand_macros     (Resources->rsc_expand_macros)
+#define rsc_expand_crossref   (Resources->rsc_expand_crossref)
+#define rsc_expand_xdata      (Resources->rsc_expand_xdata)
+#define rsc_index_write       (Resources->rsc_index_write)
+#define rsc_make_key          (Resources->rsc_make_key)
+#define rsc_make_alias        (Resources->rsc_make_alias)
+#define rsc_key_expand_macros (Resources->rsc_key_expand_macros)
+#define rsc_pass_comment      (Resources->rsc_pass_comment)
+#define rsc_parse_exit        (Resources->rsc_parse_exit)
+#define rsc_parse_lazy        (Resources->rsc_parse_lazy)
+#define rsc_key_case          (Resources->rsc_key_case)
+#define rsc_key_preserve      (Resources->rsc_key_preserve)
+#define rsc_col_s             (Resources->rsc_col_s)
+#define rsc_col_c             (Resources->rsc_col_c)
+#define rsc_col_p             (Resources->rsc_col_p)
+#define rsc_col_key           (Resources->rsc_col_key)
+#define rsc_all_macs          (Resources->rsc_all_macs)
+#define rsc_print_et          (Resources->rsc_print_et)
+#define rsc_eq_right          (Resources->rsc_eq_right)
+#define rsc_braces            (Resources->rsc_braces)
+#define rsc_print_ce          (Resources->rsc_print_ce)
+#define rsc_del_pre           (Resources->rsc_del_pre)
+#define rsc_del_q             (Resources->rsc_del_q)
+#define rsc_indent            (Resources->rsc_indent)
+#define rsc_linelen           (Resources->rsc_linelen)
+#define rsc_newlines          (Resources->rsc_newlines)
+#define rsc_parentheses       (Resources->rsc_parentheses)
+#define rsc_print_rules       (Resources->rsc_print_rules)
+#define rsc_print_timing      (Resources->rsc_print_timing)
+#define rsc_print_tc          (Resources->rsc_print_tc)
+#define rsc_print_threads     (Resources->rsc_print_threads)
+#define rsc_use_tabs          (Resources->rsc_use_tabs)
+#define rsc_print_verbatim    (Resources->rsc_print_verbatim)
+#define rsc_print_we          (Resources->rsc_print_we)
+#define rsc_quiet             (Resources->rsc_quiet)
+#define rsc_bundle            (Resources->rsc_bundle)
+#define rsc_case_rewrite      (Resources->rsc_case_rewrite)
+#define rsc_rewrite_limit     (Resources->rsc_rewrite_limit)
+#define rsc_sel_ignored       (Resources->rsc_sel_ignored)
+#define rsc_case_select       (Resources->rsc_case_select)
+#define rsc_sel_fields        (Resources->rsc_sel_fields)
+#define rsc_sel_threads       (Resources->rsc_sel_threads)
+#define rsc_xref_select       (Resources->rsc_xref_select)
+#define rsc_server            (Resources->rsc_server)
+#define rsc_sort              (Resources->rsc_sort)
+#define rsc_sort_cased        (Resources->rsc_sort_cased)
+#define rsc_srt_macs          (Resources->rsc_srt_macs)
+#define rsc_sort_memory       (Resources->rsc_sort_memory)
+#define rsc_sort_merge        (Resources->rsc_sort_merge)
+#define rsc_sort_reverse      (Resources->rsc_sort_reverse)
+#define rsc_stream            (Resources->rsc_stream)
+#define rsc_no_nl             (Resources->rsc_no_nl)
+#define rsc_verbose           (Resources->rsc_verbose)
+#define rsc_watch             (Resources->rsc_watch)
+#define rsc_select            (Resources->rsc_select)
+#define rsc_e_rsc             (Resources->rsc_e_rsc)
+#define rsc_v_rsc             (Resources->rsc_v_rsc)
 
 /*---------------------------------------------------------------------------*/
 
@@ -68,5 +152,7 @@ DECLARE( String, rsc_v_rsc , (String)(RSC_BIBTOOL_DEFAULT)	);
  bool set_rsc _ARG((Symbol name, Symbol val));
  bool use_rsc _ARG((String s));
  void rsc_print _ARG((String s));
+ SResources * rsc_state _ARG((void));
 
 /*---------------------------------------------------------------------------*/
+#endif
@@ -0,0 +1,102 @@
+/*** stats.h ******************************************************************
+**
+** This file is part of BibTool.
+** It is distributed under the GNU General Public License.
+** See the file COPYING for details.
+**
+** (c) 2020 Gerd Neugebauer
+**
+** Net: gene@gerd-neugebauer.de
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+**-----------------------------------------------------------------------------
+** Description:
+**	This header file provides the statistics of the library. The
+**	modules count the work done in the current context: the
+**	records and fields read, the symbols, the searches, the
+**	rules applied, and the bytes written. In addition the time
+**	spent in the phases of a run can be measured.
+**
+**	This header file provides also access to the functions and
+**	variables defined in |stats.c|. Consult the documentation
+**	of this file for details.
+**
+******************************************************************************/
+
+#ifndef STATS_H_LOADED
+#define STATS_H_LOADED
+
+#include <stdio.h>
+#include <bibtool/general.h>
+#include <bibtool/context.h>
+
+/*-----------------------------------------------------------------------------
+** Constant*:	STAT_PHASES
+** Type:	int
+** Purpose:	The maximal number of phases which are distinguished.
+**		Further phases are added to the last one.
+**___________________________________________________			     */
+#define STAT_PHASES 16
+
+/*-----------------------------------------------------------------------------
+** Typedef*:	SStats
+** Purpose:	The state of the statistics module in a context. It
+**		contains the counters and the times of the phases.
+**___________________________________________________			     */
+ typedef struct					   /*                        */
+ { long	  st_records;				   /* the records read       */
+   long	  st_fields;				   /* the fields read        */
+   long	  st_symbols;				   /* the symbols created    */
+   long	  st_probes;				   /* the symbols compared   */
+   long	  st_regex;				   /* the regex searches     */
+   long	  st_hits;				   /* the rules applied      */
+   long	  st_finds;				   /* the calls of db_find() */
+   long	  st_bytes;				   /* the bytes written      */
+   int	  st_phases;				   /* the phases used        */
+   int	  st_current;				   /* the running phase      */
+   char	  *st_name[STAT_PHASES];		   /* the names of the phases*/
+   double st_wall[STAT_PHASES];			   /* the elapsed times      */
+   double st_cpu[STAT_PHASES];			   /* the processor times    */
+   double st_wall0;				   /* the start of the       */
+   double st_cpu0;				   /*  running phase         */
+ } SStats;					   /*                        */
+
+/*-----------------------------------------------------------------------------
+** Macro*:	Stats
+** Type:	SStats*
+** Purpose:	The state of the statistics module in the current
+**		context.
+**___________________________________________________			     */
+#define Stats ((SStats*)CtxGet(CTX_STATS, stat_state()))
+
+/*-----------------------------------------------------------------------------
+** Macro:	StatCount()
+** Type:	void
+** Purpose:	Add a number to a counter of the current context.
+** Arguments:
+**	FIELD	the name of the counter, e.g. |st_records|
+**	N	the number to add
+** Returns:	nothing
+**___________________________________________________			     */
+#define StatCount(FIELD,N) (void)(Stats->FIELD += (N))
+
+ SStats * stat_state _ARG((void));		   /* stats.c                */
+ double stat_clock _ARG((void));		   /* stats.c                */
+ void stat_phase _ARG((char *name));		   /* stats.c                */
+ void stat_print _ARG((FILE *file,bool json));	   /* stats.c                */
+
+/*---------------------------------------------------------------------------*/
+#endif
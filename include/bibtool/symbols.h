@@ -50,6 +50,7 @@
 #define SYMBOLS_H_LOADED
 
 #include <bibtool/type.h>
+#include <bibtool/context.h>
 
 /*-----------------------------------------------------------------------------
 ** Macro:	UnlinkSymbol()
@@ -111,6 +112,38 @@ typedef String Symbol;
 **___________________________________________________			     */
 #define NO_SYMBOL (Symbol)NULL
 
+/*-----------------------------------------------------------------------------
+** Typedef*:	SSymbols
+** Purpose:	The state of the symbols module in a context. It
+**		contains the symbol table and the predefined symbols.
+**___________________________________________________			     */
+ typedef struct					   /*                        */
+ { struct STAB **sym_tab;			   /* the buckets            */
+   int	  sym_tab_size;				   /* number of buckets      */
+   int	  sym_tab_count;			   /* number of symbols      */
+   Symbol sym_empty;				   /*                        */
+   Symbol sym_crossref;				   /*                        */
+   Symbol sym_xref;				   /*                        */
+   Symbol sym_xdata;				   /*                        */
+   Symbol sym_space;				   /*                        */
+   Symbol sym_star;				   /*                        */
+   Symbol sym_qqq;				   /*                        */
+   Symbol sym_comma;				   /*                        */
+   Symbol sym_double_quote;			   /*                        */
+   Symbol sym_open_brace;			   /*                        */
+   Symbol sym_close_brace;			   /*                        */
+   Symbol sym_et;				   /*                        */
+   Symbol sym_key;				   /*                        */
+   Symbol sym_sortkey;				   /*                        */
+ } SSymbols;					   /*                        */
+
+/*-----------------------------------------------------------------------------
+** Macro*:	SymState
+** Type:	SSymbols*
+** Purpose:	The state of the symbols module in the current context.
+**___________________________________________________			     */
+#define SymState ((SSymbols*)CtxGet(CTX_SYMBOLS, sym_state()))
+
 /*-----------------------------------------------------------------------------
 ** Variable:	s_empty
 ** Type:	String 
@@ -126,7 +159,7 @@ typedef String Symbol;
 **		immediately to a |\0| byte.  This needs
 **		|init_symbols()| to be called first.
 **___________________________________________________			     */
- extern Symbol sym_empty;
+#define sym_empty (SymState->sym_empty)
 
 /*-----------------------------------------------------------------------------
 ** Variable:	sym_crossref
@@ -134,7 +167,7 @@ typedef String Symbol;
 ** Purpose:	The symbol |crossref|. This variable needs
 **		|init_symbols()| to be called first.
 **___________________________________________________			     */
- extern Symbol sym_crossref;
+#define sym_crossref (SymState->sym_crossref)
 
 /*-----------------------------------------------------------------------------
 ** Variable:	sym_xref
@@ -142,7 +175,7 @@ typedef String Symbol;
 ** Purpose:	The symbol |xref|. This variable needs
 **		|init_symbols()| to be called first.
 **___________________________________________________			     */
- extern Symbol sym_xref;
+#define sym_xref (SymState->sym_xref)
 
 /*-----------------------------------------------------------------------------
 ** Variable:	sym_xdata
@@ -150,7 +183,7 @@ typedef String Symbol;
 ** Purpose:	The symbol |xdata|. This variable needs
 **		|init_symbols()| to be called first.
 **___________________________________________________			     */
- extern Symbol sym_xdata;
+#define sym_xdata (SymState->sym_xdata)
 
 /*-----------------------------------------------------------------------------
 ** Variable:	sym_space
@@ -158,7 +191,7 @@ typedef String Symbol;
 ** Purpose:	The symbol with a single space character. This variable needs
 **		|init_symbols()| to be called first.
 **___________________________________________________			     */
- extern Symbol sym_space;
+#define sym_space (SymState->sym_space)
 
 /*-----------------------------------------------------------------------------
 ** Variable:	sym_star
@@ -166,9 +199,9 @@ typedef String Symbol;
 ** Purpose:	The symbol with a single star character. This variable needs
 **		|init_symbols()| to be called first.
 **___________________________________________________			     */
- extern Symbol sym_star;
+#define sym_star (SymState->sym_star)
 
- extern Symbol sym_qqq;
+#define sym_qqq (SymState->sym_qqq)
 
 /*-----------------------------------------------------------------------------
 ** Variable:	sym_comma
@@ -176,7 +209,7 @@ typedef String Symbol;
 ** Purpose:	The symbol with a single comma character. This variable needs
 **		|init_symbols()| to be called first.
 **___________________________________________________			     */
- extern Symbol sym_comma;
+#define sym_comma (SymState->sym_comma)
 
 /*-----------------------------------------------------------------------------
 ** Variable:	sym_double_quote
@@ -184,7 +217,7 @@ typedef String Symbol;
 ** Purpose:	The symbol with a single double quote character (").
 **		This variable needs |init_symbols()| to be called first.
 **___________________________________________________			     */
- extern Symbol sym_double_quote;
+#define sym_double_quote (SymState->sym_double_quote)
 
 /*-----------------------------------------------------------------------------
 ** Variable:	sym_open_brace
@@ -192,7 +225,7 @@ typedef String Symbol;
 ** Purpose:	The symbol with a single open brace character. This
 **		variable needs |init_symbols()| to be called first.
 **___________________________________________________			     */
- extern Symbol sym_open_brace;
+#define sym_open_brace (SymState->sym_open_brace)
 
 /*-----------------------------------------------------------------------------
 ** Variable:	sym_close_brace
@@ -200,7 +233,7 @@ typedef String Symbol;
 ** Purpose:	The symbol with a single close brace character. This
 **		variable needs |init_symbols()| to be called first.
 **___________________________________________________			     */
- extern Symbol sym_close_brace;
+#define sym_close_brace (SymState->sym_close_brace)
 
 /*-----------------------------------------------------------------------------
 ** Variable:	sym_et
@@ -208,11 +241,11 @@ typedef String Symbol;
 ** Purpose:	The symbol with a single et character (\&). This
 **		variable needs |init_symbols()| to be called first.
 **___________________________________________________			     */
- extern Symbol sym_et;
+#define sym_et (SymState->sym_et)
 
- extern Symbol sym_key;
+#define sym_key (SymState->sym_key)
 
- extern Symbol sym_sortkey;
+#define sym_sortkey (SymState->sym_sortkey)
 
 /*-----------------------------------------------------------------------------
 ** Macro:	newString()
@@ -231,12 +264,16 @@ typedef String Symbol;
 #define _ARG(A) ()
 #endif
  Symbol  symbol _ARG((String s));	   	   /* symbols.c              */
+ SSymbols * sym_state _ARG((void));		   /* symbols.c              */
+ Symbol  sym_adopt _ARG((String s));		   /* symbols.c              */
+ Symbol  sym_lookup _ARG((String s));		   /* symbols.c              */
  Symbol  sym_extract _ARG((String *sp,bool lowercase));/* symbols.c          */
  char * new_string _ARG((char * s));		   /* symbols.c              */
  void init_symbols _ARG((void));		   /* symbols.c              */
  void sym_dump _ARG((void));			   /* symbols.c              */
  void sym_del _ARG((Symbol sym));		   /* symbols.c              */
  void sym_gc _ARG((void));			   /* symbols.c              */
+ void sym_reserve _ARG((int n));		   /* symbols.c              */
  void sym_unlink _ARG((Symbol s));		   /* symbols.c              */
  void free_sym_array _ARG((Symbol *sym_arr));	   /*                        */
 
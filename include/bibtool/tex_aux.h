@@ -35,6 +35,12 @@
  bool apply_aux _ARG((DB db));			   /* tex_aux.c              */
  bool foreach_aux _ARG((bool (fct)_ARG((Symbol))));/* tex_aux.c              */
  bool aux_used _ARG((Symbol s));		   /* tex_aux.c              */
+ bool aux_selecting _ARG((void));		   /* tex_aux.c              */
+ bool aux_skipping _ARG((void));		   /* tex_aux.c              */
+ bool aux_wanted _ARG((Symbol key));		   /* tex_aux.c              */
+ bool aux_rescan _ARG((void));			   /* tex_aux.c              */
+ bool aux_rescanning _ARG((void));		   /* tex_aux.c              */
+ void aux_follow _ARG((DB db,Record rec));	   /* tex_aux.c              */
  void clear_aux _ARG((void));			   /* tex_aux.c              */
 
 /*---------------------------------------------------------------------------*/
@@ -49,6 +49,7 @@
 #define TYPE_H_LOADED
 
 #include <bibtool/general.h>
+#include <bibtool/context.h>
 
  typedef unsigned char Uchar;
  typedef Uchar* String;
@@ -360,6 +361,24 @@ Uchar trans_id[256];			   	   /*                        */
  extern Uchar trans_id[256];
 #endif
 
+/*-----------------------------------------------------------------------------
+** Typedef*:	STypeState
+** Purpose:	The state of the type module in a context. It contains
+**		the characters declared as word separators with
+**		|add_word_sep()|. The table |type__allowed| is shared
+**		by all contexts and not modified.
+**___________________________________________________			     */
+ typedef struct					   /*                        */
+ { Uchar ty_wordsep[256];			   /* the added separators   */
+ } STypeState;					   /*                        */
+
+/*-----------------------------------------------------------------------------
+** Macro*:	TypeState
+** Type:	STypeState*
+** Purpose:	The state of the type module in the current context.
+**___________________________________________________			     */
+#define TypeState ((STypeState*)CtxGet(CTX_TYPE, type_state()))
+
 /*-----------------------------------------------------------------------------
 ** Macro:	is_allowed()
 ** Type:	bool
@@ -454,7 +473,8 @@ Uchar trans_id[256];			   	   /*                        */
 **	C	Character to consider
 ** Returns:	|TRUE| iff the character is a word separator.
 **___________________________________________________			     */
-#define is_wordsep(C)	  (type__allowed[(Uchar)C]&T__WordSep)
+#define is_wordsep(C)	  ((type__allowed[(Uchar)C]&T__WordSep)	\
+			   || TypeState->ty_wordsep[(Uchar)C])
 
 /*-----------------------------------------------------------------------------
 ** Macro:	ToLower()
@@ -491,6 +511,7 @@ Uchar trans_id[256];			   	   /*                        */
 #else
 #define _ARG(A) ()
 #endif
+ STypeState * type_state _ARG((void));		   /* type.c                 */
  String lower _ARG((String s));		   	   /* type.c                 */
  bool case_eq _ARG((String s, String t));	   /* type.c                 */
  int cmp _ARG((String s, String t));	   	   /* type.c                 */
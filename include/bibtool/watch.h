@@ -0,0 +1,43 @@
+/*** watch.h ***************************************************************
+**
+** This file is part of BibTool.
+** It is distributed under the GNU General Public License.
+** See the file COPYING for details.
+**
+** (c) 2020 Gerd Neugebauer
+**
+** Net: gene@gerd-neugebauer.de
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+**-----------------------------------------------------------------------------
+** Description:
+**	This header file makes available the functions defined in
+**	|watch.c|.
+******************************************************************************/
+
+#include <bibtool/database.h>
+
+#ifdef __STDC__
+#define _ARG(A) A
+#else
+#define _ARG(A) ()
+#endif
+ bool watch_possible _ARG((void));		   /* watch.c                */
+ bool watch_in_files _ARG((bool (*fct)_ARG((DB db, Record rec)),
+			   int (*less)_ARG((Record, Record)),
+			   void (*process)_ARG((DB db,
+						int (*less)_ARG((Record,
+								 Record))))));
@@ -71,6 +71,19 @@
 **___________________________________________________			     */
 #define NextWord(WL) ((WL)->wl_next)
 
+/*-----------------------------------------------------------------------------
+** Typedef:	KeySet
+** Purpose:	This data type represents a set of keys. It is an open
+**		addressed hash table which grows as needed. Upper and
+**		lower case letters are not distinguished. An empty set
+**		is initialized with |{ (Symbol*)NULL, 0, 0 }|.
+**___________________________________________________			     */
+ typedef struct kEYsET				   /*                        */
+ { Symbol	*ks_tab;			   /* the table or NULL      */
+   int		ks_size;			   /* its size; a power of 2 */
+   int		ks_used;			   /* the number of keys     */
+ } SKeySet, *KeySet;				   /*                        */
+
 #ifdef __STDC__
 #define _ARG(A) A
 #else
@@ -80,6 +93,9 @@
  bool foreach_word _ARG((WordList wl,bool (*fct)_ARG((Symbol))));/* wordlist.c*/
  void free_words _ARG((WordList *wlp,void (*fct)_ARG((Symbol))));/* wordlist.c*/
  void add_word _ARG((Symbol s,WordList *wlp));	   /* wordlist.c             */
+ bool ks_find _ARG((KeySet ks,String s));	   /* wordlist.c             */
+ void ks_add _ARG((KeySet ks,Symbol sym));	   /* wordlist.c             */
+ void ks_clear _ARG((KeySet ks));		   /* wordlist.c             */
 
 /*---------------------------------------------------------------------------*/
 #endif
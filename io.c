@@ -38,6 +38,13 @@
 /* Internal Programs							     */
 /*===========================================================================*/
 
+#ifdef __STDC__
+#define _ARG(A) A
+#else
+#define _ARG(A) ()
+#endif
+ static void io_free _ARG((void *state));	   /* io.c                   */
+
 /*****************************************************************************/
 /* External Programs and Variables					     */
 /*===========================================================================*/
@@ -51,9 +58,58 @@
 
 #define InputFilePipeIncrement 8
 
- static Symbol* input_files;
- static int input_file_size = 0;
- static int input_file_ptr  = 0;
+/*-----------------------------------------------------------------------------
+** Typedef*:	SIoState
+** Purpose:	The state of the io module in a context. It contains
+**		the input files, the output file, and the macro file.
+**___________________________________________________			     */
+ typedef struct					   /*                        */
+ { Symbol *input_files;				   /*                        */
+   int	  input_file_size;			   /*                        */
+   int	  input_file_ptr;			   /*                        */
+   Symbol output_file;				   /*                        */
+   Symbol macro_file;				   /*                        */
+ } SIoState;					   /*                        */
+
+/*-----------------------------------------------------------------------------
+** Variable*:	io_state0
+** Type:	SIoState
+** Purpose:	The initial state of the io module in a context. No
+**		files are known.
+**___________________________________________________			     */
+ static SIoState io_state0 =			   /*                        */
+ { (Symbol*)NULL,				   /*                        */
+   0,						   /*                        */
+   0,						   /*                        */
+   NO_SYMBOL,					   /*                        */
+   NO_SYMBOL					   /*                        */
+ };						   /*                        */
+
+#define IoState ((SIoState*)CtxGet(CTX_IO,				\
+				   ctx_state(CTX_IO,			\
+					     (void*)&io_state0,		\
+					     sizeof(io_state0),		\
+					     io_free)))
+
+#define input_files	(IoState->input_files)
+#define input_file_size	(IoState->input_file_size)
+#define input_file_ptr	(IoState->input_file_ptr)
+#define output_file	(IoState->output_file)
+#define macro_file	(IoState->macro_file)
+
+/*-----------------------------------------------------------------------------
+** Function*:	io_free()
+** Type:	void
+** Purpose:	Release the input files when a context is released.
+** Arguments:
+**	state	the state
+** Returns:	nothing
+**___________________________________________________			     */
+static void io_free(state)			   /*                        */
+  void *state;					   /*                        */
+{ POSSIBLY_UNUSED(state);			   /*                        */
+  if (input_files) free(input_files);		   /*                        */
+}						   /*------------------------*/
 
 #define InputPipeIsFull		(input_file_ptr >= input_file_size)
 #define InputPipeIsEmpty	(input_file_ptr == 0)
@@ -138,8 +194,6 @@ Symbol get_input_file(i)			   /*                        */
 /***			   Output File Section				   ***/
 /*****************************************************************************/
 
- static Symbol output_file = NO_SYMBOL;	   	   /*			     */
-
 /*-----------------------------------------------------------------------------
 ** Function:	save_output_file()
 ** Purpose:	Simply feed the output file name into the static variable.
@@ -174,8 +228,6 @@ Symbol get_output_file()		   	   /*			     */
 /***			   Macro File Section				   ***/
 /*****************************************************************************/
 
- static Symbol macro_file = NO_SYMBOL;	   	   /*			     */
-
 /*-----------------------------------------------------------------------------
 ** Function:	save_macro_file()
 ** Purpose:	Simply feed the macro file name into the static variable.
@@ -35,6 +35,8 @@
 #include <bibtool/tex_read.h>
 #include <bibtool/wordlist.h>
 #include <bibtool/expand.h>
+#include <bibtool/parse.h>
+#include <bibtool/context.h>
 #ifdef HAVE_TIME_H
 #include <time.h>
 #endif
@@ -57,6 +59,7 @@
  static bool add_fmt_tree _ARG((char *s,KeyNode *treep));/* key.c             */
  static bool eval__fmt _ARG((StringBuffer *sb,KeyNode kn,Record rec));/* key.c*/
  static bool eval_fmt _ARG((StringBuffer *sb,KeyNode kn,Record rec,DB db));/* key.c*/
+ static bool fmt_inherits _ARG((KeyNode kn));	   /* key.c                  */
  static char * itostr _ARG((int i,char *digits));  /* key.c                  */
  static int deTeX _ARG((String line,void (*save_fct)_ARG((String)),int commap));/*key.c*/
  static int fmt__parse _ARG((char **sp,KeyNode *knp));/* key.c               */
@@ -70,6 +73,7 @@
  static void key_init _ARG((void));		   /* key.c                  */
  static void push_s _ARG((StringBuffer *sb,String s,int max,String trans));/* key.c*/
  static void push_word _ARG((String s));	   /* key.c                  */
+ static void key_free _ARG((void *state));	   /* key.c                  */
 
 #ifdef DEBUG
  static void show_fmt _ARG((KeyNode kn,int in));   /* key.c                  */
@@ -79,7 +83,64 @@
 /* External Programs							     */
 /*===========================================================================*/
 
- static DB tmp_key_db;
+#define ITOA_LEN 64
+
+/*-----------------------------------------------------------------------------
+** Typedef*:	SKeyState
+** Purpose:	The state of the key generation in a context. It
+**		contains the compiled key formats, the separators, the
+**		ignored words, and the buffers used while a key is
+**		generated.
+**___________________________________________________			     */
+ typedef struct					   /*                        */
+ { DB		tmp_key_db;			   /* the current database   */
+   StringBuffer *key_sb;			   /*                        */
+   StringBuffer *tmp_sb;			   /*                        */
+   KeyNode	key_tree;			   /* the key format         */
+   KeyNode	sort_key_tree;			   /* the sort format        */
+   NameNode	format[NUMBER_OF_FORMATS];	   /* the name formats       */
+   String	*words;				   /* the word stack         */
+   size_t	words_len;			   /*                        */
+   size_t	words_used;			   /*                        */
+   Symbol	*key_seps;			   /* the separators         */
+   int		key_base;			   /*                        */
+   char		itoa_buf[ITOA_LEN];		   /*                        */
+   String	detex_buf;			   /*                        */
+   size_t	detex_len;			   /*                        */
+   WordList	ignored_words[32];		   /*                        */
+   SKeySet	old_keys;			   /* the keys generated     */
+   Record	tmp_rec;			   /*                        */
+   Symbol	s_author;			   /*                        */
+   Symbol	s_editor;			   /*                        */
+   Symbol	s_title;			   /*                        */
+   Symbol	s_booktitle;			   /*                        */
+   Symbol	s_key;				   /*                        */
+   char		*old_fmt;			   /* the last format applied*/
+   KeyNode	old_kn;				   /* and its compiled form  */
+   Symbol	sym_user;			   /*                        */
+   Symbol	sym_host;			   /*                        */
+#ifdef HAVE_TIME_H
+   time_t	the_time;			   /* the time of the first  */
+   struct tm	the_tm;				   /* use of a time field    */
+   char		time_buf[32];			   /*                        */
+#endif
+ } SKeyState;					   /*                        */
+
+/*-----------------------------------------------------------------------------
+** Variable*:	key_state0
+** Type:	SKeyState
+** Purpose:	The initial state of the key generation in a context.
+**		All values are zero.
+**___________________________________________________			     */
+ static SKeyState key_state0;			   /*                        */
+
+#define KeyState ((SKeyState*)CtxGet(CTX_KEY,				\
+				     ctx_state(CTX_KEY,			\
+					       (void*)&key_state0,	\
+					       sizeof(key_state0),	\
+					       key_free)))
+
+#define tmp_key_db (KeyState->tmp_key_db)
 
 /*---------------------------------------------------------------------------*/
 
@@ -94,15 +155,15 @@
 #define DetexLower 1
 #define DetexUpper 2
 
- static StringBuffer *key_sb = (StringBuffer*)NULL;/*                        */
- static StringBuffer *tmp_sb = (StringBuffer*)NULL;/*                        */
+#define key_sb (KeyState->key_sb)
+#define tmp_sb (KeyState->tmp_sb)
 
 /*---------------------------------------------------------------------------*/
 
- static KeyNode key_tree      = (KeyNode)0;	   /*                        */
- static KeyNode sort_key_tree = (KeyNode)0;	   /*                        */
+#define key_tree      (KeyState->key_tree)
+#define sort_key_tree (KeyState->sort_key_tree)
 
- static NameNode format[NUMBER_OF_FORMATS];	   /*                        */
+#define format (KeyState->format)
 
 #define SkipSpaces(CP)	  while (is_space(*CP)) ++(CP)
 #define SkipAllowed(CP)	  while (is_allowed(*CP)) ++(CP)
@@ -128,9 +189,9 @@
 /***				Private word stack			   ***/
 /*****************************************************************************/
 
-static String *words	 = (String*)NULL;
-static size_t words_len  = 0;
-static size_t words_used = 0;
+#define words	   (KeyState->words)
+#define words_len  (KeyState->words_len)
+#define words_used (KeyState->words_used)
 #define WordLenInc 16
 
 #define PushWord(S)	if (words_len>words_used) words[words_used++]=S; \
@@ -183,7 +244,7 @@ static void Push_Word(s)			   /*			     */
 
 #define NoSeps 8
 
- static Symbol *key_seps = NULL;
+#define key_seps (KeyState->key_seps)
 
 #define DefaultKey    key_seps[0]
 #define InterNameSep  key_seps[1]
@@ -298,7 +359,7 @@ Symbol get_separator(n)				   /*                        */
 #define KEY_BASE_DIGIT 0
 #define KEY_BASE_LOWER 1
 #define KEY_BASE_UPPER 2
- static int key_base = KEY_BASE_DIGIT;
+#define key_base (KeyState->key_base)
 
 /*-----------------------------------------------------------------------------
 ** Function:	set_base()
@@ -355,8 +416,6 @@ String get_base()				   /*                        */
   }						   /*                        */
 }						   /*------------------------*/
 
-#define ITOA_LEN 64
-
 /*-----------------------------------------------------------------------------
 ** Function*:	itostr()
 ** Purpose:	Translate number using the ``digits'' given.
@@ -376,7 +435,7 @@ String get_base()				   /*                        */
 static char * itostr(i,digits)			   /*			     */
   register int	 i;				   /*			     */
   register char	 *digits;			   /*			     */
-{ static char	 buffer[ITOA_LEN];		   /* buffer to store result */
+{ char		 *buffer = KeyState->itoa_buf;	   /* buffer to store result */
   register char	 *bp;				   /* buffer pointer	     */
   register int	 sign,				   /*			     */
 		 base;				   /*			     */
@@ -498,8 +557,8 @@ static int deTeX(line,save_fct,flags)		   /*			     */
   String	line;				   /*			     */
   int		flags;				   /*			     */
   void		(*save_fct)_ARG((String));	   /*			     */
-{ static String	buffer;			   	   /*			     */
-  static size_t len   = 0;			   /*			     */
+{ String	buffer = KeyState->detex_buf;	   /*                        */
+  size_t	len    = KeyState->detex_len;	   /*                        */
   Uchar		c;				   /*                        */
   String	s, bp;			   	   /*			     */
   Uchar		last  = (Uchar)' ';		   /*			     */
@@ -524,6 +583,8 @@ static int deTeX(line,save_fct,flags)		   /*			     */
     }						   /*			     */
     if ( buffer == NULL ) 			   /*                        */
     { OUT_OF_MEMORY("deTeX()"); }   		   /*			     */
+    KeyState->detex_buf = buffer;		   /*                        */
+    KeyState->detex_len = len;			   /*                        */
   }						   /*			     */
 						   /*			     */
   TeX_open_string(line);		   	   /*			     */
@@ -621,16 +682,7 @@ static void push_s(sb,s,max,trans)		   /*			     */
   }						   /*                        */
 }						   /*------------------------*/
 
- static WordList ignored_words[32] = 
- { WordNULL, WordNULL, WordNULL, WordNULL,
-   WordNULL, WordNULL, WordNULL, WordNULL,
-   WordNULL, WordNULL, WordNULL, WordNULL,
-   WordNULL, WordNULL, WordNULL, WordNULL,
-   WordNULL, WordNULL, WordNULL, WordNULL,
-   WordNULL, WordNULL, WordNULL, WordNULL,
-   WordNULL, WordNULL, WordNULL, WordNULL,
-   WordNULL, WordNULL, WordNULL, WordNULL
- };
+#define ignored_words (KeyState->ignored_words)
 
 /*-----------------------------------------------------------------------------
 ** Function:	add_ignored_word()
@@ -1080,9 +1132,9 @@ static bool fmt_c_string(s,min,max,not)		   /*			     */
 #define GetEntryOrReturn(S,NAME)					\
 	if ((S=get_field(tmp_key_db,rec,NAME)) == NULL) return false
 
- static WordList old_keys = WordNULL;
+#define old_keys (KeyState->old_keys)
 
- static Record tmp_rec = NULL;
+#define tmp_rec (KeyState->tmp_rec)
 
 /*-----------------------------------------------------------------------------
 ** Function:	start_key_gen()
@@ -1093,7 +1145,7 @@ static bool fmt_c_string(s,min,max,not)		   /*			     */
 **___________________________________________________			     */
 void start_key_gen()				   /*                        */
 {						   /*                        */
-  free_words(&old_keys, sym_unlink);		   /*                        */
+  ks_clear(&old_keys);				   /*                        */
   init_key();					   /*                        */
 }						   /*------------------------*/
 
@@ -1106,7 +1158,7 @@ void start_key_gen()				   /*                        */
 **___________________________________________________			     */
 void end_key_gen()				   /*                        */
 {						   /*                        */
-  free_words(&old_keys,sym_unlink);		   /*                        */
+  ks_clear(&old_keys);				   /*                        */
 }						   /*------------------------*/
 
 /*-----------------------------------------------------------------------------
@@ -1127,7 +1179,7 @@ bool mark_key(db,rec)				   /*			     */
        *RecordHeap(rec) == NULL )		   /*                        */
   { return false; }				   /*			     */
    						   /*                        */
-  add_word(*RecordHeap(rec), &old_keys);	   /*                        */
+  ks_add(&old_keys, *RecordHeap(rec));		   /*                        */
   return false;					   /*                        */
 }						   /*------------------------*/
 
@@ -1192,7 +1244,7 @@ void make_key(db,rec)				   /*			     */
   pos = sbtell(key_sb);		   		   /*			     */
   kp  = (String)sbflush(key_sb);	   	   /* get collected key	     */
 						   /*			     */
-  if (find_word(kp, old_keys))		   	   /* is key already used?   */
+  if (ks_find(&old_keys, kp))		   	   /* is key already used?   */
   { int n = 1;					   /* Then disambiguate:     */
     (void)sbseek(key_sb, pos);			   /*			     */
     (void)sbputs((char*)SymbolValue(KeyNumberSep), /*                        */
@@ -1203,13 +1255,14 @@ void make_key(db,rec)				   /*			     */
       (void)sbputs(itostr(n++,key__base[key_base]),/*			     */
 		   key_sb);			   /*			     */
       kp = (String)sbflush(key_sb);	   	   /*	get new key	     */
-    } while (find_word(kp, old_keys));	   	   /*			     */
+    } while (ks_find(&old_keys, kp));	   	   /*			     */
   }						   /*			     */
  						   /*                        */
   key = symbol(kp);				   /*                        */
   old = *RecordHeap(rec);			   /*                        */
   *RecordHeap(rec) = key;		   	   /* store new key	     */
-  add_word(key, &old_keys);		   	   /* remember new key       */
+  if (key != old) SetRecordDIRTY(rec);		   /*                        */
+  ks_add(&old_keys, key);		   	   /* remember new key       */
  						   /* ---------------------- */
   if (rsc_make_alias				   /* if needed then make    */
       && !rsc_apply_alias			   /*                        */
@@ -1256,6 +1309,54 @@ void make_sort_key(db,rec)			   /*			     */
   }						   /*			     */
 }						   /*------------------------*/
 
+/*-----------------------------------------------------------------------------
+** Function*:	fmt_inherits()
+** Purpose:	Check whether a format tree reads a field which a
+**		record may inherit through a crossref. Pseudo fields
+**		starting with |$| or |@| are not inherited.
+** Arguments:
+**	kn	the key node
+** Returns:	|true| iff such a field is used.
+**___________________________________________________			     */
+static bool fmt_inherits(kn)			   /*			     */
+  KeyNode kn;					   /*			     */
+{ Uchar   c;					   /*                        */
+ 						   /*                        */
+  for (; kn != (KeyNode)0; kn = NodeNext(kn))	   /*			     */
+  { switch ( NodeType(kn) )			   /*			     */
+    { case NodeSTRING:				   /*			     */
+	break;					   /*			     */
+      case NodeSPECIAL:				   /* author, editor, title  */
+	return true;				   /*			     */
+      case NodeOR:				   /*			     */
+	if ( fmt_inherits(NodeThen(kn)) ||	   /*                        */
+	     fmt_inherits(NodeElse(kn)) ) return true;/*                     */
+	break;					   /*			     */
+      case NodeTEST:				   /*			     */
+	if ( fmt_inherits(NodeThen(kn)) ||	   /*                        */
+	     fmt_inherits(NodeElse(kn)) ) return true;/*                     */
+	/* fall through */			   /* The test symbol too.   */
+      default:					   /*			     */
+	c = *SymbolValue(NodeSymbol(kn));	   /*                        */
+	if ( c != '$' && c != '@' ) return true;   /*                        */
+    }						   /*			     */
+  }						   /*			     */
+  return false;					   /*			     */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	sort_key_inherits()
+** Type:	bool
+** Purpose:	Check whether the sort keys may depend on fields
+**		inherited through a crossref. Such a sort key can only
+**		be computed when the crossref target has been read.
+** Arguments:	none
+** Returns:	|true| iff the sort format reads a normal field.
+**___________________________________________________			     */
+bool sort_key_inherits()			   /*			     */
+{ return fmt_inherits(sort_key_tree);		   /*			     */
+}						   /*------------------------*/
+
 
 /*****************************************************************************/
 /***		      Key Format Parsing and Evaluating			   ***/
@@ -1285,6 +1386,7 @@ static KeyNode new_key_node(type, sym)	   	   /*			     */
   NodeElse(new_node)   = (KeyNode)0;		   /*			     */
   NodePre(new_node)    = -1;			   /*                        */
   NodePost(new_node)   = -1;			   /*                        */
+  if (type != NodeSTRING) demand_field(sym);	   /* the value is needed    */
   return new_node;				   /*			     */
 }						   /*------------------------*/
 
@@ -1892,18 +1994,14 @@ static void eval__special(sb,kn,rec)		   /*			     */
 { Symbol	s;				   /*			     */
   bool		missing	= true;		   	   /*			     */
   int		fmt;			   	   /*			     */
-  static Symbol	s_author    = NO_SYMBOL;	   /*			     */
-  static Symbol	s_editor    = NO_SYMBOL;	   /*			     */
-  static Symbol	s_title	    = NO_SYMBOL;	   /*			     */
-  static Symbol s_booktitle = NO_SYMBOL;	   /*			     */
-  static Symbol	s_key	    = NO_SYMBOL;	   /*			     */
+  SKeyState	*st = KeyState;			   /*                        */
 						   /*			     */
-  if ( s_author == NO_SYMBOL )		   	   /*			     */
-  { s_author	= symbol((String)"author");	   /*			     */
-    s_editor	= symbol((String)"editor");	   /*			     */
-    s_title	= symbol((String)"title");	   /*			     */
-    s_booktitle = symbol((String)"booktitle"); 	   /*			     */
-    s_key	= symbol((String)"key");	   /*			     */
+  if ( st->s_author == NO_SYMBOL )		   /*                        */
+  { st->s_author    = symbol((String)"author");	   /*                        */
+    st->s_editor    = symbol((String)"editor");	   /*                        */
+    st->s_title     = symbol((String)"title");	   /*                        */
+    st->s_booktitle = symbol((String)"booktitle"); /*                        */
+    st->s_key       = symbol((String)"key");	   /*			     */
   }						   /*			     */
 						   /*			     */
   if (key_seps == NULL) { init_key(); }	   	   /*                        */
@@ -1911,7 +2009,7 @@ static void eval__special(sb,kn,rec)		   /*			     */
   fmt = ( NodePre(kn) == KEYSTYLE_LONG ? 1 : 0 );  /*                        */
   NameStrip(format[fmt]) = NodePost(kn);	   /*                        */
     					   	   /*			     */
-  IfGetField(s, s_author)			   /*			     */
+  IfGetField(s, st->s_author)			   /*			     */
   { fmt_names(sb,				   /*                        */
 	      SymbolValue(s),			   /*                        */
 	      2,				   /*                        */
@@ -1919,7 +2017,7 @@ static void eval__special(sb,kn,rec)		   /*			     */
 	      trans_lower);	   		   /*                        */
     missing = false;				   /*			     */
   }						   /*			     */
-  else IfGetField(s, s_editor)			   /*			     */
+  else IfGetField(s, st->s_editor)		   /*                        */
   { fmt_names(sb,				   /*                        */
 	      SymbolValue(s),			   /*                        */
 	      2,				   /*                        */
@@ -1928,7 +2026,7 @@ static void eval__special(sb,kn,rec)		   /*			     */
     missing = false;				   /*			     */
   }						   /*			     */
 						   /*			     */
-  IfGetField(s, s_title)			   /*			     */
+  IfGetField(s, st->s_title)			   /*			     */
   { (void)sbputs((char*)SymbolValue(NameTitleSep), /*                        */
 		 sb);	   			   /*			     */
     fmt_title(sb,				   /*                        */
@@ -1940,7 +2038,7 @@ static void eval__special(sb,kn,rec)		   /*			     */
 	      TitleTitleSep);			   /*		             */
     missing = false;				   /*			     */
   }						   /*			     */
-  else IfGetField(s, s_booktitle)		   /*			     */
+  else IfGetField(s, st->s_booktitle)		   /*			     */
   { (void)sbputs((char*)SymbolValue(NameTitleSep), /*                        */
 		 sb);	   			   /*			     */
     fmt_title(sb,				   /*                        */
@@ -1955,7 +2053,7 @@ static void eval__special(sb,kn,rec)		   /*			     */
 						   /*			     */
   if (missing)				   	   /*			     */
   { sbrewind(sb);				   /*			     */
-    IfGetField(s, s_key)			   /*			     */
+    IfGetField(s, st->s_key)			   /*			     */
     { fmt_title(sb,				   /*                        */
 		SymbolValue(s),			   /*                        */
 		1,				   /*                        */
@@ -1987,27 +2085,26 @@ int apply_fmt(sb,fmt,rec,db)			   /*                        */
   char	         *fmt;				   /*                        */
   Record         rec;				   /*                        */
   DB	         db;				   /*                        */
-{ static char    *old_fmt = NULL;		   /*                        */
-  static KeyNode old_kn   = (KeyNode)0;		   /*                        */
+{ SKeyState	 *st = KeyState;		   /*                        */
  						   /*                        */
-  if (   old_fmt == NULL			   /* This is the first time */
-      || strcmp(fmt,old_fmt) != 0 )		   /*   or the format needs  */
+  if (   st->old_fmt == NULL			   /* This is the first time */
+      || strcmp(fmt,st->old_fmt) != 0 )		   /*   or the format needs  */
   {						   /*   recompilation.       */
     key_init();					   /*                        */
-    if ( old_fmt != NULL )			   /*                        */
-    { free(old_fmt);				   /*                        */
-      free_key_node(old_kn);			   /*                        */
-      old_kn = (KeyNode)0;			   /*                        */
+    if ( st->old_fmt != NULL )			   /*                        */
+    { free(st->old_fmt);			   /*                        */
+      free_key_node(st->old_kn);		   /*                        */
+      st->old_kn = (KeyNode)0;			   /*                        */
     }						   /*                        */
  						   /*                        */
-    old_fmt = new_string(fmt);			   /*                        */
-    if ( !add_fmt_tree(old_fmt, &old_kn) )	   /*                        */
-    { free(old_fmt);				   /*                        */
-      old_fmt = NULL;				   /*                        */
+    st->old_fmt = new_string(fmt);		   /*                        */
+    if ( !add_fmt_tree(st->old_fmt, &st->old_kn) ) /*                        */
+    { free(st->old_fmt);			   /*                        */
+      st->old_fmt = NULL;			   /*                        */
       return 1;					   /*                        */
     }						   /*                        */
   }						   /*                        */
-  return eval_fmt(sb, old_kn, rec, db);		   /*                        */
+  return eval_fmt(sb, st->old_kn, rec, db);	   /*                        */
 }						   /*------------------------*/
 
 /*-----------------------------------------------------------------------------
@@ -2257,8 +2354,8 @@ static void show_fmt(kn,in)			   /*			     */
 #endif
 
 
- static Symbol sym_user = NO_SYMBOL;
- static Symbol sym_host = NO_SYMBOL;
+#define sym_user (KeyState->sym_user)
+#define sym_host (KeyState->sym_host)
 
 /*-----------------------------------------------------------------------------
 ** Function:	get_field()
@@ -2282,17 +2379,15 @@ Symbol get_field(db,rec,name)		   	   /*			     */
   Symbol sym;					   /*                        */
   DebugPrint2("get_field ", s);		   	   /*                        */
 #ifdef HAVE_TIME_H
-  static struct tm *tp;				   /*                        */
-  static time_t the_time = 0;			   /*                        */
-  static char buffer[32];			   /*                        */
+  SKeyState *st = KeyState;			   /*                        */
  						   /*                        */
-  if ( the_time == 0 )				   /*                        */
-  { the_time = time(NULL);			   /*                        */
-    tp = localtime(&the_time);			   /*                        */
+  if ( st->the_time == 0 )			   /*                        */
+  { st->the_time = time(NULL);			   /*                        */
+    st->the_tm	 = *localtime(&st->the_time);	   /*                        */
   }						   /*                        */
-#define ReturnTime(F) if ( the_time > 0 )	\
-  { (void)strftime(buffer,32,F,tp);		\
-    return symbol((String)buffer); }		\
+#define ReturnTime(F) if ( st->the_time > 0 )	\
+  { (void)strftime(st->time_buf,32,F,&st->the_tm);\
+    return symbol((String)st->time_buf); }	\
   LinkSymbol(sym_empty); return sym_empty
 #else
 #define ReturnTime(F) return sym_empty
@@ -2416,29 +2511,27 @@ Symbol get_field(db,rec,name)		   	   /*			     */
 	 count >= 0;				   /*                        */
 	 count-- )				   /* Prevent infinite loop  */
     {						   /*                        */
-      xref = NO_SYMBOL;				   /*                        */
-      for (cpp = RecordHeap(rec), n = RecordFree(rec);/*	             */
-	   n > 0;				   /*			     */
-	   n -= 2 )				   /*			     */
+      cpp = RecordHeap(rec);			   /*                        */
+      if ( RecordFree(rec) > 0 && *cpp == name )   /* string record          */
+      { n = 0; }				   /*                        */
+      else					   /*                        */
+      { n = record_slot(rec, name); }		   /* use the field index    */
+ 						   /*                        */
+      if ( n >= 0 && cpp[n+1] != NO_SYMBOL )	   /*                        */
       {						   /*                        */
-	if ( *cpp == name && *(cpp+1) != NO_SYMBOL )/*                       */
-	{					   /*                        */
-	  sym = ( rsc_key_expand_macros	   	   /*                        */
-		  ? expand_rhs(*(cpp+1),	   /*                        */
-			       sym_open_brace,	   /*                        */
-			       sym_close_brace,    /*                        */
-			       db,		   /*                        */
-			       false)		   /*                        */
-		  : *(cpp+1) );		   	   /*			     */
-	  LinkSymbol(sym);		   	   /*                        */
-	  return sym;				   /*                        */
-	}					   /*                        */
+	sym = ( rsc_key_expand_macros	   	   /*                        */
+		? expand_rhs(cpp[n+1],		   /*                        */
+			     sym_open_brace,	   /*                        */
+			     sym_close_brace,	   /*                        */
+			     db,		   /*                        */
+			     false)		   /*                        */
+		: cpp[n+1] );			   /*                        */
+	LinkSymbol(sym);			   /*                        */
+	return sym;				   /*                        */
+      }						   /*                        */
  						   /*                        */
-        if ( *cpp == sym_crossref )		   /*                        */
-	{ xref = *++cpp; }			   /*                        */
-	else cpp++;				   /*                        */
-        cpp++;			   	   	   /*			     */
-      }					   	   /*			     */
+      n	   = record_slot(rec, sym_crossref);	   /*                        */
+      xref = (n < 0 ? NO_SYMBOL : cpp[n+1]);	   /*                        */
        						   /*                        */
       if ( xref == NO_SYMBOL ) return NO_SYMBOL;   /* No crossref field found*/
       xref = expand_rhs(xref,			   /*                        */
@@ -2564,3 +2657,34 @@ bool set_field(db,rec,name,value)		   /*			     */
  						   /*                        */
   return true;				   	   /* Nothing found.	     */
 }						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	key_free()
+** Type:	void
+** Purpose:	Release the memory held by the state of the key
+**		generation. The state belongs to the current context.
+** Arguments:
+**	state	the state
+** Returns:	nothing
+**___________________________________________________			     */
+static void key_free(state)			   /*                        */
+  void *state;					   /*                        */
+{ SKeyState *st = (SKeyState*)state;		   /*                        */
+  int	    i;					   /*                        */
+ 						   /*                        */
+  if (key_sb) (void)sbclose(key_sb);		   /*                        */
+  if (tmp_sb) (void)sbclose(tmp_sb);		   /*                        */
+  free_key_node(key_tree);			   /*                        */
+  free_key_node(sort_key_tree);			   /*                        */
+  free_key_node(st->old_kn);			   /*                        */
+  if (st->old_fmt) free(st->old_fmt);		   /*                        */
+  for (i = 0; i < NUMBER_OF_FORMATS; i++)	   /*                        */
+  { free_name_node(format[i]); }		   /*                        */
+  for (i = 0; i < 32; i++)			   /*                        */
+  { free_words(&ignored_words[i], NULL); }	   /*                        */
+  if (words)	       free(words);		   /*                        */
+  if (key_seps)	       free(key_seps);		   /*                        */
+  if (st->detex_buf)   free(st->detex_buf);	   /*                        */
+  if (old_keys.ks_tab) free(old_keys.ks_tab);	   /*                        */
+  if (tmp_rec)	       free_record(tmp_rec);	   /*                        */
+}						   /*------------------------*/
@@ -35,13 +35,71 @@
 /* Internal Programs                                                         */
 /*===========================================================================*/
 
+#ifdef __STDC__
+#define _ARG(A) A
+#else
+#define _ARG(A) ()
+#endif
+ static void macro_free _ARG((void *state));	   /* macros.c               */
+
 /*****************************************************************************/
 /* External Programs                                                         */
 /*===========================================================================*/
 
 /*---------------------------------------------------------------------------*/
 
- static Macro macros = MacroNULL;		   /*                        */
+/*-----------------------------------------------------------------------------
+** Typedef*:	SMacroState
+** Purpose:	The state of the macros module in a context. It
+**		contains the macros, the items, and the keys defined.
+**___________________________________________________			     */
+ typedef struct					   /*                        */
+ { Macro	macros;				   /* the macros             */
+   Macro	items;				   /* the appearance of fields*/
+   Macro	keys;				   /* the appearance of keys */
+   StringBuffer *macro_sb;			   /*                        */
+ } SMacroState;					   /*                        */
+
+/*-----------------------------------------------------------------------------
+** Variable*:	macro_state0
+** Type:	SMacroState
+** Purpose:	The initial state of the macros module in a context. No
+**		macros are defined.
+**___________________________________________________			     */
+ static SMacroState macro_state0 =		   /*                        */
+ { MacroNULL,					   /*                        */
+   MacroNULL,					   /*                        */
+   MacroNULL,					   /*                        */
+   (StringBuffer*)NULL				   /*                        */
+ };						   /*                        */
+
+#define MacroState ((SMacroState*)CtxGet(CTX_MACROS,			\
+					 ctx_state(CTX_MACROS,		\
+						   (void*)&macro_state0,\
+						   sizeof(macro_state0),\
+						   macro_free)))
+
+#define macros (MacroState->macros)
+#define items  (MacroState->items)
+#define keys   (MacroState->keys)
+
+/*-----------------------------------------------------------------------------
+** Function*:	macro_free()
+** Type:	void
+** Purpose:	Release the macros, items, and keys when a context is
+**		released.
+** Arguments:
+**	state	the state
+** Returns:	nothing
+**___________________________________________________			     */
+static void macro_free(state)			   /*                        */
+  void *state;					   /*                        */
+{ POSSIBLY_UNUSED(state);			   /*                        */
+  free_macro(macros);				   /*                        */
+  free_macro(items);				   /*                        */
+  free_macro(keys);				   /*                        */
+  if (MacroState->macro_sb) (void)sbclose(MacroState->macro_sb);/*           */
+}						   /*------------------------*/
 
 /*-----------------------------------------------------------------------------
 ** Function:	new_macro()
@@ -298,8 +356,6 @@ void init_macros()				   /*                        */
 /***									   ***/
 /*****************************************************************************/
 
- static Macro items = MacroNULL;		
-
 /*-----------------------------------------------------------------------------
 ** Function*:	def_item()
 ** Purpose:	Define a macro. The arguments have to be symbols.
@@ -366,7 +422,7 @@ static Symbol get_mapped_or_cased(name, mac, type) /*                        */
   Symbol	 name;				   /*                        */
   int            type;				   /*                        */
   register Macro mac;				   /*                        */
-{ static StringBuffer* sb = (StringBuffer*)NULL;   /*                        */
+{ StringBuffer	 *sb;				   /*                        */
   register String s;	   			   /*                        */
  						   /*                        */
   for ( ; mac != MacroNULL; mac = NextMacro(mac) ) /*                        */
@@ -377,8 +433,8 @@ static Symbol get_mapped_or_cased(name, mac, type) /*                        */
     }						   /*                        */
   }						   /*                        */
  						   /*                        */
-  if (sb == NULL)				   /*                        */
-  { if ((sb=sbopen()) == NULL)	   		   /*                        */
+  if ((sb = MacroState->macro_sb) == NULL)	   /*                        */
+  { if ((sb=MacroState->macro_sb=sbopen()) == NULL)/*                        */
     { OUT_OF_MEMORY("get_item()"); } 		   /*                        */
   } else 					   /*                        */
   { sbrewind(sb); }				   /*                        */
@@ -440,8 +496,6 @@ Symbol get_item(name, type)			   /*                        */
 /***									   ***/
 /*****************************************************************************/
 
- static Macro keys = MacroNULL;			   /*                        */
-
 /*-----------------------------------------------------------------------------
 ** Function:	save_key()
 ** Purpose:	Save a mapping of a lower-case key to a printed
@@ -66,6 +66,9 @@
 #include <bibtool/crossref.h>
 #include <bibtool/check.h>
 #include <bibtool/io.h>
+#include <bibtool/stats.h>
+#include <bibtool/watch.h>
+#include <bibtool/server.h>
 #ifdef HAVE_LIBKPATHSEA
 #ifdef __STDC__
 #define HAVE_PROTOTYPES
@@ -86,12 +89,25 @@
  int main _ARG((int argc,char *argv[]));	   /* main.c                 */
  static bool do_keys _ARG((DB db,Record rec));	   /* main.c                 */
  static bool do_no_keys _ARG((DB db,Record rec));  /* main.c                 */
+ static char * all_needed _ARG((bool sortp));	   /* main.c                 */
+ static bool stream_possible _ARG((bool sortp));   /* main.c                 */
+ static char *output_spec _ARG((void));		   /* main.c                 */
+ static FILE *open_output _ARG((void));		   /* main.c                 */
+ static void stream_in_files _ARG((DB db));	   /* main.c                 */
+ static void stream_record _ARG((DB db));	   /* main.c                 */
+ static void sort_in_files _ARG((DB db, int (*less)_ARG((Record, Record))));/* main.c*/
+ static void spill_record _ARG((DB db));	   /* main.c                 */
  static bool update_crossref _ARG((DB db,Record rec));/* main.c              */
  static int rec_gt _ARG((Record r1,Record r2));	   /* main.c                 */
  static int rec_gt_cased _ARG((Record r1,Record r2));/* main.c               */
  static int rec_lt _ARG((Record r1,Record r2));	   /* main.c                 */
  static int rec_lt_cased _ARG((Record r1,Record r2));/* main.c               */
  static void usage _ARG((bool fullp));		   /* main.c                 */
+ static void process_db _ARG((DB the_db, int (*fct)_ARG((Record, Record)), bool writep));/* main.c*/
+ static void print_statistics _ARG((void));	   /* main.c                 */
+ static bool watch_record _ARG((DB db,Record rec));/* main.c                 */
+ static void watch_write _ARG((DB db, int (*less)_ARG((Record, Record))));/* main.c*/
+ static void watch_process _ARG((DB db, int (*less)_ARG((Record, Record))));/* main.c*/
 
 /*****************************************************************************/
 /* External Programs and Variables					     */
@@ -327,7 +343,8 @@ static void write_macros(m_file, the_db)	   /*                        */
 ** Type:	void
 ** Purpose:	Read all the files in the input file pipe.
 **		Note that additional files can be pushed during this
-**		function is active.
+**		function is active. Crossref targets skipped due to
+**		|extract.fast| are picked up in additional passes.
 ** Arguments:
 **	db	the database
 ** Returns:	nothing
@@ -342,48 +359,478 @@ static void read_in_files(db)		   	   /*                        */
     if (read_db(db, SymbolValue(in), rsc_verbose)) /*                        */
     { NoFileError(in); }			   /*			     */
   }						   /*			     */
+						   /*                        */
+  while (aux_rescan())				   /* Pick up skipped        */
+  { for (i = 0; i < get_no_inputs(); i++)	   /*  crossref targets      */
+    { (void)read_db(db,				   /*                        */
+		    SymbolValue(get_input_file(i)),/*                        */
+		    rsc_verbose);		   /*                        */
+    }						   /*                        */
+  }						   /*                        */
 }						   /*------------------------*/
 
 /*-----------------------------------------------------------------------------
-** Function*:	write_output()
-** Type:	void
-** Purpose:	
-**		
-** Arguments:
-**	db	the database
-** Returns:	nothing
+** Function*:	open_output()
+** Type:	FILE*
+** Purpose:	Open the output file. If none is given or it can not
+**		be opened then |stdout| is used.
+** Arguments:	none
+** Returns:	The output file or |NULL| if the output is suppressed.
 **___________________________________________________			     */
-static void write_output(db)		   	   /*                        */
-  DB db;					   /*                        */
+static FILE *open_output()			   /*                        */
 { FILE  *file;				   	   /*                        */
   Symbol o_file = get_output_file();		   /*                        */
  						   /*                        */
   if (o_file == NO_SYMBOL)		   	   /*                        */
   { file = stdout; }				   /*                        */
   else if (*o_file == '\0')		   	   /*                        */
-  { return; }					   /*                        */
+  { return NULL; }				   /*                        */
   else if ((file=fopen((char*)SymbolValue(o_file),"w")) == NULL)/*           */
   { file = stdout;				   /*                        */
   }						   /*                        */
+  return file;					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	output_spec()
+** Type:	char*
+** Purpose:	Determine the specification of the entry types to be
+**		printed. If macros are expanded then no strings are
+**		printed.
+** Arguments:	none
+** Returns:	A newly allocated string which should be freed
+**		afterwards.
+**___________________________________________________			     */
+static char *output_spec()			   /*                        */
+{ char * print_spec;				   /*                        */
+  char * cp;					   /*                        */
+ 						   /*                        */
+  print_spec = new_string((char*)rsc_print_et);	   /*                        */
+  if (rsc_expand_macros)			   /*                        */
+  { for (cp=print_spec; *cp; cp++)		   /*                        */
+    { if (*cp == 's' ||				   /*                        */
+	  *cp == 'S' ||				   /*                        */
+	  *cp == '$' ) *cp = ' ';		   /*                        */
+    }						   /*                        */
+  }						   /*                        */
+  return print_spec;				   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	write_output()
+** Type:	void
+** Purpose:	Print the database to the output file.
+** Arguments:
+**	db	the database
+** Returns:	nothing
+**___________________________________________________			     */
+static void write_output(db)		   	   /*                        */
+  DB db;					   /*                        */
+{ FILE  *file;				   	   /*                        */
+  char  *print_spec;				   /*                        */
+ 						   /*                        */
+  if ((file = open_output()) == NULL) return;	   /*                        */
  						   /*                        */
   if (rsc_select) { rsc_del_q = false; }	   /*                        */
  						   /*                        */
-  { char * print_spec = (char*)rsc_print_et;	   /*                        */
+  print_spec = output_spec();			   /*                        */
+  print_db(file, db, print_spec);	   	   /*                        */
+  free(print_spec);				   /*                        */
+ 						   /*                        */
+  if (file != stdout) { fclose(file); }	   	   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	all_needed()
+** Type:	char*
+** Purpose:	Find a requested feature which needs to see all
+**		records. Otherwise each record can be processed as
+**		soon as it has been read.
+** Arguments:
+**	sortp	indicator whether the sorting and the check for
+**		double entries are done on all records afterwards
+** Returns:	the name of the feature or |NULL|.
+**___________________________________________________			     */
+static char * all_needed(sortp)			   /*                        */
+  bool sortp;					   /*                        */
+{						   /*                        */
+  return (rsc_sort && !sortp	  ? "sort"	   /*                        */
+	  : rsc_make_key	  ? "key.generation"/*                       */
+	  : rsc_double_check && !sortp ? "check.double"/*                    */
+	  : sortp && sort_key_inherits() ? "sort.format"/*                   */
+	  : have_unique_fields()  ? "unique.field" /*                        */
+	  : rsc_expand_crossref	  ? "expand.crossref"/*                      */
+	  : rsc_expand_xdata	  ? "expand.xdata" /*                        */
+	  : rsc_xref_select	  ? "select.crossrefs"/*                     */
+	  : rsc_apply_alias	  ? "apply.alias"  /*                        */
+	  : rsc_apply_modify	  ? "apply.modify" /*                        */
+	  : aux_selecting()	  ? "the aux file" /*                        */
+	  : !rsc_all_macs	  ? "print.all.strings"/*                    */
+	  : rsc_cnt_all		  ? "count.all"	   /*                        */
+	  : rsc_cnt_used	  ? "count.used"   /*                        */
+	  : get_macro_file()	  ? "the macro file"/*                       */
+	  : NULL);				   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	stream_possible()
+** Type:	bool
+** Purpose:	Check whether the records can be streamed; i.e. each
+**		record can be printed as soon as it has been read and
+**		rewritten. This is not the case if any of the
+**		requested features needs to see all records. Then a
+**		warning is issued.
+**
+**		When sorting with a memory limit or merging sorted
+**		files each record is processed right after reading as
+**		well. The sorting and the check for double entries
+**		need all records then. They are done by merging the
+**		runs.
+** Arguments:
+**	sortp	indicator whether the records are sorted
+** Returns:	|true| iff streaming is possible.
+**___________________________________________________			     */
+static bool stream_possible(sortp)		   /*                        */
+  bool sortp;					   /*                        */
+{ char *need = all_needed(sortp);		   /*                        */
+ 						   /*                        */
+  if (need == NULL) return true;		   /*                        */
  						   /*                        */
-    if (rsc_expand_macros)			   /*                        */
-    { char * cp;				   /*                        */
-      print_spec = new_string(print_spec);	   /*                        */
-      for (cp=print_spec; *cp; cp++)		   /*                        */
-      { if (*cp == 's' ||			   /*                        */
-	    *cp == 'S' ||			   /*                        */
-	    *cp == '$' ) *cp = ' ';		   /*                        */
-      }						   /*                        */
+  WARNING3((String)(sortp			   /*                        */
+		   ? "Sorting in memory: "	   /*                        */
+		   : "Streaming disabled: "),	   /*                        */
+	   need,				   /*                        */
+	   " needs all records.");		   /*                        */
+  return false;					   /*                        */
+}						   /*------------------------*/
+
+ static FILE *stream_file = NULL;
+ static char *stream_spec = NULL;
+
+/*-----------------------------------------------------------------------------
+** Function*:	stream_record()
+** Type:	void
+** Purpose:	Process the records just read into the database.
+**		A normal record is selected, rewritten and sorted. Then
+**		everything is printed and the database is emptied
+**		again. This function is installed as record hook of
+**		|read_db()|.
+** Arguments:
+**	db	the database
+** Returns:	nothing
+**___________________________________________________			     */
+static void stream_record(db)			   /*                        */
+  DB db;					   /*                        */
+{ Record rec = DBnormal(db);			   /*                        */
+ 						   /*                        */
+  if (rec != RecordNULL)			   /*                        */
+  { (void)keep_selected(db, rec);		   /*                        */
+    if (!RecordIsDELETED(rec))			   /* The keys are not       */
+    { rewrite_record(db, rec);			   /*  remembered since no   */
+      sort_record(rec);				   /*  keys are generated.   */
     }						   /*                        */
-    print_db(file, db, print_spec);	   	   /*                        */
-    if (rsc_expand_macros) free(print_spec);	   /*                        */
   }						   /*                        */
+  if (stream_file != NULL)			   /*                        */
+  { print_db(stream_file, db, stream_spec); }	   /*                        */
+  db_clear(db);					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	stream_in_files()
+** Type:	void
+** Purpose:	Read all input files and print each record as soon
+**		as it has been processed. Only the record at hand is
+**		kept in memory.
+** Arguments:
+**	db	the database
+** Returns:	nothing
+**___________________________________________________			     */
+static void stream_in_files(db)			   /*                        */
+  DB db;					   /*                        */
+{						   /*                        */
+  stream_file = open_output();			   /*                        */
+  if (rsc_select) { rsc_del_q = false; }	   /*                        */
+  stream_spec = output_spec();			   /*                        */
  						   /*                        */
-  if (file != stdout) { fclose(file); }	   	   /*                        */
+  set_record_hook(stream_record);		   /*                        */
+  read_in_files(db);				   /*                        */
+  set_record_hook(NULL);			   /*                        */
+ 						   /*                        */
+  free(stream_spec);				   /*                        */
+  if (stream_file != NULL && stream_file != stdout)/*                        */
+  { fclose(stream_file); }			   /*                        */
+}						   /*------------------------*/
+
+ static int  (*sort_less)_ARG((Record, Record)) = NULL;
+ static long sort_bytes = 0L;
+ static Record sort_last = RecordNULL;
+ static bool sort_spilled = false;
+
+/*-----------------------------------------------------------------------------
+** Function*:	spill_record()
+** Type:	void
+** Purpose:	Process a normal record just read into the database.
+**		It is selected, rewritten, and gets its sort key. When
+**		the records collected exceed \rsc{sort.memory.limit}
+**		kilobytes they are written as a sorted run. With
+**		\rsc{sort.merge} each record is written at once. It
+**		continues the current run as long as the input is
+**		sorted. This function is installed as record hook of
+**		|read_db()|.
+** Arguments:
+**	db	the database
+** Returns:	nothing
+**___________________________________________________			     */
+static void spill_record(db)			   /*                        */
+  DB db;					   /*                        */
+{ Record rec = DBnormal(db);			   /*                        */
+  int	 i;					   /*                        */
+ 						   /*                        */
+  if (rec == RecordNULL || rec == sort_last) return;/*                       */
+  sort_last = rec;				   /*                        */
+ 						   /*                        */
+  (void)keep_selected(db, rec);			   /*                        */
+  if (!RecordIsDELETED(rec))			   /*                        */
+  { rewrite_record(db, rec);			   /*                        */
+    sort_record(rec);				   /*                        */
+    make_sort_key(db, rec);			   /*                        */
+  }						   /*                        */
+ 						   /*                        */
+  sort_bytes += sizeof(SRecord) + RecordSize(rec) * sizeof(Symbol);/*        */
+  for (i = 1; i < RecordFree(rec); i += 2)	   /*                        */
+  { if (RecordHeap(rec)[i] != NO_SYMBOL)	   /*                        */
+    { sort_bytes += strlen((char*)SymbolValue(RecordHeap(rec)[i])) + 1; }/*  */
+  }						   /*                        */
+  if (rsc_sort_merge ||				   /* Sorted input is        */
+      sort_bytes > 1024L * rsc_sort_memory)	   /*  written at once.      */
+  { db_spill(db, sort_less);			   /*                        */
+    sort_last	 = RecordNULL;			   /*                        */
+    sort_bytes	 = 0L;				   /*                        */
+    sort_spilled = true;			   /*                        */
+  }						   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	sort_in_files()
+** Type:	void
+** Purpose:	Read all input files and sort the normal records with
+**		at most \rsc{sort.memory.limit} kilobytes of records in
+**		memory. The records are sorted in batches which are
+**		written to temporary files. These runs are merged when
+**		the database is printed. With \rsc{sort.merge} the
+**		records are not kept at all. Each sorted input file
+**		becomes one run.
+** Arguments:
+**	db	the database
+**	less	the comparison
+** Returns:	nothing
+**___________________________________________________			     */
+static void sort_in_files(db, less)		   /*                        */
+  DB  db;					   /*                        */
+  int (*less)_ARG((Record, Record));		   /*                        */
+{						   /*                        */
+  sort_less = less;				   /*                        */
+  set_record_hook(spill_record);		   /*                        */
+  read_in_files(db);				   /*                        */
+  set_record_hook(NULL);			   /*                        */
+ 						   /*                        */
+  db_sort(db, less);				   /*                        */
+  if (rsc_srt_macs) { db_mac_sort(db); }	   /*                        */
+  if (!sort_spilled) { apply_checks(db); }	   /* Otherwise when merging */
+  write_output(db);				   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	process_db()
+** Type:	void
+** Purpose:	Process the records read into the database and write
+**		the results. The records are selected, the
+**		cross-references are expanded, the keys are generated,
+**		and the records are sorted and checked. Finally the
+**		output, the macro file, and the statistics are
+**		written unless the database is kept for serving
+**		requests.
+** Arguments:
+**	the_db	the database
+**	fct	the comparison for sorting
+**	writep	indicator whether the results are written
+** Returns:	nothing
+**___________________________________________________			     */
+static void process_db(the_db, fct, writep)	   /*                        */
+  DB	the_db;					   /*                        */
+  int	(*fct)_ARG((Record, Record));		   /* Function pointer	     */
+  bool	writep;					   /*                        */
+{ int	c_len;					   /*                        */
+  int   *c = NULL;				   /*                        */
+ 						   /*                        */
+  stat_phase("select");				   /*                        */
+  if (!select_parallel(the_db))			   /*                        */
+  { db_forall(the_db, keep_selected); }		   /*                        */
+						   /*                        */
+  stat_phase("aux");				   /*                        */
+  apply_aux(the_db);				   /*                        */
+ 						   /*                        */
+  stat_phase("crossref");			   /*                        */
+  if (rsc_xref_select) db_xref_undelete(the_db);   /*                        */
+ 						   /*                        */
+  if (rsc_cnt_all || rsc_cnt_used)		   /*			     */
+  { int i;					   /*                        */
+    int * cnt = db_count(the_db,&c_len);	   /*                        */
+ 						   /*                        */
+    if ((c=(int*)malloc(c_len*sizeof(int))) == NULL)/*                       */
+    { rsc_cnt_all = rsc_cnt_used = 0; }		   /*                        */
+    else					   /*                        */
+    { for (i = 0; i < c_len; i++) c[i] = cnt[i];   /*                        */
+    }						   /*                        */
+  }						   /*                        */
+						   /*			     */
+  if (rsc_expand_crossref || rsc_expand_xdata)     /*                        */
+  {						   /*			     */
+    expand_crossrefs(the_db);			   /*                        */
+  }						   /*			     */
+						   /*			     */
+  stat_phase("keys");				   /*                        */
+  if (rsc_sort || rsc_make_key || need_sort_key) { /*                        */
+    DebugPrint1("start keygen");		   /*                        */
+    start_key_gen();				   /*                        */
+  }						   /*                        */
+						   /*			     */
+  if (rsc_make_key)		   		   /*                        */
+  {						   /*                        */
+    if (rsc_key_preserve)	   		   /*                        */
+    { db_forall(the_db, mark_key); }		   /*                        */
+						   /*			     */
+    DebugPrint1("rewinding");			   /*                        */
+    db_rewind(the_db);				   /*                        */
+						   /*                        */
+    DebugPrint1("do_keys");			   /*                        */
+    db_forall(the_db, do_keys);		   	   /*                        */
+						   /*                        */
+    DebugPrint1("update crossref");		   /*                        */
+    db_forall(the_db, update_crossref);	   	   /*                        */
+						   /*                        */
+    DebugPrint1("end keygen");			   /*                        */
+    end_key_gen();				   /*                        */
+  }						   /*                        */
+  else						   /*                        */
+  {						   /*                        */
+    db_forall(the_db,do_no_keys);		   /*                        */
+  }						   /*                        */
+ 						   /*                        */
+  stat_phase("sort");				   /*                        */
+  if (rsc_sort)				   	   /*                        */
+  { db_sort(the_db, fct); }			   /*                        */
+ 						   /*                        */
+  if (rsc_srt_macs)		   	   	   /* Maybe sort macros      */
+  { db_mac_sort(the_db); }			   /*                        */
+ 						   /*                        */
+  stat_phase("check");				   /*                        */
+  apply_checks(the_db);				   /*                        */
+  if (!writep)					   /*                        */
+  { if (c) free(c);				   /*                        */
+    stat_phase(NULL);				   /*                        */
+    return;					   /*                        */
+  }						   /*                        */
+ 						   /*                        */
+  stat_phase("write");				   /*                        */
+  write_output(the_db);				   /*                        */
+						   /*			     */
+  write_macros(get_macro_file(), the_db);	   /*                        */
+						   /*			     */
+  if (rsc_cnt_all || rsc_cnt_used)		   /*			     */
+  { int i;					   /*                        */
+    int *cnt = db_count(the_db, (int*)NULL);	   /*                        */
+						   /*                        */
+    ErrC('\n');		   	   	   	   /*			     */
+    for (i = 0; i < c_len; ++i)			   /*			     */
+    { if (rsc_cnt_all || c[i] > 0)	   	   /*			     */
+      { ErrPrintF3("---  %-15s %5d read  %5d written\n",/*		     */
+		   SymbolValue(get_entry_type(i)), /*			     */
+		   c[i],		   	   /*			     */
+		   cnt[i]);		   	   /*			     */
+      }						   /*			     */
+    }						   /*			     */
+    free(c);					   /*                        */
+  }						   /*                        */
+  stat_phase(NULL);				   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	print_statistics()
+** Type:	void
+** Purpose:	Print the times of the phases and the counters onto
+**		the error stream if requested by the resource
+**		|print.statistics.timing|. The value |json| selects a
+**		JSON object. The empty value and |off| suppress the
+**		output. Any other value selects a table. Afterwards
+**		the most expensive rules are printed if the resource
+**		|print.statistics.rules| is positive.
+** Arguments:	none
+** Returns:	nothing
+**___________________________________________________			     */
+static void print_statistics()			   /*                        */
+{ String s = (String)rsc_print_timing;		   /*                        */
+ 						   /*                        */
+  if (s != StringNULL && *s != '\0' &&		   /*                        */
+      !case_eq(s, (String)"off"))		   /*                        */
+  { stat_print(stderr, case_eq(s, (String)"json")); }/*                      */
+  if (rsc_print_rules > 0)			   /*                        */
+  { print_rule_profile(stderr, rsc_print_rules); } /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	watch_record()
+** Type:	bool
+** Purpose:	Process a normal record just read in watch mode. It is
+**		selected, rewritten, and gets its sort key.
+** Arguments:
+**	db	the database
+**	rec	the record
+** Returns:	|false|
+**___________________________________________________			     */
+static bool watch_record(db, rec)		   /*                        */
+  DB	 db;					   /*                        */
+  Record rec;					   /*                        */
+{ (void)keep_selected(db, rec);			   /*                        */
+  if (!RecordIsDELETED(rec)) { (void)do_no_keys(db, rec); }/*                */
+  return false;					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	watch_write()
+** Type:	void
+** Purpose:	Merge the sorted records of all files in watch mode,
+**		check them, and write them. They have been processed
+**		by |watch_record()| already.
+** Arguments:
+**	db	the database
+**	less	the comparison for sorting
+** Returns:	nothing
+**___________________________________________________			     */
+static void watch_write(db, less)		   /*                        */
+  DB	 db;					   /*                        */
+  int	 (*less)_ARG((Record, Record));		   /*                        */
+{ if (rsc_sort) { db_sort(db, less); }		   /*                        */
+  if (rsc_srt_macs) { db_mac_sort(db); }	   /*                        */
+  apply_checks(db);				   /*                        */
+  write_output(db);				   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	watch_process()
+** Type:	void
+** Purpose:	Process and write the records of all files in watch
+**		mode if some requested feature needs to see all
+**		records.
+** Arguments:
+**	db	the database
+**	less	the comparison for sorting
+** Returns:	nothing
+**___________________________________________________			     */
+static void watch_process(db, less)		   /*                        */
+  DB	 db;					   /*                        */
+  int	 (*less)_ARG((Record, Record));		   /*                        */
+{ process_db(db, less, true);			   /*                        */
 }						   /*------------------------*/
 
 #define Toggle(X) X = !(X)
@@ -415,11 +862,10 @@ int main(argc,argv)				   /*			     */
   int	i;				   	   /*			     */
   bool	need_rsc = true;		   	   /*			     */
   int	(*fct)(Record, Record);			   /* Function pointer	     */
-  int	c_len;					   /*                        */
-  int   *c = NULL;				   /*                        */
  						   /*                        */
   init_error(stderr);				   /*                        */
   init_bibtool(argv[0]);			   /*                        */
+  stat_phase("init");				   /*                        */
 						   /*			     */
   for (i = 1; i < argc; i++)			   /*			     */
   { char *ap;				   	   /*			     */
@@ -500,101 +946,67 @@ int main(argc,argv)				   /*			     */
 						   /*			     */
   if (need_rsc) { (void)search_rsc(); }	   	   /*			     */
 						   /*			     */
-  if (get_no_inputs() == 0)			   /* If no input file given */
+  if (get_no_inputs() == 0 && !*rsc_server)	   /* If no input file given */
   { save_input_file(symbol((String)"-")); }	   /*  then read from stdin  */
 						   /*			     */
   init_read();					   /* Just in case the path  */
  						   /*  has been modified.    */
   the_db = new_db();				   /*                        */
 						   /*			     */
-  read_in_files(the_db);			   /*                        */
- 						   /*                        */
-  db_forall(the_db, keep_selected);		   /*                        */
-						   /*                        */
-  apply_aux(the_db);				   /*                        */
- 						   /*                        */
-  if (rsc_xref_select) db_xref_undelete(the_db);   /*                        */
- 						   /*                        */
-  if (rsc_cnt_all || rsc_cnt_used)		   /*			     */
-  { int i;					   /*                        */
-    int * cnt = db_count(the_db,&c_len);	   /*                        */
+  if (rsc_sort_cased)			   	   /*                        */
+  { if (rsc_sort_reverse) fct = rec_lt_cased;	   /*                        */
+    else		  fct = rec_gt_cased;	   /*                        */
+  }						   /*                        */
+  else					   	   /*                        */
+  { if (rsc_sort_reverse) fct = rec_lt;	   	   /*                        */
+    else		  fct = rec_gt;		   /*                        */
+  }						   /*                        */
  						   /*                        */
-    if ((c=(int*)malloc(c_len*sizeof(int))) == NULL)/*                       */
-    { rsc_cnt_all = rsc_cnt_used = 0; }		   /*                        */
-    else					   /*                        */
-    { for (i = 0; i < c_len; i++) c[i] = cnt[i];   /*                        */
+  if (rsc_watch && watch_possible())		   /* Process again whenever */
+  { bool per_record = (all_needed(true) == NULL);  /*  an input file changes.*/
+    bool watched;				   /*                        */
+    if (per_record) { start_key_gen(); }	   /*                        */
+    watched = (per_record			   /*                        */
+	       ? watch_in_files(watch_record, fct, watch_write)/*            */
+	       : watch_in_files(NULL, fct, watch_process));/*                */
+    if (per_record) { end_key_gen(); }		   /*                        */
+    if (watched)				   /*                        */
+    { free_db(the_db);				   /*                        */
+      return 0;					   /*                        */
     }						   /*                        */
   }						   /*                        */
-						   /*			     */
-  if (rsc_expand_crossref || rsc_expand_xdata)     /*                        */
-  {						   /*			     */
-    db_forall(the_db,expand_crossref);		   /*                        */
-  }						   /*			     */
-						   /*			     */
-  if (rsc_sort || rsc_make_key || need_sort_key) { /*                        */
-    DebugPrint1("start keygen");		   /*                        */
-    start_key_gen();				   /*                        */
+  if (*rsc_server)				   /* Answer requests for    */
+  { bool failed;				   /*  the entries.          */
+    read_in_files(the_db);			   /*                        */
+    process_db(the_db, fct, false);		   /*                        */
+    failed = serve(the_db, rsc_make_key ? do_keys : do_no_keys);/*           */
+    free_db(the_db);				   /*                        */
+    return failed ? 1 : 0;			   /*                        */
   }						   /*                        */
-						   /*			     */
-  if (rsc_make_key)		   		   /*                        */
-  {						   /*                        */
-    if (rsc_key_preserve)	   		   /*                        */
-    { db_forall(the_db, mark_key); }		   /*                        */
-						   /*			     */
-    DebugPrint1("rewinding");			   /*                        */
-    db_rewind(the_db);				   /*                        */
-						   /*                        */
-    DebugPrint1("do_keys");			   /*                        */
-    db_forall(the_db, do_keys);		   	   /*                        */
-						   /*                        */
-    DebugPrint1("update crossref");		   /*                        */
-    db_forall(the_db, update_crossref);	   	   /*                        */
-						   /*                        */
-    DebugPrint1("end keygen");			   /*                        */
+  if (rsc_sort &&				   /* Sort in batches with   */
+      (rsc_sort_memory > 0 || rsc_sort_merge) &&   /*  limited memory.       */
+      stream_possible(true))			   /*                        */
+  { stat_phase("sort");				   /*                        */
+    start_key_gen();				   /*                        */
+    sort_in_files(the_db, fct);			   /*                        */
     end_key_gen();				   /*                        */
+    print_statistics();				   /*                        */
+    free_db(the_db);				   /*                        */
+    return 0;					   /*                        */
   }						   /*                        */
-  else						   /*                        */
-  {						   /*                        */
-    db_forall(the_db,do_no_keys);		   /*                        */
+  if (rsc_stream && stream_possible(false))	   /* Print each record      */
+  { stat_phase("stream");			   /*  right after reading.  */
+    stream_in_files(the_db);			   /*                        */
+    print_statistics();				   /*                        */
+    free_db(the_db);				   /*                        */
+    return 0;					   /*                        */
   }						   /*                        */
  						   /*                        */
-  if (rsc_sort)				   	   /*                        */
-  {				   		   /*                        */
-    if (rsc_sort_cased)			   	   /*                        */
-    { if (rsc_sort_reverse) fct = rec_lt_cased;    /*                        */
-      else		    fct = rec_gt_cased;    /*                        */
-    }						   /*                        */
-    else					   /*                        */
-    { if (rsc_sort_reverse) fct = rec_lt;	   /*                        */
-      else		    fct = rec_gt;	   /*                        */
-    }						   /*                        */
-    db_sort(the_db, fct);			   /*                        */
-  }						   /*                        */
- 						   /*                        */
-  if (rsc_srt_macs)		   	   	   /* Maybe sort macros      */
-  { db_mac_sort(the_db); }			   /*                        */
- 						   /*                        */
-  apply_checks(the_db);				   /*                        */
+  stat_phase("read");				   /*                        */
+  read_in_files(the_db);			   /*                        */
  						   /*                        */
-  write_output(the_db);				   /*                        */
-						   /*			     */
-  write_macros(get_macro_file(), the_db);	   /*                        */
-						   /*			     */
-  if (rsc_cnt_all || rsc_cnt_used)		   /*			     */
-  { int i;					   /*                        */
-    int *cnt = db_count(the_db, (int*)NULL);	   /*                        */
-						   /*                        */
-    ErrC('\n');		   	   	   	   /*			     */
-    for (i = 0; i < c_len; ++i)			   /*			     */
-    { if (rsc_cnt_all || c[i] > 0)	   	   /*			     */
-      { ErrPrintF3("---  %-15s %5d read  %5d written\n",/*		     */
-		   SymbolValue(get_entry_type(i)), /*			     */
-		   c[i],		   	   /*			     */
-		   cnt[i]);		   	   /*			     */
-      }						   /*			     */
-    }						   /*			     */
-    free(c);					   /*                        */
-  }						   /*                        */
+  process_db(the_db, fct, true);		   /*                        */
+  print_statistics();				   /*                        */
 						   /*			     */
 #ifdef SYMBOL_DUMP
   if (rsc_dump_symbols) sym_dump();		   /* Write symbols.	     */
@@ -767,6 +1179,7 @@ static bool update_crossref(db, rec)		   /*			     */
 		 : "{%s}"),			   /*                        */
 		SymbolValue(s));		   /* make new crossref      */
   *hp = symbol(t);				   /* store new crossref     */
+  SetRecordDIRTY(rec);				   /*                        */
   free(t);					   /* free temp memory	     */
   return false;					   /*                        */
 }						   /*------------------------*/
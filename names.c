@@ -43,6 +43,7 @@
 #endif
  NameNode name_format _ARG((String s));		   /* names.c                */
  String  pp_list_of_names _ARG((String *wa,NameNode format,String trans,int max,String comma,String and,char *namesep,char *etal));/* names.c*/
+ void free_name_node _ARG((NameNode node));	   /* names.c                */
 #ifdef STANDALONE
  char * pp_names _ARG((char *s,NameNode format,String trans,int max,char *namesep,char *etal));/* names.c*/
 #endif
@@ -51,6 +52,7 @@
  static bool is_lower_word _ARG((String s));	   /* names.c                */
  static void initial _ARG((String s,String trans,int len,StringBuffer *sb));/* names.c*/
  static void pp_one_name _ARG((StringBuffer *sb,String *w,NameNode format,String trans,int len,String comma,int commas));/* names.c*/
+ static void names_free _ARG((void *state));	   /* names.c                */
 
 #ifdef BIBTEX_SYNTAX
  static void set_type _ARG((char **sp,char **midp));/* names.c               */
@@ -100,10 +102,8 @@ static NameNode new_name_node(type, strip, trim, pre, mid, post)/*           */
   return node;					   /*                        */
 }						   /*------------------------*/
 
-#ifdef UNUSED
-
 /*-----------------------------------------------------------------------------
-** Function*:	free_name_node()
+** Function:	free_name_node()
 ** Purpose:	Release the memory allocated for a node together with all
 **		nodes reachable via a |NextName| chain.
 **		It is not save to access a freed node.
@@ -111,7 +111,7 @@ static NameNode new_name_node(type, strip, trim, pre, mid, post)/*           */
 **	node	Node to free.
 ** Returns:	nothing
 **___________________________________________________			     */
-static void free_name_node(node)		   /*                        */
+void free_name_node(node)			   /*                        */
   NameNode node;				   /*                        */
 { NameNode next;				   /*                        */
  						   /*                        */
@@ -121,7 +121,6 @@ static void free_name_node(node)		   /*                        */
     node = next;				   /*                        */
   }						   /*                        */
 }						   /*------------------------*/
-#endif
 
 #ifdef DEBUG
 /*-----------------------------------------------------------------------------
@@ -380,6 +379,43 @@ NameNode name_format(s)				   /*                        */
   return node;					   /*                        */
 }						   /*------------------------*/
 
+/*-----------------------------------------------------------------------------
+** Typedef*:	SNamesState
+** Purpose:	The state of the names module in a context. It
+**		contains the buffer for the formatted names.
+**___________________________________________________			     */
+ typedef struct					   /*                        */
+ { StringBuffer *names_sb;			   /*                        */
+ } SNamesState;					   /*                        */
+
+/*-----------------------------------------------------------------------------
+** Variable*:	names_state0
+** Type:	SNamesState
+** Purpose:	The initial state of the names module in a context.
+**___________________________________________________			     */
+ static SNamesState names_state0;		   /*                        */
+
+#define NamesState ((SNamesState*)CtxGet(CTX_NAMES,			\
+					 ctx_state(CTX_NAMES,		\
+						   (void*)&names_state0,\
+						   sizeof(names_state0),\
+						   names_free)))
+
+/*-----------------------------------------------------------------------------
+** Function*:	names_free()
+** Type:	void
+** Purpose:	Release the buffer of the names module when a context
+**		is released.
+** Arguments:
+**	state	the state
+** Returns:	nothing
+**___________________________________________________			     */
+static void names_free(state)			   /*                        */
+  void *state;					   /*                        */
+{ SNamesState *st = (SNamesState*)state;	   /*                        */
+  if (st->names_sb) (void)sbclose(st->names_sb);   /*                        */
+}						   /*------------------------*/
+
 /*-----------------------------------------------------------------------------
 ** Function:	pp_list_of_names()
 ** Purpose:	Pretty-print a list of names.
@@ -410,10 +446,11 @@ String  pp_list_of_names(wa,format,trans,max,comma,and,namesep,etal)/*       */
   String	    word;		   	   /*                        */
   int  		    commas;			   /*                        */
   bool 		    first = true;		   /*                        */
-  static StringBuffer *sb = (StringBuffer*)0;	   /*                        */
+  SNamesState	    *st = NamesState;		   /*                        */
+  StringBuffer	    *sb = st->names_sb;		   /*                        */
  						   /*                        */
   if ( sb == (StringBuffer*)0 			   /*                        */
-      && (sb=sbopen()) == (StringBuffer*)0 )	   /*                        */
+      && (sb=st->names_sb=sbopen()) == (StringBuffer*)0 )/*                  */
   { OUT_OF_MEMORY("name list"); }		   /*                        */
   else						   /*                        */
   { sbrewind(sb); }				   /*                        */
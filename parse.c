@@ -35,6 +35,12 @@
 #include <bibtool/sbuffer.h>
 #include <bibtool/macros.h>
 #include <bibtool/print.h>
+#include <bibtool/stats.h>
+#include <bibtool/bundle.h>
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 #ifdef HAVE_LIBKPATHSEA
 #ifdef __STDC__
 #define HAVE_PROTOTYPES
@@ -58,21 +64,32 @@
  static bool parse_block _ARG((int quotep));	   /* parse.c                */
  static bool parse_equation _ARG((Record rec));	   /* parse.c                */
  static bool parse_key _ARG((int alpha));	   /* parse.c                */
- static bool parse_rhs _ARG((void));		   /* parse.c                */
+ static bool parse_rhs _ARG((bool intern));	   /* parse.c                */
+ static bool is_demanded _ARG((Symbol field));	   /* parse.c                */
+ static Symbol lazy_value _ARG((char *s));	   /* parse.c                */
+ void release_lazy_values _ARG((void));		   /* parse.c                */
+ void adopt_lazy_values _ARG((Record rec));	   /* parse.c                */
+ void suspend_lazy _ARG((bool on));		   /* parse.c                */
+ void demand_field _ARG((Symbol field));	   /* parse.c                */
  static bool parse_string _ARG((int quotep));	   /* parse.c                */
  static bool parse_symbol _ARG((int alpha));	   /* parse.c                */
  static bool parse_value _ARG((void));		   /* parse.c                */
  static bool see_rsc _ARG((String fname));	   /* parse.c                */
  static int fill_line _ARG((void));		   /* parse.c                */
  static int see_bib_msg _ARG((char *s));	   /* parse.c                */
+ static void see_source _ARG((String fname));	   /*                        */
+ String bib_source _ARG((Symbol name, long offset, long length));/*          */
  static int skip _ARG((int inc));		   /* parse.c                */
  static int skip_c _ARG((void));		   /* parse.c                */
+ static int skip_entry _ARG((int c));		   /* parse.c                */
  static int skip_nl _ARG((void));		   /* parse.c                */
  static void init___ _ARG((char ***pathp,char **pattern,char **envvp,char *env));/* parse.c*/
  static void init_parse _ARG((void));		   /* parse.c                */
  static void parse_number _ARG((void));		   /* parse.c                */
  void init_read _ARG((void));			   /* parse.c                */
  void set_rsc_path _ARG((String  val));		   /* parse.c                */
+ void set_key_filter _ARG((bool (*fct)(Symbol)));  /* parse.c                */
+ static void parse_free _ARG((void *state));	   /* parse.c                */
 
 /*****************************************************************************/
 /* External Programs							     */
@@ -80,20 +97,153 @@
 
 /*---------------------------------------------------------------------------*/
 
+/*-----------------------------------------------------------------------------
+** Typedef*:	SParseState
+** Purpose:	The state of the parser in a context. It contains the
+**		file read, its line buffer, the sources seen, and the
+**		settings of the parser. The fields are described with
+**		the macros giving access to them below.
+**___________________________________________________			     */
+ typedef struct					   /*                        */
+ { StringBuffer *ps_parse_sb;			   /*                        */
+   Symbol	ps_filename;			   /*                        */
+   FILE		*ps_file;			   /*                        */
+   String	ps_file_line_buffer;		   /*                        */
+   String	ps_flp;				   /*                        */
+   size_t	ps_fl_size;			   /*                        */
+   int		ps_flno;			   /*                        */
+   long		ps_fl_pos;			   /*                        */
+   long		ps_fl_len;			   /*                        */
+   long		ps_fl_start;			   /*                        */
+   struct sOURCE *ps_sources;			   /*                        */
+   bool		(*ps_key_filter)_ARG((Symbol));	   /*                        */
+   Symbol	*ps_demanded;			   /*                        */
+   int		ps_demanded_len;		   /*                        */
+   int		ps_demanded_size;		   /*                        */
+   bool		ps_lazy_entry;			   /*                        */
+   bool		ps_lazy_off;			   /*                        */
+   char		**ps_lazy_values;		   /*                        */
+   int		ps_lazy_used;			   /*                        */
+   int		ps_lazy_size;			   /*                        */
+   char		**ps_f_path;			   /*                        */
+   char		**ps_r_path;			   /*                        */
+   StringBuffer *ps_comment_sb;			   /*                        */
+   bool		ps_nl_state;			   /*                        */
+   Symbol	ps_rsc_file;			   /*                        */
+   int		ps_rsc_line;			   /*                        */
+ } SParseState;					   /*                        */
+
+/*-----------------------------------------------------------------------------
+** Variable*:	parse_state0
+** Type:	SParseState
+** Purpose:	The initial state of the parser in a context. All
+**		fields are empty.
+**___________________________________________________			     */
+ static SParseState parse_state0;		   /*                        */
+
+#define ParseState ((SParseState*)CtxGet(CTX_PARSE,			\
+					 ctx_state(CTX_PARSE,		\
+						   (void*)&parse_state0,\
+						   sizeof(parse_state0),\
+						   parse_free)))
+
 /*-----------------------------------------------------------------------------
 ** Variable*:	parse_sb
 ** Purpose:	This string buffer is used temporaliry during parsing.
 **___________________________________________________			     */
- static StringBuffer * parse_sb = (StringBuffer*)NULL;
+#define parse_sb   (ParseState->ps_parse_sb)
+#define comment_sb (ParseState->ps_comment_sb)
 
 #define FLBLEN	80		/* initial size and increment of line buffer */
 
- static Symbol  filename;
- static FILE	*file;
- static String	file_line_buffer;
- static String	flp;
- static size_t	fl_size	 = 0;
- static int	flno	 = 0;
+#define filename	 (ParseState->ps_filename)
+#define file		 (ParseState->ps_file)
+#define file_line_buffer (ParseState->ps_file_line_buffer)
+#define flp		 (ParseState->ps_flp)
+#define fl_size		 (ParseState->ps_fl_size)
+#define flno		 (ParseState->ps_flno)
+
+/*-----------------------------------------------------------------------------
+** Variable*:	rsc_file
+** Purpose:	The resource file and the line of the resource
+**		instruction evaluated by |read_rsc()|. The file is
+**		|NO_SYMBOL| for other instructions.
+**___________________________________________________			     */
+#define rsc_file	 (ParseState->ps_rsc_file)
+#define rsc_line	 (ParseState->ps_rsc_line)
+
+/*-----------------------------------------------------------------------------
+** Variable*:	fl_pos
+** Purpose:	The byte offset of the line buffer in the file, the
+**		number of bytes in the line buffer, and the byte offset
+**		of the |@| starting the last entry. They are maintained
+**		for the index of a \BibTeX{} file.
+**___________________________________________________			     */
+#define fl_pos	  (ParseState->ps_fl_pos)
+#define fl_len	  (ParseState->ps_fl_len)
+#define fl_start  (ParseState->ps_fl_start)
+
+/*-----------------------------------------------------------------------------
+** Typedef*:	SSource
+** Purpose:	A \BibTeX{} file opened with |see_bib()|. The contents
+**		is loaded when the source text of a record is needed
+**		first. If possible the file is mapped into memory.
+**___________________________________________________			     */
+ typedef struct sOURCE
+ { Symbol	 s_name;			   /* the name given         */
+   String	 s_path;			   /* the file found         */
+   char		 *s_buf;			   /* the contents or NULL   */
+   size_t	 s_size;			   /* its size                */
+   bool		 s_loaded;			   /* has it been tried?     */
+   bool		 s_mapped;			   /* is s_buf mapped?       */
+   struct sOURCE *s_next;			   /* the next file          */
+ } SSource, *Source;
+
+#define sources (ParseState->ps_sources)
+
+
+/*-----------------------------------------------------------------------------
+** Variable*:	key_filter
+** Purpose:	This function decides which entries are parsed
+**		completely. If it is not |NULL| then it is applied to
+**		the reference key of each normal entry. Entries for
+**		which it returns |false| are passed over.
+**___________________________________________________			     */
+#define key_filter (ParseState->ps_key_filter)
+
+/*-----------------------------------------------------------------------------
+** Variable*:	demanded
+** Purpose:	The fields whose values are used by some resource
+**		instruction. With |parse.lazy| only the values of these
+**		fields are entered into the symbol table. The others
+**		get a private copy which is never looked up.
+**___________________________________________________			     */
+#define demanded      (ParseState->ps_demanded)
+#define demanded_len  (ParseState->ps_demanded_len)
+#define demanded_size (ParseState->ps_demanded_size)
+
+/*-----------------------------------------------------------------------------
+** Variable*:	lazy_entry
+** Purpose:	Indicator that the fields of a normal entry are parsed
+**		and |parse.lazy| is in effect.
+**___________________________________________________			     */
+#define lazy_entry (ParseState->ps_lazy_entry)
+
+/*-----------------------------------------------------------------------------
+** Variable*:	lazy_off
+** Purpose:	Indicator that |parse.lazy| is suspended, e.g. while
+**		a cache image is written which refers to the values.
+**___________________________________________________			     */
+#define lazy_off (ParseState->ps_lazy_off)
+
+/*-----------------------------------------------------------------------------
+** Variable*:	lazy_values
+** Purpose:	The private copies of field values made since they
+**		have been released last.
+**___________________________________________________			     */
+#define lazy_values (ParseState->ps_lazy_values)
+#define lazy_used   (ParseState->ps_lazy_used)
+#define lazy_size   (ParseState->ps_lazy_size)
 
 /*---------------------------------------------------------------------------*/
 
@@ -108,8 +258,9 @@
 #define UnGetC		flp--
 
 #define InitLine	*file_line_buffer = '\0';	\
-			flp  = file_line_buffer;	\
-			flno = 0;
+			flp    = file_line_buffer;	\
+			flno   = 0;			\
+			fl_pos = fl_len = 0L;
 
 /*---------------------------------------------------------------------------*/
 
@@ -179,7 +330,7 @@ static void init___(pathp,pattern,envvp,env)	   /*			     */
 }						   /*------------------------*/
 
 #ifndef HAVE_LIBKPATHSEA
- static char **f_path = (char**)0;		   /*                        */
+#define f_path (ParseState->ps_f_path)
  static char *f_pattern[] =			   /*                        */
  { "%s/%s", "%s/%s.bib", NULL };		   /*                        */
 #endif
@@ -267,9 +418,106 @@ bool see_bib(fname)				   /*			     */
 		  see_bib_msg);		   	   /*			     */
   filename = (String)px_filename;		   /*			     */
 #endif
+  if (file != NULL) see_source(fname);		   /*                        */
   return (file != NULL);			   /*			     */
 }						   /*------------------------*/
 
+/*-----------------------------------------------------------------------------
+** Function*:	see_source()
+** Purpose:	Remember the file just opened by |see_bib()|. Thus the
+**		source text of the records read from it can be
+**		retrieved later on. If the file is read again then it
+**		may have been changed. Thus the contents loaded before
+**		is released.
+** Arguments:
+**	fname	the name given to |see_bib()|
+** Returns:	nothing
+**___________________________________________________			     */
+static void see_source(fname)			   /*                        */
+  String fname;					   /*                        */
+{ Symbol name = symbol(fname);			   /*                        */
+  Source src;					   /*                        */
+ 						   /*                        */
+  for (src = sources; src && src->s_name != name; src = src->s_next) {}/*    */
+  if (src == NULL)				   /*                        */
+  { if ((src = (Source)malloc(sizeof(SSource))) == NULL)/*                   */
+    { OUT_OF_MEMORY("source"); }		   /*                        */
+    src->s_name	  = name;			   /*                        */
+    src->s_buf	  = NULL;			   /*                        */
+    src->s_mapped = false;			   /*                        */
+    src->s_next	  = sources;			   /*                        */
+    sources	  = src;			   /*                        */
+  }						   /*                        */
+  else if (src->s_buf != NULL)			   /*                        */
+  {						   /*                        */
+#ifdef HAVE_SYS_MMAN_H
+    if (src->s_mapped)				   /*                        */
+    { (void)munmap(src->s_buf, src->s_size); }	   /*                        */
+    else					   /*                        */
+#endif
+    { free(src->s_buf); }			   /*                        */
+    src->s_buf	  = NULL;			   /*                        */
+    src->s_mapped = false;			   /*                        */
+  }						   /*                        */
+  src->s_path	= symbol(filename);		   /*                        */
+  src->s_size	= 0;				   /*                        */
+  src->s_loaded = false;			   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	bib_source()
+** Purpose:	Get the source text of a record. The file is loaded
+**		when it is needed first. It is mapped into memory if
+**		possible. The text is not terminated by a null byte.
+** Arguments:
+**	name	the name of the file as given to |see_bib()|; i.e.
+**		the source of the record
+**	offset	the byte offset of the text
+**	length	the length of the text
+** Returns:	A pointer to the text or |NULL| if it is not available.
+**___________________________________________________			     */
+String bib_source(name, offset, length)		   /*                        */
+  Symbol name;					   /*                        */
+  long	 offset;				   /*                        */
+  long	 length;				   /*                        */
+{ Source src;					   /*                        */
+  FILE	 *f;					   /*                        */
+  long	 n;					   /*                        */
+ 						   /*                        */
+  for (src = sources; src && src->s_name != name; src = src->s_next) {}/*    */
+  if (src == NULL || offset < 0L) return StringNULL;/*                       */
+ 						   /*                        */
+  if (!src->s_loaded)				   /*                        */
+  { src->s_loaded = true;			   /*                        */
+    if ((f = fopen((char*)src->s_path, "rb")) == NULL)/*                     */
+    { return StringNULL; }			   /*                        */
+    if (fseek(f, 0L, SEEK_END) == 0 && (n = ftell(f)) > 0)/*                 */
+    { src->s_size = (size_t)n;			   /*                        */
+#ifdef HAVE_SYS_MMAN_H
+      src->s_buf = mmap(NULL, src->s_size, PROT_READ,/*                      */
+			MAP_PRIVATE, fileno(f), 0);/*                        */
+      if (src->s_buf == (char*)MAP_FAILED) src->s_buf = NULL;/*              */
+      src->s_mapped = (src->s_buf != NULL);	   /*                        */
+#endif
+      if (src->s_buf == NULL &&			   /*                        */
+	  (src->s_buf = malloc(src->s_size)) != NULL)/*                      */
+      { rewind(f);				   /*                        */
+	if (fread(src->s_buf, 1, src->s_size, f) != src->s_size)/*           */
+	{ free(src->s_buf);			   /*                        */
+	  src->s_buf = NULL;			   /*                        */
+	}					   /*                        */
+      }						   /*                        */
+    }						   /*                        */
+    (void)fclose(f);				   /*                        */
+  }						   /*                        */
+ 						   /*                        */
+  if (src->s_buf == NULL ||			   /*                        */
+      offset + length > (long)src->s_size ||	   /*                        */
+      src->s_buf[offset] != '@')		   /*                        */
+  { return StringNULL; }			   /*                        */
+  return (String)src->s_buf + offset;		   /*                        */
+}						   /*------------------------*/
+
 /*-----------------------------------------------------------------------------
 ** Function:	seen()
 ** Purpose:	Close input file for the \BibTeX{} reading apparatus.
@@ -297,10 +545,63 @@ bool seen()					   /*			     */
   return false;					   /*			     */
 }						   /*------------------------*/
 
+/*-----------------------------------------------------------------------------
+** Function:	seen_bib_file()
+** Purpose:	Get the name of the file opened with |see_bib()|. This
+**		is the name found on the search path. For the
+**		standard input |NULL| is returned.
+** Arguments:	none
+** Returns:	The file name or |NULL|.
+**___________________________________________________			     */
+String seen_bib_file()				   /*                        */
+{						   /*                        */
+  return (file == stdin ? StringNULL : (String)filename);/*                  */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	seen_bib_span()
+** Purpose:	Get the byte range of the entry returned by the last
+**		call of |parse_bib()|. It starts at the |@| and ends
+**		after the closing delimiter.
+** Arguments:
+**	fromp	pointer to the start offset
+**	top	pointer to the end offset
+** Returns:	nothing
+**___________________________________________________			     */
+void seen_bib_span(fromp, top)			   /*                        */
+  long *fromp;					   /*                        */
+  long *top;					   /*                        */
+{ *fromp = fl_start;				   /*                        */
+  *top	 = fl_pos + (flp - file_line_buffer);	   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	seek_bib()
+** Purpose:	Continue reading the file opened with |see_bib()| at
+**		the given byte offset. The next call of |parse_bib()|
+**		starts there. The line number is needed for messages.
+** Arguments:
+**	offset	the byte offset
+**	lineno	the line number at this offset
+** Returns:	|true| iff the position could be set.
+**___________________________________________________			     */
+bool seek_bib(offset, lineno)			   /*                        */
+  long offset;					   /*                        */
+  int  lineno;					   /*                        */
+{						   /*                        */
+  if (file == NULL || file == stdin ||		   /*                        */
+      fseek(file, offset, SEEK_SET) != 0)	   /*                        */
+  { return false; }				   /*                        */
+  InitLine;					   /*                        */
+  fl_pos = offset;				   /*                        */
+  flno	 = lineno - 1;				   /*                        */
+  return true;					   /*                        */
+}						   /*------------------------*/
+
 #define Expect(C,N)	  if (GetC != C) { UnexpectedError; return(N); }
 #define ExpectSymbol(C,N) if (!parse_symbol(C))	  return (N)
 #define ExpectKey(C,N)    if (!parse_key(C))	  return (N)
-#define ExpectRhs(N)	  if (!parse_rhs())	  return (N)
+#define ExpectRhs(N)	  if (!parse_rhs(true))	  return (N)
 #define ExpectEq(R,N)	  if (!parse_equation(R)) return (N)
 #define ExpectEqMac(R,N)  if (!parse_equation(R)) return (N)
 
@@ -344,42 +645,48 @@ static void init_parse()			   /*			     */
 ** Returns:	Returns 0 iff a character has been read.
 **___________________________________________________'			     */
 static int fill_line()				   /*			     */
-{ register size_t	len;			   /*			     */
+{ register SParseState *st = ParseState;	   /*			     */
+  register size_t	len;			   /*			     */
 						   /*			     */
-  flp = file_line_buffer;			   /* Reset line pointer     */
-  ++flno;					   /* Increase line number   */
+  st->ps_flp = st->ps_file_line_buffer;		   /* Reset line pointer     */
+  ++st->ps_flno;				   /* Increase line number   */
+  st->ps_fl_pos += st->ps_fl_len;		   /*                        */
+  st->ps_fl_len  = 0L;				   /*                        */
 						   /*			     */
-  if (fgets((char*)file_line_buffer, fl_size,file) /*                        */
+  if (fgets((char*)st->ps_file_line_buffer,	   /*                        */
+	    st->ps_fl_size,			   /*                        */
+	    st->ps_file)			   /*                        */
       == NULL)					   /*Get first chunk         */
-  { ClearLine; 		   			   /*	or report EOF	     */
+  { *st->ps_flp = '\0';				   /*	or report EOF	     */
     DebugPrint1("Reading failed for first line."); /*                        */
     return 1;					   /*                        */
   }						   /*                        */
 						   /*			     */
   FOREVER					   /*			     */
   { for (len = 0;				   /* Find the end	     */
-	 file_line_buffer[len] != '\0';		   /*  of the buffer and     */
+	 st->ps_file_line_buffer[len] != '\0';	   /*  of the buffer and     */
 	 ++len) ;				   /*  count the length.     */
 						   /*			     */
 #ifdef DEBUG
     ErrPrintF2("+++ BibTool: line buffer: used %d of %d\n",/*                */
 	       len + 1,				   /*                        */
-	       fl_size);			   /*                        */
+	       st->ps_fl_size);			   /*                        */
 #endif
 						   /*			     */
-    if (file_line_buffer[len-1] == '\n'	   	   /*			     */
-	|| len < fl_size - 1)			   /*			     */
+    st->ps_fl_len = (long)len;			   /*                        */
+    if (st->ps_file_line_buffer[len-1] == '\n'	   /*                        */
+	|| len < st->ps_fl_size - 1)		   /*                        */
     { return 0; }				   /*			     */
 						   /*			     */
-    if ((file_line_buffer = (String)		   /* Try to enlarge	     */
-	  realloc((char*)file_line_buffer,	   /*  the line buffer	     */
-		  fl_size+=FLBLEN)) == NULL)	   /*			     */
+    if ((st->ps_file_line_buffer = (String)	   /* Try to enlarge         */
+	  realloc((char*)st->ps_file_line_buffer,  /*  the line buffer	     */
+		  st->ps_fl_size+=FLBLEN)) == NULL)/*			     */
     { OUT_OF_MEMORY("line buffer"); }		   /*			     */
-    flp = file_line_buffer;			   /* Reset line pointer     */
+    st->ps_flp = st->ps_file_line_buffer;	   /* Reset line pointer     */
 						   /*			     */
-    if (fgets((char*)file_line_buffer + len,	   /*                        */
+    if (fgets((char*)st->ps_file_line_buffer + len,/*                        */
 	      FLBLEN + 1,			   /*                        */
-	      file)				   /*		             */
+	      st->ps_file)			   /*                        */
 	== NULL)				   /*			     */
     { return 0; }				   /*			     */
   }						   /*			     */
@@ -395,11 +702,12 @@ static int fill_line()				   /*			     */
 **___________________________________________________			     */
 static int skip(inc)				   /*			     */
   register bool inc;				   /*			     */
-{						   /*			     */
+{ register SParseState *st = ParseState;	   /*			     */
+						   /*			     */
   FOREVER					   /*			     */
-  { if (EmptyC && fill_line())   return EOF;	   /*			     */
-    else if (is_space(CurrentC)) SkipC;	   	   /*			     */
-    else return (inc ? NextC : CurrentC);	   /*			     */
+  { if (*st->ps_flp == '\0' && fill_line()) return EOF;/*		     */
+    else if (is_space(*st->ps_flp)) st->ps_flp++;  /*			     */
+    else return (inc ? *(st->ps_flp++) : *st->ps_flp);/*		     */
   }						   /*			     */
 }						   /*------------------------*/
 
@@ -410,11 +718,42 @@ static int skip(inc)				   /*			     */
 ** Returns:	the next character or |EOF|
 **___________________________________________________			     */
 static int skip_c()				   /*			     */
-{						   /*			     */
-  FOREVER					   /*			     */
-  { if (EmptyC && fill_line()) return EOF;	   /*			     */
-    else { return NextC; }			   /*			     */
-  }						   /*			     */
+{ register SParseState *st = ParseState;	   /*			     */
+						   /*			     */
+  if (*st->ps_flp == '\0' && fill_line()) return EOF;/*			     */
+  return *(st->ps_flp++);			   /*			     */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	skip_entry()
+** Purpose:	Pass over the remainder of an entry without parsing
+**		it. Braces are counted and at the outer level double
+**		quotes are taken into account for entries in parentheses.
+** Arguments:
+**	c	the opening delimiter of the entry
+** Returns:	the closing delimiter or |EOF|
+**___________________________________________________			     */
+static int skip_entry(c)			   /*                        */
+  int  c;					   /*                        */
+{ int  depth  = 0;				   /*                        */
+  bool quoted = false;				   /*                        */
+ 						   /*                        */
+  FOREVER					   /*                        */
+  { switch (skip_c())				   /*                        */
+    { case EOF: return EOF;			   /*                        */
+      case '{': depth++; break;			   /*                        */
+      case '}':					   /*                        */
+	if (depth == 0) return '}';		   /*                        */
+	depth--;				   /*                        */
+	break;					   /*                        */
+      case '"':					   /*                        */
+	if (depth == 0) quoted = !quoted;	   /*                        */
+	break;					   /*                        */
+      case ')':					   /*                        */
+	if (depth == 0 && !quoted && c == '(') return ')';/*                 */
+	break;					   /*                        */
+    }						   /*                        */
+  }						   /*                        */
 }						   /*------------------------*/
 
 /*-----------------------------------------------------------------------------
@@ -426,10 +765,13 @@ static int skip_c()				   /*			     */
 ** Returns:	the next character or EOF
 **___________________________________________________			     */
 static int skip_nl()				   /*			     */
-{ static bool state = false;			   /*			     */
+{ register SParseState *st = ParseState;	   /*                        */
   int c;					   /*                        */
  						   /*                        */
-  if (state) { state = false; return '\n'; }	   /*                        */
+  if (st->ps_nl_state)				   /*                        */
+  { st->ps_nl_state = false; return '\n'; }	   /*                        */
+  if (*st->ps_flp != '\0' && !is_space(*st->ps_flp))/* Most characters are  */
+  { return *(st->ps_flp++); }			   /*  passed on directly.   */
  						   /*                        */
   FOREVER					   /*			     */
   { if (EmptyC && fill_line()) return EOF;	   /*			     */
@@ -452,7 +794,7 @@ static int skip_nl()				   /*			     */
 	   c = skip_c()) {}			   /*                        */
       if (c == EOF) return EOF;		   	   /*                        */
       UnGetC;					   /*                        */
-      state = true;				   /*                        */
+      st->ps_nl_state = true;			   /*                        */
       return '\n';				   /*                        */
     }						   /*			     */
     else { return NextC; }		   	   /*			     */
@@ -471,17 +813,18 @@ static bool parse_symbol(alpha)			   /*			     */
   register int   alpha;				   /*			     */
 { register Uchar c;				   /*			     */
   register String cp;				   /*			     */
+  register SParseState *st = ParseState;	   /*			     */
 						   /*			     */
   c = GetC;					   /*                        */
-  cp = flp - 1;			   	   	   /*			     */
+  cp = st->ps_flp - 1;				   /*			     */
   if (alpha && (! is_alpha(c)))		   	   /*			     */
   { Warning("Symbol does not start with a letter");/*                        */
   }		   				   /*			     */
-  while (is_allowed(CurrentC)) { SkipC; }	   /*			     */
-  c = CurrentC;					   /*                        */
-  CurrentC = '\0';		   		   /*			     */
+  while (is_allowed(*st->ps_flp)) { st->ps_flp++; }/*			     */
+  c = *st->ps_flp;				   /*                        */
+  *st->ps_flp = '\0';				   /*			     */
   push_string(symbol(lower(cp)));		   /*			     */
-  CurrentC = c;					   /*			     */
+  *st->ps_flp = c;				   /*			     */
   return true;					   /*			     */
 }						   /*------------------------*/
 
@@ -558,25 +901,26 @@ static bool parse_string(quotep)		   /*			     */
 { int c;					   /*                        */
   int left;				   	   /*			     */
   int start_flno = flno;			   /*                        */
+  StringBuffer *sb = parse_sb;			   /*                        */
 						   /*			     */
   left = 0;					   /*			     */
-  if (quotep) (void)sbputchar('"', parse_sb);	   /*"			     */
+  if (quotep) (void)sbputchar('"', sb);		   /*"			     */
   do						   /*			     */
   { switch (c = skip_nl())			   /*			     */
     { case EOF:					   /*                        */
 	UnterminatedError("Unterminated double quote",/*                     */
 			  start_flno);		   /*                        */
 	return false;	   			   /*			     */
-      case '{':	 left++; (void)sbputchar((char)c,parse_sb); break;/*	     */
+      case '{':	 left++; (void)sbputchar((char)c,sb); break;/*		     */
       case '}':	 if (left-- < 0)		   /*			     */
 		 { Warning("Expecting \" here"); } /*			     */
-		 (void)sbputchar((char)c,parse_sb);/*                        */
+		 (void)sbputchar((char)c,sb);	   /*                        */
 		 break;                            /*                        */
-      case '\\': (void)sbputchar((char)c,parse_sb); c = NextC;/*	     */
-		 (void)sbputchar((char)c,parse_sb); c = ' ';/*		     */
+      case '\\': (void)sbputchar((char)c,sb); c = NextC;/*		     */
+		 (void)sbputchar((char)c,sb); c = ' ';/*		     */
 		 break;				   /*			     */
       case '"':	 if (!quotep) break;		   /*			     */
-      default:	 (void)sbputchar((char)c,parse_sb);/*			     */
+      default:	 (void)sbputchar((char)c,sb);	   /*			     */
     }						   /*			     */
   } while (c != '"');				   /*			     */
 						   /*			     */
@@ -599,9 +943,10 @@ static bool parse_block(quotep)			   /*			     */
 { int c;					   /*                        */
   int left;				   	   /*			     */
   int start_flno = flno;			   /*                        */
+  StringBuffer *sb = parse_sb;			   /*                        */
 						   /*			     */
   left = 1;					   /*			     */
-  if (quotep) (void)sbputchar('{',parse_sb);	   /*			     */
+  if (quotep) (void)sbputchar('{',sb);		   /*			     */
  						   /*                        */
   FOREVER					   /*			     */
   { switch (c = skip_nl())			   /*			     */
@@ -612,12 +957,11 @@ static bool parse_block(quotep)			   /*			     */
       case '{': left++; break;			   /*			     */
       case '}':					   /*			     */
 	if (--left < 1)			   	   /*			     */
-	{ if (quotep) (void)sbputchar('}',	   /*                        */
-				      parse_sb);   /*		             */
+	{ if (quotep) (void)sbputchar('}', sb);	   /*                        */
 	  return true;				   /*			     */
 	}					   /*			     */
     }						   /*			     */
-    (void)sbputchar(c, parse_sb);		   /*			     */
+    (void)sbputchar(c, sb);			   /*			     */
   }						   /*			     */
 }						   /*------------------------*/
 
@@ -626,10 +970,13 @@ static bool parse_block(quotep)			   /*			     */
 ** Purpose:	Parse the right hand side of an item.
 **		This can be composed of strings, blocks, numbers, and symbols
 **		separated by #
-** Arguments:	none
+** Arguments:
+**	intern	Indicator whether the value should be entered into the
+**		symbol table. Otherwise a private copy is made.
 ** Returns:	Success status
 **___________________________________________________			     */
-static bool parse_rhs()				   /*			     */
+static bool parse_rhs(intern)			   /*			     */
+  bool intern;					   /*                        */
 { int start_flno = flno;			   /*                        */
   Symbol sym;					   /*                        */
  						   /*                        */
@@ -674,7 +1021,9 @@ static bool parse_rhs()				   /*			     */
     }						   /*			     */
   } while (GetC == '#');			   /*			     */
 						   /*			     */
-  push_string(symbol((String)sbflush(parse_sb)));  /*			     */
+  push_string(intern				   /*                        */
+	      ? symbol((String)sbflush(parse_sb))  /*                        */
+	      : lazy_value(sbflush(parse_sb)));	   /*                        */
   sbrewind(parse_sb);				   /*			     */
   UnGetC;					   /*                        */
   return true;				   	   /*			     */
@@ -692,15 +1041,192 @@ static bool parse_equation(rec)		   	   /*			     */
 { Symbol s, t;				   	   /*			     */
 						   /*			     */
   ExpectSymbol(true, false);			   /*			     */
+  s = pop_string();				   /*			     */
   Expect('=', false);				   /*			     */
-  ExpectRhs(false);				   /*			     */
+  if (!parse_rhs(!lazy_entry || is_demanded(s)))   /*                        */
+  { return false; }				   /*                        */
 						   /*			     */
   t = pop_string();				   /*			     */
-  s = pop_string();				   /*			     */
   push_to_record(rec, s, t, true);		   /*			     */
   return true;					   /*			     */
 }						   /*------------------------*/
 
+/*-----------------------------------------------------------------------------
+** Function:	demand_field()
+** Purpose:	Register a field whose value is used by some resource
+**		instruction, e.g.\ a key format or a rewrite rule. With
+**		|parse.lazy| the values of other fields are not entered
+**		into the symbol table when a normal entry is parsed.
+** Arguments:
+**	field	the field name
+** Returns:	nothing
+**___________________________________________________			     */
+void demand_field(field)			   /*                        */
+  Symbol field;					   /*                        */
+{						   /*                        */
+  if (field == NO_SYMBOL || is_demanded(field)) return;/*                    */
+ 						   /*                        */
+  if (demanded_len >= demanded_size)		   /*                        */
+  { demanded_size += 16;			   /*                        */
+    demanded = (demanded == (Symbol*)NULL	   /*                        */
+		? (Symbol*)malloc(demanded_size * sizeof(Symbol))/*          */
+		: (Symbol*)realloc(demanded,	   /*                        */
+				   demanded_size * sizeof(Symbol)));/*       */
+    if (demanded == (Symbol*)NULL)		   /*                        */
+    { OUT_OF_MEMORY("demanded fields"); }	   /*                        */
+  }						   /*                        */
+  demanded[demanded_len++] = field;		   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	is_demanded()
+** Purpose:	Check whether the value of a field is used by some
+**		resource instruction. The crossref and xdata fields
+**		are always needed.
+** Arguments:
+**	field	the field name
+** Returns:	|true| iff the field has been registered
+**___________________________________________________			     */
+static bool is_demanded(field)			   /*                        */
+  Symbol field;					   /*                        */
+{ int i;					   /*                        */
+ 						   /*                        */
+  if (field == sym_crossref || field == sym_xdata) return true;/*            */
+  for (i = 0; i < demanded_len; i++)		   /*                        */
+  { if (demanded[i] == field) return true; }	   /*                        */
+  return false;					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	lazy_value()
+** Purpose:	Make a private copy of a field value which is not
+**		entered into the symbol table. The copy is remembered
+**		until it is handed to a record with
+**		|adopt_lazy_values()| or freed with
+**		|release_lazy_values()|.
+** Arguments:
+**	s	the value
+** Returns:	The copy.
+**___________________________________________________			     */
+static Symbol lazy_value(s)			   /*                        */
+  char *s;					   /*                        */
+{						   /*                        */
+  if (lazy_used >= lazy_size)			   /*                        */
+  { lazy_size += 1024;				   /*                        */
+    lazy_values = (lazy_values == (char**)NULL	   /*                        */
+		   ? (char**)malloc(lazy_size * sizeof(char*))/*             */
+		   : (char**)realloc(lazy_values,  /*                        */
+				     lazy_size * sizeof(char*)));/*          */
+    if (lazy_values == (char**)NULL)		   /*                        */
+    { OUT_OF_MEMORY("lazy values"); }		   /*                        */
+  }						   /*                        */
+  return (Symbol)(lazy_values[lazy_used++] = new_string(s));/*               */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	adopt_lazy_values()
+** Purpose:	Hand the private copies of the field values made by
+**		the parser with \rsc{parse.lazy} for the last entry
+**		over to a record. They are freed together with the
+**		record.
+** Arguments:
+**	rec	the record referring to the values
+** Returns:	nothing
+**___________________________________________________			     */
+void adopt_lazy_values(rec)			   /*                        */
+  Record rec;					   /*                        */
+{ String *lp;					   /*                        */
+ 						   /*                        */
+  if (lazy_used == 0) return;			   /*                        */
+  if ((lp = (String*)malloc((lazy_used + 1) * sizeof(String))) == NULL)/*    */
+  { OUT_OF_MEMORY("lazy values"); }		   /*                        */
+  RecordLazy(rec) = lp;				   /*                        */
+  lp[lazy_used] = StringNULL;			   /*                        */
+  while (lazy_used > 0)				   /*                        */
+  { --lazy_used;				   /*                        */
+    lp[lazy_used] = (String)lazy_values[lazy_used];/*                        */
+  }						   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	suspend_lazy()
+** Purpose:	Turn \rsc{parse.lazy} off temporarily or on again.
+**		While it is off all field values are entered into the
+**		symbol table.
+** Arguments:
+**	on	whether to suspend lazy parsing
+** Returns:	nothing
+**___________________________________________________			     */
+void suspend_lazy(on)				   /*                        */
+  bool on;					   /*                        */
+{ lazy_off = on;				   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	release_lazy_values()
+** Purpose:	Free the private copies of the field values made by
+**		the parser with \rsc{parse.lazy} which have not been
+**		handed over to a record. No record may refer to them.
+** Arguments:	none
+** Returns:	nothing
+**___________________________________________________			     */
+void release_lazy_values()			   /*                        */
+{						   /*                        */
+  while (lazy_used > 0)				   /*                        */
+  { free(lazy_values[--lazy_used]); }		   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	parse_free()
+** Purpose:	Release the memory of the parser when a context is
+**		released.
+** Arguments:
+**	state	the state
+** Returns:	nothing
+**___________________________________________________			     */
+static void parse_free(state)			   /*                        */
+  void	 *state;				   /*                        */
+{ Source src;					   /*                        */
+  POSSIBLY_UNUSED(state);			   /*                        */
+ 						   /*                        */
+  release_lazy_values();			   /*                        */
+  if (lazy_values) free(lazy_values);		   /*                        */
+  if (demanded) free(demanded);			   /*                        */
+  while ((src = sources) != NULL)		   /*                        */
+  { sources = src->s_next;			   /*                        */
+    if (src->s_buf != NULL)			   /*                        */
+    {						   /*                        */
+#ifdef HAVE_SYS_MMAN_H
+      if (src->s_mapped)			   /*                        */
+      { (void)munmap(src->s_buf, src->s_size); }   /*                        */
+      else					   /*                        */
+#endif
+      { free(src->s_buf); }			   /*                        */
+    }						   /*                        */
+    free(src);					   /*                        */
+  }						   /*                        */
+  if (fl_size > 0) free(file_line_buffer);	   /*                        */
+  if (parse_sb) (void)sbclose(parse_sb);	   /*                        */
+  if (comment_sb) (void)sbclose(comment_sb);	   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	set_key_filter()
+** Purpose:	Install a function which decides which entries are
+**		parsed by |parse_bib()|. After the reference key of a
+**		normal entry has been read the function is called with
+**		the key as argument. If it returns |false| then the
+**		remainder of the entry is passed over and |BIB_SKIP|
+**		is returned. The argument |NULL| disables the filter.
+** Arguments:
+**	fct	the filter function or |NULL|
+** Returns:	nothing
+**___________________________________________________			     */
+void set_key_filter(fct)			   /*                        */
+  bool (*fct)_ARG((Symbol));			   /*                        */
+{ key_filter = fct;				   /*                        */
+}						   /*------------------------*/
+
 /*-----------------------------------------------------------------------------
 ** Function:	parse_bib()
 ** Purpose:	Read one entry and fill the internal record structure.
@@ -713,12 +1239,17 @@ static bool parse_equation(rec)		   	   /*			     */
 **		an indicator that no record has been read but the
 **		error recovery is ready to try it again.
 **
+**		|BIB_SKIP| is returned when the entry has been passed
+**		over because its key has been rejected by the filter
+**		installed with |set_key_filter()|.
+**
 **		This function is for internal purposes mainly. See
 **		|read_db()| for a higher level function to read a
 **		database. 
 ** Arguments:
 **	rec	Record to store the result in.
-** Returns:	The type of the entry read, |BIB_EOF|, or |BIB_NOOP|.
+** Returns:	The type of the entry read, |BIB_EOF|, |BIB_NOOP|, or
+**		|BIB_SKIP|.
 **___________________________________________________			     */
 int parse_bib(rec)				   /*			     */
   Record rec;					   /*                        */
@@ -727,10 +1258,10 @@ int parse_bib(rec)				   /*			     */
 	       c;				   /*			     */
   bool	       again;				   /*			     */
   long	       ignored = 0L;			   /*			     */
+  long	       to;				   /*                        */
   String       name;				   /*                        */
   int          line;				   /*                        */
   char	       buffer[32];			   /*                        */
-  static StringBuffer * comment_sb = (StringBuffer*)NULL;/*                  */
  						   /*                        */
   if (file == NULL) return BIB_EOF;	   	   /*                        */
   if (comment_sb == (StringBuffer*)NULL)	   /*                        */
@@ -738,7 +1269,12 @@ int parse_bib(rec)				   /*			     */
  						   /*                        */
   RecordOldKey(rec)  = NULL;	   	   	   /*			     */
   RecordFree(rec)    = 0;		   	   /*			     */
+  RecordClear(rec, RecordFlagINDEXED);		   /*                        */
+  RecordSet(rec, RecordFlagPACKED);		   /* no deleted fields yet  */
   RecordComment(rec) = sym_empty;	   	   /*                        */
+  RecordOffset(rec)  = -1L;			   /*                        */
+  lazy_entry	     = false;			   /*                        */
+  release_lazy_values();			   /* of passed over entries */
  						   /*                        */
   do						   /*                        */
   { init_parse();				   /*			     */
@@ -761,6 +1297,7 @@ int parse_bib(rec)				   /*			     */
       if (ignored > 0 && rsc_pass_comment)	   /*			     */
       { sbputchar(c, comment_sb); }		   /*			     */
     }						   /*			     */
+    fl_start = fl_pos + (flp - file_line_buffer) - 1;/*                      */
     						   /*			     */
     if (ignored != 0L)			   	   /*			     */
     { if (rsc_pass_comment)			   /*                        */
@@ -804,7 +1341,7 @@ int parse_bib(rec)				   /*			     */
   switch (type)				   	   /*			     */
   { case BIB_COMMENT:				   /* This code is not used  */
       UnGetC; 					   /*  any more.             */
-      (void)parse_rhs();			   /*                        */
+      (void)parse_rhs(true);			   /*                        */
       push_to_record(rec, pop_string(),		   /*                        */
 		     NO_SYMBOL, true);		   /*			     */
       return type;				   /*                        */
@@ -842,8 +1379,23 @@ int parse_bib(rec)				   /*			     */
 	Expect(',', BIB_NOOP);			   /*			     */
 	push_to_record(rec, pop_string(),	   /*                        */
 		       NO_SYMBOL, true);	   /*			     */
+ 						   /*                        */
+	if ( key_filter != NULL &&		   /* Pass over entries with */
+	     !(*key_filter)(*RecordHeap(rec)) )	   /* unwanted keys.         */
+	{ sbrewind(comment_sb);			   /*                        */
+	  if (skip_entry(c) == EOF)		   /*                        */
+	  { error(ERR_ERROR|ERR_FILE,		   /*                        */
+		  (String)(c == '{' ? "'{'" : "'('"),/*                      */
+		  (String)" not closed at end of file.",/*                   */
+		  StringNULL, StringNULL, StringNULL,/*                      */
+		  line, name);			   /*                        */
+	    return BIB_NOOP;			   /*                        */
+	  }					   /*                        */
+	  return BIB_SKIP;			   /*                        */
+	}					   /*                        */
       }						   /*			     */
 						   /*			     */
+      lazy_entry = rsc_parse_lazy && !lazy_off;	   /*                        */
       do					   /*			     */
       { ExpectEq(rec, BIB_NOOP);		   /*			     */
 	for (n = 0; GetC == ','; n++)		   /*			     */
@@ -901,6 +1453,14 @@ int parse_bib(rec)				   /*			     */
     if (*t) RecordComment(rec) = symbol(t);	   /*                        */
   }						   /*                        */
   sbrewind(comment_sb);				   /*                        */
+  StatCount(st_records, 1);			   /*                        */
+  StatCount(st_fields,				   /*                        */
+	    RecordFree(rec) / 2 - (IsNormalRecord(type) ? 1 : 0));/*         */
+  if (file != stdin)				   /* Remember the source    */
+  { seen_bib_span(&RecordOffset(rec), &to);	   /*  text.                 */
+    RecordLength(rec) = to - RecordOffset(rec);	   /*                        */
+    RecordClear(rec, RecordFlagDIRTY);		   /*                        */
+  }						   /*                        */
   return type;					   /*			     */
 }						   /*------------------------*/
 
@@ -909,7 +1469,7 @@ int parse_bib(rec)				   /*			     */
 /*									     */
 /*****************************************************************************/
 
- static char **r_path	  = (char**)0;
+#define r_path (ParseState->ps_r_path)
  static char *r_pattern[] =
  { "%s/%s", "%s/%s.rsc", NULL };
 
@@ -1019,12 +1579,17 @@ bool read_rsc(name)				   /*			     */
   String	name;				   /*			     */
 { int	        c;				   /*			     */
   Symbol	token;				   /*			     */
+  Symbol	value;				   /*                        */
   String	s_filename;			   /*			     */
   FILE		*s_file;			   /*                        */
   String	s_file_line_buffer;		   /*                        */
   size_t	s_fl_size;			   /*                        */
   int		s_flno;				   /*                        */
   String	s_flp;				   /*                        */
+  Symbol	s_rsc_file;			   /*                        */
+  int		s_rsc_line;			   /*                        */
+  Symbol	source;				   /*                        */
+  int		line;				   /*                        */
   bool	        ret;				   /*                        */
  						   /* Save the old state in  */
  						   /*  local variables to    */
@@ -1035,37 +1600,56 @@ bool read_rsc(name)				   /*			     */
   s_fl_size	     = fl_size;			   /*                        */
   s_flno	     = flno;			   /*                        */
   s_flp		     = flp;			   /*                        */
+  s_rsc_file	     = rsc_file;		   /*                        */
+  s_rsc_line	     = rsc_line;		   /*                        */
  						   /*                        */
   fl_size	     = 0;			   /*                        */
 						   /*			     */
   init_parse();					   /*			     */
 						   /*			     */
-  if (see_rsc(name))				   /*                        */
-  {						   /*                        */
+  if (!see_rsc(name))				   /*                        */
+  { ret = false;				   /*			     */
+  }						   /*                        */
+  else if (is_bundle(file))			   /* precompiled resources  */
+  { source = symbol(filename);			   /* the buffer is reused   */
+    (void)seen();				   /*                        */
+    (void)read_bundle(source);			   /*                        */
+    ret = true;					   /*                        */
+  }						   /*                        */
+  else						   /*                        */
+  { source = symbol(filename);			   /* the buffer is reused   */
+    bundle_begin(name, source);			   /*                        */
     while ((c=TestC) != EOF)			   /*			     */
     { switch (c)				   /*			     */
       { case '#': case '%': case ';':		   /*			     */
 	  ClearLine; break;			   /*			     */
 	default:				   /*			     */
+	  line = flno;				   /*                        */
 	  if (!parse_symbol(c))		   	   /*			     */
 	  { (void)seen();			   /*                        */
+	    bundle_end();			   /*                        */
 	    return true;			   /*                        */
 	  }	   				   /*			     */
 	  token = pop_string();			   /*			     */
 	  if (TestC == '=') (void)GetC;	   	   /* = is optional	     */
 	  if (!parse_value())			   /*			     */
 	  { (void)seen();			   /*                        */
+	    bundle_end();			   /*                        */
 	    return true;			   /*                        */
 	  }					   /*			     */
-	  (void)set_rsc(token, pop_string());	   /*			     */
+	  value	   = pop_string();		   /*                        */
+	  bundle_record(token, value, source, line);/*                       */
+	  rsc_file = source;			   /*                        */
+	  rsc_line = line;			   /*                        */
+	  (void)set_rsc(token, value);		   /*			     */
+	  rsc_file = s_rsc_file;		   /*                        */
+	  rsc_line = s_rsc_line;		   /*                        */
 	}					   /*			     */
     }						   /*			     */
     (void)seen();				   /*			     */
+    bundle_end();				   /*                        */
     ret = true;					   /*			     */
   }						   /*                        */
-  else						   /*                        */
-  { ret = false;				   /*			     */
-  }						   /*                        */
   if (fl_size > 0) 				   /*                        */
   { free((char*)file_line_buffer);		   /*                        */
   }						   /*                        */
@@ -1078,3 +1662,39 @@ bool read_rsc(name)				   /*			     */
  						   /*                        */
   return ret;					   /*                        */
 }						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	rsc_source()
+** Purpose:	Get the location of the resource instruction which is
+**		evaluated by |read_rsc()| at the moment. Instructions
+**		given on the command line have no location.
+** Arguments:
+**	linep	pointer to the line number. It is set if a file name
+**		is returned.
+** Returns:	The name of the resource file or |NO_SYMBOL|.
+**___________________________________________________			     */
+Symbol rsc_source(linep)			   /*                        */
+  int	 *linep;				   /*                        */
+{						   /*                        */
+  if (rsc_file != NO_SYMBOL) *linep = rsc_line;	   /*                        */
+  return rsc_file;				   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	set_rsc_source()
+** Purpose:	Set the location of the resource instruction which is
+**		evaluated at the moment. This is used for instructions
+**		which are not read by |read_rsc()| from the resource
+**		file itself but taken from a resource bundle.
+** Arguments:
+**	fname	the name of the resource file or |NO_SYMBOL|
+**	line	the line number
+** Returns:	nothing
+**___________________________________________________			     */
+void set_rsc_source(fname, line)		   /*                        */
+  Symbol fname;					   /*                        */
+  int	 line;					   /*                        */
+{						   /*                        */
+  rsc_file = fname;				   /*                        */
+  rsc_line = line;				   /*                        */
+}						   /*------------------------*/
@@ -40,6 +40,11 @@
 #include <bibtool/sbuffer.h>
 #include <bibtool/expand.h>
 #include <bibtool/error.h>
+#include <bibtool/parse.h>
+#include <bibtool/stats.h>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
 
 /*****************************************************************************/
 /* Internal Programs							     */
@@ -51,13 +56,24 @@
 #define _ARG(A) ()
 #endif
  char * sput_record _ARG((Record rec,DB db,String start));/* print.c         */
- static int fput_char _ARG((int c));		   /* print.c                */
- static int sput_char _ARG((int c));		   /* print.c                */
- static void indent _ARG((int col,int (*fct)_ARG((int))));/* print.c         */
- static void line_breaking _ARG((String t,int align,int (*fct)_ARG((int))));/* print.c*/
- static void print_equation _ARG((String pre,Symbol s,Symbol t,int align,int (*fct)_ARG((int))));/* print.c*/
- static void puts_in _ARG((String s,int in,int (*fct)_ARG((int))));/* print.c */
+ typedef struct oSINK *OSink;
+ static void os_grow _ARG((OSink os,size_t n));	   /* print.c                */
+ static void os_putc _ARG((OSink os,int c));	   /* print.c                */
+ static void os_write _ARG((OSink os,String s,size_t n));/* print.c          */
+ static void os_record _ARG((OSink os,Record rec,DB db,String start));/* print.c*/
+ static bool os_source _ARG((OSink os,Record rec));/* print.c                */
+ static int adjust_align _ARG((Record rec));	   /* print.c                */
+ static void print_free _ARG((void *state));	   /* print.c                */
+#ifdef HAVE_PTHREAD_H
+ static void * print_worker _ARG((void * arg));	   /* print.c                */
+#endif
+ static void indent _ARG((int col,OSink os));	   /* print.c                */
+ static void line_breaking _ARG((String t,int align,OSink os));/* print.c    */
+ static void print_equation _ARG((String pre,Symbol s,Symbol t,int align,OSink os));/* print.c*/
+ static void puts_in _ARG((String s,int in,OSink os));/* print.c             */
+ static void puts_n _ARG((String s,size_t n,int in,OSink os));/* print.c     */
  void fput_record _ARG((FILE *file,Record rec,DB db,String start));/* print.c*/
+ void fput_records _ARG((FILE *file,Record *recs,int n,DB db,String start,String del_start));/* print.c*/
  void put_record _ARG((int (*fct)_ARG((int)),Record rec,DB db,String start));/* print.c*/
  void rsc_align _ARG((String s));	   	   /* print.c                */
  void set_key_type _ARG((String  s));		   /* print.c                */
@@ -71,7 +87,92 @@
 
 #define TAB_WIDTH 8
 
- static int symbol_type = SYMBOL_TYPE_LOWER;	   /*                        */
+/*-----------------------------------------------------------------------------
+** Typedef*:	OSink
+** Purpose:	An output sink collects the printed representation of a
+**		record in a memory buffer which grows as needed. The
+**		characters are appended in runs and the current column
+**		of the output is tracked. When the record is complete
+**		the buffer is handed over to the destination in one
+**		piece.
+**		The sink is the only state of the formatter. Thus
+**		several records can be formatted at the same time into
+**		different sinks.
+**___________________________________________________			     */
+ typedef struct oSINK				   /*                        */
+ { char   *os_buf;				   /* The buffer.            */
+   size_t os_used;				   /* The bytes used.        */
+   size_t os_size;				   /* The size of the buffer.*/
+   int    os_column;				   /* The current column.    */
+   char   *os_word;				   /* Scratch for a word.    */
+   size_t os_wsize;				   /* The size of the word.  */
+ } SOSink;					   /*                        */
+
+/*-----------------------------------------------------------------------------
+** Typedef*:	SPrintState
+** Purpose:	The state of the print module in a context. It
+**		contains the settings of the formatter and the sinks
+**		for streams and strings.
+**___________________________________________________			     */
+ typedef struct					   /*                        */
+ { int		   symbol_type;			   /* the case of field names*/
+   int		   align_value;			   /*                        */
+   bool		   align_auto;			   /*                        */
+   SOSink	   f_sink;			   /* for streams            */
+   SOSink	   s_sink;			   /* for strings            */
+   bool		   first_record;		   /*                        */
+#ifdef HAVE_PTHREAD_H
+   pthread_mutex_t *p_lock;			   /* guards shared data     */
+#endif
+ } SPrintState;					   /*                        */
+
+/*-----------------------------------------------------------------------------
+** Variable*:	print_state0
+** Type:	SPrintState
+** Purpose:	The initial state of the print module in a context.
+**___________________________________________________			     */
+ static SPrintState print_state0 =		   /*                        */
+ { SYMBOL_TYPE_LOWER,				   /*                        */
+   18,						   /*                        */
+   false,					   /*                        */
+   { NULL, 0, 0, 0, NULL, 0 },			   /*                        */
+   { NULL, 0, 0, 0, NULL, 0 },			   /*                        */
+   true						   /*                        */
+#ifdef HAVE_PTHREAD_H
+   , NULL					   /*                        */
+#endif
+ };						   /*                        */
+
+#define PrintState ((SPrintState*)CtxGet(CTX_PRINT,			\
+					 ctx_state(CTX_PRINT,		\
+						   (void*)&print_state0,\
+						   sizeof(print_state0),\
+						   print_free)))
+
+#define symbol_type  (PrintState->symbol_type)
+#define align_value  (PrintState->align_value)
+#define align_auto   (PrintState->align_auto)
+#define f_sink	     (PrintState->f_sink)
+#define s_sink	     (PrintState->s_sink)
+#define first_record (PrintState->first_record)
+#define p_lock	     (PrintState->p_lock)
+
+/*-----------------------------------------------------------------------------
+** Function*:	print_free()
+** Purpose:	Release the buffers of the sinks when a context is
+**		released.
+** Arguments:
+**	state	the state
+** Returns:	nothing
+**___________________________________________________			     */
+static void print_free(state)			   /*                        */
+  void *state;					   /*                        */
+{ POSSIBLY_UNUSED(state);			   /*                        */
+  if (f_sink.os_buf) free(f_sink.os_buf);	   /*                        */
+  if (f_sink.os_word) free(f_sink.os_word);	   /*                        */
+  if (s_sink.os_buf) free(s_sink.os_buf);	   /*                        */
+  if (s_sink.os_word) free(s_sink.os_word);	   /*                        */
+}						   /*------------------------*/
 
  static String s_upper = (String)"upper";	   /*                        */
  static String s_lower = (String)"lower";	   /*                        */
@@ -148,9 +249,6 @@ void set_key_type(s)				   /*			     */
 #endif
 
 
- static int align_value = 18;
- static bool align_auto = false;
-
 /*-----------------------------------------------------------------------------
 ** Function:	rsc_align()
 ** Purpose:	Parse the value of the resource print.align and set the values
@@ -195,40 +293,106 @@ void rsc_align(s)				   /*			     */
 
 /*-----------------------------------------------------------------------------
 ** Function*:	adjust_align()
-** Purpose:	Set the value of the |align_value| according to the width of the
+** Purpose:	Determine the alignment column according to the width of the
 **		labels of the current record.
 ** Arguments:
 **	rec	the record
-** Returns:	nothing
+** Returns:	the alignment column
 **___________________________________________________			     */
- static void adjust_align(rec)			   /*			     */
+ static int adjust_align(rec)			   /*			     */
   Record rec;					   /*			     */
 { register int i;				   /*			     */
   register int len;				   /*			     */
   Symbol *hp = RecordHeap(rec);			   /*			     */
-  align_value = 0;				   /*			     */
+  int    align = 0;				   /*			     */
 						   /*			     */
   for (i = RecordFree(rec); i > 0; i -= 2)	   /*			     */
   {		   				   /* Not a deleted or       */
     if (*hp && is_allowed(*SymbolValue(*hp))	   /*   private entry        */
         && *(hp+1) )				   /* and is a equation	     */
     { len = strlen(*hp);			   /*			     */
-      if (len > align_value) align_value = len;	   /*			     */
+      if (len > align) align = len;		   /*                        */
     }						   /*			     */
     hp += 2;					   /*			     */
   }						   /*                        */
-  align_value += rsc_indent + (rsc_print_we ? 3 : 1);/*                      */
+  return align + rsc_indent + (rsc_print_we ? 3 : 1);/*                      */
 }						   /*------------------------*/
 
-
-						   /*------------------------*/
- static int column = 0;				   /* The current column of  */
-						   /*  the output stream is  */
-						   /*  kept in this variable.*/
+#define OSinkPutc(OS,C) ((OS)->os_used < (OS)->os_size		\
+			 ? (void)((OS)->os_buf[(OS)->os_used++] = (C))	\
+			 : os_putc(OS, C))
+
+#define column	(os->os_column)
+#define NL	OSinkPutc(os, '\n'), column = 0
+#define PUTC(C) (void)(OSinkPutc(os, C), ++column)
+#define PUTS(S) puts_in((String)(S), 0, os)
+
+#ifdef HAVE_PTHREAD_H
+#define LockPrint()   if (p_lock) (void)pthread_mutex_lock(p_lock)
+#define UnlockPrint() if (p_lock) (void)pthread_mutex_unlock(p_lock)
+#else
+#define LockPrint()
+#define UnlockPrint()
+#endif
 
-#define NL	(void)(*fct)('\n'),column=0
-#define PUTC(C) (void)((*fct)(C),++column)
-#define PUTS(S) puts_in((String)(S), 0, fct)
+/*-----------------------------------------------------------------------------
+** Function*:	os_grow()
+** Purpose:	Make room for at least n more bytes in an output sink.
+**		The size of the buffer is at least doubled.
+** Arguments:
+**	os	the output sink
+**	n	the number of bytes needed
+** Returns:	nothing
+**___________________________________________________			     */
+static void os_grow(os, n)			   /*                        */
+  OSink  os;					   /*                        */
+  size_t n;					   /*                        */
+{ size_t size = os->os_size ? 2 * os->os_size : 8192;/*                      */
+ 						   /*                        */
+  if (os->os_used + n <= os->os_size) return;	   /*                        */
+  while (size < os->os_used + n) size *= 2;	   /*                        */
+  if ((os->os_buf = (os->os_buf			   /*                        */
+		     ? (char*)realloc(os->os_buf, size)/*                    */
+		     : (char*)malloc(size))) == NULL)/*                      */
+  { OUT_OF_MEMORY("print buffer"); }		   /*                        */
+  os->os_size = size;				   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	os_putc()
+** Purpose:	Append a single character to an output sink. This
+**		function is used by the macro |OSinkPutc()| if the
+**		buffer is full. The column is not updated.
+** Arguments:
+**	os	the output sink
+**	c	the character
+** Returns:	nothing
+**___________________________________________________			     */
+static void os_putc(os, c)			   /*                        */
+  OSink os;					   /*                        */
+  int   c;					   /*                        */
+{ os_grow(os, 1);				   /*                        */
+  os->os_buf[os->os_used++] = c;		   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	os_write()
+** Purpose:	Append a run of characters to an output sink. The
+**		column is not updated.
+** Arguments:
+**	os	the output sink
+**	s	the characters
+**	n	the number of characters
+** Returns:	nothing
+**___________________________________________________			     */
+static void os_write(os, s, n)			   /*                        */
+  OSink  os;					   /*                        */
+  String s;					   /*                        */
+  size_t n;					   /*                        */
+{ os_grow(os, n);				   /*                        */
+  memcpy(os->os_buf + os->os_used, s, n);	   /*                        */
+  os->os_used += n;				   /*                        */
+}						   /*------------------------*/
 
 /*-----------------------------------------------------------------------------
 ** Function:	puts_in()
@@ -236,25 +400,54 @@ void rsc_align(s)				   /*			     */
 ** Arguments:
 **	s	string to be printed.
 **	in	indentation. Alignment column.
-**	fct	function to use for writing a character.
+**	os	the output sink
 ** Returns:	nothing
 **___________________________________________________			     */
-static void puts_in(s,in,fct)			   /*			     */
+static void puts_in(s,in,os)			   /*			     */
   register String s;				   /*			     */
   register int  in;				   /*                        */
-  int (*fct)_ARG((int));			   /*                        */
-{						   /*			     */
-  while ( *s )					   /*			     */
-  { (void)(*fct)(*s);			   	   /*                        */
-    switch ( *(s++) )				   /*			     */
+  OSink os;					   /*                        */
+{ puts_n(s, strlen((char*)s), in, os);		   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	puts_n()
+** Purpose:	Print the first n characters of a string and update
+**		current column. Runs of characters without tab or
+**		newline are written at once. The string is not modified.
+** Arguments:
+**	s	string to be printed.
+**	n	the number of characters
+**	in	indentation. Alignment column.
+**	os	the output sink
+** Returns:	nothing
+**___________________________________________________			     */
+static void puts_n(s,n,in,os)			   /*			     */
+  register String s;				   /*			     */
+  size_t        n;				   /*                        */
+  register int  in;				   /*                        */
+  OSink         os;				   /*                        */
+{ String end = s + n;				   /*                        */
+  String p;					   /*                        */
+						   /*			     */
+  while ( s < end )				   /*			     */
+  { for (p = s; p < end && *p != '\t' && *p != '\n'; p++) {}/*               */
+    if ( p > s )				   /*                        */
+    { os_write(os, s, p - s);			   /*                        */
+      column += p - s;				   /*                        */
+      s = p;					   /*                        */
+      if ( s >= end ) break;			   /*                        */
+    }						   /*                        */
+    switch ( *s )				   /*			     */
     { case '\t':				   /*                        */
+	OSinkPutc(os, *s++);			   /*                        */
 	column += TAB_WIDTH - (column%TAB_WIDTH);  /*                        */
 	break;					   /*	                     */
       case '\n':				   /*                        */
-	column = 0;			   	   /*                        */
-        if ( in > 0 ) indent(in, fct);		   /*                        */
+	OSinkPutc(os, *s++);			   /*                        */
+	column = 0;				   /*                        */
+        if ( in > 0 ) indent(in, os);		   /*                        */
         break;  				   /*			     */
-      default: ++column;			   /*			     */
     }						   /*			     */
   }						   /*			     */
 }						   /*------------------------*/
@@ -266,22 +459,22 @@ static void puts_in(s,in,fct)			   /*			     */
 **		The resource use.tabs can be used to disable the use of TAB.
 ** Arguments:
 **	col	Target column
-**	fct	function to use for writing a character.
+**	os	the output sink
 ** Returns:	nothing
 **___________________________________________________			     */
-static void indent(col,fct)			   /*			     */
+static void indent(col,os)			   /*			     */
   register int col;				   /*			     */
-  int (*fct)_ARG((int));			   /*                        */
+  OSink os;					   /*                        */
 {						   /*			     */
   if ( col > rsc_linelen ) col = rsc_linelen;	   /*                        */
   while ( column < col )			   /*			     */
   { if (   rsc_use_tabs				   /*	TAB is allowed and   */
 	&& column+TAB_WIDTH-(column%TAB_WIDTH) <= col )/* enough space left  */
-    { (void)(*fct)('\t');			   /*	then put a TAB and   */
+    { OSinkPutc(os, '\t');			   /*	then put a TAB and   */
       column += TAB_WIDTH - (column%TAB_WIDTH);	   /*	update column.	     */
     }						   /*			     */
     else					   /* otherwise		     */
-    { (void)(*fct)(' ');			   /*  write a single space  */
+    { OSinkPutc(os, ' ');			   /*  write a single space  */
       ++column;					   /*  and advance column.   */
     }						   /*			     */
   }						   /*			     */
@@ -292,27 +485,30 @@ static void indent(col,fct)			   /*			     */
 ** Purpose:	Write out a right hand side of an equation.
 **		If it does not fit break the line into several parts and
 **		print them on successive lines.
-**		Temporarily end marks are placed inside the string,
-**		but the old contents has been restored at the end.
+**		The string is not modified. The parts are passed on as
+**		ranges. Thus symbols can be printed by several threads
+**		at the same time.
 ** Arguments:
 **	t	string to print.
 **	align	starting column for continuation lines.
-**	fct	function to use for writing a character.
+**	os	the output sink
 ** Returns:	nothing
 **___________________________________________________			     */
-static void line_breaking(t, align, fct)	   /*			     */
+static void line_breaking(t, align, os)		   /*                        */
   register String t;				   /* string to print.	     */
   int		 align;				   /* alignment column	     */
-  int            (*fct)_ARG((int));		   /*                        */
+  OSink          os;				   /* the output sink        */
 { register String s;			   	   /* intermediate pointer   */
-  char		  end_c;			   /* temp. character.	     */
+  String	  e;				   /* end of s		     */
   int		  brace,			   /* brace counter	     */
 		  len;				   /* length of rem. output  */
   bool		  first = true;			   /* indicator for #	     */
 						   /*			     */
+#define At(P) ((P) < e ? *(P) : '\0')
+						   /*			     */
   while (is_space(*t)) ++t;			   /* skip leading spaces    */
 						   /*			     */
-  indent(align, fct);				   /* goto alignment column  */
+  indent(align, os);				   /* goto alignment column  */
 						   /*			     */
   while (*t)					   /* as long as sth to print*/
   { s = t;					   /*			     */
@@ -326,8 +522,7 @@ static void line_breaking(t, align, fct)	   /*			     */
 	  { ++t; ++len; }			   /*  similar constructs.   */
 	}					   /*			     */
 	if ( *t ) ++t;				   /* skip after end, if poss*/
-	if ( *t ) { end_c = *t; *t = '\0'; }	   /* save char and mark end.*/
-	else	  { end_c = *t; }		   /*			     */
+	e = t;					   /* mark end.		     */
 	break;					   /*			     */
       case '{':					   /* BRACED PART	     */
 	brace = 1;				   /*			     */
@@ -340,84 +535,93 @@ static void line_breaking(t, align, fct)	   /*			     */
 	    case '}': brace--; break;		   /*			     */
 	  }					   /*			     */
 	}					   /*			     */
-	if ( *t ) { end_c = *t; *t = '\0'; }	   /* save char and mark end.*/
-	else	  { end_c = *t; }		   /*			     */
+	e = t;					   /* mark end.		     */
 	break;					   /*			     */
       default:					   /* Now we should have a   */
 	while ( is_allowed(*t) ) ++t;		   /*	SYMBOL		     */
-	end_c = *t; *t = '\0';			   /*			     */
+	if ( *t )				   /* Copy it if it is not   */
+	{ if ( (size_t)(t - s) >= os->os_wsize )   /*  at the end.           */
+	  { os->os_wsize = t - s + 64;		   /*                        */
+	    os->os_word  = (os->os_word		   /*                        */
+			    ? (char*)realloc(os->os_word, os->os_wsize)/*    */
+			    : (char*)malloc(os->os_wsize));/*                */
+	    if ( os->os_word == NULL )		   /*                        */
+	    { OUT_OF_MEMORY("print buffer"); }	   /*                        */
+	  }					   /*                        */
+	  (void)memcpy(os->os_word, s, t - s);	   /*                        */
+	  os->os_word[t - s] = '\0';		   /*                        */
+	  s = (String)os->os_word;		   /*                        */
+	}					   /*                        */
+	LockPrint();				   /*                        */
 	s = SymbolValue(get_item(symbol(s),	   /*                        */
 				 symbol_type));	   /*			     */
+	UnlockPrint();				   /*                        */
 	len = strlen((char*)s);			   /*			     */
+	e = s + len;				   /*                        */
     }						   /*			     */
 						   /* Now s is a single	     */
 						   /*  string to print.	     */
-						   /* t points to the closing*/
-						   /*  '\0' of s	     */
-						   /* end_c is the old *t    */
-    while ( *s )				   /*			     */
+						   /* e points to the end    */
+						   /*  of s		     */
+    while ( At(s) )				   /*			     */
     { if ( len + (first?0:3) <= rsc_linelen - column)/* Is there enough space*/
       { if ( !first ) PUTS(" # ");	   	   /* Maybe add separator    */
-	puts_in(s, align, fct);			   /* write it out	     */
-	s = t;					   /* and we are done	     */
+	puts_n(s, e - s, align, os);		   /* write it out	     */
+	s = e;					   /* and we are done	     */
       }						   /*			     */
       else if ( !first )			   /* If sth has been before */
-      { puts_in((String)"\n# ", align - 2, fct);   /*  start a new line	     */
+      { puts_in((String)"\n# ", align - 2, os);	   /* start a new line       */
 	first = true;				   /*			     */
       }						   /* Now we have to break   */
       else					   /*  a single entry	     */
-      { Uchar  save_c;			   	   /*                        */
-	String save_ptr,		   	   /*                        */
+      { String save_ptr,		   	   /*                        */
 	       ptr;			   	   /*			     */
 						   /*			     */
         if ( 0 <= rsc_linelen - column )	   /*                        */
 	  save_ptr = s + rsc_linelen - column;	   /* Potential end	     */
 	else					   /*                        */
 	  save_ptr = s;				   /*                        */
+	if ( save_ptr > e ) save_ptr = e;	   /*                        */
  						   /*                        */
 	for ( ptr = s;				   /* Search next newline    */
 	      ptr < save_ptr && *ptr != '\n';	   /*  or end of region      */
 	      ptr++ ) {}			   /*                        */
  						   /*                        */
-	if ( *ptr == '\n' )			   /*                        */
+	if ( At(ptr) == '\n' )			   /*                        */
 	{ save_ptr = ptr;			   /*                        */
-	  *save_ptr = '\0';	   		   /* Save and mark end.     */
-	  puts_in(s, align, fct);		   /*                        */
+	  puts_n(s, save_ptr - s, align, os);	   /*                        */
 	  NL;					   /*                        */
-	  indent(align,fct);	   		   /*			     */
-	  *save_ptr = '\n';			   /* Restore end	     */
+	  indent(align,os);	   		   /*			     */
 	  len += s - save_ptr - 1;		   /* Update the length	     */
 	  s = save_ptr + 1;			   /*			     */
 	}					   /*                        */
 	else					   /*                        */
 	{					   /*                        */
-	  while ( save_ptr != s && *save_ptr != ' ' )/*                      */
+	  while ( save_ptr != s && At(save_ptr) != ' ' )/*                   */
 	  { save_ptr--; }			   /* Find a  SPC  backward  */
 	  					   /*			     */
 	  if ( save_ptr == s  )			   /* If no SPC found then   */
-	  { while ( *save_ptr && *save_ptr != ' ' )/*  search one forward.   */
+	  { while ( At(save_ptr) && At(save_ptr) != ' ' )/* search one forward*/
 	    { save_ptr++; }	   		   /*                        */
 	  }					   /*                        */
 	  len += s - save_ptr;			   /* Update the length	     */
-	  save_c = *save_ptr; *save_ptr = '\0';	   /* Save and mark end.     */
-	  puts_in(s, align, fct);		   /*                        */
-	  if (save_c != 0)			   /*                        */
+	  puts_n(s, save_ptr - s, align, os);	   /*                        */
+	  if ( At(save_ptr) != 0 )		   /*                        */
 	  { NL;					   /*                        */
-	    indent(align, fct);	   		   /*			     */
+	    indent(align, os);	   		   /*			     */
 	  }					   /*                        */
-	  *save_ptr = save_c;			   /* Restore end	     */
 	  s = save_ptr;	   			   /*			     */
-	  while ( is_space(*s) ) { s++; len--; }   /* Skip spaces	     */
+	  while ( is_space(At(s)) ) { s++; len--; }/* Skip spaces	     */
 	}					   /*                        */
       }						   /*			     */
     }						   /*			     */
-    *t = end_c;					   /* Restore the end	     */
 						   /*			     */
     while ( *t && *t != '#' ) ++t;		   /* Search next #	     */
     if ( *t ) ++t;				   /* Skip beyond the #	     */
     while ( is_space(*t) ) ++t;			   /* Ignore following spaces*/
     first = false;				   /*			     */
   }						   /*			     */
+#undef At
 }						   /*------------------------*/
 
 /*-----------------------------------------------------------------------------
@@ -430,171 +634,100 @@ static void line_breaking(t, align, fct)	   /*			     */
 **	s	left hand side
 **	t	right hand side
 **	align	target column. If negative no indentation is performed.
-**	fct	function to use for writing a character.
+**	os	the output sink
 ** Returns:	nothing
 **___________________________________________________'			     */
-static void print_equation(pre, lhs, rhs, align, fct)/*			     */
+static void print_equation(pre, lhs, rhs, align, os)/*			     */
   String pre;					   /*                        */
   Symbol lhs;				   	   /*			     */
   Symbol rhs;				   	   /*			     */
   int  align;				   	   /*			     */
-  int (*fct)_ARG((int));			   /*                        */
+  OSink os;					   /*                        */
 {						   /*			     */
-  if ( align >= 0 ) indent(rsc_indent, fct);	   /*			     */
+  if ( align >= 0 ) indent(rsc_indent, os);	   /*			     */
 						   /*			     */
   PUTS(pre);		   			   /*			     */
-  PUTS(SymbolValue(get_item(lhs, symbol_type)));   /*			     */
+  LockPrint();					   /*                        */
+  lhs = get_item(lhs, symbol_type);		   /*                        */
+  UnlockPrint();				   /*                        */
+  PUTS(SymbolValue(lhs));			   /*                        */
 						   /*			     */
   if ( align < 0 ) {}				   /*			     */
   else if ( rsc_print_we && column > align - 2 )   /*                        */
   { PUTC(' '); }				   /*                        */
   else if ( rsc_eq_right )			   /*                        */
-  { indent(align - (rsc_print_we ? 3: align_auto? 1 : 2), fct); }/*	     */
+  { indent(align - (rsc_print_we ? 3: align_auto? 1 : 2), os); }/*	     */
   else if ( column < align || rsc_print_we )	   /*                        */
   { PUTC(' '); }	   			   /*                        */
 						   /*			     */
   PUTS(rsc_print_we ? " = " : "=");		   /*                        */
-  line_breaking(SymbolValue(rhs), align, fct);     /*			     */
-}						   /*------------------------*/
-
- static FILE * ofile = NULL;
-
-/*-----------------------------------------------------------------------------
-** Function:	fput_char()
-** Purpose:	Output function which places the character on the |ofile| 
-**		stream.
-** Arguments:
-**	c	Character to print.
-** Returns:	The return status of |fputc()|.
-**___________________________________________________			     */
-static int fput_char(c)				   /*                        */
-  int c;					   /*                        */
-{ return fputc(c, ofile);			   /*                        */
-}						   /*------------------------*/
-
-/*-----------------------------------------------------------------------------
-** Function:	fput_record()
-** Purpose:	Format and print a complete record onto a given stream.
-**		for further details see |put_record()|.
-** Arguments:
-**	file	Stream to print onto.
-**	db	Database containing the record.
-**	rec	Record to print.
-**	start	Initial string used before the type. Should be "@" normally.
-** Returns:	nothing
-**___________________________________________________			     */
-void fput_record(file, rec, db, start)	   	   /*			     */
-  FILE	 *file;			   		   /*                        */
-  DB	 db;			   		   /*                        */
-  Record rec;			   		   /* record to print	     */
-  String start;		   	   	   	   /* initial string = "@"   */
-{						   /*                        */
-  ofile = file;					   /*                        */
-  put_record(fput_char, rec, db, start);	   /*                        */
+  line_breaking(SymbolValue(rhs), align, os);	   /*                        */
 }						   /*------------------------*/
 
- static StringBuffer *osb = NULL;
-
 /*-----------------------------------------------------------------------------
-** Function:	sput_char()
-** Purpose:	Output function which places the character on the |osb| 
-**		string buffer.
+** Function*:	os_source()
+** Purpose:	Copy the source text of a record into an output sink.
+**		This is done only if \rsc{print.verbatim} is on and the
+**		record has not been modified since it has been read.
+**		Macros are expanded while printing. Thus records are
+**		not copied if \rsc{expand.macros} is on.
 ** Arguments:
-**	c	Character to print.
-** Returns:	The return status of |fputc()|.
+**	os	the output sink
+**	rec	the record
+** Returns:	|true| iff the source text has been copied.
 **___________________________________________________			     */
-static int sput_char(c)				   /*                        */
-  int c;					   /*                        */
-{ return sbputchar(c, osb);			   /*                        */
+static bool os_source(os, rec)			   /*                        */
+  OSink  os;					   /*                        */
+  Record rec;					   /*                        */
+{ String s;					   /*                        */
+  long	 i;					   /*                        */
+ 						   /*                        */
+  if (!rsc_print_verbatim	||		   /*                        */
+      rsc_expand_macros		||		   /*                        */
+      RecordOffset(rec) < 0L	||		   /*                        */
+      RecordIsDIRTY(rec)	||		   /*                        */
+      RecordIsDELETED(rec))			   /*                        */
+  { return false; }				   /*                        */
+ 						   /*                        */
+  LockPrint();					   /*                        */
+  s = bib_source(RecordSource(rec),		   /*                        */
+		 RecordOffset(rec),		   /*                        */
+		 RecordLength(rec));		   /*                        */
+  if (s != StringNULL)				   /*                        */
+  { os_write(os, s, (size_t)RecordLength(rec));	   /*                        */
+    for (i = RecordLength(rec); i > 0 && s[i-1] != '\n'; i--) {}/*           */
+    column = (int)(RecordLength(rec) - i);	   /*                        */
+  }						   /*                        */
+  UnlockPrint();				   /*                        */
+  return s != StringNULL;			   /*                        */
 }						   /*------------------------*/
 
 /*-----------------------------------------------------------------------------
-** Function:	sput_record()
-** Purpose:	Format and print a complete record into a string and return it.
-**		The string returned points to static memory which is
-**		reused upon the next invocation of this function.
+** Function*:	os_record()
+** Purpose:	Format a complete record into an output sink. See
+**		|put_record()| for details.
 ** Arguments:
-**	file	Stream to print onto.
-**	db	Database containing the record.
+**	os	the output sink
 **	rec	Record to print.
-**	start	Initial string used before the type. Should be "@" normally.
-** Returns:	The string containing the printed representation.
-**___________________________________________________			     */
-char * sput_record(rec, db, start)	   	   /*			     */
-  DB	 db;			   		   /*                        */
-  Record rec;			   		   /* record to print	     */
-  String start;		   	   	   	   /* initial string = "@"   */
-{						   /*                        */
-  if ( osb == NULL ) osb = sbopen();		   /*                        */
-  sbrewind(osb);				   /*                        */
-  put_record(sput_char, rec, db, start);	   /*                        */
-  return sbflush(osb);				   /*                        */
-}						   /*------------------------*/
-
-/*-----------------------------------------------------------------------------
-** Function:	put_record()
-** Purpose:	Format and print a complete record.
-**		The record type and several resources are taken into
-**		account. The following external variables (from
-**		|rsc.c|) are taken into account:
-**		\begin{description}
-**		\item[rsc\_parentheses] If this boolean variable is
-**		  |true| then |(| and |)| are used to delimit the
-**		  record. Otherwise |{| and |}| are used.
-**		\item[rsc\_col\_p] This integer variable controls the
-**		  indentation of preamble records.
-**		\item[rsc\_col\_s] This integer variable controls the
-**		  indentation of string records.
-**		\item[rsc\_expand\_macros] If this boolean variable is
-**		  set then macros are expanded before the record is
-**		  printed. This does not effect the internal
-**		  representation. 
-**		\item[rsc\_col] This integer variable controls the
-**		  indentation of normal records.
-**		\item[rsc\_col\_key] This integer variable controls the
-**		  indentation of the key in a normal record.
-**		\item[rsc\_newlines] This integer variable controls
-**		  the number of newlines printed after a normal record.
-**		\item[rsc\_linelen] This integer variable controls
-**		  the length of the line. The line breaking algorithm
-**		  is applied if this column is about to be violated.
-**		\item[rsc\_indent] This integer variable controls the
-**		  indentation of equations.
-**		\item[rsc\_eq\_right] This boolean variable controls
-**		  the alignment of the |=| in equations. It it is set
-**		  then the equality sign is flushed right. Otherwise it
-**		  is flushed left.
-**		\end{description}
-**
-**		The field in the record are sorted with
-**		|sort_record()| before they are printed.
-**
-**		In normal records all fields not starting with an
-**		allowed character are ignored. Thus it is possible to
-**		store private and invisible information in a
-**		field. Simply start the field name with an not allowed
-**		character like |%|.
-** Arguments:
-**	fct	function to use for writing a character.
 **	db	Database containing the record.
-**	rec	Record to print.
 **	start	Initial string used before the type. Should be "@" normally.
 ** Returns:	nothing
 **___________________________________________________			     */
-void put_record(fct, rec, db, start)		   /*                        */
-  int	       (*fct)_ARG((int));		   /*                        */
+static void os_record(os, rec, db, start)	   /*                        */
+  OSink	       os;				   /*                        */
   Record       rec;				   /*                        */
   DB	       db;				   /*                        */
   String       start;		   	   	   /* initial string = "@"   */
 { Symbol       *hp;			   	   /* heap pointer	     */
+  Symbol       rhs;				   /*                        */
   unsigned int i;			   	   /*			     */
+  int	       align = align_value;		   /*                        */
   char	       open_brace, close_brace;		   /*			     */
-  static int   first = 1;			   /*                        */
   						   /*                        */
   sort_record(rec);				   /*                        */
  						   /*                        */
   hp = RecordHeap(rec);				   /*			     */
-  if ( rsc_no_nl && first ) { first = 0; }	   /*                        */
+  if ( rsc_no_nl && first_record ) { first_record = false; }/*               */
   else if ( IsNormalRecord(RecordType(rec)) ) { NL; }/*			     */
  						   /*                        */
   if ( *SymbolValue(RecordComment(rec)) )	   /*                        */
@@ -614,7 +747,7 @@ void put_record(fct, rec, db, start)		   /*                        */
   switch (RecordType(rec))			   /*			     */
   { case BIB_COMMENT:				   /*			     */
 #ifdef OLD
-      indent(rsc_col_c, fct);			   /*			     */
+      indent(rsc_col_c, os);			   /*			     */
       PUTS(*hp);				   /*			     */
       PUTC(' ');				   /*                        */
       NL;				   	   /*			     */
@@ -624,10 +757,10 @@ void put_record(fct, rec, db, start)		   /*                        */
       PUTS(start);				   /*			     */
       PUTS(SymbolValue(EntryName(RecordType(rec))));/*			     */
       PUTC(open_brace);				   /*			     */
-      indent(rsc_col_p,fct);			   /*			     */
+      indent(rsc_col_p,os);			   /*			     */
       line_breaking(SymbolValue(*hp),		   /*                        */
 		    rsc_col_p,			   /*                        */
-		    fct);	   		   /*			     */
+		    os);	   		   /*			     */
       PUTC(' ');				   /*                        */
       PUTC(close_brace);			   /*                        */
       NL;				   	   /*			     */
@@ -640,7 +773,7 @@ void put_record(fct, rec, db, start)		   /*                        */
 		     *hp,		   	   /*                        */
 		     *(hp+1),	   		   /*                        */
 		     rsc_col_s,			   /*                        */
-		     fct);			   /*		             */
+		     os);			   /*		             */
       PUTC(' ');				   /*                        */
       PUTC(close_brace);			   /*                        */
       NL;				   	   /*			     */
@@ -653,7 +786,7 @@ void put_record(fct, rec, db, start)		   /*                        */
 		     *hp,		   	   /*                        */
 		     *(hp+1),	   		   /*                        */
 		     rsc_col_s,			   /*                        */
-		     fct);			   /*		             */
+		     os);			   /*		             */
       PUTC(' ');				   /*                        */
       PUTC(close_brace);			   /*                        */
       NL;				   	   /*			     */
@@ -672,6 +805,11 @@ void put_record(fct, rec, db, start)		   /*                        */
       if (RecordType(rec) == type_xdata		   /*                        */
 	  && rsc_expand_xdata) return;		   /*                        */
  						   /*                        */
+      if (os_source(os, rec))			   /* Unmodified records are */
+      { for ( i = rsc_newlines; i > 0; --i ) { NL; }/*  copied.              */
+	return;					   /*                        */
+      }						   /*                        */
+ 						   /*                        */
       PUTS(start);				   /*			     */
       PUTS(SymbolValue(EntryName(RecordType(rec))));/*			     */
       PUTC(open_brace);				   /*			     */
@@ -684,7 +822,7 @@ void put_record(fct, rec, db, start)		   /*                        */
 	}					   /*                        */
  						   /*                        */
  	if (align_auto)				   /*                        */
-	{ adjust_align(rec);			   /*                        */
+	{ align = adjust_align(rec);		   /*                        */
 	}					   /*                        */
  						   /*                        */
         for ( i = RecordFree(rec); i > 0; i -= 2 ) /*			     */
@@ -694,25 +832,32 @@ void put_record(fct, rec, db, start)		   /*                        */
 	    if ( *(hp+1) )			   /* If equation	     */
 	    { PUTS(comma1);			   /*                        */
 	      NL;			   	   /*                        */
+	      rhs = *(hp+1);			   /*                        */
+	      if (rsc_expand_macros)		   /*                        */
+	      { LockPrint();			   /*                        */
+		rhs = expand_rhs(rhs,		   /*                        */
+				 (rsc_braces	   /*                        */
+				  ? sym_open_brace /*                        */
+				  : sym_double_quote),/*                     */
+				 (rsc_braces	   /*                        */
+				  ? sym_close_brace/*                        */
+				  : sym_double_quote),/*                     */
+				 db,		   /*                        */
+				 false);	   /*                        */
+		UnlockPrint();			   /*                        */
+	      }					   /*                        */
 	      print_equation(comma2,		   /*                        */
 			     *hp,	   	   /*                        */
-			     (rsc_expand_macros	   /*                        */
-			      ? expand_rhs(*(hp+1),/*                        */
-					   (rsc_braces/*                     */
-					    ? sym_open_brace/*               */
-					    : sym_double_quote),/*           */
-					   (rsc_braces/*                     */
-					    ? sym_close_brace/*              */
-					    : sym_double_quote),/*           */
-					   db,	   /*                        */
-					   false)  /*                        */
-			      : *(hp+1) ),	   /*                        */
-			     align_value,	   /*                        */
-			     fct);		   /*                        */
+			     rhs,		   /*                        */
+			     align,		   /*                        */
+			     os);		   /*                        */
 	    }					   /*			     */
 	    else				   /* Otherwise print a key  */
-	    { indent(rsc_col_key, fct);		   /*			     */
-	      PUTS(SymbolValue(get_key(*hp)));	   /*			     */
+	    { indent(rsc_col_key, os);		   /*			     */
+	      LockPrint();			   /*                        */
+	      rhs = get_key(*hp);		   /*                        */
+	      UnlockPrint();			   /*                        */
+	      PUTS(SymbolValue(rhs));		   /*                        */
 	    }					   /*			     */
 	  }					   /*			     */
 	  hp += 2;				   /* Goto next pair.	     */
@@ -724,3 +869,309 @@ void put_record(fct, rec, db, start)		   /*                        */
       for ( i = rsc_newlines; i > 0; --i ) { NL; } /*                        */
   }						   /*			     */
 }						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	fput_record()
+** Purpose:	Format and print a complete record onto a given stream.
+**		The record is collected in a buffer which is written
+**		with a single call to |fwrite()|.
+**		For further details see |put_record()|.
+** Arguments:
+**	file	Stream to print onto.
+**	db	Database containing the record.
+**	rec	Record to print.
+**	start	Initial string used before the type. Should be "@" normally.
+** Returns:	nothing
+**___________________________________________________			     */
+void fput_record(file, rec, db, start)	   	   /*			     */
+  FILE	 *file;			   		   /*                        */
+  DB	 db;			   		   /*                        */
+  Record rec;			   		   /* record to print	     */
+  String start;		   	   	   	   /* initial string = "@"   */
+{						   /*                        */
+  f_sink.os_used = 0;				   /*                        */
+  os_record(&f_sink, rec, db, start);		   /*                        */
+  if (f_sink.os_used > 0)			   /*                        */
+  { (void)fwrite(f_sink.os_buf, 1, f_sink.os_used, file);/*                  */
+    StatCount(st_bytes, f_sink.os_used);	   /*                        */
+  }						   /*                        */
+}						   /*------------------------*/
+
+#ifdef HAVE_PTHREAD_H
+
+#define PRINT_BATCH 64
+
+ typedef struct pRINTjOB
+ { Record	 *pj_recs;			   /* the records to print   */
+   int		 pj_n;				   /* the number of records  */
+   DB		 pj_db;				   /* the database           */
+   String	 pj_start;			   /* the prefix             */
+   String	 pj_del_start;			   /* the prefix if deleted  */
+   int		 pj_batches;			   /* the number of batches  */
+   int		 pj_next;			   /* the next unclaimed one */
+   int		 pj_written;			   /* the batches written    */
+   int		 pj_window;			   /* the number of sinks    */
+   SOSink	 *pj_sink;			   /* the sinks              */
+   bool		 *pj_done;			   /* the sink is filled     */
+   pthread_mutex_t pj_lock;			   /* guards the counters    */
+   pthread_cond_t  pj_cond;			   /* signals changes        */
+   Context	   pj_ctx;			   /* the context            */
+ } SPrintJob, *PrintJob;
+
+/*-----------------------------------------------------------------------------
+** Function*:	print_worker()
+** Purpose:	Thread function for the parallel printing. Batches of
+**		records are claimed from the job and formatted into
+**		one of the sinks of the job. A batch is only claimed if
+**		its sink has already been written. Thus at most
+**		|pj_window| batches are kept in memory.
+** Arguments:
+**	arg	the job
+** Returns:	|NULL|
+**___________________________________________________			     */
+static void * print_worker(arg)			   /*                        */
+  void * arg;					   /*                        */
+{ PrintJob job = (PrintJob)arg;			   /*                        */
+  OSink    os;					   /*                        */
+  Record   rec;					   /*                        */
+  int      b, i, n;				   /*                        */
+ 						   /*                        */
+  (void)ctx_use(job->pj_ctx);			   /* use the callers context*/
+  for (;;)					   /*                        */
+  { (void)pthread_mutex_lock(&job->pj_lock);	   /*                        */
+    while (job->pj_next < job->pj_batches &&	   /*                        */
+	   job->pj_next >= job->pj_written + job->pj_window)/*               */
+    { (void)pthread_cond_wait(&job->pj_cond, &job->pj_lock); }/*             */
+    b = job->pj_next++;				   /*                        */
+    (void)pthread_mutex_unlock(&job->pj_lock);	   /*                        */
+    if (b >= job->pj_batches) break;		   /*                        */
+ 						   /*                        */
+    os = &job->pj_sink[b % job->pj_window];	   /*                        */
+    os->os_used = 0;				   /*                        */
+    n = (b + 1) * PRINT_BATCH;			   /*                        */
+    if (n > job->pj_n) n = job->pj_n;		   /*                        */
+    for (i = b * PRINT_BATCH; i < n; i++)	   /*                        */
+    { rec = job->pj_recs[i];			   /*                        */
+      os_record(os,				   /*                        */
+		rec,				   /*                        */
+		job->pj_db,			   /*                        */
+		RecordIsDELETED(rec)		   /*                        */
+		? job->pj_del_start		   /*                        */
+		: job->pj_start);		   /*                        */
+    }						   /*                        */
+ 						   /*                        */
+    (void)pthread_mutex_lock(&job->pj_lock);	   /*                        */
+    job->pj_done[b % job->pj_window] = true;	   /*                        */
+    (void)pthread_cond_broadcast(&job->pj_cond);   /*                        */
+    (void)pthread_mutex_unlock(&job->pj_lock);	   /*                        */
+  }						   /*                        */
+  return NULL;					   /*                        */
+}						   /*------------------------*/
+#endif
+
+/*-----------------------------------------------------------------------------
+** Function:	fput_records()
+** Purpose:	Format and print a sequence of records onto a given
+**		stream. Records marked as deleted are printed with the
+**		prefix |del_start|; all others with |start|.
+**
+**		If the resource |print.threads| is larger than 1 then
+**		the records are formatted in batches by several
+**		threads. Each batch is collected in a private buffer.
+**		The calling thread writes the buffers in the order of
+**		the records. Thus the output is the same as if
+**		|fput_record()| had been called for each record in
+**		turn.
+** Arguments:
+**	file	Stream to print onto.
+**	recs	the records to print
+**	n	the number of records
+**	db	Database containing the records.
+**	start	Initial string used before the type. Should be "@" normally.
+**	del_start	Initial string used for deleted records.
+** Returns:	nothing
+**___________________________________________________			     */
+void fput_records(file, recs, n, db, start, del_start)/*                     */
+  FILE	 *file;					   /*                        */
+  Record *recs;					   /*                        */
+  int	 n;					   /*                        */
+  DB	 db;					   /*                        */
+  String start;					   /*                        */
+  String del_start;				   /*                        */
+{ int	 i;					   /*                        */
+#ifdef HAVE_PTHREAD_H
+  SPrintJob       job;				   /*                        */
+  pthread_mutex_t lock;				   /*                        */
+  pthread_t       *tids;			   /*                        */
+  int             threads;			   /*                        */
+ 						   /*                        */
+  if (n > 0 && rsc_no_nl && first_record)	   /* The first record is    */
+  { fput_record(file,				   /* special.               */
+		recs[0],			   /*                        */
+		db,				   /*                        */
+		RecordIsDELETED(recs[0]) ? del_start : start);/*             */
+    recs++;					   /*                        */
+    n--;					   /*                        */
+  }						   /*                        */
+  job.pj_batches = (n + PRINT_BATCH - 1) / PRINT_BATCH;/*                    */
+  threads	 = rsc_print_threads;		   /*                        */
+  if (threads > job.pj_batches) threads = job.pj_batches;/*                  */
+  for (i = 0; i < n && threads > 1; i++)	   /* Only normal records    */
+  { if (!IsNormalRecord(RecordType(recs[i])))	   /* start in column 0.     */
+    { threads = 0; }				   /*                        */
+  }						   /*                        */
+  if (threads > 1 &&				   /*                        */
+      (tids = (pthread_t*)malloc(threads * sizeof(pthread_t))) != NULL)/*    */
+  { job.pj_recs	     = recs;			   /*                        */
+    job.pj_n	     = n;			   /*                        */
+    job.pj_db	     = db;			   /*                        */
+    job.pj_start     = start;			   /*                        */
+    job.pj_del_start = del_start;		   /*                        */
+    job.pj_next	     = 0;			   /*                        */
+    job.pj_written   = 0;			   /*                        */
+    job.pj_window    = 4 * threads;		   /*                        */
+    job.pj_ctx	     = ctx_current();		   /*                        */
+    job.pj_sink = (SOSink*)calloc(job.pj_window, sizeof(SOSink));/*          */
+    job.pj_done = (bool*)calloc(job.pj_window, sizeof(bool));/*              */
+    if ( job.pj_sink == NULL || job.pj_done == NULL )/*                      */
+    { OUT_OF_MEMORY("print buffer"); }		   /*                        */
+    (void)pthread_mutex_init(&job.pj_lock, NULL);  /*                        */
+    (void)pthread_cond_init(&job.pj_cond, NULL);   /*                        */
+    (void)pthread_mutex_init(&lock, NULL);	   /*                        */
+    p_lock = &lock;				   /*                        */
+ 						   /*                        */
+    for (threads = 0; threads < job.pj_window / 4; threads++)/*              */
+    { if (pthread_create(&tids[threads], NULL, print_worker, &job) != 0)/*   */
+	break;					   /*                        */
+    }						   /*                        */
+ 						   /*                        */
+    for (i = 0; threads > 0 && i < job.pj_batches; i++)/* Write the batches  */
+    { OSink os = &job.pj_sink[i % job.pj_window];  /* in order.              */
+      (void)pthread_mutex_lock(&job.pj_lock);	   /*                        */
+      while (!job.pj_done[i % job.pj_window])	   /*                        */
+      { (void)pthread_cond_wait(&job.pj_cond, &job.pj_lock); }/*             */
+      (void)pthread_mutex_unlock(&job.pj_lock);	   /*                        */
+      if (os->os_used > 0)			   /*                        */
+      { (void)fwrite(os->os_buf, 1, os->os_used, file);/*                    */
+	StatCount(st_bytes, os->os_used);	   /*                        */
+      }						   /*                        */
+      f_sink.os_column = os->os_column;		   /*                        */
+      (void)pthread_mutex_lock(&job.pj_lock);	   /*                        */
+      job.pj_done[i % job.pj_window] = false;	   /*                        */
+      job.pj_written++;				   /*                        */
+      (void)pthread_cond_broadcast(&job.pj_cond);  /*                        */
+      (void)pthread_mutex_unlock(&job.pj_lock);	   /*                        */
+    }						   /*                        */
+    for (i = 0; i < threads; i++)		   /*                        */
+    { (void)pthread_join(tids[i], NULL); }	   /*                        */
+ 						   /*                        */
+    p_lock = NULL;				   /*                        */
+    (void)pthread_mutex_destroy(&lock);		   /*                        */
+    (void)pthread_cond_destroy(&job.pj_cond);	   /*                        */
+    (void)pthread_mutex_destroy(&job.pj_lock);	   /*                        */
+    for (i = 0; i < job.pj_window; i++)		   /*                        */
+    { if (job.pj_sink[i].os_buf) free(job.pj_sink[i].os_buf);/*              */
+      if (job.pj_sink[i].os_word) free(job.pj_sink[i].os_word);/*            */
+    }						   /*                        */
+    free(job.pj_sink);				   /*                        */
+    free(job.pj_done);				   /*                        */
+    free(tids);					   /*                        */
+    if (threads > 0) return;			   /* Otherwise print serially*/
+  }						   /*                        */
+#endif
+  for (i = 0; i < n; i++)			   /*                        */
+  { fput_record(file,				   /*                        */
+		recs[i],			   /*                        */
+		db,				   /*                        */
+		RecordIsDELETED(recs[i]) ? del_start : start);/*             */
+  }						   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	sput_record()
+** Purpose:	Format and print a complete record into a string and return it.
+**		The string returned points to static memory which is
+**		reused upon the next invocation of this function.
+** Arguments:
+**	db	Database containing the record.
+**	rec	Record to print.
+**	start	Initial string used before the type. Should be "@" normally.
+** Returns:	The string containing the printed representation.
+**___________________________________________________			     */
+char * sput_record(rec, db, start)	   	   /*			     */
+  DB	 db;			   		   /*                        */
+  Record rec;			   		   /* record to print	     */
+  String start;		   	   	   	   /* initial string = "@"   */
+{						   /*                        */
+  s_sink.os_used = 0;				   /*                        */
+  os_record(&s_sink, rec, db, start);		   /*                        */
+  OSinkPutc(&s_sink, '\0');			   /*                        */
+  return s_sink.os_buf;				   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	put_record()
+** Purpose:	Format and print a complete record.
+**		The record is formatted into a buffer first. Then
+**		the characters are passed to the function |fct|.
+**		The record type and several resources are taken into
+**		account. The following external variables (from
+**		|rsc.c|) are taken into account:
+**		\begin{description}
+**		\item[rsc\_parentheses] If this boolean variable is
+**		  |true| then |(| and |)| are used to delimit the
+**		  record. Otherwise |{| and |}| are used.
+**		\item[rsc\_col\_p] This integer variable controls the
+**		  indentation of preamble records.
+**		\item[rsc\_col\_s] This integer variable controls the
+**		  indentation of string records.
+**		\item[rsc\_expand\_macros] If this boolean variable is
+**		  set then macros are expanded before the record is
+**		  printed. This does not effect the internal
+**		  representation. 
+**		\item[rsc\_col] This integer variable controls the
+**		  indentation of normal records.
+**		\item[rsc\_col\_key] This integer variable controls the
+**		  indentation of the key in a normal record.
+**		\item[rsc\_newlines] This integer variable controls
+**		  the number of newlines printed after a normal record.
+**		\item[rsc\_linelen] This integer variable controls
+**		  the length of the line. The line breaking algorithm
+**		  is applied if this column is about to be violated.
+**		\item[rsc\_indent] This integer variable controls the
+**		  indentation of equations.
+**		\item[rsc\_eq\_right] This boolean variable controls
+**		  the alignment of the |=| in equations. It it is set
+**		  then the equality sign is flushed right. Otherwise it
+**		  is flushed left.
+**		\end{description}
+**
+**		The field in the record are sorted with
+**		|sort_record()| before they are printed.
+**
+**		In normal records all fields not starting with an
+**		allowed character are ignored. Thus it is possible to
+**		store private and invisible information in a
+**		field. Simply start the field name with an not allowed
+**		character like |%|.
+** Arguments:
+**	fct	function to use for writing a character.
+**	db	Database containing the record.
+**	rec	Record to print.
+**	start	Initial string used before the type. Should be "@" normally.
+** Returns:	nothing
+**___________________________________________________			     */
+void put_record(fct, rec, db, start)		   /*                        */
+  int	       (*fct)_ARG((int));		   /*                        */
+  Record       rec;				   /*                        */
+  DB	       db;				   /*                        */
+  String       start;		   	   	   /* initial string = "@"   */
+{ register String s, end;			   /* unsigned: 0..255       */
+ 						   /*                        */
+  f_sink.os_used = 0;				   /*                        */
+  os_record(&f_sink, rec, db, start);		   /*                        */
+  s   = (String)f_sink.os_buf;			   /*                        */
+  end = s + f_sink.os_used;			   /*                        */
+  for (; s < end; s++)				   /*                        */
+  { (void)(*fct)(*s); }				   /*                        */
+}						   /*------------------------*/
@@ -70,6 +70,7 @@
  char ** px_s2p _ARG((char * s,int sep));
  static bool absolute_file _ARG((char *name,char **basename,char ***path));
  static void expand_env _ARG((char * s,char * se,StringBuffer * res));
+ static void px_free _ARG((void *state));
 
 /*****************************************************************************/
 /* External Programs							     */
@@ -79,20 +80,53 @@
 /*****************************************************************************/
 
 /*-----------------------------------------------------------------------------
-** Variable:	px_filename
-** Purpose:	This variable contains the file name actually used by
-**		the last |px_fopen()| call. The memory is automatically
-**		managed and will be reused by the next call to
-**		|px_fopen()|.  Thus if you need to use it make a
-**		private copy immediately after the call to the
-**		function |px_fopen()|.
+** Variable*:	px_state0
+** Type:	SPxState
+** Purpose:	The initial state of the pxfile module in a context.
 **___________________________________________________			     */
- char	       *px_filename   = "" ;
- static size_t px_len	      = 0  ;
+ static SPxState px_state0 =			   /*                        */
+ { "",						   /*                        */
+   0,						   /*                        */
+   { NULL, NULL }				   /*                        */
+ };						   /*                        */
+
+#define px_len (PxState->px_len)
 
  static char   * no_path[]    = { "."		 , NULL };
  static char   * no_pattern[] = { DEFAULT_PATTERN, NULL };
 
+/*-----------------------------------------------------------------------------
+** Function*:	px_free()
+** Type:	void
+** Purpose:	Release the file names of the pxfile module when a
+**		context is released.
+** Arguments:
+**	state	the state
+** Returns:	nothing
+**___________________________________________________			     */
+static void px_free(state)			   /*                        */
+  void *state;					   /*                        */
+{ POSSIBLY_UNUSED(state);			   /*                        */
+  if (px_len > 0) free(px_filename);		   /*                        */
+  if (PxState->px_abs_path[0]) free(PxState->px_abs_path[0]);/*              */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	px_state()
+** Type:	SPxState*
+** Purpose:	Create the state of the pxfile module in the current
+**		context. This function is used by the macro |PxState|
+**		when the state does not exist yet.
+** Arguments:	none
+** Returns:	the state
+**___________________________________________________			     */
+SPxState * px_state()				   /*                        */
+{ return (SPxState*)ctx_state(CTX_PXFILE,	   /*                        */
+			      (void*)&px_state0,   /*                        */
+			      sizeof(px_state0),   /*                        */
+			      px_free);		   /*                        */
+}						   /*------------------------*/
+
 /*-----------------------------------------------------------------------------
 ** Function*:	absolute_file()
 ** Purpose:	Check is the file is an absolute file name.
@@ -112,9 +146,8 @@ static bool absolute_file(name,basename,path)	   /*                        */
   char        *name;				   /*                        */
   char        **basename;			   /*                        */
   char        ***path;				   /*                        */
-{ static char *absolut_path[2];			   /*                        */
-  static int  first = (-1);			   /*                        */
-  size_t         l;				   /*                        */
+{ char **absolut_path = PxState->px_abs_path;	   /*                        */
+  size_t      l;				   /*                        */
   char        *sp;				   /*                        */
 #undef SEPARATOR
   						   /*                        */
@@ -141,9 +174,8 @@ static bool absolute_file(name,basename,path)	   /*                        */
   if ( sp == NULL ) sp = strchr(name,':');	   /*                        */
 #endif
   l = (size_t)(sp-name);			   /* length of directory.   */
-  if (first)				   	   /*                        */
-  { first = 0;					   /*                        */
-    absolut_path[1] = NULL;			   /* mark end of array.     */
+  if (absolut_path[0] == NULL)			   /*                        */
+  { absolut_path[1] = NULL;			   /* mark end of array.     */
     absolut_path[0] = malloc(l+1);		   /* allocate               */
   }						   /*  or                    */
   else						   /*  reallocate            */
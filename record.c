@@ -25,6 +25,7 @@
 ******************************************************************************/
 
 #include <bibtool/general.h>
+#include <limits.h>
 #include <bibtool/error.h>
 #include <bibtool/record.h>
 #include <bibtool/symbols.h>
@@ -38,19 +39,34 @@
 #else
 #define _ARG(A) ()
 #endif
+ static Record record_alloc _ARG((void));	   /*                        */
+ static void record_release _ARG((Record rec));	   /*                        */
+ static Symbol *heap_alloc _ARG((int *sizep));	   /*                        */
+ static void heap_release _ARG((Symbol *heap,int size));/*                   */
+ static void rec_slab _ARG((void *slab));	   /*                        */
+ static void rec_free _ARG((void *state));	   /*                        */
+ static void copy_lazy _ARG((Record new,Record rec));/*                      */
  Record copy_record _ARG((Record rec)); 	   /* record.c               */
  Record new_record _ARG((int token,int size)); 	   /* record.c               */
  Record record_gc _ARG((Record rec)); 		   /* record.c               */
  Record unlink_record _ARG((Record rec)); 	   /* record.c               */
+ typedef struct oRDERLIST *OrderList;
  Symbol record_get _ARG((Record rec, Symbol key)); /* record.c               */
  WordList new_wordlist _ARG((Symbol  sym));	   /* record.c               */
  int count_record _ARG((Record rec));		   /* record.c               */
+ int record_slot _ARG((Record rec,Symbol key));	   /* record.c               */
+ static int record_hole _ARG((Record rec));	   /* record.c               */
+ static void record_index _ARG((Record rec));	   /* record.c               */
+ static void index_add _ARG((Record rec,int pos)); /* record.c               */
+ static void heap_append _ARG((Record rec,Symbol s,Symbol t));/* record.c     */
  void add_sort_order _ARG((Symbol val)); 	   /* record.c               */
  void free_1_record _ARG((Record rec)); 	   /* record.c               */
  void free_record _ARG((Record rec)); 		   /* record.c               */
  void provide_to_record _ARG((Record rec,Symbol s,Symbol t));/* record.c     */
  void push_to_record _ARG((Record rec,Symbol s,Symbol t, bool err));/* record.c*/
  void sort_record _ARG((Record rec)); 		   /* record.c               */
+ static int order_rank _ARG((OrderList ol,Symbol sym));/* record.c           */
+ static void order_ranks _ARG((OrderList ol));	   /* record.c               */
 
 /*****************************************************************************/
 /* External Programs							     */
@@ -58,6 +74,189 @@
 
 /*---------------------------------------------------------------------------*/
 
+/*-----------------------------------------------------------------------------
+** Constant*:	RECORD_SLAB
+** Purpose:	The number of records allocated at once.
+**___________________________________________________			     */
+#define RECORD_SLAB 256
+
+/*-----------------------------------------------------------------------------
+** Constant*:	HEAP_CLASSES
+** Purpose:	The number of size classes for small heaps. The class
+**		|k| holds heaps of |2*k+2| symbols; i.e. one more field
+**		than the class before. Larger heaps are allocated
+**		individually.
+**___________________________________________________			     */
+#define HEAP_CLASSES 32
+#define HEAP_MAX     (2 * HEAP_CLASSES)
+
+/*-----------------------------------------------------------------------------
+** Constant*:	HEAP_SLAB
+** Purpose:	The number of symbols allocated at once for small heaps.
+**___________________________________________________			     */
+#define HEAP_SLAB 1024
+
+/*-----------------------------------------------------------------------------
+** Typedef*:	SRecState
+** Purpose:	The state of the record module in a context. It
+**		contains the free lists of records and heaps, the
+**		slabs they are taken from, and the sort orders.
+**___________________________________________________			     */
+ typedef struct					   /*                        */
+ { Record    record_free_list;			   /* the free records       */
+   Symbol    *heap_free_list[HEAP_CLASSES];	   /* the free small heaps   */
+   void	     **rec_slabs;			   /* the slabs allocated    */
+   int	     rec_slabs_used;			   /*                        */
+   int	     rec_slabs_size;			   /*                        */
+   OrderList order;				   /* the sort orders        */
+ } SRecState;					   /*                        */
+
+/*-----------------------------------------------------------------------------
+** Variable*:	rec_state0
+** Type:	SRecState
+** Purpose:	The initial state of the record module in a context.
+**		The free lists are empty.
+**___________________________________________________			     */
+ static SRecState rec_state0;			   /*                        */
+
+#define RecState ((SRecState*)CtxGet(CTX_RECORD,			\
+				     ctx_state(CTX_RECORD,		\
+					       (void*)&rec_state0,	\
+					       sizeof(rec_state0),	\
+					       rec_free)))
+
+#define record_free_list (RecState->record_free_list)
+#define heap_free_list	 (RecState->heap_free_list)
+#define rec_slabs	 (RecState->rec_slabs)
+#define rec_slabs_used	 (RecState->rec_slabs_used)
+#define rec_slabs_size	 (RecState->rec_slabs_size)
+
+/*-----------------------------------------------------------------------------
+** Function*:	rec_slab()
+** Purpose:	Remember a slab of memory. It is released when the
+**		context is released.
+**		If no memory is left then an error is raised and the
+**		program is terminated.
+** Arguments:
+**	slab	the memory
+** Returns:	nothing
+**___________________________________________________			     */
+static void rec_slab(slab)			   /*                        */
+  void *slab;					   /*                        */
+{						   /*                        */
+  if ( rec_slabs_used >= rec_slabs_size )	   /*                        */
+  { rec_slabs_size += 64;			   /*                        */
+    rec_slabs = (rec_slabs == NULL		   /*                        */
+		 ? (void**)malloc(rec_slabs_size * sizeof(void*))/*          */
+		 : (void**)realloc(rec_slabs, rec_slabs_size * sizeof(void*)));/* */
+    if ( rec_slabs == NULL ) { OUT_OF_MEMORY("Record"); }/*                  */
+  }						   /*                        */
+  rec_slabs[rec_slabs_used++] = slab;		   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	record_alloc()
+** Purpose:	Get the memory for a new record. Records are taken
+**		from a free list which is refilled in slabs of
+**		|RECORD_SLAB| records. Thus the memory of released
+**		records is reused.
+**		If no memory is left then an error is raised and the
+**		program is terminated.
+** Arguments:	none
+** Returns:	The uninitialized record.
+**___________________________________________________			     */
+static Record record_alloc()			   /*                        */
+{ Record new;					   /*                        */
+  int    i;					   /*                        */
+ 						   /*                        */
+  if ( record_free_list == RecordNULL )		   /*                        */
+  { if ( (new = (Record)malloc(sizeof(SRecord) * RECORD_SLAB)) == RecordNULL )/* */
+    { OUT_OF_MEMORY("Record"); }		   /*                        */
+    rec_slab((void*)new);			   /*                        */
+    for (i = 0; i < RECORD_SLAB; i++)		   /*                        */
+    { record_release(new + i); }		   /*                        */
+  }						   /*                        */
+  new = record_free_list;			   /*                        */
+  record_free_list = NextRecord(new);		   /*                        */
+  return new;					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	record_release()
+** Purpose:	Put the memory of a record back onto the free list.
+** Arguments:
+**	rec	the record
+** Returns:	nothing
+**___________________________________________________			     */
+static void record_release(rec)			   /*                        */
+  Record rec;					   /*                        */
+{ NextRecord(rec) = record_free_list;		   /*                        */
+  record_free_list = rec;			   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	heap_alloc()
+** Purpose:	Get the memory for the heap of a record. Small heaps
+**		are rounded up to an even size and taken from
+**		the free list of this class. The free heaps are
+**		chained through their first slot.
+**		If no memory is left then an error is raised and the
+**		program is terminated.
+** Arguments:
+**	sizep	Pointer to the requested number of symbols. It is
+**		updated to the number of symbols actually available.
+** Returns:	The new heap.
+**___________________________________________________			     */
+static Symbol *heap_alloc(sizep)		   /*                        */
+  int    *sizep;				   /*                        */
+{ Symbol *heap;					   /*                        */
+  int    k, n;					   /*                        */
+ 						   /*                        */
+  if ( *sizep > HEAP_MAX )			   /*                        */
+  { if ( (heap = (Symbol*)malloc(sizeof(Symbol) * (size_t)*sizep)) == NULL )/* */
+    { OUT_OF_MEMORY("Record"); }		   /*                        */
+    return heap;				   /*                        */
+  }						   /*                        */
+  if ( *sizep < 2 ) *sizep = 2;			   /*                        */
+  k	 = (*sizep + 1) / 2 - 1;		   /*                        */
+  *sizep = 2 * k + 2;				   /*                        */
+ 						   /*                        */
+  if ( heap_free_list[k] == NULL )		   /* refill the class       */
+  { if ( (heap = (Symbol*)malloc(sizeof(Symbol) * HEAP_SLAB)) == NULL )/*    */
+    { OUT_OF_MEMORY("Record"); }		   /*                        */
+    rec_slab((void*)heap);			   /*                        */
+    for (n = 0; n + *sizep <= HEAP_SLAB; n += *sizep)/*                      */
+    { heap_release(heap + n, *sizep); }		   /*                        */
+  }						   /*                        */
+  heap = heap_free_list[k];			   /*                        */
+  heap_free_list[k] = *(Symbol**)heap;		   /*                        */
+  return heap;					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	heap_release()
+** Purpose:	Release the heap of a record. Small heaps are put back
+**		onto the free list of their size class.
+** Arguments:
+**	heap	the heap
+**	size	the allocated size of the heap as returned by
+**		|heap_alloc()|
+** Returns:	nothing
+**___________________________________________________			     */
+static void heap_release(heap, size)		   /*                        */
+  Symbol *heap;					   /*                        */
+  int    size;					   /*                        */
+{ int    k;					   /*                        */
+ 						   /*                        */
+  if ( size > HEAP_MAX )			   /*                        */
+  { free(heap);					   /*                        */
+    return;					   /*                        */
+  }						   /*                        */
+  k = size / 2 - 1;				   /*                        */
+  *(Symbol**)heap   = heap_free_list[k];	   /*                        */
+  heap_free_list[k] = heap;			   /*                        */
+}						   /*------------------------*/
+
 /*-----------------------------------------------------------------------------
 ** Function:	copy_record()
 ** Purpose:	Copy a record and return a new instance.
@@ -73,11 +272,10 @@ Record copy_record(rec)				   /*			     */
   register Symbol *new_heap,			   /*			     */
 		  *old_heap;			   /*			     */
   register int	  i;				   /*			     */
+  int		  size = RecordFree(rec);	   /*                        */
 						   /*			     */
-  if (	(new=(Record)malloc(sizeof(SRecord))) == 0L/*			     */
-     || (new_heap=(Symbol*)malloc(sizeof(Symbol)*(size_t)RecordFree(rec)))/* */
-	== 0L )					   /*			     */
-  { OUT_OF_MEMORY("Record"); }      		   /*                        */
+  new	   = record_alloc();			   /*                        */
+  new_heap = heap_alloc(&size);			   /*                        */
   RecordSortkey(new)	  = sym_empty;		   /*			     */
   RecordOldKey(new)	  = RecordOldKey(rec);	   /*			     */
   NextRecord(new)	  = RecordNULL;		   /*			     */
@@ -90,15 +288,59 @@ Record copy_record(rec)				   /*			     */
     LinkSymbol(RecordSource(new));		   /*			     */
   }			  			   /*			     */
   RecordLineno(new)	  = RecordLineno(rec);	   /*			     */
+  RecordOffset(new)	  = RecordOffset(rec);	   /*                        */
+  RecordLength(new)	  = RecordLength(rec);	   /*                        */
+  RecordLazy(new)	  = (String*)NULL;	   /*                        */
   RecordHeap(new)	  = new_heap;		   /*			     */
+  RecordSize(new)	  = size;		   /*                        */
+  RecordIndex(new)	  = (int*)NULL;		   /*                        */
+  new->rc_index_size	  = 0;			   /*                        */
+  new->rc_index_used	  = 0;			   /*                        */
   RecordFlags(new)	  = RecordFlags(rec);	   /*			     */
+  RecordClear(new, RecordFlagINDEXED|RecordFlagPACKED);/*                    */
   for (i = 0, old_heap = RecordHeap(rec);	   /*			     */
        i < RecordFree(new);			   /*			     */
        ++i)					   /*			     */
   { *(new_heap++) = *(old_heap++); }		   /*			     */
+  if (RecordLazy(rec) != (String*)NULL)		   /*                        */
+  { copy_lazy(new, rec); }			   /*                        */
   return (new);					   /*			     */
 }						   /*------------------------*/
 
+/*-----------------------------------------------------------------------------
+** Function*:	copy_lazy()
+** Purpose:	Give a copy of a record its own copies of the private
+**		values of the original. The heap of the copy is
+**		changed to refer to them.
+** Arguments:
+**	new	the copy
+**	rec	the original record
+** Returns:	nothing
+**___________________________________________________			     */
+static void copy_lazy(new, rec)			   /*			     */
+  Record new;					   /*			     */
+  Record rec;					   /*			     */
+{ String *lp;					   /*                        */
+  int	 n, i, j;				   /*                        */
+ 						   /*                        */
+  for (n = 0, lp = RecordLazy(rec); *lp; lp++) n++;/*                        */
+  if ((lp = (String*)malloc((n + 1) * sizeof(String))) == NULL)/*            */
+  { OUT_OF_MEMORY("lazy values"); }		   /*                        */
+  for (j = 0; j < n; j++)			   /*                        */
+  { lp[j] = (String)new_string((char*)RecordLazy(rec)[j]); }/*               */
+  lp[n] = StringNULL;				   /*                        */
+  RecordLazy(new) = lp;				   /*                        */
+ 						   /*                        */
+  for (i = 1; i < RecordFree(new); i += 2)	   /*                        */
+  { for (j = 0; j < n; j++)			   /*                        */
+    { if (RecordHeap(new)[i] == RecordLazy(rec)[j])/*                        */
+      { RecordHeap(new)[i] = lp[j];		   /*                        */
+	break;					   /*                        */
+      }						   /*                        */
+    }						   /*                        */
+  }						   /*                        */
+}						   /*------------------------*/
+
 /*-----------------------------------------------------------------------------
 ** Function:	new_record()
 ** Purpose:	Create a new record and return it.
@@ -115,12 +357,12 @@ Record new_record(token,size)			   /*			     */
 { register Record new;				   /*			     */
   register Symbol *new_heap;			   /*			     */
   register int	  i;				   /*			     */
+  int		  cap;				   /*                        */
 						   /*			     */
   if ( size < 1 ) size = 1;			   /*                        */
-  if (	(new=(Record)malloc(sizeof(SRecord))) == 0L/*			     */
-     || (new_heap=(Symbol*)malloc(sizeof(Symbol)*(size_t)(size)))/*          */
-	== 0L )					   /*			     */
-  { OUT_OF_MEMORY("Record"); }      		   /*                        */
+  cap	   = size;				   /*                        */
+  new	   = record_alloc();			   /*                        */
+  new_heap = heap_alloc(&cap);			   /*                        */
   RecordSortkey(new)	= sym_empty;		   /*			     */
   RecordOldKey(new)	= RecordSortkey(new);	   /*			     */
   NextRecord(new)	= RecordNULL;		   /*			     */
@@ -130,8 +372,15 @@ Record new_record(token,size)			   /*			     */
   RecordComment(new)	= sym_empty;		   /*			     */
   RecordSource(new)	= sym_empty;		   /*			     */
   RecordLineno(new)	= -1;             	   /*			     */
+  RecordOffset(new)	= -1L;			   /*                        */
+  RecordLength(new)	= 0L;			   /*                        */
+  RecordLazy(new)	= (String*)NULL;	   /*                        */
   RecordFlags(new)	= 0;	   		   /*			     */
   RecordHeap(new)	= new_heap;		   /*			     */
+  RecordSize(new)	= cap;			   /*                        */
+  RecordIndex(new)	= (int*)NULL;		   /*                        */
+  new->rc_index_size	= 0;			   /*                        */
+  new->rc_index_used	= 0;			   /*                        */
   for (i = 0; i < RecordFree(new); ++i)		   /*			     */
   { *(new_heap++) = NO_SYMBOL; }	   	   /*			     */
   return (new);					   /*			     */
@@ -173,6 +422,7 @@ void free_record(rec)				   /*                        */
 void free_1_record(rec)				   /*                        */
   Record rec;					   /*                        */
 { int i;					   /*                        */
+  String *lp;					   /*                        */
  						   /*                        */
   if ( rec != RecordNULL )			   /*                        */
   {						   /*                        */
@@ -184,9 +434,15 @@ void free_1_record(rec)				   /*                        */
     {						   /*                        */
       for (i = 0; i < RecordFree(rec); i++ )	   /*                        */
       { UnlinkSymbol(RecordHeap(rec)[i]); }	   /*                        */
-      free(RecordHeap(rec));			   /*                        */
+      heap_release(RecordHeap(rec), RecordSize(rec));/*                      */
     }						   /*                        */
-    free(rec);					   /*                        */
+    if ( RecordIndex(rec) != NULL )		   /*                        */
+    { free(RecordIndex(rec)); }			   /*                        */
+    if ( (lp = RecordLazy(rec)) != NULL )	   /* the private values     */
+    { while (*lp) free(*lp++);			   /*                        */
+      free(RecordLazy(rec));			   /*                        */
+    }						   /*                        */
+    record_release(rec);			   /*                        */
   }						   /*                        */
 }						   /*------------------------*/
 
@@ -259,31 +515,179 @@ Record record_gc(rec)				   /*                        */
 
 /*-----------------------------------------------------------------------------
 ** Function:	record_get()
-** Type:	String
-** Purpose:	
-**		
+** Type:	Symbol
+** Purpose:	Get the value of a field of a record. The position 0
+**		is considered as well. It contains the name of a
+**		string record.
 ** Arguments:
 **	rec	the record
-**	key	the key
-** Returns:	
+**	key	the name of the field
+** Returns:	The value or |NO_SYMBOL|.
 **___________________________________________________			     */
 Symbol record_get(rec, key)			   /*                        */
   Record rec;					   /*                        */
   Symbol key;					   /*                        */
 { int i;					   /*                        */
-  register Symbol *hp;				   /*                        */
-  register Symbol s, t;				   /*                        */
  						   /*                        */
-  for (i = RecordFree(rec), hp = RecordHeap(rec);  /* visit all fields       */
-       i > 0;					   /*			     */
-       i -= 2)			   	   	   /*			     */
-  { s = *hp++;                                     /*                        */
-    t = *hp++;                                     /*                        */
-    if (s == key && t != NO_SYMBOL)		   /*                        */
-    { return t; }              			   /*                        */
-  }						   /*			     */
+  if ( RecordFree(rec) > 0 &&			   /*                        */
+       RecordHeap(rec)[0] == key &&		   /*                        */
+       RecordHeap(rec)[1] != NO_SYMBOL )	   /*                        */
+  { return RecordHeap(rec)[1]; }		   /*                        */
  						   /*                        */
-  return NO_SYMBOL;				   /*                        */
+  i = record_slot(rec, key);			   /*                        */
+  return (i < 0 ? NO_SYMBOL : RecordHeap(rec)[i+1]);/*                       */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Constant*:	RECORD_INDEX_MIN
+** Purpose:	Records with at least this many heap slots get a field
+**		index. Smaller records are searched linearly.
+**___________________________________________________			     */
+#define RECORD_INDEX_MIN 32
+
+#define IndexHash(R,S) ((int)(((unsigned long)(S) >> 3)	\
+			      & ((R)->rc_index_size - 1)))
+
+/*-----------------------------------------------------------------------------
+** Function*:	record_index()
+** Purpose:	(Re)build the field index of a record. The first
+**		occurrence of a field name wins.
+** Arguments:
+**	rec	the record
+** Returns:	nothing
+**___________________________________________________			     */
+static void record_index(rec)			   /*                        */
+  Record rec;					   /*                        */
+{ int    i, size;				   /*                        */
+ 						   /*                        */
+  for (size = 64; size < 2 * RecordSize(rec); size *= 2) {}/*                */
+  if ( size != rec->rc_index_size )		   /*                        */
+  { if ( RecordIndex(rec) ) free(RecordIndex(rec));/*                        */
+    if ( (RecordIndex(rec) = (int*)malloc(size * sizeof(int))) == NULL )/*   */
+    { OUT_OF_MEMORY("index"); }			   /*                        */
+    rec->rc_index_size = size;			   /*                        */
+  }						   /*                        */
+  for (i = 0; i < size; i++) { RecordIndex(rec)[i] = -1; }/*                 */
+  rec->rc_index_used = 0;			   /*                        */
+  RecordSet(rec, RecordFlagINDEXED);		   /*                        */
+ 						   /*                        */
+  for (i = 2; i < RecordFree(rec); i += 2)	   /*                        */
+  { if ( RecordHeap(rec)[i] != NO_SYMBOL &&	   /*                        */
+	 record_slot(rec, RecordHeap(rec)[i]) < 0 )/*                        */
+    { index_add(rec, i); }			   /*                        */
+  }						   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	index_add()
+** Purpose:	Enter a heap position into the field index of a
+**		record. If the index becomes too full then it is
+**		invalidated and rebuilt on the next lookup.
+** Arguments:
+**	rec	the record
+**	pos	the heap position of the field name
+** Returns:	nothing
+**___________________________________________________			     */
+static void index_add(rec, pos)			   /*                        */
+  Record rec;					   /*                        */
+  int    pos;					   /*                        */
+{ int    i;					   /*                        */
+ 						   /*                        */
+  if ( !RecordIs(rec, RecordFlagINDEXED) ) return; /*                        */
+  if ( 2 * ++rec->rc_index_used > rec->rc_index_size )/*                     */
+  { RecordClear(rec, RecordFlagINDEXED);	   /*                        */
+    return;					   /*                        */
+  }						   /*                        */
+  for (i = IndexHash(rec, RecordHeap(rec)[pos]);   /*                        */
+       RecordIndex(rec)[i] >= 0;		   /*                        */
+       i = (i + 1) & (rec->rc_index_size - 1)) {}  /*                        */
+  RecordIndex(rec)[i] = pos;			   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	record_slot()
+** Type:	int
+** Purpose:	Find the position of a field on the heap of a
+**		record. The search starts at position 2; i.e. the key
+**		of a normal record is not considered. Large records
+**		are searched with the field index. Entries of the
+**		index which do not point to the field any more are
+**		skipped. Thus deleting a field does not invalidate
+**		the index.
+** Arguments:
+**	rec	the record
+**	key	the name of the field
+** Returns:	The position of the field name or |-1|.
+**___________________________________________________			     */
+int record_slot(rec, key)			   /*                        */
+  Record rec;					   /*                        */
+  Symbol key;					   /*                        */
+{ register int i, pos;				   /*                        */
+ 						   /*                        */
+  if ( RecordFree(rec) < RECORD_INDEX_MIN )	   /*                        */
+  { for (i = 2; i < RecordFree(rec); i += 2)	   /*                        */
+    { if ( RecordHeap(rec)[i] == key ) return i; } /*                        */
+    return -1;					   /*                        */
+  }						   /*                        */
+ 						   /*                        */
+  if ( !RecordIs(rec, RecordFlagINDEXED) ) record_index(rec);/*              */
+  for (i = IndexHash(rec, key);			   /*                        */
+       (pos = RecordIndex(rec)[i]) >= 0;	   /*                        */
+       i = (i + 1) & (rec->rc_index_size - 1))	   /*                        */
+  { if ( pos < RecordFree(rec) && RecordHeap(rec)[pos] == key )/*            */
+    { return pos; }				   /*                        */
+  }						   /*                        */
+  return -1;					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	record_hole()
+** Purpose:	Find the first deleted field on the heap of a record.
+** Arguments:
+**	rec	the record
+** Returns:	The position of the deleted field or |-1|.
+**___________________________________________________			     */
+static int record_hole(rec)			   /*                        */
+  Record rec;					   /*                        */
+{ register int i;				   /*                        */
+ 						   /*                        */
+  if ( RecordIs(rec, RecordFlagPACKED) ) return -1;/*                        */
+  for (i = 2; i < RecordFree(rec); i += 2)	   /*                        */
+  { if ( RecordHeap(rec)[i] == NO_SYMBOL ) return i; }/*                     */
+  return -1;					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	heap_append()
+** Purpose:	Append a field to the heap of a record. The heap is
+**		enlarged geometrically if required.
+** Arguments:
+**	rec	the record
+**	s	the name of the field
+**	t	the value of the field
+** Returns:	nothing
+**___________________________________________________			     */
+static void heap_append(rec, s, t)		   /*                        */
+  Record rec;					   /*                        */
+  Symbol s;					   /*                        */
+  Symbol t;					   /*                        */
+{ int    i = RecordFree(rec);			   /*                        */
+ 						   /*                        */
+  if ( i + 2 > RecordSize(rec) )		   /*                        */
+  { int    size = (RecordSize(rec) < 8		   /*                        */
+		   ? 16				   /*                        */
+		   : 2 * RecordSize(rec));	   /*                        */
+    Symbol *heap = heap_alloc(&size);		   /* enlarge the heap       */
+ 						   /*                        */
+    (void)memcpy(heap, RecordHeap(rec), sizeof(Symbol) * (size_t)i);/*       */
+    heap_release(RecordHeap(rec), RecordSize(rec));/*                        */
+    RecordHeap(rec) = heap;			   /*                        */
+    RecordSize(rec) = size;			   /*                        */
+  }						   /*                        */
+  RecordFree(rec) += 2;				   /*                        */
+  RecordHeap(rec)[i]   = s;			   /*                        */
+  RecordHeap(rec)[i+1] = t;			   /*                        */
+  if ( i > 0 ) index_add(rec, i);		   /*                        */
 }						   /*------------------------*/
 
 /*-----------------------------------------------------------------------------
@@ -319,7 +723,7 @@ int count_record(rec)				   /*                        */
 **		overwritten.  The arguments are expected to be
 **		symbols. Thus it is not necessary to make private
 **		copies and it is possible to avoid expensive string
-**		comparisons. 
+**		comparisons. The record is marked as modified.
 ** Arguments:
 **	rec	the record
 **	s	Left hand side of the equation.
@@ -336,37 +740,27 @@ void push_to_record(rec, s, t, err)		   /*			     */
    						   /*                        */
   if (s == sym_crossref || s == sym_xdata)	   /*                        */
   { SetRecordXREF(rec); } 			   /*			     */
+  SetRecordDIRTY(rec);				   /*                        */
  						   /*                        */
-  for (i = 2; i < RecordFree(rec); i += 2)	   /* search the field       */
-  { if (RecordHeap(rec)[i] == s)		   /* if found then          */
-    { sym_unlink(RecordHeap(rec)[i + 1]);	   /*                        */
-      RecordHeap(rec)[i + 1] = t;		   /* overwrite the value    */
-      if (err) {				   /*			     */
-	error(ERR_WARNING|ERR_FILE,		   /*                        */
-	      (String)"Duplicate field `", s,	   /*                        */
-	      (String)"' overwritten", NULL, 0,	   /*                        */
-	      RecordLineno(rec), RecordSource(rec));/*                       */
-      }						   /*			     */
-      return;					   /*                        */
-    }   					   /*                        */
-  }						   /*                        */
-  for (i = 2; i < RecordFree(rec); i += 2)	   /* search empty field     */
-  { if (RecordHeap(rec)[i] == NO_SYMBOL)	   /* if found then          */
-    { RecordHeap(rec)[i++] = s;			   /* add the new item       */
-      RecordHeap(rec)[i]   = t;			   /*                        */
-      return;					   /*                        */
-    }   					   /*                        */
-  }						   /*                        */
-  i = RecordFree(rec);				   /*                        */
-  RecordFree(rec) += 2;				   /*                        */
-  if ( (RecordHeap(rec)   			   /* enlarge the heap	     */
-	=(Symbol*)realloc(RecordHeap(rec),	   /*	                     */
-			 RecordFree(rec)*sizeof(Symbol)))/*                  */
-     == (Symbol*)NULL )			   	   /*	                     */
-  { OUT_OF_MEMORY("heap"); }      		   /*                        */
-						   /*			     */
-  RecordHeap(rec)[i++] = s;		   	   /*			     */
-  RecordHeap(rec)[i]   = t;		   	   /*			     */
+  if ((i = record_slot(rec, s)) >= 0)		   /* search the field       */
+  { sym_unlink(RecordHeap(rec)[i + 1]);		   /*                        */
+    RecordHeap(rec)[i + 1] = t;			   /* overwrite the value    */
+    if (err) {					   /*			     */
+      error(ERR_WARNING|ERR_FILE,		   /*                        */
+	    (String)"Duplicate field `", s,	   /*                        */
+	    (String)"' overwritten", NULL, 0,	   /*                        */
+	    RecordLineno(rec), RecordSource(rec)); /*                        */
+    }						   /*			     */
+    return;					   /*                        */
+  }						   /*                        */
+  RecordClear(rec, RecordFlagSORTED);		   /*                        */
+  if ((i = record_hole(rec)) >= 0)		   /* search empty field     */
+  { RecordHeap(rec)[i]   = s;			   /* add the new item       */
+    RecordHeap(rec)[i+1] = t;			   /*                        */
+    index_add(rec, i);				   /*                        */
+    return;					   /*                        */
+  }						   /*                        */
+  heap_append(rec, s, t);			   /*                        */
 }						   /*------------------------*/
 
 /*-----------------------------------------------------------------------------
@@ -392,27 +786,16 @@ void provide_to_record(rec,s,t)			   /*			     */
   if (s == sym_crossref || s == sym_xdata)	   /*                        */
   { SetRecordXREF(rec); } 			   /*			     */
  						   /*                        */
-  for (i = 2; i < RecordFree(rec); i += 2 )	   /* search the field       */
-  { if ( RecordHeap(rec)[i] == s )		   /* if found then          */
-    { return; }					   /*  done                  */
-  }						   /*                        */
-  for (i = 2; i < RecordFree(rec); i += 2 )	   /* search empty field     */
-  { if ( RecordHeap(rec)[i] == NO_SYMBOL )	   /* if found then          */
-    { RecordHeap(rec)[i++] = s;			   /* add the new item       */
-      RecordHeap(rec)[i]   = t;			   /*                        */
-      return;					   /*                        */
-    }   					   /*                        */
+  if (record_slot(rec, s) >= 0) return;		   /* search the field       */
+  RecordClear(rec, RecordFlagSORTED);		   /*                        */
+  SetRecordDIRTY(rec);				   /*                        */
+  if ((i = record_hole(rec)) >= 0)		   /* search empty field     */
+  { RecordHeap(rec)[i]   = s;			   /* add the new item       */
+    RecordHeap(rec)[i+1] = t;			   /*                        */
+    index_add(rec, i);				   /*                        */
+    return;					   /*                        */
   }						   /*                        */
-  i = RecordFree(rec);				   /*                        */
-  RecordFree(rec) += 2;				   /*                        */
-  if ( (RecordHeap(rec)   			   /* enlarge the heap	     */
-	=(Symbol*)realloc(RecordHeap(rec),	   /*	                     */
-			 RecordFree(rec)*sizeof(Symbol)))/*                  */
-     == (Symbol*)NULL )			   	   /*	                     */
-  { OUT_OF_MEMORY("heap"); }      		   /*                        */
-						   /*			     */
-  RecordHeap(rec)[i++] = s;		   	   /*			     */
-  RecordHeap(rec)[i]   = t;		   	   /*			     */
+  heap_append(rec, s, t);			   /*                        */
 }						   /*------------------------*/
 
 
@@ -445,15 +828,58 @@ WordList new_wordlist(s)			   /*                        */
  typedef struct oRDERLIST			   /*                        */
  { int		    ol_type;			   /*                        */
    WordList	    ol_val;			   /*                        */
+   Symbol	    *ol_sym;			   /* rank table: the fields */
+   int		    *ol_rank;			   /* rank table: positions  */
+   int		    ol_size;			   /* size of the rank table */
    struct oRDERLIST *ol_next;			   /*                        */
- } SOrderList, *OrderList;			   /*                        */
+ } SOrderList;					   /*                        */
 
 #define OrderType(OL) ((OL)->ol_type)
 #define OrderVal(OL)  ((OL)->ol_val)
+#define OrderSym(OL)  ((OL)->ol_sym)
+#define OrderRank(OL) ((OL)->ol_rank)
+#define OrderSize(OL) ((OL)->ol_size)
 #define NextOrder(OL) ((OL)->ol_next)
 #define OrderNULL     ((OrderList)0)
 
- static OrderList order = OrderNULL;		   /*                        */
+#define OrderHash(OL,S) ((int)(((unsigned long)(S) >> 3)	\
+				& (OrderSize(OL) - 1)))
+
+#define RANK_OTHER	(INT_MAX - 1)
+#define RANK_DELETED	INT_MAX
+
+#define order (RecState->order)
+
+/*-----------------------------------------------------------------------------
+** Function*:	rec_free()
+** Purpose:	Release the memory of the record module when a context
+**		is released. All records and heaps allocated in the
+**		context become invalid.
+** Arguments:
+**	state	the state
+** Returns:	nothing
+**___________________________________________________			     */
+static void rec_free(state)			   /*                        */
+  void	    *state;				   /*                        */
+{ OrderList ol;					   /*                        */
+  WordList  wl;					   /*                        */
+  int	    i;					   /*                        */
+  POSSIBLY_UNUSED(state);			   /*                        */
+ 						   /*                        */
+  while ( (ol = order) != OrderNULL )		   /*                        */
+  { order = NextOrder(ol);			   /*                        */
+    while ( (wl = OrderVal(ol)) != WordNULL )	   /*                        */
+    { OrderVal(ol) = NextWord(wl);		   /*                        */
+      free((char*)wl);				   /*                        */
+    }						   /*                        */
+    if (OrderSym(ol)) free((char*)OrderSym(ol));   /*                        */
+    if (OrderRank(ol)) free((char*)OrderRank(ol)); /*                        */
+    free((char*)ol);				   /*                        */
+  }						   /*                        */
+  for (i = 0; i < rec_slabs_used; i++)		   /*                        */
+  { free(rec_slabs[i]); }			   /*                        */
+  if (rec_slabs) free(rec_slabs);		   /*                        */
+}						   /*------------------------*/
 
 /*-----------------------------------------------------------------------------
 ** Function:	add_sort_order()
@@ -498,6 +924,9 @@ void add_sort_order(val)			   /*                        */
   else						   /*                        */
   { OrderType(ol) = type;			   /*                        */
     OrderVal(ol)  = WordNULL;			   /*                        */
+    OrderSym(ol)  = (Symbol*)NULL;		   /*                        */
+    OrderRank(ol) = (int*)NULL;			   /*                        */
+    OrderSize(ol) = 0;				   /*                        */
     NextOrder(ol) = order;			   /*                        */
     order         = ol;				   /*                        */
     wlp           = &OrderVal(ol);		   /*                        */
@@ -522,29 +951,97 @@ void add_sort_order(val)			   /*                        */
     free((char*)wl);				   /*                        */
     wl = wl_next;				   /*                        */
   }						   /*                        */
+  order_ranks(ol);				   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	order_ranks()
+** Purpose:	Build the rank table of a sort order. The rank table
+**		is a hash table which maps a field name to its
+**		position in the word list of the order. If a field is
+**		mentioned several times then the first position counts.
+** Arguments:
+**	ol	the sort order
+** Returns:	nothing
+**___________________________________________________			     */
+static void order_ranks(ol)			   /*                        */
+  OrderList ol;					   /*                        */
+{ WordList  wl;					   /*                        */
+  int       i, n, size;				   /*                        */
+ 						   /*                        */
+  for (n = 0, wl = OrderVal(ol); wl; wl = NextWord(wl)) { n++; }/*           */
+  for (size = 8; size < 2 * n; size *= 2) {}	   /*                        */
+ 						   /*                        */
+  if (size != OrderSize(ol))			   /*                        */
+  { if (OrderSym(ol)) free((char*)OrderSym(ol));   /*                        */
+    if (OrderRank(ol)) free((char*)OrderRank(ol)); /*                        */
+    if ( (OrderSym(ol) = (Symbol*)malloc(size * sizeof(Symbol))) == NULL/*   */
+	|| (OrderRank(ol) = (int*)malloc(size * sizeof(int))) == NULL )/*    */
+    { OUT_OF_MEMORY("OrderList"); }		   /*                        */
+    OrderSize(ol) = size;			   /*                        */
+  }						   /*                        */
+  for (i = 0; i < size; i++) { OrderSym(ol)[i] = NO_SYMBOL; }/*              */
+ 						   /*                        */
+  for (n = 0, wl = OrderVal(ol); wl; wl = NextWord(wl), n++)/*               */
+  { for (i = OrderHash(ol, ThisWord(wl));	   /*                        */
+	 OrderSym(ol)[i] != NO_SYMBOL && OrderSym(ol)[i] != ThisWord(wl);/*  */
+	 i = (i + 1) & (size - 1)) {}		   /*                        */
+    if (OrderSym(ol)[i] == NO_SYMBOL)		   /* first one wins         */
+    { OrderSym(ol)[i]  = ThisWord(wl);		   /*                        */
+      OrderRank(ol)[i] = n;			   /*                        */
+    }						   /*                        */
+  }						   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	order_rank()
+** Purpose:	Look up the rank of a field in a sort order.
+** Arguments:
+**	ol	the sort order
+**	sym	the field name
+** Returns:	The position of the field in the sort order. Fields not
+**		mentioned get |RANK_OTHER| and deleted fields get
+**		|RANK_DELETED|. Thus they are moved to the end.
+**___________________________________________________			     */
+static int order_rank(ol, sym)			   /*                        */
+  OrderList ol;					   /*                        */
+  Symbol    sym;				   /*                        */
+{ register int i;				   /*                        */
+ 						   /*                        */
+  if (sym == NO_SYMBOL) return RANK_DELETED;	   /*                        */
+  for (i = OrderHash(ol, sym);			   /*                        */
+       OrderSym(ol)[i] != NO_SYMBOL;		   /*                        */
+       i = (i + 1) & (OrderSize(ol) - 1))	   /*                        */
+  { if (OrderSym(ol)[i] == sym) return OrderRank(ol)[i]; }/*                 */
+  return RANK_OTHER;				   /*                        */
 }						   /*------------------------*/
 
 /*-----------------------------------------------------------------------------
 ** Function:	sort_record()
 ** Purpose:	The heap is reordered according to the sorting order
 **		determined by the record type.
-**		For this purpose a copy of the original record is made and the
-**		original record is overwritten. The copy is released at the
-**		end.
+**		The fields are permuted in place with a stable
+**		insertion sort on the ranks of the field names. Fields
+**		not mentioned in the order keep their relative order
+**		and follow the ordered ones. Deleted fields are moved
+**		to the end.
 **		Memory management is easy since all strings are in fact
 **		symbols, i.e. they must not be freed and comparison is done
 **		by pointer comparison.
+**		A sorted record is flagged. The flag is cleared when a
+**		new field is added. Thus a record is not sorted twice.
 ** Arguments:
 **	rec     Record to sort
 ** Returns:	nothing
 **___________________________________________________			     */
 void sort_record(rec)				   /*			     */
   register Record rec;				   /*			     */
-{ Record          r;				   /* Temp. record           */
-  OrderList       ol;				   /*                        */
-  int             i, ptr;			   /*                        */
+{ OrderList       ol;				   /*                        */
+  int             i, j, n, r;			   /*                        */
   int             type = RecordType(rec);	   /*                        */
-  WordList        wl;				   /*                        */
+  Symbol          *hp, s, t;			   /*                        */
+ 						   /*                        */
+  if (RecordIs(rec, RecordFlagSORTED)) return;	   /*                        */
  						   /*                        */
   for (ol = order;				   /* Search for an order    */
        ol && OrderType(ol) != type;		   /*  for this type of      */
@@ -556,34 +1053,33 @@ void sort_record(rec)				   /*			     */
     if ( ol == OrderNULL ) return;		   /* No order then return.  */
   }						   /*                        */
   						   /*                        */
-  if ( (wl=OrderVal(ol)) == WordNULL ) return;	   /* Empty order found. Done*/
- 						   /*                        */
-  r   = copy_record(rec);			   /*                        */
-  ptr = 2;					   /* Heap pointer for rec   */
- 						   /*                        */
-  while ( wl )					   /* For all words          */
-  { for ( i = 2; i < RecordFree(r); i += 2 )	   /* Find the word on the   */
-    { if ( RecordHeap(r)[i] == ThisWord(wl) )	   /*  heap and              */
-      { RecordHeap(rec)[ptr++] = RecordHeap(r)[i]; /*  transfer it into the  */
-	RecordHeap(rec)[ptr++] = RecordHeap(r)[i+1];/* original record.      */
-	RecordHeap(r)[i]       = NULL;		   /* Delete the copy.       */
-	i = RecordFree(r);			   /*                        */
-      }						   /*                        */
-    }   					   /*                        */
-    wl = NextWord(wl);				   /* Look at next word.     */
+  if ( OrderVal(ol) == WordNULL ) return;	   /* Empty order found. Done*/
+ 						   /*                        */
+  hp = RecordHeap(rec);				   /*                        */
+  n  = RecordFree(rec);				   /*                        */
+  for (i = 4;					   /* Check whether it is    */
+       i < n && order_rank(ol, hp[i-2]) <= order_rank(ol, hp[i]);/* sorted   */
+       i += 2) {}				   /* already.               */
+  if (i < n)					   /* Positions will change  */
+  { RecordClear(rec, RecordFlagINDEXED);	   /*                        */
+    SetRecordDIRTY(rec);			   /*                        */
   }						   /*                        */
-  for ( i = 2; i < RecordFree(r); i += 2 )	   /* Transfer all remaining */
-  { if ( RecordHeap(r)[i] )			   /*  elements of the heap  */
-    { RecordHeap(rec)[ptr++] = RecordHeap(r)[i];   /*  which are not         */
-      RecordHeap(rec)[ptr++] = RecordHeap(r)[i+1]; /*  deleted.              */
+ 						   /*                        */
+  for ( ; i < n; i += 2)			   /* Insert the remaining   */
+  { s = hp[i];					   /* fields.                */
+    t = hp[i+1];				   /*                        */
+    r = order_rank(ol, s);			   /*                        */
+    for (j = i; j > 2 && order_rank(ol, hp[j-2]) > r; j -= 2)/*              */
+    { hp[j]   = hp[j-2];			   /*                        */
+      hp[j+1] = hp[j-1];			   /*                        */
     }						   /*                        */
-  }   						   /*                        */
-  while ( ptr < RecordFree(r) )			   /* Clear the remaining    */
-  { RecordHeap(rec)[ptr++] = NULL;		   /*  elements of the heap. */
+    hp[j]   = s;				   /*                        */
+    hp[j+1] = t;				   /*                        */
   }						   /*                        */
+  for (i = n - 2; i >= 2 && hp[i] == NO_SYMBOL; i -= 2)/* Clear the deleted  */
+  { hp[i+1] = NO_SYMBOL; }			   /* fields at the end.     */
  						   /*                        */
-  free((char*)RecordHeap(r));			   /* Free the temp. record. */
-  free((char*)r);				   /*                        */
+  RecordSet(rec, RecordFlagSORTED);		   /*                        */
 }						   /*------------------------*/
 
 /*---------------------------------------------------------------------------*/
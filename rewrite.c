@@ -26,6 +26,8 @@
 
 #include <bibtool/general.h>
 #include <bibtool/symbols.h>
+#include <bibtool/context.h>
+#include <bibtool/stats.h>
 #include <bibtool/entry.h>
 #include <bibtool/error.h>
 #include <bibtool/macros.h>
@@ -34,10 +36,14 @@
 #include <bibtool/s_parse.h>
 #include <bibtool/sbuffer.h>
 #include <bibtool/rewrite.h>
+#include <bibtool/parse.h>
 #include <bibtool/symbols.h>
 
 #ifdef REGEX
 #include <bibtool/regex.h>
+#endif
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
 #endif
 
  typedef struct rULE
@@ -46,7 +52,17 @@
    Symbol	rr_value;
    Symbol	rr_frame;
    int		rr_flag;
+   String	rr_fold;
+   int		rr_fold_len;
+   int		rr_fold_gen;
+   Uchar	*rr_shift;
    struct rULE	*rr_next;
+   long		rr_attempts;
+   long		rr_matches;
+   long		rr_repl;
+   double	rr_time;
+   Symbol	rr_source;
+   int		rr_line;
 #ifdef REGEX
    struct re_pattern_buffer rr_pat_buff;
 #endif
@@ -61,6 +77,132 @@
 #define RuleFrame(X)	((X)->rr_frame)
 #define NextRule(X)	((X)->rr_next)
 #define RuleFlag(X)	((X)->rr_flag)
+#define RuleFold(X)	((X)->rr_fold)
+#define RuleFoldLen(X)	((X)->rr_fold_len)
+#define RuleFoldGen(X)	((X)->rr_fold_gen)
+#define RuleShift(X)	((X)->rr_shift)
+#define RuleAttempts(X)	((X)->rr_attempts)
+#define RuleMatches(X)	((X)->rr_matches)
+#define RuleRepl(X)	((X)->rr_repl)
+#define RuleTime(X)	((X)->rr_time)
+#define RuleSource(X)	((X)->rr_source)
+#define RuleLine(X)	((X)->rr_line)
+
+ typedef struct tEXT
+ { String	tx_buf;
+   size_t	tx_size;
+   long		tx_searches;			   /* the regex searches     */
+ } SText, *Text;
+
+#ifdef REGEX
+ typedef struct pATTERN
+ { Symbol	pt_goal;
+   int		pt_casep;
+   reg_syntax_t pt_syntax;
+   struct re_pattern_buffer pt_buf;
+   struct pATTERN *pt_next;
+   struct pATTERN *pt_seq;
+ } SPattern, *Pattern;
+
+#define PatternNULL	(Pattern)0
+#define PATTERN_HASH	256
+#endif
+
+ typedef struct kEEPtAB
+ { Symbol	kt_field;
+   char		*kt_state;
+ } SKeepTab, *KeepTab;
+
+/*-----------------------------------------------------------------------------
+** Typedef*:	SRewriteState
+** Purpose:	The state of the rewrite module in a context. It
+**		contains the lists of rules, the tables derived from
+**		them, and the buffers used while applying them.
+**___________________________________________________			     */
+ typedef struct					   /*                        */
+ { Rule		c_match;			   /* the matching check rule*/
+   Macro	addlist;			   /* the fields to add      */
+   Symbol	*rule_stack;			   /* the fields of a rule   */
+   int		rule_stack_size;		   /*                        */
+   StringBuffer *repl_sb1;			   /*                        */
+   StringBuffer *repl_sb2;			   /*                        */
+   StringBuffer *check_sb;			   /*                        */
+   StringBuffer *rewrite_sb;			   /*                        */
+   Rule		r_rule;				   /* the rewrite rules      */
+   Rule		r_rule_end;			   /*                        */
+   Rule		*k_rules;			   /* the keep rules         */
+   KeepTab	k_tab;				   /* indexed by field symbol*/
+   int		k_tab_size;			   /* a power of 2           */
+   char		*k_star;			   /* state of other fields  */
+   int		k_types;			   /* number of entry types  */
+   bool		k_valid;			   /*                        */
+   Rule		c_rule;				   /* the check rules        */
+   Rule		c_rule_end;			   /*                        */
+   Rule		x_rule;				   /* the extract rules      */
+   Rule		x_rule_end;			   /*                        */
+   int		s_cased;			   /*                        */
+   int		s_gen;				   /* generation of s_class  */
+   String	s_ignored;			   /*                        */
+   SText	s_text;				   /* folded text buffer     */
+   Uchar	s_class[256];			   /*                        */
+#ifdef REGEX
+   struct re_registers reg;			   /*                        */
+   reg_syntax_t re_syntax;			   /* the regex syntax       */
+   Pattern	*r_patterns;			   /* the compiled patterns  */
+   Pattern	r_pattern_seq;			   /*  latest first          */
+#endif
+#ifdef HAVE_PTHREAD_H
+   pthread_mutex_t *s_lock;			   /* guards get_field()     */
+#endif
+ } SRewriteState;				   /*                        */
+
+/*-----------------------------------------------------------------------------
+** Variable*:	rewrite_state0
+** Type:	SRewriteState
+** Purpose:	The initial state of the rewrite module in a context.
+**___________________________________________________			     */
+ static SRewriteState rewrite_state0 =		   /*                        */
+ { RuleNULL,					   /*                        */
+   MacroNULL,					   /*                        */
+   (Symbol*)NULL,				   /*                        */
+   0,						   /*                        */
+   (StringBuffer*)NULL,				   /*                        */
+   (StringBuffer*)NULL,				   /*                        */
+   (StringBuffer*)NULL,				   /*                        */
+   (StringBuffer*)NULL,				   /*                        */
+   RuleNULL,					   /*                        */
+   RuleNULL,					   /*                        */
+   (Rule*)NULL,					   /*                        */
+   (KeepTab)NULL,				   /*                        */
+   0,						   /*                        */
+   NULL,					   /*                        */
+   0,						   /*                        */
+   false,					   /*                        */
+   RuleNULL,					   /*                        */
+   RuleNULL,					   /*                        */
+   RuleNULL,					   /*                        */
+   RuleNULL,					   /*                        */
+   -33,						   /*                        */
+   0,						   /*                        */
+   StringNULL,					   /*                        */
+   { StringNULL, 0, 0L },			   /*                        */
+   { 0 },					   /*                        */
+#ifdef REGEX
+   { 0 },					   /*                        */
+   0,						   /*                        */
+   (Pattern*)NULL,				   /*                        */
+   (Pattern)NULL,				   /*                        */
+#endif
+#ifdef HAVE_PTHREAD_H
+   (pthread_mutex_t*)NULL,			   /*                        */
+#endif
+ };						   /*                        */
+
+#define RewriteState ((SRewriteState*)CtxGet(CTX_REWRITE,		\
+				      ctx_state(CTX_REWRITE,		\
+					      (void*)&rewrite_state0,	\
+					      sizeof(rewrite_state0),	\
+					      rewrite_free)))
 
 /*****************************************************************************/
 /* Internal Programs							     */
@@ -76,23 +218,50 @@
  static Rule new_rule _ARG((Symbol field,Symbol value,Symbol pattern,Symbol frame,int flags,int casep));
  static String  check_regex _ARG((Symbol field,Symbol value,Rule rule,DB db,Record rec));
  static String  repl_regex _ARG((Symbol field,Symbol value,Rule rule,DB db,Record rec));
- static bool s_match _ARG((String  p,String  s));  /*                        */
- static bool s_search _ARG((String  pattern,String  s));/*                   */
+ static void s_fold_rule _ARG((Rule rule));	   /*                        */
+ static void s_prepare _ARG((void));		   /*                        */
+ static bool s_search _ARG((Rule rule,String  s,Text text));/*               */
+ static bool selected _ARG((DB db,Record rec,Text text));/*                  */
+ static bool select_match _ARG((Rule rule,Symbol value,Text text));/*        */
+ static void rule_count _ARG((Rule rule,bool matchp,double start));/*        */
+ static int profile_rules _ARG((Rule rule,char *kind,Rule *top,char **kinds,int n,int used));
+ void print_rule_profile _ARG((FILE *file,int n)); /*                        */
+#ifdef REGEX
+ static int rule_search _ARG((Rule rule,String s,int len));/*                */
+ static bool copy_pattern _ARG((Symbol goal,int casep,struct re_pattern_buffer *buf));/**/
+ static void add_pattern _ARG((Symbol goal,int casep,reg_syntax_t syntax,struct re_pattern_buffer *buf));/**/
+ static void free_patterns _ARG((void));	   /*                        */
+#endif
+#ifdef HAVE_PTHREAD_H
+ static void * select_worker _ARG((void * arg));   /*                        */
+#endif
+ bool select_parallel _ARG((DB db));		   /*                        */
  static void add_rule _ARG((String s,Rule *rp,Rule *rp_end,int flags,int casep));
 #ifdef UNUSED
  static void free_rule _ARG((Rule rule));	   /*                        */
 #endif
  static void init_s_search _ARG((String  ignored));/*                        */
+ static int keep_state _ARG((Rule rule,int type)); /*                        */
+ static void compile_keep_rules _ARG((void));	   /*                        */
+ static unsigned long keep_fingerprint _ARG((void));/*                       */
+ static bool keep_p _ARG((Symbol sym,Record rec,DB db));/*                   */
  static void rewrite_1 _ARG((String frame,StringBuffer *sb,String match,DB db,Record rec));/**/
+ static void rewrite_free _ARG((void *state));	   /*                        */
  void add_check_rule _ARG((String s,int flags));   /*                        */
  void add_extract _ARG((Symbol s,int regexp,int notp));/*                    */
  void add_field _ARG((String spec));		   /*                        */
  void add_rewrite_rule _ARG((String s));	   /*                        */
  void clear_addlist _ARG((void));		   /*                        */
+ void clear_extract _ARG((void));		   /*                        */
+ bool have_extract _ARG((void));		   /*                        */
  void remove_field _ARG((Symbol field,Record rec));/*                        */
  void rename_field _ARG((Symbol spec));		   /*                        */
  void rewrite_record _ARG((DB db,Record rec));	   /*                        */
  void save_regex _ARG((String s));		   /*                        */
+ bool read_keep_table _ARG((BundleCursor c));	   /*                        */
+ bool read_patterns _ARG((BundleCursor c));	   /*                        */
+ void write_keep_table _ARG((FILE *file));	   /*                        */
+ void write_patterns _ARG((FILE *file));	   /*                        */
 
 /*****************************************************************************/
 /* External Programs							     */
@@ -103,14 +272,14 @@
 
  static String s_if = (String)"if";
 
- static Rule match = RuleNULL;
+#define c_match (RewriteState->c_match)
 
 
 /*****************************************************************************/
 /***			  Field Add/Delete Section			   ***/
 /*****************************************************************************/
 
- static Macro addlist = MacroNULL;
+#define addlist (RewriteState->addlist)
 
 /*-----------------------------------------------------------------------------
 ** Function:	clear_addlist()
@@ -176,9 +345,14 @@ void remove_field(field, rec)			   /*			     */
   Record	 rec;				   /*			     */
 { register int	 i;				   /*			     */
 						   /*			     */
-  for (i = 0; i < RecordFree(rec); i += 2 )	   /*			     */
-  { if ( field == RecordHeap(rec)[i] )		   /* compare symbols	     */
-    { RecordHeap(rec)[i] = NO_SYMBOL; }	   	   /*			     */
+  if ( RecordFree(rec) > 0 && field == RecordHeap(rec)[0] )/*                */
+  { RecordHeap(rec)[0] = NO_SYMBOL;		   /*                        */
+    SetRecordDIRTY(rec);			   /*                        */
+  }						   /*                        */
+  while ( (i = record_slot(rec, field)) >= 0 )	   /* use the field index    */
+  { RecordHeap(rec)[i] = NO_SYMBOL;		   /*                        */
+    RecordClear(rec, RecordFlagPACKED);		   /*                        */
+    SetRecordDIRTY(rec);			   /*                        */
   }						   /*			     */
 						   /*			     */
   while ( RecordFree(rec) > 0 &&		   /* Adjust Heap Length     */
@@ -193,8 +367,221 @@ void remove_field(field, rec)			   /*			     */
 /*****************************************************************************/
 
 #ifdef REGEX
- static struct re_registers reg;		   /*			     */
+#define reg (RewriteState->reg)
+#define re_syntax (RewriteState->re_syntax)
+
+/*-----------------------------------------------------------------------------
+** Variable*:	re_lock
+** Type:	pthread_mutex_t
+** Purpose:	The lock guarding the compilation of regular
+**		expressions. The regex library takes the syntax from a
+**		global variable.
+**___________________________________________________			     */
+#ifdef HAVE_PTHREAD_H
+ static pthread_mutex_t re_lock = PTHREAD_MUTEX_INITIALIZER;/*               */
+#endif
+#endif
+
+#ifdef REGEX
+#define r_patterns (RewriteState->r_patterns)
+#define r_pattern_seq (RewriteState->r_pattern_seq)
+
+#define PatternHash(GOAL) \
+  ((int)(((unsigned long)(GOAL) >> 4) & (PATTERN_HASH - 1)))
+
+/*-----------------------------------------------------------------------------
+** Function*:	copy_pattern()
+** Type:	bool
+** Purpose:	Look up a compiled regular expression and copy it
+**		into a pattern buffer of a rule. Thus a regular
+**		expression is compiled only once for all rules using
+**		it. The syntax has to be the current syntax.
+** Arguments:
+**	goal	the regular expression
+**	casep	indicator for case insensitive matching
+**	buf	the pattern buffer to fill
+** Returns:	|true| iff the pattern has been found.
+**___________________________________________________			     */
+static bool copy_pattern(goal, casep, buf)	   /*                        */
+  Symbol	goal;				   /*                        */
+  int		casep;				   /*                        */
+  struct re_pattern_buffer *buf;		   /*                        */
+{ Pattern	pt;				   /*                        */
+ 						   /*                        */
+  if (r_patterns == NULL) return false;		   /*                        */
+  for (pt = r_patterns[PatternHash(goal)]; pt; pt = pt->pt_next)/*           */
+  { if (pt->pt_goal == goal &&			   /*                        */
+	pt->pt_casep == casep &&		   /*                        */
+	pt->pt_syntax == re_syntax)		   /*                        */
+    { *buf = pt->pt_buf;			   /*                        */
+      if ((buf->buffer = (unsigned char*)malloc(buf->used + 1)) == NULL)/*   */
+      { OUT_OF_MEMORY("pattern"); }		   /*                        */
+      (void)memcpy(buf->buffer, pt->pt_buf.buffer, buf->used);/*             */
+      buf->allocated	    = buf->used + 1;	   /*                        */
+      buf->fastmap	    = NULL;		   /*                        */
+      buf->fastmap_accurate = 0;		   /*                        */
+      buf->regs_allocated   = REGS_FIXED;	   /*                        */
+      buf->translate	    = (casep ? (char*)trans_lower : NULL);/*         */
+      return true;				   /*                        */
+    }						   /*                        */
+  }						   /*                        */
+  return false;					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	add_pattern()
+** Type:	void
+** Purpose:	Remember a compiled regular expression. The compiled
+**		code is copied.
+** Arguments:
+**	goal	the regular expression
+**	casep	indicator for case insensitive matching
+**	syntax	the syntax used to compile it
+**	buf	the compiled pattern
+** Returns:	nothing
+**___________________________________________________			     */
+static void add_pattern(goal, casep, syntax, buf)  /*                        */
+  Symbol	goal;				   /*                        */
+  int		casep;				   /*                        */
+  reg_syntax_t	syntax;				   /*                        */
+  struct re_pattern_buffer *buf;		   /*                        */
+{ Pattern	pt;				   /*                        */
+  int		h = PatternHash(goal);		   /*                        */
+ 						   /*                        */
+  if (r_patterns == NULL &&			   /*                        */
+      (r_patterns = (Pattern*)calloc(PATTERN_HASH, sizeof(Pattern))) == NULL)
+  { OUT_OF_MEMORY("pattern"); }			   /*                        */
+  if ((pt = (Pattern)malloc(sizeof(SPattern))) == PatternNULL ||/*          */
+      (pt->pt_buf.buffer = (unsigned char*)malloc(buf->used + 1)) == NULL)/* */
+  { OUT_OF_MEMORY("pattern"); }			   /*                        */
+  pt->pt_goal	= goal;				   /*                        */
+  pt->pt_casep	= casep;			   /*                        */
+  pt->pt_syntax = syntax;			   /*                        */
+  pt->pt_buf.used	    = buf->used;	   /*                        */
+  pt->pt_buf.allocated	    = buf->used + 1;	   /*                        */
+  pt->pt_buf.syntax	    = buf->syntax;	   /*                        */
+  pt->pt_buf.fastmap	    = NULL;		   /*                        */
+  pt->pt_buf.translate	    = NULL;		   /*                        */
+  pt->pt_buf.re_nsub	    = buf->re_nsub;	   /*                        */
+  pt->pt_buf.can_be_null    = buf->can_be_null;	   /*                        */
+  pt->pt_buf.regs_allocated = REGS_FIXED;	   /*                        */
+  pt->pt_buf.fastmap_accurate = 0;		   /*                        */
+  pt->pt_buf.no_sub	    = buf->no_sub;	   /*                        */
+  pt->pt_buf.not_bol	    = buf->not_bol;	   /*                        */
+  pt->pt_buf.not_eol	    = buf->not_eol;	   /*                        */
+  pt->pt_buf.newline_anchor = buf->newline_anchor; /*                        */
+  (void)memcpy(pt->pt_buf.buffer, buf->buffer, buf->used);/*                 */
+  LinkSymbol(goal);				   /*                        */
+  pt->pt_next	 = r_patterns[h];		   /*                        */
+  r_patterns[h] = pt;				   /*                        */
+  pt->pt_seq	 = r_pattern_seq;		   /*                        */
+  r_pattern_seq = pt;				   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	free_patterns()
+** Type:	void
+** Purpose:	Release the compiled regular expressions remembered.
+** Arguments:	none
+** Returns:	nothing
+**___________________________________________________			     */
+static void free_patterns()			   /*                        */
+{ Pattern	pt, next;			   /*                        */
+ 						   /*                        */
+  for (pt = r_pattern_seq; pt; pt = next)	   /*                        */
+  { next = pt->pt_seq;				   /*                        */
+    free(pt->pt_buf.buffer);			   /*                        */
+    free(pt);					   /*                        */
+  }						   /*                        */
+  r_pattern_seq = PatternNULL;			   /*                        */
+  if (r_patterns) free(r_patterns);		   /*                        */
+  r_patterns = NULL;				   /*                        */
+}						   /*------------------------*/
+#endif
+
+/*-----------------------------------------------------------------------------
+** Function:	write_patterns()
+** Type:	void
+** Purpose:	Write the compiled regular expressions remembered to a
+**		resource bundle.
+** Arguments:
+**	file	the output stream
+** Returns:	nothing
+**___________________________________________________			     */
+void write_patterns(file)			   /*                        */
+  FILE		*file;				   /*                        */
+{						   /*                        */
+#ifdef REGEX
+  Pattern	pt;				   /*                        */
+  unsigned long n = 0;				   /*                        */
+ 						   /*                        */
+  for (pt = r_pattern_seq; pt; pt = pt->pt_seq) n++;/*                       */
+  bundle_put(n, file);				   /*                        */
+  for (pt = r_pattern_seq; pt; pt = pt->pt_seq)	   /*                        */
+  { bundle_put_bytes(SymbolValue(pt->pt_goal),	   /*                        */
+		     strlen((char*)SymbolValue(pt->pt_goal)) + 1,/*          */
+		     file);			   /*                        */
+    bundle_put((unsigned long)pt->pt_casep, file); /*                        */
+    bundle_put((unsigned long)pt->pt_syntax, file);/*                        */
+    bundle_put((unsigned long)pt->pt_buf.syntax, file);/*                    */
+    bundle_put((unsigned long)pt->pt_buf.re_nsub, file);/*                   */
+    bundle_put((pt->pt_buf.can_be_null ? 1UL : 0UL) |/*                      */
+	       (pt->pt_buf.no_sub ? 2UL : 0UL) |   /*                        */
+	       (pt->pt_buf.not_bol ? 4UL : 0UL) |  /*                        */
+	       (pt->pt_buf.not_eol ? 8UL : 0UL) |  /*                        */
+	       (pt->pt_buf.newline_anchor ? 16UL : 0UL),/*                   */
+	       file);				   /*                        */
+    bundle_put_bytes(pt->pt_buf.buffer, pt->pt_buf.used, file);/*            */
+  }						   /*                        */
+#else
+  bundle_put(0UL, file);			   /*                        */
 #endif
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	read_patterns()
+** Type:	bool
+** Purpose:	Read compiled regular expressions from a resource
+**		bundle and remember them. Rules using them do not need
+**		to compile them again.
+** Arguments:
+**	c	the cursor in the bundle
+** Returns:	|false| iff the data are corrupt.
+**___________________________________________________			     */
+bool read_patterns(c)				   /*                        */
+  BundleCursor	c;				   /*                        */
+{ unsigned long n = bundle_get(c);		   /*                        */
+#ifdef REGEX
+  struct re_pattern_buffer buf;			   /*                        */
+  unsigned char *goal;				   /*                        */
+  unsigned long bits;				   /*                        */
+  reg_syntax_t	syntax;				   /*                        */
+  int		casep;				   /*                        */
+  size_t	len;				   /*                        */
+ 						   /*                        */
+  while (n-- > 0 && c->bc_ok)			   /*                        */
+  { goal	   = bundle_bytes(c, &len);	   /*                        */
+    if (goal == NULL || len == 0 || goal[len-1] != '\0') return false;/*     */
+    casep	   = (int)bundle_get(c);	   /*                        */
+    syntax	   = (reg_syntax_t)bundle_get(c);  /*                        */
+    buf.syntax	   = (reg_syntax_t)bundle_get(c);  /*                        */
+    buf.re_nsub	   = (size_t)bundle_get(c);	   /*                        */
+    bits	   = bundle_get(c);		   /*                        */
+    buf.buffer	   = bundle_bytes(c, &len);	   /*                        */
+    if (!c->bc_ok) return false;		   /*                        */
+    buf.used	   = len;			   /*                        */
+    buf.can_be_null    = (bits & 1UL) != 0;	   /*                        */
+    buf.no_sub	       = (bits & 2UL) != 0;	   /*                        */
+    buf.not_bol	       = (bits & 4UL) != 0;	   /*                        */
+    buf.not_eol	       = (bits & 8UL) != 0;	   /*                        */
+    buf.newline_anchor = (bits & 16UL) != 0;	   /*                        */
+    add_pattern(symbol(goal), casep, syntax, &buf);/*                        */
+  }						   /*                        */
+  return c->bc_ok;				   /*                        */
+#else
+  return c->bc_ok && n == 0;			   /*                        */
+#endif
+}						   /*------------------------*/
 
 /*-----------------------------------------------------------------------------
 ** Function*:	new_rule()
@@ -216,12 +603,10 @@ static Rule new_rule(field, value, pattern, frame, flags, casep)/*           */
   int		flags;				   /*			     */
   int		casep;				   /*			     */
 { register Rule rule;				   /*			     */
-  static int    init = 1;			   /*                        */
  						   /*                        */
 #ifdef REGEX
-  if ( init )					   /*                        */
-  { init = 0;					   /*                        */
-    reg.num_regs = 32;				   /*                        */
+  if ( reg.start == NULL )			   /*                        */
+  { reg.num_regs = 32;				   /*                        */
     reg.start = (regoff_t*)calloc(32,sizeof(regoff_t));/*                    */
     reg.end   = (regoff_t*)calloc(32,sizeof(regoff_t));/*                    */
     if ( reg.start == NULL || reg.end == NULL )	   /*                        */
@@ -234,38 +619,61 @@ static Rule new_rule(field, value, pattern, frame, flags, casep)/*           */
 						   /*			     */
   RuleField(rule) = field;			   /*			     */
   if (field) { LinkSymbol(field); }		   /*                        */
+  demand_field(field);				   /*                        */
   RuleValue(rule) = value;			   /*			     */
   if (value) { LinkSymbol(value); }		   /*                        */
   RuleFrame(rule) = frame;			   /*			     */
   if (frame) { LinkSymbol(frame); }		   /*                        */
   RuleFlag(rule)  = flags;			   /*			     */
+  RuleFold(rule)  = StringNULL;			   /*                        */
+  RuleFoldLen(rule) = 0;			   /*                        */
+  RuleFoldGen(rule) = -1;			   /*                        */
+  RuleShift(rule) = (Uchar*)NULL;		   /*                        */
   NextRule(rule)  = RuleNULL;			   /*			     */
   RuleGoal(rule)  = pattern;			   /*                        */
   if (pattern) { LinkSymbol(pattern); }		   /*                        */
+  RuleAttempts(rule) = 0L;			   /*                        */
+  RuleMatches(rule)  = 0L;			   /*                        */
+  RuleRepl(rule)     = 0L;			   /*                        */
+  RuleTime(rule)     = 0.0;			   /*                        */
+  RuleLine(rule)     = 0;			   /*                        */
+  RuleSource(rule)   = rsc_source(&RuleLine(rule));/* where it comes from   */
+  if (RuleSource(rule)) { LinkSymbol(RuleSource(rule)); }/*                  */
 					       	   /*                        */
 #ifdef REGEX
   if ( pattern &&				   /*                        */
        *SymbolValue(pattern) &&			   /*                        */
        (flags&RULE_REGEXP) )			   /*                        */
   { char *msg;					   /*                        */
-    if ( (RulePattern(rule).buffer = (String)malloc(16)) == NULL )/*         */
-    { OUT_OF_MEMORY("pattern"); }		   /*			     */
-    RulePattern(rule).allocated = 16;		   /*			     */
-    RulePattern(rule).syntax    = RE_SYNTAX_EMACS; /*			     */
-    RulePattern(rule).fastmap   = NULL;		   /*			     */
-    RulePattern(rule).regs_allocated = REGS_FIXED; /*			     */
-    RulePattern(rule).translate = (casep	   /*                        */
-				  ? (char*)trans_lower/*                     */
-				  : NULL);	   /*	                     */
+    if (!copy_pattern(pattern, casep, &RulePattern(rule)))/* not compiled    */
+    {						   /*  before                */
+      if ( (RulePattern(rule).buffer = (String)malloc(16)) == NULL )/*       */
+      { OUT_OF_MEMORY("pattern"); }		   /*			     */
+      RulePattern(rule).allocated = 16;		   /*			     */
+      RulePattern(rule).syntax    = RE_SYNTAX_EMACS;/*			     */
+      RulePattern(rule).fastmap   = NULL;	   /*                        */
+      RulePattern(rule).regs_allocated = REGS_FIXED;/*			     */
+      RulePattern(rule).translate = (casep	   /*                        */
+				    ? (char*)trans_lower/*                   */
+				    : NULL);	   /*	                     */
 						   /*			     */
-    msg = (char*)re_compile_pattern((char*)SymbolValue(pattern),/*	     */
-				    symlen(pattern),/*		             */
-				    &RulePattern(rule) );/*	             */
-    if (msg) {				   	   /*                        */
-      Err(msg);					   /*                        */
-      free(rule);				   /*                        */
-      return NULL;				   /*                        */
-    }	   					   /*			     */
+#ifdef HAVE_PTHREAD_H
+      (void)pthread_mutex_lock(&re_lock);	   /*                        */
+#endif
+      re_syntax_options = re_syntax;		   /* the context syntax     */
+      msg = (char*)re_compile_pattern((char*)SymbolValue(pattern),/*	     */
+				      symlen(pattern),/*		     */
+				      &RulePattern(rule) );/*	             */
+#ifdef HAVE_PTHREAD_H
+      (void)pthread_mutex_unlock(&re_lock);	   /*                        */
+#endif
+      if (msg) {				   /*                        */
+        Err(msg);				   /*                        */
+        free(rule);				   /*                        */
+        return NULL;				   /*                        */
+      }	   					   /*			     */
+      add_pattern(pattern, casep, re_syntax, &RulePattern(rule));/*          */
+    }						   /*                        */
   }						   /*                        */
   else						   /*                        */
   { RuleFlag(rule) = (flags & ~RULE_REGEXP);	   /*                        */
@@ -287,7 +695,6 @@ static Rule new_rule(field, value, pattern, frame, flags, casep)/*           */
   return rule;					   /*			     */
 }						   /*------------------------*/
 
-#ifdef UNUSED
 /*-----------------------------------------------------------------------------
 ** Function*:	free_rule()
 ** Purpose:	Free a list of rules.
@@ -302,13 +709,18 @@ static void free_rule(rule)			   /*                        */
   while (rule)				   	   /*                        */
   { next = NextRule(rule);			   /*                        */
 #ifdef REGEX
-    free(RulePattern(rule).buffer);		   /*                        */
+    if (RuleFlag(rule) & RULE_REGEXP)		   /* Only then a pattern    */
+    { free(RulePattern(rule).buffer); }		   /*  has been compiled.    */
 #endif
+    if (RuleFold(rule))  { free(RuleFold(rule)); } /*                        */
+    if (RuleShift(rule)) { free(RuleShift(rule)); }/*                        */
     free(rule);					   /*                        */
     rule = next;				   /*                        */
   }						   /*                        */
 }						   /*------------------------*/
-#endif
+
+#define rule_stack      (RewriteState->rule_stack)
+#define rule_stack_size (RewriteState->rule_stack_size)
 
 /*-----------------------------------------------------------------------------
 ** Function*:	add_rule()
@@ -333,13 +745,15 @@ static void add_rule(s,rp,rp_end,flags,casep)	   /*			     */
   Rule		rule;				   /*			     */
   int		sp;				   /*                        */
   int		stackp;				   /* stack pointer for the  */
-  static Symbol	*stack;			   	   /* local stack of fields  */
-  static int    stacksize = 0;			   /*                        */
+  Symbol	*stack = rule_stack;		   /* local stack of fields  */
+  int		stacksize = rule_stack_size;	   /*                        */
  						   /*                        */
   if ( stacksize == 0 )				   /*                        */
   { stacksize++;				   /*                        */
     if ((stack=(Symbol*)malloc(sizeof(Symbol)))==(Symbol*)NULL)/*            */
     { OUT_OF_MEMORY("rule stack"); }		   /*                        */
+    rule_stack      = stack;			   /*                        */
+    rule_stack_size = stacksize;		   /*                        */
   }						   /*                        */
   stackp = 0;					   /*                        */
 						   /*			     */
@@ -364,6 +778,8 @@ static void add_rule(s,rp,rp_end,flags,casep)	   /*			     */
       if ( (stack=(Symbol*)realloc((void*)stack,   /*                        */
 				   stacksize*sizeof(Symbol)))==NULL)/*       */
       { OUT_OF_MEMORY("rule stack"); }		   /*                        */
+      rule_stack      = stack;			   /*                        */
+      rule_stack_size = stacksize;		   /*                        */
     }						   /*                        */
     stack[stackp++] = field;			   /*                        */
   }						   /*                        */
@@ -391,6 +807,7 @@ static void add_rule(s,rp,rp_end,flags,casep)	   /*			     */
 		    frame,			   /*                        */
 		    flags,			   /*                        */
 		    casep);			   /*                        */
+    if ( rule == RuleNULL ) return;		   /* Invalid pattern        */
     if ( *rp == RuleNULL )			   /*                        */
     { *rp = *rp_end = rule; }			   /*			     */
     else					   /*                        */
@@ -405,6 +822,7 @@ static void add_rule(s,rp,rp_end,flags,casep)	   /*			     */
 		    frame,			   /*                        */
 		    flags,			   /*                        */
 		    casep);			   /*		             */
+    if ( rule == RuleNULL ) continue;		   /* Invalid pattern        */
     if ( *rp == RuleNULL )			   /*                        */
     { *rp = *rp_end = rule; }			   /*			     */
     else					   /*                        */
@@ -473,8 +891,68 @@ static void rewrite_1(frame,sb,match,db,rec)	   /*			     */
   }						   /*			     */
 }						   /*------------------------*/
 
+/*-----------------------------------------------------------------------------
+** Function*:	rule_count()
+** Type:	void
+** Purpose:	Record an attempt to match a rule in its profile.
+** Arguments:
+**	rule	the rule
+**	matchp	indicator whether the rule has matched
+**	start	the time when the attempt has been started
+** Returns:	nothing
+**___________________________________________________			     */
+static void rule_count(rule, matchp, start)	   /*                        */
+  Rule	 rule;					   /*                        */
+  bool	 matchp;				   /*                        */
+  double start;					   /*                        */
+{ RuleAttempts(rule)++;				   /*                        */
+  if (matchp) RuleMatches(rule)++;		   /*                        */
+  RuleTime(rule) += stat_clock() - start;	   /*                        */
+}						   /*------------------------*/
+
 #ifdef REGEX
 
+/*-----------------------------------------------------------------------------
+** Function*:	rule_search()
+** Type:	int
+** Purpose:	Search the pattern of a rule in a whole string. The
+**		match is stored in the registers |reg|. The search is
+**		counted in the statistics. If the rules are profiled
+**		then the search is counted and timed in the rule too.
+** Arguments:
+**	rule	the rule
+**	s	the string
+**	len	the length of the string
+** Returns:	the start of the match or a negative value if none is
+**		found
+**___________________________________________________			     */
+static int rule_search(rule, s, len)		   /*                        */
+  Rule	 rule;					   /*                        */
+  String s;					   /*                        */
+  int	 len;					   /*                        */
+{ int	 ret;					   /*                        */
+  double start;					   /*                        */
+ 						   /*                        */
+  StatCount(st_regex, 1);			   /*                        */
+  if (rsc_print_rules <= 0)			   /*                        */
+  { return re_search(&RulePattern(rule),	   /*                        */
+		     (char*)s,			   /*                        */
+		     len,			   /*                        */
+		     0,				   /*                        */
+		     len - 1,			   /*                        */
+		     &reg);			   /*                        */
+  }						   /*                        */
+  start = stat_clock();				   /*                        */
+  ret	= re_search(&RulePattern(rule),		   /*                        */
+		    (char*)s,			   /*                        */
+		    len,			   /*                        */
+		    0,				   /*                        */
+		    len - 1,			   /*                        */
+		    &reg);			   /*                        */
+  rule_count(rule, ret >= 0, start);		   /*                        */
+  return ret;					   /*                        */
+}						   /*------------------------*/
+
 /*-----------------------------------------------------------------------------
 ** Function*:	selector_hits()
 ** Type:	bool
@@ -494,19 +972,18 @@ static bool selector_hits(rule, db, rec)	   /*                        */
   Symbol value;					   /*                        */
   int len;					   /*                        */
  						   /*                        */
-  if (field == NO_SYMBOL) { return true; }	   /*                        */
+  if (field == NO_SYMBOL)			   /* Without a selector the */
+  { if (rsc_print_rules > 0)			   /*  rule matches always.  */
+    { rule_count(rule, true, stat_clock()); }	   /*                        */
+    return true;				   /*                        */
+  }						   /*                        */
  						   /*                        */
   value = get_field(db, rec, field);		   /*                        */
 #ifdef REGEX
   len	= (value ? symlen(value) : 0) ;		   /*                        */
   return (value &&				   /*                        */
 	  SymbolValue(value) &&			   /*			     */
-	  re_search(&RulePattern(rule),	   	   /*			     */
-		    (char*)SymbolValue(value),	   /*                        */
-		    len,	   		   /*                        */
-		    0,			   	   /*                        */
-		    len - 1,		   	   /*                        */
-		    &reg) >= 0 );	   	   /*			     */
+	  rule_search(rule, SymbolValue(value), len) >= 0);/*                */
 #else
   return true;					   /*                        */
 #endif
@@ -541,12 +1018,15 @@ static String repl_regex(field, value, rule, db, rec)/*			     */
   bool		once_more;		   	   /*                        */
   int		limit;			   	   /* depth counter to break */
  						   /*  out of infinite loops */
-  static StringBuffer *s1 = NULL;		   /*			     */
-  static StringBuffer *s2 = NULL;		   /*			     */
+  StringBuffer	*s1 = RewriteState->repl_sb1;	   /*                        */
+  StringBuffer	*s2 = RewriteState->repl_sb2;	   /*                        */
 						   /*			     */
   if (rule == RuleNULL) return val; 		   /*			     */
 						   /*			     */
-  if (s1 == NULL) { s1 = sbopen(); s2 = sbopen(); }/*			     */
+  if (s1 == NULL)				   /*                        */
+  { s1 = RewriteState->repl_sb1 = sbopen();	   /*                        */
+    s2 = RewriteState->repl_sb2 = sbopen();	   /*                        */
+  }						   /*                        */
   else		  { sbrewind(s1);  sbrewind(s2);  }/*			     */
 						   /*			     */
   (void)sbputs((char*)val, s1);		   	   /*			     */
@@ -579,6 +1059,11 @@ static String repl_regex(field, value, rule, db, rec)/*			     */
 	  {					   /*			     */
 	    if (*hp == field)	   		   /*			     */
 	    { field = *hp = RuleValue(rule);	   /*                        */
+	      StatCount(st_hits, 1);		   /*                        */
+	      RuleRepl(rule)++;			   /*                        */
+	      RecordClear(rec, RecordFlagSORTED	   /*                        */
+			  | RecordFlagINDEXED);	   /*                        */
+	      SetRecordDIRTY(rec);		   /*                        */
 	      break;				   /*                        */
 	    }					   /*                        */
 	  }					   /*                        */
@@ -589,12 +1074,7 @@ static String repl_regex(field, value, rule, db, rec)/*			     */
       else if ((RuleField(rule) == NULL	   	   /*			     */
 		|| RuleField(rule) == field ) &&   /*			     */
 	       (RuleFlag(rule) & RULE_ADD) == 0 && /*                        */
-	       re_search(&RulePattern(rule),	   /*			     */
-			 (char*)val,		   /*                        */
-			 len,			   /*                        */
-			 0,			   /*                        */
-			 len - 1,		   /*                        */
-			 &reg) >= 0 )		   /*			     */
+	       rule_search(rule, val, len) >= 0 )  /*			     */
       {					   	   /*			     */
 	if (--limit < 0)			   /*                        */
 	{ ErrPrintF2("\n*** BibTool WARNING: Rewrite limit exceeded for field %s\n\t\t     in record %s\n",
@@ -605,6 +1085,8 @@ static String repl_regex(field, value, rule, db, rec)/*			     */
 	  once_more = false;			   /*                        */
 	  break;				   /*                        */
 	}					   /*                        */
+	StatCount(st_hits, 1);			   /*                        */
+	RuleRepl(rule)++;			   /*                        */
 	if (RuleFrame(rule) == NO_SYMBOL)	   /*			     */
 	{ return StringNULL; }		   	   /*			     */
 						   /*			     */
@@ -659,14 +1141,14 @@ static String check_regex(field, value, rule, db, rec)/*		     */
 {						   /*			     */
 #ifdef REGEX
   int		      len;			   /*			     */
-  static StringBuffer *s2 = 0L;			   /*			     */
+  StringBuffer	      *s2 = RewriteState->check_sb;/*                        */
 						   /*			     */
   if (rule == RuleNULL)				   /*                        */
-  { match = RuleNULL;				   /*                        */
+  { c_match = RuleNULL;				   /*                        */
     return SymbolValue(value);			   /*			     */
   }						   /*			     */
 						   /*			     */
-  if ( s2 == NULL ) { s2 = sbopen(); }		   /*			     */
+  if ( s2 == NULL ) { s2 = RewriteState->check_sb = sbopen(); }/*            */
   else		    { sbrewind(s2);  }		   /*			     */
 						   /*			     */
   for ( len  =	symlen(value);		   	   /* Loop through all rules */
@@ -676,13 +1158,13 @@ static String check_regex(field, value, rule, db, rec)/*		     */
 	  || RuleField(rule) == field )		   /*			     */
 	&&					   /*                        */
 	 (   (RuleFlag(rule)&RULE_REGEXP) == 0	   /*                        */
-	  || re_search(&RulePattern(rule),	   /*			     */
-		       (char*)SymbolValue(value),  /*                        */
-		       len,0,len-1,&reg) >=0 	   /*			     */
+	  || rule_search(rule, SymbolValue(value), len) >= 0/*               */
 	 )					   /*                        */
        )					   /*			     */
-    { if ( RuleFrame(rule) == NO_SYMBOL )	   /*			     */
-      { match = RuleNULL;			   /*                        */
+    { StatCount(st_hits, 1);			   /*                        */
+      RuleRepl(rule)++;				   /*                        */
+      if ( RuleFrame(rule) == NO_SYMBOL )	   /*			     */
+      { c_match = RuleNULL;			   /*                        */
 	return StringNULL;			   /*                        */
       }						   /*			     */
       rewrite_1(SymbolValue(RuleFrame(rule)),	   /*                        */
@@ -690,12 +1172,12 @@ static String check_regex(field, value, rule, db, rec)/*		     */
 		SymbolValue(value),		   /*                        */
 		db,				   /*                        */
 		rec);  				   /*		             */
-      match = rule;				   /*                        */
+      c_match = rule;				   /*                        */
       return (String)sbflush(s2);		   /* TODO: update the value?*/
     }						   /*                        */
   }						   /*			     */
 #endif
-  match = RuleNULL;				   /*                        */
+  c_match = RuleNULL;				   /*                        */
   return StringNULL;				   /* return the result.     */
 }						   /*------------------------*/
 
@@ -703,8 +1185,8 @@ static String check_regex(field, value, rule, db, rec)/*		     */
 /*---			    Rewrite Rule Section			  ---*/
 /*---------------------------------------------------------------------------*/
 
- static Rule r_rule = RuleNULL;
- static Rule r_rule_end	= RuleNULL;
+#define r_rule	   (RewriteState->r_rule)
+#define r_rule_end (RewriteState->r_rule_end)
 
 /*-----------------------------------------------------------------------------
 ** Function:	rename_field()
@@ -791,7 +1273,19 @@ void add_rewrite_rule(s)			   /*			     */
 
 #define K_RULES_SIZE 37
 
-static Rule *k_rules = (Rule*)NULL;
+#define k_rules (RewriteState->k_rules)
+
+#define KEEP_NONE	0
+#define KEEP_DYNAMIC	1
+#define KEEP_ALL	2
+
+#define k_tab	   (RewriteState->k_tab)
+#define k_tab_size (RewriteState->k_tab_size)
+#define k_star	   (RewriteState->k_star)
+#define k_types	   (RewriteState->k_types)
+#define k_valid	   (RewriteState->k_valid)
+
+#define KeepHash(S)	((int)(((unsigned long)(S)>>3) & (k_tab_size-1)))
 
 /*-----------------------------------------------------------------------------
 ** Function:	keep_field()
@@ -855,6 +1349,7 @@ void keep_field(spec)				   /*			     */
     NextRule(rule) = k_rules[i];		   /*                        */
     k_rules[i] = rule;				   /*                        */
   }						   /*                        */
+  k_valid = false;				   /* recompile on next use  */
   						   /*                        */
   free_sym_array(names);			   /*                        */
 }						   /*------------------------*/
@@ -863,8 +1358,8 @@ void keep_field(spec)				   /*			     */
 /*---			      Check Rule Section			  ---*/
 /*---------------------------------------------------------------------------*/
 
- static Rule c_rule = RuleNULL;
- static Rule c_rule_end = RuleNULL;
+#define c_rule	   (RewriteState->c_rule)
+#define c_rule_end (RewriteState->c_rule_end)
 
 /*-----------------------------------------------------------------------------
 ** Function:	add_check_rule()
@@ -914,6 +1409,320 @@ static bool dont_keep(sym,rec,db)		   /*                        */
   return true;					   /*                        */
 }						   /*------------------------*/
 
+/*---------------------------------------------------------------------------*/
+/*---			  Compiled Keep Rule Section			  ---*/
+/*---------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	keep_state()
+** Type:	static int
+** Purpose:	Determine statically in which way a keep rule applies
+**		to records of a given entry type. Rules without a
+**		condition and rules conditioned on the pseudo field
+**		|$type| can be decided once and for all. Any other
+**		condition depends on the record itself.
+** Arguments:
+**	rule	the keep rule
+**	type	the entry type
+** Returns:	One of |KEEP_NONE|, |KEEP_DYNAMIC|, or |KEEP_ALL|.
+**___________________________________________________			     */
+static int keep_state(rule, type)		   /*                        */
+  Rule rule;					   /*                        */
+  int  type;					   /*                        */
+{ Symbol sel = RuleFrame(rule);			   /*                        */
+  String name;					   /*                        */
+  int    len;					   /*                        */
+ 						   /*                        */
+  if (sel == NO_SYMBOL) return KEEP_ALL;	   /*                        */
+  if ((RuleFlag(rule) & RULE_REGEXP) == 0	   /*                        */
+      || !case_eq(SymbolValue(sel), (String)"$type"))/*                      */
+  { return KEEP_DYNAMIC; }			   /*                        */
+ 						   /*                        */
+  if ((name = SymbolValue(get_entry_type(type))) == StringNULL)/*            */
+  { return KEEP_NONE; }				   /*                        */
+  len = strlen((char*)name);			   /*                        */
+#ifdef REGEX
+  return (rule_search(rule, name, len) >= 0	   /*                        */
+	  ? KEEP_ALL				   /*                        */
+	  : KEEP_NONE);				   /*                        */
+#else
+  return KEEP_ALL;				   /*                        */
+#endif
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	compile_keep_rules()
+** Type:	static void
+** Purpose:	Translate the keep rules into a table which records
+**		for each field mentioned in a rule and each entry type
+**		whether the field is kept, deleted, or needs the
+**		evaluation of the conditions at hand of the record. The
+**		pseudo field |*| is folded into every table row and
+**		serves as the default for all other fields.
+** Arguments:	none
+** Returns:	nothing
+**___________________________________________________			     */
+static void compile_keep_rules()		   /*                        */
+{ Rule    r;					   /*                        */
+  int     i, t, st, n;				   /*                        */
+  char    *state;				   /*                        */
+  KeepTab kt;					   /*                        */
+ 						   /*                        */
+  for (i = 0; i < k_tab_size; i++)		   /* Release old table      */
+  { if (k_tab[i].kt_field) free(k_tab[i].kt_state);}/*                       */
+  if (k_tab)  free(k_tab);			   /*                        */
+  if (k_star) free(k_star);			   /*                        */
+ 						   /*                        */
+  for (k_types = 0;				   /*                        */
+       get_entry_type(k_types) != NO_SYMBOL;	   /*                        */
+       k_types++) {}				   /*                        */
+ 						   /*                        */
+  for (n = 0, i = 0; i < K_RULES_SIZE; i++)	   /*                        */
+  { for (r = k_rules[i]; r; r = NextRule(r)) n++; }/*                        */
+  for (k_tab_size = 16; k_tab_size < 2*n; k_tab_size *= 2) {}/*              */
+ 						   /*                        */
+  if ((k_tab = (KeepTab)calloc(k_tab_size, sizeof(SKeepTab))) == NULL/*      */
+      || (k_star = (char*)calloc(k_types + 1, sizeof(char))) == NULL)/*      */
+  { OUT_OF_MEMORY("keep table"); }		   /*                        */
+ 						   /*                        */
+  for (i = 0; i < K_RULES_SIZE; i++)		   /*                        */
+  { for (r = k_rules[i]; r; r = NextRule(r))	   /*                        */
+    { if (RuleField(r) == sym_star)		   /*                        */
+      { state = k_star; }			   /*                        */
+      else					   /*                        */
+      { for (kt = &k_tab[KeepHash(RuleField(r))];  /*                        */
+	     kt->kt_field && kt->kt_field != RuleField(r);/*                 */
+	     kt = (kt == &k_tab[k_tab_size-1] ? k_tab : kt+1)) {}/*          */
+	if (kt->kt_field == NO_SYMBOL)		   /*                        */
+	{ kt->kt_field = RuleField(r);		   /*                        */
+	  if ((kt->kt_state = (char*)calloc(k_types + 1,/*                   */
+					    sizeof(char))) == NULL)/*        */
+	  { OUT_OF_MEMORY("keep table"); }	   /*                        */
+	}					   /*                        */
+	state = kt->kt_state;			   /*                        */
+      }						   /*                        */
+      for (t = 0; t < k_types; t++)		   /*                        */
+      { st = keep_state(r, t);			   /*                        */
+	if (st > state[t]) state[t] = st;	   /*                        */
+      }						   /*                        */
+    }						   /*                        */
+  }						   /*                        */
+ 						   /*                        */
+  for (i = 0; i < k_tab_size; i++)		   /* Fold in the rules for **/
+  { if ((state = k_tab[i].kt_state) != NULL)	   /*                        */
+    { for (t = 0; t < k_types; t++)		   /*                        */
+      { if (k_star[t] > state[t]) state[t] = k_star[t]; }/*                  */
+    }						   /*                        */
+  }						   /*                        */
+  k_valid = true;				   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	keep_fingerprint()
+** Type:	unsigned long
+** Purpose:	Compute a hash of the keep rules. It does not depend on
+**		the order of the rules in the table since this order
+**		differs between runs.
+** Arguments:	none
+** Returns:	The hash.
+**___________________________________________________			     */
+static unsigned long keep_fingerprint()		   /*                        */
+{ Rule		r;				   /*                        */
+  Symbol	s[3];				   /*                        */
+  unsigned long h, sum = 0;			   /*                        */
+  int		i, j;				   /*                        */
+ 						   /*                        */
+  for (i = 0; k_rules && i < K_RULES_SIZE; i++)	   /*                        */
+  { for (r = k_rules[i]; r; r = NextRule(r))	   /*                        */
+    { s[0] = RuleField(r);			   /*                        */
+      s[1] = RuleFrame(r);			   /*                        */
+      s[2] = RuleGoal(r);			   /*                        */
+      h	   = BUNDLE_HASH_INIT;			   /*                        */
+      for (j = 0; j < 3; j++)			   /*                        */
+      { h = (s[j]				   /*                        */
+	     ? bundle_hash(h,			   /*                        */
+			   SymbolValue(s[j]),	   /*                        */
+			   strlen((char*)SymbolValue(s[j])) + 1)/*           */
+	     : bundle_hash(h, (unsigned char*)"", 1));/*                     */
+      }						   /*                        */
+      sum = (sum + h) & 0xffffffffUL;		   /*                        */
+    }						   /*                        */
+  }						   /*                        */
+  return sum;					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	write_keep_table()
+** Type:	void
+** Purpose:	Write the compiled table of the keep rules to a
+**		resource bundle. The table is compiled if required.
+**		The entry types are written as well since the table
+**		is indexed by them.
+** Arguments:
+**	file	the output stream
+** Returns:	nothing
+**___________________________________________________			     */
+void write_keep_table(file)			   /*                        */
+  FILE	  *file;				   /*                        */
+{ int	  i, j, n;				   /*                        */
+  String  s;					   /*                        */
+  KeepTab *order;				   /*                        */
+ 						   /*                        */
+  if (k_rules == NULL)				   /*                        */
+  { bundle_put(0UL, file);			   /*                        */
+    return;					   /*                        */
+  }						   /*                        */
+  if (!k_valid || get_entry_type(k_types) != NO_SYMBOL)/*                    */
+  { compile_keep_rules(); }			   /*                        */
+ 						   /*                        */
+  bundle_put(1UL, file);			   /*                        */
+  bundle_put(keep_fingerprint(), file);		   /*                        */
+  bundle_put((unsigned long)k_types, file);	   /*                        */
+  for (i = 0; i < k_types; i++)			   /*                        */
+  { s = SymbolValue(get_entry_type(i));		   /*                        */
+    bundle_put_bytes(s, strlen((char*)s) + 1, file);/*                       */
+  }						   /*                        */
+  bundle_put_bytes((unsigned char*)k_star, k_types, file);/*                 */
+  if ((order = (KeepTab*)malloc(k_tab_size * sizeof(KeepTab))) == NULL)/*   */
+  { OUT_OF_MEMORY("keep table"); }		   /*                        */
+  for (n = 0, i = 0; i < k_tab_size; i++)	   /* Sort the fields to get */
+  { if (k_tab[i].kt_field == NO_SYMBOL) continue;  /*  the same bundle in    */
+    for (j = n++;				   /*  each run.             */
+	 j > 0 && strcmp((char*)SymbolValue(order[j-1]->kt_field),/*         */
+			 (char*)SymbolValue(k_tab[i].kt_field)) > 0;/*       */
+	 j--)					   /*                        */
+    { order[j] = order[j-1]; }			   /*                        */
+    order[j] = &k_tab[i];			   /*                        */
+  }						   /*                        */
+  bundle_put((unsigned long)n, file);		   /*                        */
+  for (i = 0; i < n; i++)			   /*                        */
+  { s = SymbolValue(order[i]->kt_field);	   /*                        */
+    bundle_put_bytes(s, strlen((char*)s) + 1, file);/*                       */
+    bundle_put_bytes((unsigned char*)order[i]->kt_state, k_types, file);/*   */
+  }						   /*                        */
+  free(order);					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	read_keep_table()
+** Type:	bool
+** Purpose:	Read the compiled table of the keep rules from a
+**		resource bundle. The table is used only if the keep
+**		rules and the entry types are the same as those in
+**		the bundle. Otherwise it is compiled on first use as
+**		usual.
+** Arguments:
+**	c	the cursor in the bundle
+** Returns:	|false| iff the data are corrupt.
+**___________________________________________________			     */
+bool read_keep_table(c)				   /*                        */
+  BundleCursor	c;				   /*                        */
+{ unsigned long h, types, n;			   /*                        */
+  unsigned long i;				   /*                        */
+  unsigned char *s, *star;			   /*                        */
+  size_t	len;				   /*                        */
+  SBundleCursor tab;				   /*                        */
+  bool		match;				   /*                        */
+  KeepTab	kt;				   /*                        */
+  Symbol	field;				   /*                        */
+ 						   /*                        */
+  if (bundle_get(c) == 0UL) return c->bc_ok;	   /*                        */
+  h	= bundle_get(c);			   /*                        */
+  types = bundle_get(c);			   /*                        */
+  match = (c->bc_ok &&				   /*                        */
+	   h == keep_fingerprint() &&		   /*                        */
+	   get_entry_type((int)types) == NO_SYMBOL);/*                       */
+  for (i = 0; i < types && c->bc_ok; i++)	   /*                        */
+  { s = bundle_bytes(c, &len);			   /*                        */
+    if (s == NULL || len == 0 || s[len-1] != '\0') return false;/*           */
+    if (match &&				   /*                        */
+	(get_entry_type((int)i) == NO_SYMBOL ||	   /*                        */
+	 strcmp((char*)SymbolValue(get_entry_type((int)i)), (char*)s) != 0))
+    { match = false; }				   /*                        */
+  }						   /*                        */
+  star = bundle_bytes(c, &len);			   /*                        */
+  if (star == NULL || len != types) return false;  /*                        */
+  n   = bundle_get(c);				   /*                        */
+  tab = *c;					   /*                        */
+  for (i = 0; i < n && c->bc_ok; i++)		   /*                        */
+  { s = bundle_bytes(c, &len);			   /*                        */
+    if (s == NULL || len == 0 || s[len-1] != '\0') return false;/*           */
+    s = bundle_bytes(c, &len);			   /*                        */
+    if (s == NULL || len != types) return false;   /*                        */
+  }						   /*                        */
+  if (!c->bc_ok) return false;			   /*                        */
+  if (!match) return true;			   /*                        */
+ 						   /*                        */
+  for (i = 0; i < (unsigned long)k_tab_size; i++)  /* Release old table      */
+  { if (k_tab[i].kt_field) free(k_tab[i].kt_state);}/*                       */
+  if (k_tab)  free(k_tab);			   /*                        */
+  if (k_star) free(k_star);			   /*                        */
+ 						   /*                        */
+  k_types = (int)types;				   /*                        */
+  for (k_tab_size = 16;				   /*                        */
+       (unsigned long)k_tab_size < 2*n;		   /*                        */
+       k_tab_size *= 2) {}			   /*                        */
+  if ((k_tab = (KeepTab)calloc(k_tab_size, sizeof(SKeepTab))) == NULL/*      */
+      || (k_star = (char*)calloc(k_types + 1, sizeof(char))) == NULL)/*      */
+  { OUT_OF_MEMORY("keep table"); }		   /*                        */
+  (void)memcpy(k_star, star, types);		   /*                        */
+ 						   /*                        */
+  for (i = 0; i < n; i++)			   /*                        */
+  { field = symbol(bundle_bytes(&tab, &len));	   /*                        */
+    for (kt = &k_tab[KeepHash(field)];		   /*                        */
+	 kt->kt_field && kt->kt_field != field;	   /*                        */
+	 kt = (kt == &k_tab[k_tab_size-1] ? k_tab : kt+1)) {}/*              */
+    kt->kt_field = field;			   /*                        */
+    if ((kt->kt_state = (char*)calloc(k_types + 1, sizeof(char))) == NULL)/* */
+    { OUT_OF_MEMORY("keep table"); }		   /*                        */
+    (void)memcpy(kt->kt_state, bundle_bytes(&tab, &len), types);/*          */
+  }						   /*                        */
+  k_valid = true;				   /*                        */
+  return true;					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	keep_p()
+** Type:	static bool
+** Purpose:	Decide whether a field of a record survives the keep
+**		rules. The compiled table answers most requests
+**		immediately. Only rules with a condition on a real
+**		field are evaluated with |dont_keep()|.
+** Arguments:
+**	sym	the field name
+**	rec	the record
+**	db	the database
+** Returns:	|true| iff the field should be kept
+**___________________________________________________			     */
+static bool keep_p(sym, rec, db)		   /*                        */
+  Symbol  sym;					   /*                        */
+  Record  rec;					   /*                        */
+  DB      db;					   /*                        */
+{ KeepTab kt;					   /*                        */
+  int     st;					   /*                        */
+  int     type = RecordType(rec);		   /*                        */
+ 						   /*                        */
+  if (!k_valid					   /*                        */
+      || type >= k_types			   /*                        */
+      || get_entry_type(k_types) != NO_SYMBOL)	   /* new entry types defined*/
+  { compile_keep_rules(); }			   /*                        */
+  if (type < 0 || type >= k_types)		   /*                        */
+  { return !(dont_keep(sym_star, rec, db) &&	   /*                        */
+	     dont_keep(sym, rec, db)); }	   /*                        */
+ 						   /*                        */
+  for (kt = &k_tab[KeepHash(sym)];		   /*                        */
+       kt->kt_field && kt->kt_field != sym;	   /*                        */
+       kt = (kt == &k_tab[k_tab_size-1] ? k_tab : kt+1)) {}/*                */
+  st = (kt->kt_field ? kt->kt_state : k_star)[type];/*                       */
+ 						   /*                        */
+  switch (st)					   /*                        */
+  { case KEEP_ALL:  return true;		   /*                        */
+    case KEEP_NONE: return false;		   /*                        */
+  }						   /*                        */
+  return !(dont_keep(sym_star, rec, db) &&	   /*                        */
+	   dont_keep(sym, rec, db));		   /*                        */
+}						   /*------------------------*/
+
 /*-----------------------------------------------------------------------------
 ** Function:	rewrite_record()
 ** Purpose:	Apply deletions, checks, additions, and rewriting steps
@@ -930,9 +1739,9 @@ void rewrite_record(db, rec)			   /*			     */
   register Symbol *hp;				   /* heap pointer	     */
   register Macro  mac;				   /*			     */
   String          cp;				   /*			     */
-  static StringBuffer *sb = NULL;		   /*                        */
+  StringBuffer	  *sb = RewriteState->rewrite_sb;  /*                        */
  						   /*                        */
-  if (sb == NULL) sb = sbopen();		   /*                        */
+  if (sb == NULL) sb = RewriteState->rewrite_sb = sbopen();/*                */
 						   /*			     */
   if (c_rule)			   		   /*			     */
   {						   /*                        */
@@ -950,10 +1759,10 @@ void rewrite_record(db, rec)			   /*			     */
 			     rec))		   /*		             */
 	  )					   /*			     */
       { ErrPrint("*** BibTool");		   /*                        */
-	if (match)				   /*			     */
-	{ if (RuleFlag(match)&RULE_ERROR)	   /*			     */
+	if (c_match)				   /*			     */
+	{ if (RuleFlag(c_match)&RULE_ERROR)	   /*			     */
 	  { ErrPrint(" ERROR"); }		   /*			     */
-	  if (RuleFlag(match)&RULE_WARNING)	   /*			     */
+	  if (RuleFlag(c_match)&RULE_WARNING)	   /*			     */
 	  { ErrPrint(" WARNING"); }		   /*			     */
 	}					   /*			     */
 	err_location(RecordLineno(rec),		   /*                        */
@@ -976,11 +1785,13 @@ void rewrite_record(db, rec)			   /*			     */
 	{ if (*hp) UnlinkSymbol(*hp);		   /*                        */
 	  if (*(hp+1)) UnlinkSymbol(*(hp+1));	   /*                        */
 	  *hp = *(hp+1) = NO_SYMBOL;		   /*                        */
+	  SetRecordDIRTY(rec);			   /*                        */
 	}					   /*                        */
 	else if (strcmp((char*)cp,		   /*                        */
 			(char*)SymbolValue(*(hp+1))))/*		             */
 	{ if (*(hp+1)) UnlinkSymbol(*(hp+1));	   /*                        */
 	  *(hp+1) = symbol(cp);			   /*                        */
+	  SetRecordDIRTY(rec);			   /*                        */
 	}		   			   /*			     */
       }						   /*			     */
     }						   /*			     */
@@ -994,11 +1805,11 @@ void rewrite_record(db, rec)			   /*			     */
     {						   /*			     */
       if (*hp &&				   /*                        */
 	  *(hp+1) &&				   /*                        */
-	  dont_keep(sym_star, rec, db) &&	   /*                        */
-	  dont_keep(*hp, rec, db))		   /*                        */
+	  !keep_p(*hp, rec, db))		   /*                        */
       { if (*hp) UnlinkSymbol(*hp);		   /*                        */
 	if (*(hp+1)) UnlinkSymbol(*(hp+1));	   /*                        */
 	*hp = *(hp+1) = NO_SYMBOL;		   /*                        */
+	SetRecordDIRTY(rec);			   /*                        */
       }						   /*			     */
     }						   /*			     */
   }						   /*			     */
@@ -1030,8 +1841,8 @@ void rewrite_record(db, rec)			   /*			     */
 /*---			    Extract Rule Section			  ---*/
 /*---------------------------------------------------------------------------*/
 
- static Rule x_rule = RuleNULL;
- static Rule x_rule_end = RuleNULL;
+#define x_rule	   (RewriteState->x_rule)
+#define x_rule_end (RewriteState->x_rule_end)
 
 /*-----------------------------------------------------------------------------
 ** Function:	add_extract()
@@ -1065,6 +1876,32 @@ void add_extract(s,regexp,notp)			   /*			     */
   rsc_select = true;				   /*                        */
 }						   /*------------------------*/
 
+/*-----------------------------------------------------------------------------
+** Function:	clear_extract()
+** Purpose:	Remove all extraction rules. Afterwards all records are
+**		selected until new rules are added.
+** Arguments:	none
+** Returns:	nothing
+**___________________________________________________			     */
+void clear_extract()				   /*                        */
+{						   /*                        */
+  free_rule(x_rule);				   /*                        */
+  x_rule     = RuleNULL;			   /*                        */
+  x_rule_end = RuleNULL;			   /*                        */
+  rsc_select = false;				   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	have_extract()
+** Type:	bool
+** Purpose:	Check whether extraction rules are present.
+** Arguments:	none
+** Returns:	|true| iff at least one extraction rule is present.
+**___________________________________________________			     */
+bool have_extract()				   /*                        */
+{ return x_rule != RuleNULL;			   /*                        */
+}						   /*------------------------*/
+
 /*-----------------------------------------------------------------------------
 ** Function:	save_regex()
 ** Purpose:	Save an extraction rule for later use.
@@ -1097,15 +1934,20 @@ void save_regex(s)				   /*                        */
 }						   /*------------------------*/
 
 
- static char s_class[256];			   /*                        */
- static String s_ignored = (String)NULL;	   /*                        */
- static int  s_cased    = -33;			   /*                        */
+#define s_class	  (RewriteState->s_class)
+#define s_ignored (RewriteState->s_ignored)
+#define s_cased	  (RewriteState->s_cased)
+#define s_gen	  (RewriteState->s_gen)
+#define s_text	  (RewriteState->s_text)
 
 /*-----------------------------------------------------------------------------
 ** Function*:	init_s_search()
-** Purpose:	
-**		
-**		
+** Purpose:	Initialize the character classes used for string
+**		matching. Characters to be ignored are mapped to 0.
+**		If the comparison is not case sensitive then lower
+**		case letters are mapped to their upper case
+**		counterparts. Any folded pattern computed with the
+**		previous classes is invalidated.
 ** Arguments:
 **	ignored	the letters to be ignored
 ** Returns:	Nothing
@@ -1115,94 +1957,163 @@ static void init_s_search(ignored)		   /*                        */
 { int i;					   /*                        */
   for (i = 0; i < 256; i++) s_class[i] = i;	   /*                        */
  						   /*                        */
-  if (!rsc_case_select) 			   /*                        */
-  {						   /*                        */
-    s_class['a'] = 'A';				   /*                        */
-    s_class['b'] = 'B';				   /*                        */
-    s_class['c'] = 'C';				   /*                        */
-    s_class['d'] = 'D';				   /*                        */
-    s_class['e'] = 'E';				   /*                        */
-    s_class['f'] = 'F';				   /*                        */
-    s_class['g'] = 'G';				   /*                        */
-    s_class['h'] = 'H';				   /*                        */
-    s_class['i'] = 'I';				   /*                        */
-    s_class['j'] = 'J';				   /*                        */
-    s_class['k'] = 'K';				   /*                        */
-    s_class['l'] = 'L';				   /*                        */
-    s_class['m'] = 'M';				   /*                        */
-    s_class['n'] = 'N';				   /*                        */
-    s_class['o'] = 'O';				   /*                        */
-    s_class['p'] = 'P';				   /*                        */
-    s_class['q'] = 'Q';				   /*                        */
-    s_class['r'] = 'R';				   /*                        */
-    s_class['s'] = 'S';				   /*                        */
-    s_class['t'] = 'T';				   /*                        */
-    s_class['u'] = 'U';				   /*                        */
-    s_class['v'] = 'V';				   /*                        */
-    s_class['w'] = 'W';				   /*                        */
-    s_class['x'] = 'X';				   /*                        */
-    s_class['y'] = 'Y';				   /*                        */
-    s_class['z'] = 'Z';				   /*                        */
+  if (!rsc_case_select)				   /*                        */
+  { for (i = 'a'; i <= 'z'; i++)		   /*                        */
+    { s_class[i] = i - 'a' + 'A'; }		   /*                        */
   }						   /*                        */
   while ( *ignored )				   /*                        */
   { s_class[(unsigned int)(*(ignored++))] = '\0'; }/*                        */
  						   /*                        */
   s_cased   = rsc_case_select;			   /*                        */
-  s_ignored = rsc_sel_ignored;	   	   	   /*                        */
+  s_ignored = rsc_sel_ignored;			   /*                        */
+  s_gen++;					   /*                        */
 }						   /*------------------------*/
 
 /*-----------------------------------------------------------------------------
-** Function*:	s_match()
-** Purpose:	
-**		
-**		
+** Function*:	s_fold_rule()
+** Purpose:	Compute the folded pattern of a string matching rule.
+**		The folded pattern consists of the character classes
+**		of the pattern with all ignored characters removed.
+**		For longer patterns the shift table of the Horspool
+**		algorithm is computed as well. The result is cached
+**		in the rule until the character classes change.
 ** Arguments:
-**	pattern	the pattern
-**	s	the string
-** Returns:	
+**	rule	the rule
+** Returns:	nothing
 **___________________________________________________			     */
-static bool s_match(p,s)			   /*                        */
-  String  p;					   /*                        */
-  String  s;					   /*                        */
-{						   /*                        */
-  while (*p && s_class[(unsigned int)*p] == '\0') p++;/*                     */
+static void s_fold_rule(rule)			   /*                        */
+  Rule   rule;					   /*                        */
+{ String p = SymbolValue(RuleGoal(rule));	   /*                        */
+  String fp;					   /*                        */
+  Uchar  c;					   /*                        */
+  int    m, i;					   /*                        */
  						   /*                        */
-  while (*p)					   /*                        */
-  {						   /*                        */
-    while (*s && s_class[(unsigned int)*s] == '\0') s++;/*                   */
+  if (RuleFold(rule) == StringNULL		   /*                        */
+      && (RuleFold(rule) = (String)malloc(strlen((char*)p) + 1))/*           */
+	  == StringNULL)			   /*                        */
+  { OUT_OF_MEMORY("pattern"); }			   /*                        */
+ 						   /*                        */
+  for (fp = RuleFold(rule); *p; p++)		   /*                        */
+  { if ((c = s_class[*p]) != '\0') *fp++ = c; }	   /*                        */
+  *fp = '\0';					   /*                        */
+  RuleFoldLen(rule) = m = fp - RuleFold(rule);	   /*                        */
+  RuleFoldGen(rule) = s_gen;			   /*                        */
+ 						   /*                        */
+  if (m < 4) return;				   /*                        */
+  if (RuleShift(rule) == (Uchar*)NULL		   /*                        */
+      && (RuleShift(rule) = (Uchar*)malloc(256)) == (Uchar*)NULL)/*          */
+  { OUT_OF_MEMORY("pattern"); }			   /*                        */
+  fp = RuleFold(rule);				   /*                        */
+  for (i = 0; i < 256; i++)			   /* shifts are limited to  */
+  { RuleShift(rule)[i] = (m < 255 ? m : 255); }	   /* 255; a smaller shift   */
+  for (i = 0; i < m - 1; i++)			   /* is always safe         */
+  { RuleShift(rule)[fp[i]] = (m - 1 - i < 255 ? m - 1 - i : 255); }/*        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	s_prepare()
+** Purpose:	Bring the character classes and the folded patterns of
+**		all string matching selection rules up to date. Afterwards
+**		|s_search()| does not modify any shared data when
+**		applied to these rules.
+** Arguments:	none
+** Returns:	nothing
+**___________________________________________________			     */
+static void s_prepare()				   /*                        */
+{ Rule rule;					   /*                        */
  						   /*                        */
-    if (s_class[(unsigned int)*s] != s_class[(unsigned int)*p]) return false;
-    while (*p && s_class[(unsigned int)*p] == '\0') p++;/*                   */
-    if (*s) s++;				   /*                        */
-    if (*p) p++;				   /*                        */
+  if ( s_cased != rsc_case_select ||		   /*                        */
+       s_ignored != rsc_sel_ignored )		   /*                        */
+  { init_s_search(rsc_sel_ignored); }		   /*                        */
+ 						   /*                        */
+  for (rule = x_rule; rule != RuleNULL; rule = NextRule(rule))/*             */
+  { if ( !(RuleFlag(rule) & RULE_REGEXP) &&	   /*                        */
+	 RuleFoldGen(rule) != s_gen )		   /*                        */
+    { s_fold_rule(rule); }			   /*                        */
   }						   /*                        */
-  return true;					   /*                        */
 }						   /*------------------------*/
 
 /*-----------------------------------------------------------------------------
 ** Function*:	s_search()
-** Purpose:	Match a pattern against all positions in a string.
+** Purpose:	Match the pattern of a rule against all positions in a
+**		string. Ignored characters are removed from pattern and
+**		string and the remaining characters are compared
+**		according to their classes. For this purpose the
+**		string is folded into a text buffer first. Short
+**		patterns are located with |memchr()| for the first
+**		character followed by a verification; longer patterns
+**		use the Horspool algorithm.
 ** Arguments:
-**	pattern	the pattern
+**	rule	the rule containing the pattern
 **	s	the string
+**	text	the text buffer to fold the string into
 ** Returns:	If a match is found then |true| is returned. Otherwise
 **		|false|.
 **___________________________________________________			     */
-static bool s_search(pattern,s)			   /*                        */
-  String  pattern;				   /*                        */
+static bool s_search(rule, s, text)		   /*                        */
+  Rule    rule;					   /*                        */
   String  s;					   /*                        */
-{						   /*                        */
+  Text    text;					   /*                        */
+{ String  fp, tp, end, buf;			   /*                        */
+  Uchar   *cls;					   /*                        */
+  Uchar   *shift;				   /*                        */
+  size_t  len, m, i;				   /*                        */
+  Uchar   c;					   /*                        */
+ 						   /*                        */
   if ( s_cased != rsc_case_select ||		   /*                        */
-       strcmp((char*)s_ignored,			   /*                        */
-	      (char*)rsc_sel_ignored) != 0 )	   /*                        */
+       s_ignored != rsc_sel_ignored )		   /*                        */
   { init_s_search(rsc_sel_ignored); }		   /*                        */
+  if (RuleFoldGen(rule) != s_gen) s_fold_rule(rule);/*                       */
+ 						   /*                        */
+  if (*s == '\0') return false;			   /*                        */
+  if ((m = RuleFoldLen(rule)) == 0) return true;   /*                        */
+  fp = RuleFold(rule);				   /*                        */
+ 						   /*                        */
+  len = strlen((char*)s);			   /*                        */
+  if (len + 1 > text->tx_size)			   /*                        */
+  { text->tx_size = len + 1 + 256;		   /*                        */
+    if (text->tx_buf) free(text->tx_buf);	   /*                        */
+    if ((text->tx_buf = (String)malloc(text->tx_size)) == StringNULL)/*      */
+    { OUT_OF_MEMORY("string search"); }		   /*                        */
+  }						   /*                        */
+  buf	= text->tx_buf;				   /*                        */
+  cls   = s_class;				   /*                        */
+  for (tp = buf; *s; s++)			   /* fold the string        */
+  { c   = cls[*s];				   /*                        */
+    *tp = c;					   /*                        */
+    tp += (c != '\0');				   /*                        */
+  }						   /*                        */
+  len = tp - buf;				   /*                        */
+  if (len < m) return false;			   /*                        */
+ 						   /*                        */
+  if (m < 4)					   /*                        */
+  { end = buf + len - m + 1;			   /*                        */
+    for (tp = buf;				   /*                        */
+	 (tp = (String)memchr(tp, *fp, end - tp)) != StringNULL;/*           */
+	 tp++)					   /*                        */
+    { if (memcmp(tp + 1, fp + 1, m - 1) == 0) return true; }/*               */
+    return false;				   /*                        */
+  }						   /*                        */
  						   /*                        */
-  for ( ; *s; s++ )				   /*                        */
-  { if (s_match(pattern,s)) return true;	   /*                        */
+  shift = RuleShift(rule);			   /* Horspool               */
+  c     = fp[m - 1];				   /*                        */
+  for (i = 0; i + m <= len; i += shift[buf[i + m - 1]])/*                    */
+  { if (buf[i + m - 1] == c &&			   /*                        */
+	memcmp(buf + i, fp, m - 1) == 0)	   /*                        */
+    { return true; }				   /*                        */
   }						   /*                        */
   return false;					   /*                        */
 }						   /*------------------------*/
 
+#ifdef HAVE_PTHREAD_H
+#define s_lock (RewriteState->s_lock)
+#define LockField()   if (s_lock) (void)pthread_mutex_lock(s_lock)
+#define UnlockField() if (s_lock) (void)pthread_mutex_unlock(s_lock)
+#else
+#define LockField()
+#define UnlockField()
+#endif
+
 #define ReturnIf(COND)					\
   if ( COND )						\
   { if ( !(RuleFlag(rule) & RULE_NOT) ) return true; }	\
@@ -1210,57 +2121,90 @@ static bool s_search(pattern,s)			   /*                        */
   { if (  (RuleFlag(rule) & RULE_NOT) ) return true; }
 
 /*-----------------------------------------------------------------------------
-** Function:	is_selected()
+** Function*:	select_match()
+** Type:	bool
+** Purpose:	Match a selection rule against a value. Regular
+**		expressions are searched without registers. Otherwise
+**		the string is searched in the value. The attempt is
+**		recorded in the profile of the rule if the rules are
+**		profiled.
+** Arguments:
+**	rule	the rule
+**	value	the value
+**	text	the text buffer for string matching
+** Returns:	|true| iff the rule matches
+**___________________________________________________			     */
+static bool select_match(rule, value, text)	   /*                        */
+  Rule	 rule;					   /*                        */
+  Symbol value;					   /*                        */
+  Text	 text;					   /*                        */
+{ bool	 ok;					   /*                        */
+  double start = 0.0;				   /*                        */
+ 						   /*                        */
+  if (rsc_print_rules > 0) start = stat_clock();   /*                        */
+#ifdef REGEX
+  if ( RuleFlag(rule) & RULE_REGEXP )		   /*                        */
+  { int len = symlen(value);			   /*                        */
+    text->tx_searches++;			   /*                        */
+    ok	= re_search(&RulePattern(rule),		   /*                        */
+		    (char*)SymbolValue(value),	   /*                        */
+		    len,			   /*                        */
+		    0,				   /*                        */
+		    len - 1,			   /*                        */
+		    NULL) >= 0;			   /*                        */
+  }						   /*                        */
+  else						   /*                        */
+#endif
+  { ok = s_search(rule, SymbolValue(value), text); }/*                       */
+  if (rsc_print_rules > 0) rule_count(rule, ok, start);/*                    */
+  return ok;					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	selected()
 ** Purpose:	Boolean function to decide whether a record should be
-**		considered. These selections are described by a set of
-**		regular expressions which are applied. If none are
-**		given then the match simply succeeds.
+**		considered. This is the worker behind |is_selected()|.
+**		The matching does not use any shared scratch space:
+**		string matching folds into the text buffer given and
+**		regular expressions are searched without registers.
+**		The access to the fields is serialized when the
+**		selection runs in parallel since it may create symbols.
 ** Arguments:
 **	db	Database containing the record.
 **	rec	Record to look at.
+**	text	the text buffer for string matching
 ** Returns:	|true| iff the record is seleced by a regexp or none is
 **		given.
 **___________________________________________________			     */
-bool is_selected(db,rec)			   /*			     */
+static bool selected(db, rec, text)		   /*                        */
   DB     db;					   /*                        */
-  Record rec;			   		   /*			     */
-{						   /*			     */
-  int	 len, i;				   /*			     */
-  Symbol value;				   	   /*                        */
+  Record rec;					   /*                        */
+  Text   text;					   /*                        */
+{						   /*                        */
+  int	 i;					   /*                        */
+  Symbol value;					   /*                        */
   Rule   rule;					   /*                        */
  						   /*                        */
   if ( (rule=x_rule) == RuleNULL ||		   /* If no rule is given or */
-       !rsc_select	   			   /*  no selection is       */
-     )				   		   /*  requested then        */
-    return true;				   /*  select all records.   */
+       !rsc_select				   /* no selection is        */
+     )						   /* requested then         */
+    return true;				   /* select all records.    */
  						   /*                        */
-  for ( ;			   		   /* Loop through all rules */
-	rule != RuleNULL;			   /*			     */
-	rule =	NextRule(rule) )		   /*			     */
-  {						   /*			     */
+  for ( ;					   /* Loop through all rules */
+	rule != RuleNULL;			   /*                        */
+	rule =	NextRule(rule) )		   /*                        */
+  {						   /*                        */
     if ( RuleField(rule) == NULL )		   /* If no field is given   */
-    {						   /*  then try all normal   */
+    {						   /* then try all normal    */
       if ( RuleFlag(rule) & RULE_REGEXP )	   /*                        */
       {						   /*                        */
 #ifdef REGEX
 	if ( RecordHeap(rec)[0] )		   /*                        */
-	{ len = symlen(RecordHeap(rec)[0]);	   /*                        */
-	  ReturnIf(re_search(&RulePattern(rule),   /*			     */
-			     (char*)SymbolValue(RecordHeap(rec)[0]),/*       */
-			     len,		   /*                        */
-			     0,		   	   /*                        */
-			     len - 1,		   /*                        */
-			     &reg) >= 0 );	   /*		             */
+	{ ReturnIf(select_match(rule, RecordHeap(rec)[0], text));/*          */
 	}					   /*                        */
 	for (i = 2; i < RecordFree(rec); i += 2 )  /*                        */
 	{ if ( RecordHeap(rec)[i] )		   /*                        */
-	  { len = symlen(RecordHeap(rec)[i+1]);	   /*                        */
-	    ReturnIf(re_search(&RulePattern(rule), /*			     */
-			       (char*)SymbolValue(RecordHeap(rec)[i+1]),/*   */
-			       len,		   /*                        */
-			       0,		   /*                        */
-			       len - 1,		   /*                        */
-			       &reg) >= 0 );	   /*		             */
+	  { ReturnIf(select_match(rule, RecordHeap(rec)[i+1], text));/*      */
 	  }					   /*                        */
 	}					   /*                        */
 #endif
@@ -1268,44 +2212,205 @@ bool is_selected(db,rec)			   /*			     */
       else					   /*                        */
       {						   /*                        */
 	if ( SymbolValue(RecordHeap(rec)[0]) )	   /*                        */
-	{ ReturnIf(s_search(SymbolValue(RuleGoal(rule)),/*		     */
-			    SymbolValue(RecordHeap(rec)[0])) );/*	     */
+	{ ReturnIf(select_match(rule, RecordHeap(rec)[0], text));/*          */
 	}					   /*                        */
 	for (i = 2; i < RecordFree(rec); i += 2 )  /*                        */
 	{ if ( RecordHeap(rec)[i] )		   /*                        */
-	  { ReturnIf(s_search(SymbolValue(RuleGoal(rule)),/*		     */
-			      SymbolValue(RecordHeap(rec)[i+1])) );/*	     */
+	  { ReturnIf(select_match(rule, RecordHeap(rec)[i+1], text));/*      */
 	  }					   /*                        */
 	}					   /*                        */
       }						   /*                        */
+      continue;					   /*                        */
     }						   /*                        */
-    else if ( (value=get_field(db,		   /*                        */
-			       rec,		   /*                        */
-			       RuleField(rule)))   /*                        */
-	     != NO_SYMBOL )			   /*                        */
+ 						   /*                        */
+    LockField();				   /*                        */
+    value = get_field(db, rec, RuleField(rule));   /*                        */
+    UnlockField();				   /*                        */
+ 						   /*                        */
+    if ( value == NO_SYMBOL )			   /*                        */
+    { if ( RuleFlag(rule) & RULE_NOT ) return true; }/*                      */
+    else if ( RuleFlag(rule) & RULE_REGEXP )	   /*                        */
     {						   /*                        */
-      if ( RuleFlag(rule) & RULE_REGEXP )	   /*                        */
-      {						   /*                        */
 #ifdef REGEX
-	len = symlen(value);   			   /*                        */
-        ReturnIf(re_search(&RulePattern(rule),	   /*			     */
-			   (char*)SymbolValue(value),/*                      */
-			   len,			   /*                        */
-			   0,			   /*                        */
-			   len - 1,		   /*                        */
-			   &reg) >=0 ) 		   /*			     */
+      ReturnIf(select_match(rule, value, text))	   /*                        */
 #endif
-      }						   /*                        */
-      else ReturnIf(s_search(SymbolValue(RuleGoal(rule)),/*                  */
-			     SymbolValue(value)))  /*                        */
-    }						   /*			     */
-    else if ( RuleFlag(rule) & RULE_NOT )	   /*                        */
-    { return true;				   /*                        */
     }						   /*                        */
+    else ReturnIf(select_match(rule, value, text)) /*                        */
   }						   /*                        */
-  return false;				   	   /* return the result.     */
+  return false;					   /* return the result.     */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	is_selected()
+** Purpose:	Boolean function to decide whether a record should be
+**		considered. These selections are described by a set of
+**		regular expressions which are applied. If none are
+**		given then the match simply succeeds.
+** Arguments:
+**	db	Database containing the record.
+**	rec	Record to look at.
+** Returns:	|true| iff the record is seleced by a regexp or none is
+**		given.
+**___________________________________________________			     */
+bool is_selected(db,rec)			   /*                        */
+  DB     db;					   /*                        */
+  Record rec;					   /*                        */
+{ bool ok;					   /*                        */
+ 						   /*                        */
+  s_text.tx_searches = 0L;			   /*                        */
+  ok = selected(db, rec, &s_text);		   /*                        */
+  StatCount(st_regex, s_text.tx_searches);	   /*                        */
+  return ok;					   /*                        */
 }						   /*------------------------*/
 
+#ifdef HAVE_PTHREAD_H
+
+#define SELECT_BATCH 64
+
+ typedef struct sELECTjOB
+ { DB		 sj_db;				   /* the database           */
+   Record	 *sj_recs;			   /* the records to inspect */
+   int		 sj_n;				   /* the number of records  */
+   int		 sj_next;			   /* the next unclaimed one */
+   pthread_mutex_t sj_lock;			   /* guards sj_next         */
+   Context	 sj_ctx;			   /* the context            */
+ } SSelectJob, *SelectJob;
+
+/*-----------------------------------------------------------------------------
+** Function*:	select_worker()
+** Purpose:	Thread function for the parallel selection. Batches of
+**		records are claimed from the job until all records
+**		have been inspected. Records which are not selected are
+**		marked as deleted. Each record is touched by exactly one
+**		thread.
+** Arguments:
+**	arg	the job
+** Returns:	|NULL|
+**___________________________________________________			     */
+static void * select_worker(arg)		   /*                        */
+  void * arg;					   /*                        */
+{ SelectJob job = (SelectJob)arg;		   /*                        */
+  SText     text;				   /*                        */
+  Record    rec;				   /*                        */
+  int       i, n;				   /*                        */
+ 						   /*                        */
+  (void)ctx_use(job->sj_ctx);			   /* use the callers context*/
+  text.tx_buf      = StringNULL;		   /*                        */
+  text.tx_size     = 0;				   /*                        */
+  text.tx_searches = 0L;			   /*                        */
+ 						   /*                        */
+  for (;;)					   /*                        */
+  { (void)pthread_mutex_lock(&job->sj_lock);	   /*                        */
+    i = job->sj_next;				   /*                        */
+    job->sj_next += SELECT_BATCH;		   /*                        */
+    (void)pthread_mutex_unlock(&job->sj_lock);	   /*                        */
+    if (i >= job->sj_n) break;			   /*                        */
+ 						   /*                        */
+    n = i + SELECT_BATCH;			   /*                        */
+    if (n > job->sj_n) n = job->sj_n;		   /*                        */
+    for (; i < n; i++)				   /*                        */
+    { rec = job->sj_recs[i];			   /*                        */
+      if (!selected(job->sj_db, rec, &text))	   /*                        */
+      { SetRecordDELETED(rec); }		   /*                        */
+    }						   /*                        */
+  }						   /*                        */
+ 						   /*                        */
+  if (text.tx_buf) free(text.tx_buf);		   /*                        */
+  (void)pthread_mutex_lock(&job->sj_lock);	   /* The statistics are     */
+  StatCount(st_regex, text.tx_searches);	   /*  shared by the threads.*/
+  (void)pthread_mutex_unlock(&job->sj_lock);	   /*                        */
+  return NULL;					   /*                        */
+}						   /*------------------------*/
+#endif
+
+/*-----------------------------------------------------------------------------
+** Function:	select_parallel()
+** Type:	bool
+** Purpose:	Apply the selection to the normal records of a database
+**		with several threads. The number of threads is taken
+**		from the resource |select.threads|. Records which are
+**		not selected are marked as deleted. The records are
+**		distributed in batches; the calling thread takes part
+**		in the work.
+**
+**		Nothing is done if no selection is requested, less
+**		than two threads are requested, or BibTool has been
+**		compiled without support for threads.
+** Arguments:
+**	db	the database
+** Returns:	|true| iff the selection has been performed. Otherwise
+**		the caller has to apply |is_selected()| itself.
+**___________________________________________________			     */
+bool select_parallel(db)			   /*                        */
+  DB db;					   /*                        */
+{						   /*                        */
+#ifdef HAVE_PTHREAD_H
+  SSelectJob      job;				   /*                        */
+  pthread_mutex_t lock;				   /*                        */
+  pthread_t       *tids;			   /*                        */
+  Record          rec;				   /*                        */
+  int             n, i, threads;		   /*                        */
+ 						   /*                        */
+  if ( x_rule == RuleNULL ||			   /*                        */
+       !rsc_select ||				   /*                        */
+       rsc_sel_threads < 2 ||			   /*                        */
+       rsc_print_rules > 0 ||			   /* The profiles are shared*/
+       DBnormal(db) == RecordNULL )		   /*                        */
+  { return false; }				   /*                        */
+ 						   /*                        */
+  n = 0;					   /*                        */
+  for (rec = DBnormal(db); rec != RecordNULL; rec = NextRecord(rec))/*       */
+  { n++; }					   /*                        */
+  for (rec = PrevRecord(DBnormal(db));		   /*                        */
+       rec != RecordNULL;			   /*                        */
+       rec = PrevRecord(rec))			   /*                        */
+  { n++; }					   /*                        */
+  if ( (job.sj_recs = (Record*)malloc(n * sizeof(Record))) == NULL )/*       */
+  { OUT_OF_MEMORY("selection"); }		   /*                        */
+ 						   /*                        */
+  n = 0;					   /*                        */
+  for (rec = DBnormal(db); rec != RecordNULL; rec = NextRecord(rec))/*       */
+  { if (!RecordIsDELETED(rec)) job.sj_recs[n++] = rec; }/*                   */
+  for (rec = PrevRecord(DBnormal(db));		   /*                        */
+       rec != RecordNULL;			   /*                        */
+       rec = PrevRecord(rec))			   /*                        */
+  { if (!RecordIsDELETED(rec)) job.sj_recs[n++] = rec; }/*                   */
+ 						   /*                        */
+  threads = (n + SELECT_BATCH - 1) / SELECT_BATCH; /*                        */
+  if (threads > rsc_sel_threads) threads = rsc_sel_threads;/*                */
+  if ( threads < 1 ||				   /*                        */
+       (tids = (pthread_t*)malloc(threads * sizeof(pthread_t))) == NULL )/*  */
+  { free(job.sj_recs);				   /*                        */
+    return false;				   /*                        */
+  }						   /*                        */
+ 						   /*                        */
+  s_prepare();					   /*                        */
+  job.sj_db   = db;				   /*                        */
+  job.sj_n    = n;				   /*                        */
+  job.sj_next = 0;				   /*                        */
+  job.sj_ctx  = ctx_current();			   /*                        */
+  (void)pthread_mutex_init(&job.sj_lock, NULL);	   /*                        */
+  (void)pthread_mutex_init(&lock, NULL);	   /*                        */
+  s_lock = &lock;				   /*                        */
+ 						   /*                        */
+  for (i = 1; i < threads; i++)			   /* thread 0 is the caller */
+  { if (pthread_create(&tids[i], NULL, select_worker, &job) != 0)/*          */
+      break;					   /*                        */
+  }						   /*                        */
+  (void)select_worker(&job);			   /*                        */
+  while (--i > 0)				   /*                        */
+  { (void)pthread_join(tids[i], NULL); }	   /*                        */
+ 						   /*                        */
+  s_lock = NULL;				   /*                        */
+  (void)pthread_mutex_destroy(&lock);		   /*                        */
+  (void)pthread_mutex_destroy(&job.sj_lock);	   /*                        */
+  free(tids);					   /*                        */
+  free(job.sj_recs);				   /*                        */
+  return true;					   /*                        */
+#else
+  return false;					   /*                        */
+#endif
+}						   /*------------------------*/
 #ifdef REGEX
 #endif
 
@@ -1323,21 +2428,21 @@ int set_regex_syntax(name)			   /*                        */
 {						   /*                        */
 #ifdef REGEX
   if ( strcmp(name,"emacs")  == 0 )		   /*                        */
-  { re_set_syntax(RE_SYNTAX_EMACS); }		   /*                        */
+  { re_syntax = RE_SYNTAX_EMACS; }		   /*                        */
   else if ( strcmp(name,"awk") == 0 )		   /*                        */
-  { re_set_syntax(RE_SYNTAX_AWK); }		   /*                        */
+  { re_syntax = RE_SYNTAX_AWK; }		   /*                        */
   else if ( strcmp(name,"grep") == 0 )		   /*                        */
-  { re_set_syntax(RE_SYNTAX_GREP); }		   /*                        */
+  { re_syntax = RE_SYNTAX_GREP; }		   /*                        */
   else if ( strcmp(name,"egrep") == 0 )		   /*                        */
-  { re_set_syntax(RE_SYNTAX_EGREP); }		   /*                        */
+  { re_syntax = RE_SYNTAX_EGREP; }		   /*                        */
   else if ( strcmp(name,"posix_awk") == 0 )	   /*                        */
-  { re_set_syntax(RE_SYNTAX_POSIX_AWK); }	   /*                        */
+  { re_syntax = RE_SYNTAX_POSIX_AWK; }		   /*                        */
   else if ( strcmp(name,"posix_egrep") == 0 )	   /*                        */
-  { re_set_syntax(RE_SYNTAX_POSIX_EGREP); }	   /*                        */
+  { re_syntax = RE_SYNTAX_POSIX_EGREP; }	   /*                        */
   else if ( strcmp(name,"ed") == 0 )		   /*                        */
-  { re_set_syntax(RE_SYNTAX_ED); }		   /*                        */
+  { re_syntax = RE_SYNTAX_ED; }			   /*                        */
   else if ( strcmp(name,"sed") == 0 )		   /*                        */
-  { re_set_syntax(RE_SYNTAX_SED); }		   /*                        */
+  { re_syntax = RE_SYNTAX_SED; }		   /*                        */
   else						   /*                        */
   { WARNING3("Unknown regexp syntax: ",name,"\n"); /*                        */
     return 1;					   /*                        */
@@ -1357,7 +2462,7 @@ int set_regex_syntax(name)			   /*                        */
 char* get_regex_syntax()			   /*                        */
 {						   /*                        */
 #ifdef REGEX
-  switch(re_syntax_options)			   /*                        */
+  switch(re_syntax)				   /*                        */
   { case RE_SYNTAX_EMACS:       return "emacs";	   /*                        */
     case RE_SYNTAX_AWK:         return "awk";	   /*                        */
     case RE_SYNTAX_GREP:        return "grep";	   /*                        */
@@ -1371,3 +2476,152 @@ char* get_regex_syntax()			   /*                        */
 #endif
   return "";				   	   /*                        */
 }						   /*------------------------*/
+
+/*---------------------------------------------------------------------------*/
+/*---			    Rule Profile Section			  ---*/
+/*---------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	profile_rules()
+** Type:	int
+** Purpose:	Insert the rules of a list into the table of the rules
+**		with the largest time spent for matching. The table is
+**		sorted by decreasing time. The earlier rule wins on
+**		ties.
+** Arguments:
+**	rule	the first rule of the list
+**	kind	the kind of the rules in the list
+**	top	the table of rules
+**	kinds	the table of kinds
+**	n	the size of the tables
+**	used	the number of rules in the tables
+** Returns:	the new number of rules in the tables
+**___________________________________________________			     */
+static int profile_rules(rule, kind, top, kinds, n, used)/*                  */
+  Rule	 rule;					   /*                        */
+  char	 *kind;					   /*                        */
+  Rule	 *top;					   /*                        */
+  char	 **kinds;				   /*                        */
+  int	 n;					   /*                        */
+  int	 used;					   /*                        */
+{ int	 i;					   /*                        */
+ 						   /*                        */
+  for (; rule != RuleNULL; rule = NextRule(rule))  /*                        */
+  { for (i = used; i > 0 && RuleTime(top[i-1]) < RuleTime(rule); i--)/*      */
+    { if (i < n) { top[i] = top[i-1]; kinds[i] = kinds[i-1]; }/*             */
+    }						   /*                        */
+    if (i >= n) continue;			   /*                        */
+    top[i]   = rule;				   /*                        */
+    kinds[i] = (RuleFlag(rule) & RULE_RENAME ? "rename" : kind);/*           */
+    if (used < n) used++;			   /*                        */
+  }						   /*                        */
+  return used;					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	print_rule_profile()
+** Type:	void
+** Purpose:	Print the rules of the current context which have
+**		used the most time for matching. For each rule the
+**		number of attempts to match it, the number of matches,
+**		the number of replacements, and the time are printed
+**		together with the resource file and the line where it
+**		has been defined. The numbers are collected only if
+**		the resource |print.statistics.rules| is positive
+**		while the rules are applied.
+** Arguments:
+**	file	the output stream
+**	n	the maximal number of rules to print
+** Returns:	nothing
+**___________________________________________________			     */
+void print_rule_profile(file, n)		   /*                        */
+  FILE	 *file;					   /*                        */
+  int	 n;					   /*                        */
+{ Rule	 *top;					   /*                        */
+  char	 **kinds;				   /*                        */
+  Rule	 rule;					   /*                        */
+  int	 used, i;				   /*                        */
+ 						   /*                        */
+  if (n <= 0) return;				   /*                        */
+  if ( (top   = (Rule*)malloc(n * sizeof(Rule))) == NULL ||/*                */
+       (kinds = (char**)malloc(n * sizeof(char*))) == NULL )/*               */
+  { OUT_OF_MEMORY("rule profile"); }		   /*                        */
+ 						   /*                        */
+  used = profile_rules(r_rule, "rewrite", top, kinds, n, 0);/*               */
+  used = profile_rules(c_rule, "check", top, kinds, n, used);/*              */
+  used = profile_rules(x_rule, "select", top, kinds, n, used);/*             */
+  if (k_rules)					   /*                        */
+  { for (i = 0; i < K_RULES_SIZE; i++)		   /*                        */
+    { used = profile_rules(k_rules[i], "keep", top, kinds, n, used); }/*     */
+  }						   /*                        */
+ 						   /*                        */
+  fprintf(file, "\n---  %-7s %10s %10s %10s %10s  %s\n",/*                   */
+	  "rule",				   /*                        */
+	  "attempts",				   /*                        */
+	  "matches",				   /*                        */
+	  "replaced",				   /*                        */
+	  "time [s]",				   /*                        */
+	  "source");				   /*                        */
+  for (i = 0; i < used; i++)			   /*                        */
+  { rule = top[i];				   /*                        */
+    fprintf(file, "---  %-7s %10ld %10ld %10ld %10.4f  ",/*                  */
+	    kinds[i],				   /*                        */
+	    RuleAttempts(rule),			   /*                        */
+	    RuleMatches(rule),			   /*                        */
+	    RuleRepl(rule),			   /*                        */
+	    RuleTime(rule));			   /*                        */
+    if (RuleSource(rule))			   /*                        */
+    { fprintf(file, "%s:%d",			   /*                        */
+	      (char*)SymbolValue(RuleSource(rule)),/*                        */
+	      RuleLine(rule));			   /*                        */
+    }						   /*                        */
+    else					   /*                        */
+    { fputs("-", file); }			   /*                        */
+    if (RuleField(rule))			   /*                        */
+    { fprintf(file, " %s", (char*)SymbolValue(RuleField(rule))); }/*         */
+    if (RuleGoal(rule))				   /*                        */
+    { fprintf(file, " \"%s\"", (char*)SymbolValue(RuleGoal(rule))); }/*      */
+    fputc('\n', file);				   /*                        */
+  }						   /*                        */
+  free(kinds);					   /*                        */
+  free(top);					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	rewrite_free()
+** Type:	void
+** Purpose:	Release the memory held by the state of the rewrite
+**		module. The state belongs to the current context.
+** Arguments:
+**	state	the state
+** Returns:	nothing
+**___________________________________________________			     */
+static void rewrite_free(state)			   /*                        */
+  void *state;					   /*                        */
+{ int i;					   /*                        */
+  POSSIBLY_UNUSED(state);			   /*                        */
+ 						   /*                        */
+  free_rule(r_rule);				   /*                        */
+  free_rule(c_rule);				   /*                        */
+  free_rule(x_rule);				   /*                        */
+  if (k_rules)					   /*                        */
+  { for (i = 0; i < K_RULES_SIZE; i++) free_rule(k_rules[i]);/*              */
+    free(k_rules);				   /*                        */
+  }						   /*                        */
+  for (i = 0; i < k_tab_size; i++)		   /*                        */
+  { if (k_tab[i].kt_field) free(k_tab[i].kt_state);}/*                       */
+  if (k_tab)  free(k_tab);			   /*                        */
+  if (k_star) free(k_star);			   /*                        */
+  clear_addlist();				   /*                        */
+  if (rule_stack) free(rule_stack);		   /*                        */
+  if (RewriteState->repl_sb1) (void)sbclose(RewriteState->repl_sb1);/*       */
+  if (RewriteState->repl_sb2) (void)sbclose(RewriteState->repl_sb2);/*       */
+  if (RewriteState->check_sb) (void)sbclose(RewriteState->check_sb);/*       */
+  if (RewriteState->rewrite_sb) (void)sbclose(RewriteState->rewrite_sb);/*   */
+  if (s_text.tx_buf) free(s_text.tx_buf);	   /*                        */
+#ifdef REGEX
+  if (reg.start) free(reg.start);		   /*                        */
+  if (reg.end)   free(reg.end);			   /*                        */
+  free_patterns();				   /*                        */
+#endif
+}						   /*------------------------*/
@@ -52,7 +52,6 @@
 #include <bibtool/version.h>
 #include <bibtool/io.h>
 #include "config.h"
-#define RSC_INIT
 #include <bibtool/rsc.h>
 
 /*****************************************************************************/
@@ -81,11 +80,66 @@
 
 /*---------------------------------------------------------------------------*/
 
-#define RscNumeric(SYM,S,V,I) static Symbol S = NO_SYMBOL;
-#define RscString(SYM,S,V,I)  static Symbol S = NO_SYMBOL;
-#define RscBoolean(SYM,S,V,I) static Symbol S = NO_SYMBOL;
-#define RscByFct(SYM,S,FCT)   static Symbol S = NO_SYMBOL;
+/*-----------------------------------------------------------------------------
+** Variable*:	rsc_state0
+** Type:	SResources
+** Purpose:	The initial values of the resources in a context.
+**___________________________________________________			     */
+ static SResources rsc_state0 =			   /*                        */
+ {						   /*                        */
+#define RscNumeric(SYM,S,V,I) I,
+#define RscString(SYM,S,V,I)  (String)I,
+#define RscBoolean(SYM,S,V,I) I,
+#define RscByFct(SYM,S,FCT)   
+#ifndef MAKEDEPEND
+#include <bibtool/resource.h>
+#endif
+   FALSE,					   /* rsc_select             */
+   RSC_BIBTOOL,					   /* rsc_e_rsc              */
+   (String)(RSC_BIBTOOL_DEFAULT)		   /* rsc_v_rsc              */
+ };						   /*                        */
+
+/*-----------------------------------------------------------------------------
+** Function:	rsc_state()
+** Type:	SResources*
+** Purpose:	Create the resources in the current context with
+**		their default values. This function is used by the
+**		macro |Resources| when they do not exist yet.
+** Arguments:	none
+** Returns:	the resources
+**___________________________________________________			     */
+SResources * rsc_state()			   /*                        */
+{ return (SResources*)ctx_state(CTX_RESOURCES,	   /*                        */
+				(void*)&rsc_state0,/*                        */
+				sizeof(rsc_state0),/*                        */
+				NULL);		   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Typedef*:	SRscNames
+** Purpose:	The symbols of the resource names in a context. They
+**		are compared with the name of a resource to be set.
+**___________________________________________________			     */
+ typedef struct					   /*                        */
+ {						   /*                        */
+#define RscNumeric(SYM,S,V,I) Symbol S;
+#define RscString(SYM,S,V,I)  Symbol S;
+#define RscBoolean(SYM,S,V,I) Symbol S;
+#define RscByFct(SYM,S,FCT)   Symbol S;
+#ifndef MAKEDEPEND
 #include <bibtool/resource.h>
+#endif
+ } SRscNames;					   /*                        */
+
+/*-----------------------------------------------------------------------------
+** Variable*:	rsc_names0
+** Type:	SRscNames
+** Purpose:	The initial state of the resource names in a
+**		context. The symbols are created by |init_rsc()|.
+**___________________________________________________			     */
+ static SRscNames rsc_names0;			   /*                        */
+
+#define RscNames ((SRscNames*)CtxState(CTX_RSC, rsc_names0))
 
 /*-----------------------------------------------------------------------------
 ** Function:	init_rsc()
@@ -104,11 +158,11 @@
 ** Returns:	nothing
 **___________________________________________________			     */
 static void init_rsc()				   /*			     */
-{						   /*			     */
-#define RscNumeric(SYM,S,V,I)  S = symbol((String)SYM);
-#define RscString(SYM,S,V,I)   S = symbol((String)SYM);
-#define RscBoolean(SYM,S,V,I)  S = symbol((String)SYM);
-#define RscByFct(SYM,S,FCT)    S = symbol((String)SYM);
+{ SRscNames *names = RscNames;			   /*			     */
+#define RscNumeric(SYM,S,V,I)  names->S = symbol((String)SYM);
+#define RscString(SYM,S,V,I)   names->S = symbol((String)SYM);
+#define RscBoolean(SYM,S,V,I)  names->S = symbol((String)SYM);
+#define RscByFct(SYM,S,FCT)    names->S = symbol((String)SYM);
 #ifndef MAKEDEPEND
 #include <bibtool/resource.h>
 #endif
@@ -183,7 +237,7 @@ bool search_rsc()				   /*			     */
 bool load_rsc(name)			   	   /*			     */
   register String name;				   /*			     */
 {						   /*			     */
-  if (r_v == NULL) { init_rsc(); }		   /*			     */
+  if (RscNames->r_v == NULL) { init_rsc(); }		   /*			     */
   return (name != NULL ? read_rsc(name) : false);  /*			     */
 }						   /*------------------------*/
 
@@ -265,7 +319,7 @@ bool use_rsc(s)					   /*			     */
     return true;				   /*			     */
   }						   /*                        */
 						   /*			     */
-  if (r_v == NULL) { init_rsc(); }		   /*			     */
+  if (RscNames->r_v == NULL) { init_rsc(); }		   /*			     */
 						   /*			     */
   return set_rsc(name, value);			   /*                        */
 }						   /*------------------------*/
@@ -283,7 +337,8 @@ bool use_rsc(s)					   /*			     */
 bool set_rsc(name,val)				   /*			     */
   Symbol name;				   	   /*			     */
   Symbol val;				   	   /*			     */
-{						   /*			     */
+{ SRscNames *names = RscNames;			   /*			     */
+						   /*			     */
   if ( rsc_verbose )				   /*			     */
   { VerbosePrint4("Set resource ",		   /*                        */
 		  (char*)SymbolValue(name),	   /*                        */
@@ -295,16 +350,16 @@ bool set_rsc(name,val)				   /*			     */
 						   /*			     */
 #define SETQ(V,T) V=T; UnlinkSymbol(name);
 #define RscNumeric(SYM,S,V,I)						\
-  if ( name == S ) { SETQ(V,atoi((char*)SymbolValue(val)));		\
+  if ( name == names->S ) { SETQ(V,atoi((char*)SymbolValue(val)));		\
     UnlinkSymbol(val); return false; }
 #define RscString(SYM,S,V,I)						\
-  if ( name == S ) { V = (String)new_string((char*)SymbolValue(val));	\
+  if ( name == names->S ) { V = (String)new_string((char*)SymbolValue(val));	\
     UnlinkSymbol(name); return false; }
 #define RscBoolean(SYM,S,V,I)						\
-  if ( name == S ) { SETQ(V,test_true(val));				\
+  if ( name == names->S ) { SETQ(V,test_true(val));				\
     UnlinkSymbol(val); return false; }
 #define RscByFct(SYM,S,FCT)						\
-  if ( name == S ) { (void)FCT;						\
+  if ( name == names->S ) { (void)FCT;						\
     UnlinkSymbol(name); return false; }
 #define RSC_FIRST(C)	      case C:
 #define RSC_NEXT(C)	      break; case C:
@@ -54,7 +54,23 @@
  static String unexpected = (String)"Unexpected "; /*                        */
  static String expected   = (String)" expected.";  /*                        */
 
- static String sp_line = StringNULL;		   /*                        */
+/*-----------------------------------------------------------------------------
+** Typedef*:	SSParseState
+** Purpose:	The state of the s_parse module in a context. It
+**		contains the string currently parsed.
+**___________________________________________________			     */
+ typedef struct					   /*                        */
+ { String sp_line;				   /*                        */
+ } SSParseState;				   /*                        */
+
+/*-----------------------------------------------------------------------------
+** Variable*:	s_parse_state0
+** Type:	SSParseState
+** Purpose:	The initial state of the s_parse module in a context.
+**___________________________________________________			     */
+ static SSParseState s_parse_state0 = { StringNULL };/*                      */
+
+#define sp_line (((SSParseState*)CtxState(CTX_S_PARSE, s_parse_state0))->sp_line)
 
 /*-----------------------------------------------------------------------------
 ** Function:	sp_open()
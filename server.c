@@ -0,0 +1,572 @@
+/*** server.c *****************************************************************
+**
+** This file is part of BibTool.
+** It is distributed under the GNU General Public License.
+** See the file COPYING for details.
+**
+** (c) 2020 Gerd Neugebauer
+**
+** Net: gene@gerd-neugebauer.de
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+**-----------------------------------------------------------------------------
+** Description:
+**	This module contains the server mode of \BibTool{}. The
+**	entries of a database are served to clients reading from the
+**	standard input or connecting to a socket.
+**
+******************************************************************************/
+
+#include <bibtool/general.h>
+#include <bibtool/error.h>
+#include <bibtool/database.h>
+#include <bibtool/symbols.h>
+#include <bibtool/key.h>
+#include <bibtool/print.h>
+#include <bibtool/rewrite.h>
+#include <bibtool/tex_aux.h>
+#include <bibtool/rsc.h>
+#include <bibtool/server.h>
+#include "config.h"
+#ifdef HAVE_SYS_UN_H
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+/*****************************************************************************/
+/* Internal Programs							     */
+/*===========================================================================*/
+
+#ifdef __STDC__
+#define _ARG(A) A
+#else
+#define _ARG(A) ()
+#endif
+#ifdef HAVE_SYS_UN_H
+ typedef struct cLIENT *Client;
+ static void srv_index _ARG((DB db));		   /* server.c               */
+ static Record srv_find _ARG((Symbol key));	   /* server.c               */
+ static void srv_key _ARG((DB db, char *arg, FILE *out));/* server.c         */
+ static void srv_select _ARG((DB db, char *arg, FILE *out));/* server.c      */
+ static void srv_bibdata _ARG((Symbol file));	   /* server.c               */
+ static void srv_aux _ARG((DB db, char *arg, FILE *out));/* server.c         */
+ static void srv_format _ARG((char *body, size_t len, FILE *out));/* server.c*/
+ static bool srv_requests _ARG((DB db, Client cl, bool eofp));/* server.c    */
+ static bool srv_read _ARG((DB db, Client cl));	   /* server.c               */
+ static int srv_listen _ARG((char *path));	   /* server.c               */
+#endif
+
+/*****************************************************************************/
+/* External Programs and Variables					     */
+/*===========================================================================*/
+
+/*---------------------------------------------------------------------------*/
+
+#ifdef HAVE_SYS_UN_H
+/*-----------------------------------------------------------------------------
+** Typedef*:	Client
+** Purpose:	This data type represents a client of the server. The
+**		requests are read from a descriptor and collected in a
+**		buffer until they are complete. The buffer is always
+**		terminated by a null character. The responses are
+**		written to a stream.
+**___________________________________________________			     */
+ struct cLIENT					   /*                        */
+ { int		cl_fd;				   /* the descriptor read    */
+   FILE		*cl_out;			   /* the stream written     */
+   char		*cl_buf;			   /* the input not yet used */
+   size_t	cl_len;				   /* its length             */
+   size_t	cl_size;			   /* the size of the buffer */
+ };						   /*                        */
+ typedef struct cLIENT SClient;			   /*                        */
+
+#define SERVER_CHUNK 4096
+
+ static Record *srv_tab	 = (Record*)NULL;	   /* the records by key     */
+ static unsigned long srv_size = 0;		   /* its size; a power of 2 */
+ static char   *srv_tmp	 = NULL;		   /* the file for format    */
+ static bool   (*srv_fct)_ARG((DB, Record)) = NULL;/* applied to the entries */
+
+#define SrvHash(KEY)	((((unsigned long)(KEY)) >> 4) * 2654435761UL)
+
+/*-----------------------------------------------------------------------------
+** Function*:	srv_index()
+** Type:	void
+** Purpose:	Enter the normal records of a database into a hash
+**		table by their keys. Records marked as deleted are not
+**		entered. If several records have the same key then the
+**		first one is found.
+** Arguments:
+**	db	the database; it has been rewound
+** Returns:	nothing
+**___________________________________________________			     */
+static void srv_index(db)			   /*                        */
+  DB db;					   /*                        */
+{ Record	rec;				   /*                        */
+  unsigned long h, n = 0;			   /*                        */
+ 						   /*                        */
+  for (rec = DBnormal(db); rec != RecordNULL; rec = NextRecord(rec))/*       */
+  { n++; }					   /*                        */
+  for (srv_size = 64; srv_size < 2 * n; srv_size *= 2) { }/*                 */
+  if ((srv_tab = (Record*)calloc(srv_size, sizeof(Record))) == NULL)/*       */
+  { OUT_OF_MEMORY("server"); }			   /*                        */
+ 						   /*                        */
+  for (rec = DBnormal(db); rec != RecordNULL; rec = NextRecord(rec))/*       */
+  { if (RecordIsDELETED(rec) || *RecordHeap(rec) == NO_SYMBOL) continue;/*   */
+    for (h = SrvHash(*RecordHeap(rec)) & (srv_size - 1);/*                   */
+	 srv_tab[h] != RecordNULL &&		   /*                        */
+	 *RecordHeap(srv_tab[h]) != *RecordHeap(rec);/*                      */
+	 h = (h + 1) & (srv_size - 1)) { }	   /*                        */
+    if (srv_tab[h] == RecordNULL) srv_tab[h] = rec;/* keep the first one     */
+  }						   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	srv_find()
+** Type:	Record
+** Purpose:	Find a record by its key in the hash table of the
+**		server.
+** Arguments:
+**	key	the key
+** Returns:	the record or |RecordNULL|.
+**___________________________________________________			     */
+static Record srv_find(key)			   /*                        */
+  Symbol key;					   /*                        */
+{ unsigned long h;				   /*                        */
+ 						   /*                        */
+  if (key == NO_SYMBOL) return RecordNULL;	   /* not even a symbol      */
+  for (h = SrvHash(key) & (srv_size - 1);	   /*                        */
+       srv_tab[h] != RecordNULL;		   /*                        */
+       h = (h + 1) & (srv_size - 1))		   /*                        */
+  { if (*RecordHeap(srv_tab[h]) == key) return srv_tab[h]; }/*               */
+  return RecordNULL;				   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	srv_key()
+** Type:	void
+** Purpose:	Serve the request |key|. The records with the given
+**		keys are written. For an unknown key an error line is
+**		written instead.
+** Arguments:
+**	db	the database
+**	arg	the keys separated by spaces
+**	out	the output stream
+** Returns:	nothing
+**___________________________________________________			     */
+static void srv_key(db, arg, out)		   /*                        */
+  DB	 db;					   /*                        */
+  char	 *arg;					   /*                        */
+  FILE	 *out;					   /*                        */
+{ char	 *key;					   /*                        */
+  Record rec;					   /*                        */
+ 						   /*                        */
+  for (key = strtok(arg, " \t"); key != NULL; key = strtok(NULL, " \t"))/*   */
+  { if ((rec = srv_find(sym_lookup((String)key))) == RecordNULL)/*           */
+    { fprintf(out, "? %s not found\n", key); }	   /*                        */
+    else					   /*                        */
+    { fput_record(out, rec, db, (String)"@"); }	   /*                        */
+  }						   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	srv_select()
+** Type:	void
+** Purpose:	Serve the request |select|. The regular expression is
+**		used like the one of the command line option
+**		\opt{X}. All records matching it are written.
+** Arguments:
+**	db	the database
+**	arg	the regular expression
+**	out	the output stream
+** Returns:	nothing
+**___________________________________________________			     */
+static void srv_select(db, arg, out)		   /*                        */
+  DB	 db;					   /*                        */
+  char	 *arg;					   /*                        */
+  FILE	 *out;					   /*                        */
+{ Record rec;					   /*                        */
+ 						   /*                        */
+  if (*arg) { save_regex((String)arg); }	   /*                        */
+  if (!have_extract())				   /*                        */
+  { fputs("? invalid regular expression\n", out);  /*                        */
+    return;					   /*                        */
+  }						   /*                        */
+  for (rec = DBnormal(db); rec != RecordNULL; rec = NextRecord(rec))/*       */
+  { if (!RecordIsDELETED(rec) && is_selected(db, rec))/*                     */
+    { fput_record(out, rec, db, (String)"@"); }	   /*                        */
+  }						   /*                        */
+  clear_extract();				   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	srv_bibdata()
+** Type:	void
+** Purpose:	Ignore a \BibTeX{} file named in an aux file. The
+**		server uses the databases it has loaded.
+** Arguments:
+**	file	the file name
+** Returns:	nothing
+**___________________________________________________			     */
+static void srv_bibdata(file)			   /*                        */
+  Symbol file;					   /*                        */
+{ (void)file;					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	srv_aux()
+** Type:	void
+** Purpose:	Serve the request |aux|. The records cited in the aux
+**		file are written.
+** Arguments:
+**	db	the database
+**	arg	the name of the aux file
+**	out	the output stream
+** Returns:	nothing
+**___________________________________________________			     */
+static void srv_aux(db, arg, out)		   /*                        */
+  DB	 db;					   /*                        */
+  char	 *arg;					   /*                        */
+  FILE	 *out;					   /*                        */
+{ Record rec;					   /*                        */
+  bool	 del_q = rsc_del_q;			   /* |read_aux()| resets it */
+ 						   /*                        */
+  if (read_aux((String)arg, srv_bibdata, false))   /*                        */
+  { fprintf(out, "? aux file %s not found\n", arg); }/*                      */
+  else						   /*                        */
+  { for (rec = DBnormal(db); rec != RecordNULL; rec = NextRecord(rec))/*     */
+    { if (!RecordIsDELETED(rec) &&		   /*                        */
+	  *RecordHeap(rec) != NO_SYMBOL &&	   /*                        */
+	  aux_used(*RecordHeap(rec)))		   /*                        */
+      { fput_record(out, rec, db, (String)"@"); }  /*                        */
+    }						   /*                        */
+  }						   /*                        */
+  clear_aux();					   /*                        */
+  rsc_del_q  = del_q;				   /*                        */
+  rsc_select = false;				   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	srv_format()
+** Type:	void
+** Purpose:	Serve the request |format|. The entries submitted are
+**		read into a database of their own. The function given
+**		to |serve()| is applied to them, e.g.\ to rewrite them
+**		and to give them new keys as the loaded ones. Then the
+**		normal records are written. The loaded database is not
+**		modified.
+** Arguments:
+**	body	the submitted text
+**	len	its length
+**	out	the output stream
+** Returns:	nothing
+**___________________________________________________			     */
+static void srv_format(body, len, out)		   /*                        */
+  char	 *body;					   /*                        */
+  size_t len;					   /*                        */
+  FILE	 *out;					   /*                        */
+{ FILE	 *f;					   /*                        */
+  DB	 db;					   /*                        */
+  Record rec;					   /*                        */
+  String cache_dir = rsc_cache_dir;		   /*                        */
+ 						   /*                        */
+  if ((f = fopen(srv_tmp, "w")) == NULL ||	   /*                        */
+      fwrite(body, 1, len, f) != len ||		   /*                        */
+      fclose(f) != 0)				   /*                        */
+  { fputs("? the entries could not be stored\n", out);/*                     */
+    return;					   /*                        */
+  }						   /*                        */
+  db		= new_db();			   /*                        */
+  rsc_cache_dir = (String)"";			   /* Do not cache them.     */
+  (void)read_db(db, (String)srv_tmp, false);	   /*                        */
+  rsc_cache_dir = cache_dir;			   /*                        */
+ 						   /*                        */
+  if (rsc_make_key) { start_key_gen(); }	   /*                        */
+  db_forall(db, srv_fct);			   /*                        */
+  if (rsc_make_key) { end_key_gen(); }		   /*                        */
+ 						   /*                        */
+  db_rewind(db);				   /*                        */
+  for (rec = DBnormal(db); rec != RecordNULL; rec = NextRecord(rec))/*       */
+  { if (!RecordIsDELETED(rec))			   /*                        */
+    { fput_record(out, rec, db, (String)"@"); }	   /*                        */
+  }						   /*                        */
+  free_db(db);					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	srv_requests()
+** Type:	bool
+** Purpose:	Serve the complete requests collected for a client. A
+**		request is a line. The request |format| is followed by
+**		the entries and a line containing a single period. The
+**		response to each request is terminated by a line
+**		containing a single period as well. Error messages in
+**		the response start with a question mark.
+** Arguments:
+**	db	the database
+**	cl	the client
+**	eofp	indicator whether the input of the client has ended
+** Returns:	|false| iff the client has requested to quit.
+**___________________________________________________			     */
+static bool srv_requests(db, cl, eofp)		   /*                        */
+  DB	 db;					   /*                        */
+  Client cl;					   /*                        */
+  bool	 eofp;					   /*                        */
+{ char	 *line, *end, *arg, *body, *stop;	   /*                        */
+  size_t used;					   /*                        */
+  bool	 go_on = true;				   /*                        */
+ 						   /*                        */
+  while (go_on && cl->cl_len > 0)		   /*                        */
+  { line = cl->cl_buf;				   /*                        */
+    if ((end = strchr(line, '\n')) == NULL)	   /*                        */
+    { if (!eofp) break;				   /* wait for the rest      */
+      end = line + cl->cl_len;			   /*                        */
+    }						   /*                        */
+    body = (*end ? end + 1 : end);		   /*                        */
+    stop = body;				   /*                        */
+    used = body - line;				   /*                        */
+    if (strncmp(line, "format", 6) == 0 &&	   /*                        */
+	(line + 6 == end || line[6] == ' ' ||	   /*                        */
+	 line[6] == '\t' || line[6] == '\r'))	   /*                        */
+    { while (*stop && !(stop[0] == '.' &&	   /* find the line with .   */
+			(stop[1] == '\n' ||	   /*                        */
+			 (stop[1] == '\r' && stop[2] == '\n'))))/*           */
+      { stop = strchr(stop, '\n');		   /*                        */
+	stop = (stop ? stop + 1 : body + strlen(body));/*                    */
+      }						   /*                        */
+      if (*stop == '\0' && !eofp) break;	   /* wait for the rest      */
+      used = (*stop ? strchr(stop, '\n') + 1 : stop) - line;/*               */
+    }						   /*                        */
+ 						   /*                        */
+    *end = '\0';				   /*                        */
+    if (end > line && end[-1] == '\r') end[-1] = '\0';/*                     */
+    for (arg = line; *arg && *arg != ' ' && *arg != '\t'; arg++) { }/*       */
+    if (*arg) { *arg++ = '\0'; }		   /*                        */
+    while (*arg == ' ' || *arg == '\t') { arg++; } /*                        */
+ 						   /*                        */
+    if (*line == '\0') { }			   /* ignore empty lines     */
+    else if (strcmp(line, "quit") == 0) { go_on = false; }/*                 */
+    else					   /*                        */
+    { if (strcmp(line, "key") == 0)		   /*                        */
+      { srv_key(db, arg, cl->cl_out); }		   /*                        */
+      else if (strcmp(line, "select") == 0)	   /*                        */
+      { srv_select(db, arg, cl->cl_out); }	   /*                        */
+      else if (strcmp(line, "aux") == 0)	   /*                        */
+      { srv_aux(db, arg, cl->cl_out); }		   /*                        */
+      else if (strcmp(line, "format") == 0)	   /*                        */
+      { srv_format(body, (size_t)(stop - body), cl->cl_out); }/*             */
+      else					   /*                        */
+      { fprintf(cl->cl_out, "? unknown request %s\n", line); }/*             */
+      fputs(".\n", cl->cl_out);			   /*                        */
+      fflush(cl->cl_out);			   /*                        */
+    }						   /*                        */
+ 						   /*                        */
+    cl->cl_len -= used;				   /*                        */
+    memmove(cl->cl_buf, cl->cl_buf + used, cl->cl_len + 1);/*                */
+  }						   /*                        */
+  return go_on;					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	srv_read()
+** Type:	bool
+** Purpose:	Read the available input of a client and serve the
+**		complete requests.
+** Arguments:
+**	db	the database
+**	cl	the client
+** Returns:	|false| iff the client has finished.
+**___________________________________________________			     */
+static bool srv_read(db, cl)			   /*                        */
+  DB	  db;					   /*                        */
+  Client  cl;					   /*                        */
+{ ssize_t n;					   /*                        */
+ 						   /*                        */
+  if (cl->cl_len + SERVER_CHUNK + 1 > cl->cl_size) /*                        */
+  { cl->cl_size = cl->cl_len + SERVER_CHUNK + 1;   /*                        */
+    if ((cl->cl_buf = realloc(cl->cl_buf, cl->cl_size)) == NULL)/*           */
+    { OUT_OF_MEMORY("server"); }		   /*                        */
+  }						   /*                        */
+  n = read(cl->cl_fd, cl->cl_buf + cl->cl_len, SERVER_CHUNK);/*              */
+  if (n < 0 && errno == EINTR) return true;	   /*                        */
+  if (n > 0) cl->cl_len += n;			   /*                        */
+  cl->cl_buf[cl->cl_len] = '\0';		   /*                        */
+  return srv_requests(db, cl, n <= 0) && n > 0;	   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	srv_listen()
+** Type:	int
+** Purpose:	Create a socket in the file system and listen on it.
+**		A socket left behind by a previous server is removed.
+** Arguments:
+**	path	the name of the socket
+** Returns:	the descriptor of the socket or -1 in case of an error.
+**___________________________________________________			     */
+static int srv_listen(path)			   /*                        */
+  char		     *path;			   /*                        */
+{ struct sockaddr_un addr;			   /*                        */
+  struct stat	     st;			   /*                        */
+  int		     fd;			   /*                        */
+ 						   /*                        */
+  if (strlen(path) >= sizeof(addr.sun_path)) return -1;/*                    */
+  if (stat(path, &st) == 0 && S_ISSOCK(st.st_mode))/*                        */
+  { (void)unlink(path); }			   /*                        */
+ 						   /*                        */
+  memset(&addr, 0, sizeof(addr));		   /*                        */
+  addr.sun_family = AF_UNIX;			   /*                        */
+  strcpy(addr.sun_path, path);			   /*                        */
+  if ((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) return -1;/*               */
+  if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||/*               */
+      listen(fd, SOMAXCONN) < 0)		   /*                        */
+  { (void)close(fd);				   /*                        */
+    return -1;					   /*                        */
+  }						   /*                        */
+  return fd;					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	serve()
+** Type:	bool
+** Purpose:	Serve requests for the entries of a database which has
+**		been read and processed. The requests are read from
+**		the standard input if the resource |server| is |-|.
+**		Otherwise it names a socket in the file system. Then
+**		any number of clients can connect to it. Their
+**		requests are served in the order of their arrival. The
+**		database is not modified by the requests. Thus all
+**		clients see the same entries.
+** Arguments:
+**	db	the database
+**	fct	the function applied to the entries submitted with
+**		the request |format|
+** Returns:	|true| iff the socket could not be created.
+**___________________________________________________			     */
+bool serve(db, fct)				   /*                        */
+  DB		db;				   /*                        */
+  bool		(*fct)_ARG((DB, Record));	   /*                        */
+{ SClient	*cls  = NULL;			   /* the clients            */
+  struct pollfd *pfd  = NULL;			   /*                        */
+  int		n     = 0;			   /* the number of clients  */
+  int		size  = 0;			   /*                        */
+  int		lfd, fd, i, k;			   /*                        */
+  char		*dir;				   /*                        */
+ 						   /*                        */
+  srv_fct = fct;				   /*                        */
+  db_rewind(db);				   /*                        */
+  srv_index(db);				   /*                        */
+  clear_extract();				   /* The selection is done. */
+ 						   /*                        */
+  if ((dir = getenv("TMPDIR")) == NULL || *dir == '\0') dir = "/tmp";/*      */
+  if ((srv_tmp = malloc(strlen(dir) + 16)) == NULL)/*                        */
+  { OUT_OF_MEMORY("server"); }			   /*                        */
+  sprintf(srv_tmp, "%s/bibtoolXXXXXX", dir);	   /*                        */
+  if ((fd = mkstemp(srv_tmp)) >= 0) { (void)close(fd); }/*                   */
+  (void)signal(SIGPIPE, SIG_IGN);		   /* clients may go away    */
+ 						   /*                        */
+  if (strcmp((char*)rsc_server, "-") == 0)	   /*                        */
+  { SClient cl;					   /*                        */
+    cl.cl_fd   = fileno(stdin);			   /*                        */
+    cl.cl_out  = stdout;			   /*                        */
+    cl.cl_buf  = NULL;				   /*                        */
+    cl.cl_len  = 0;				   /*                        */
+    cl.cl_size = 0;				   /*                        */
+    if (rsc_verbose) { VerbosePrint1("Serving the standard input"); }/*      */
+    while (srv_read(db, &cl)) { }		   /*                        */
+    free(cl.cl_buf);				   /*                        */
+    lfd = 0;					   /*                        */
+  }						   /*                        */
+  else if ((lfd = srv_listen((char*)rsc_server)) < 0)/*                      */
+  { ERROR3("Socket ", rsc_server, " could not be created."); }/*             */
+  else						   /*                        */
+  { if (rsc_verbose) { VerbosePrint2("Serving on ", rsc_server); }/*         */
+    for (;;)					   /* until terminated       */
+    { if (n + 1 > size)				   /*                        */
+      { size = 2 * (n + 1);			   /*                        */
+	cls  = (SClient*)realloc(cls, size * sizeof(SClient));/*             */
+	pfd  = (struct pollfd*)realloc(pfd, size * sizeof(struct pollfd));/* */
+	if (cls == NULL || pfd == NULL) { OUT_OF_MEMORY("server"); }/*       */
+      }						   /*                        */
+      pfd[0].fd	    = lfd;			   /*                        */
+      pfd[0].events = POLLIN;			   /*                        */
+      for (i = 0; i < n; i++)			   /*                        */
+      { pfd[i + 1].fd	  = cls[i].cl_fd;	   /*                        */
+	pfd[i + 1].events = POLLIN;		   /*                        */
+      }						   /*                        */
+      if (poll(pfd, n + 1, -1) < 0)		   /*                        */
+      { if (errno == EINTR) continue;		   /*                        */
+	break;					   /*                        */
+      }						   /*                        */
+      for (i = n - 1; i >= 0; i--)		   /* Removing a client moves*/
+      { if (pfd[i + 1].revents == 0) continue;	   /* the last one.          */
+	if (!srv_read(db, &cls[i]))		   /*                        */
+	{ (void)fclose(cls[i].cl_out);		   /*                        */
+	  (void)close(cls[i].cl_fd);		   /*                        */
+	  free(cls[i].cl_buf);			   /*                        */
+	  cls[i] = cls[--n];			   /*                        */
+	}					   /*                        */
+      }						   /*                        */
+      if ((pfd[0].revents & POLLIN) &&		   /*                        */
+	  (fd = accept(lfd, NULL, NULL)) >= 0)	   /*                        */
+      { if ((k = dup(fd)) < 0 ||		   /*                        */
+	    (cls[n].cl_out = fdopen(k, "w")) == NULL)/*                      */
+	{ (void)close(fd);			   /*                        */
+	  continue;				   /*                        */
+	}					   /*                        */
+	cls[n].cl_fd   = fd;			   /*                        */
+	cls[n].cl_buf  = NULL;			   /*                        */
+	cls[n].cl_len  = 0;			   /*                        */
+	cls[n].cl_size = 0;			   /*                        */
+	n++;					   /*                        */
+      }						   /*                        */
+    }						   /*                        */
+    (void)close(lfd);				   /*                        */
+  }						   /*                        */
+ 						   /*                        */
+  (void)unlink(srv_tmp);			   /*                        */
+  free(srv_tmp);				   /*                        */
+  free(srv_tab);				   /*                        */
+  if (cls) free(cls);				   /*                        */
+  if (pfd) free(pfd);				   /*                        */
+  return lfd < 0;				   /*                        */
+}						   /*------------------------*/
+#else
+
+/*-----------------------------------------------------------------------------
+** Function:	serve()
+** Type:	bool
+** Purpose:	Dummy for systems without sockets. A warning is
+**		issued.
+** Arguments:
+**	db	the database
+**	fct	the function applied to the entries submitted
+** Returns:	|true|
+**___________________________________________________			     */
+bool serve(db, fct)				   /*                        */
+  DB		db;				   /*                        */
+  bool		(*fct)_ARG((DB, Record));	   /*                        */
+{ (void)db;					   /*                        */
+  (void)fct;					   /*                        */
+  WARNING("Serving disabled: sockets are not available.");/*                 */
+  return true;					   /*                        */
+}						   /*------------------------*/
+#endif
@@ -53,6 +53,7 @@
 #endif
  Symbol  pop_string _ARG((void));		   /* stack.c                */
  void push_string _ARG((Symbol  s));		   /* stack.c                */
+ static void stack_free _ARG((void *state));	   /* stack.c                */
 
 /*****************************************************************************/
 /* External Programs                                                         */
@@ -60,9 +61,47 @@
 
 /*---------------------------------------------------------------------------*/
 
- static Symbol *stack;
- static size_t stack_size = 0;
- static size_t stack_ptr  = 0;
+/*-----------------------------------------------------------------------------
+** Typedef*:	SStack
+** Purpose:	The state of the stack module in a context.
+**___________________________________________________			     */
+ typedef struct					   /*                        */
+ { Symbol *stack;				   /* the elements           */
+   size_t stack_size;				   /* the size of the array  */
+   size_t stack_ptr;				   /* the number of elements */
+ } SStack;					   /*                        */
+
+/*-----------------------------------------------------------------------------
+** Variable*:	stack_state0
+** Type:	SStack
+** Purpose:	The initial state of the stack module in a context. The
+**		stack is empty.
+**___________________________________________________			     */
+ static SStack stack_state0 = { (Symbol*)NULL, 0, 0 };/*                     */
+
+#define StackState ((SStack*)CtxGet(CTX_STACK,				\
+				    ctx_state(CTX_STACK,		\
+					      (void*)&stack_state0,	\
+					      sizeof(stack_state0),	\
+					      stack_free)))
+
+#define stack	   (StackState->stack)
+#define stack_size (StackState->stack_size)
+#define stack_ptr  (StackState->stack_ptr)
+
+/*-----------------------------------------------------------------------------
+** Function*:	stack_free()
+** Type:	void
+** Purpose:	Release the stack when a context is released.
+** Arguments:
+**	state	the state
+** Returns:	nothing
+**___________________________________________________			     */
+static void stack_free(state)			   /*                        */
+  void *state;					   /*                        */
+{ POSSIBLY_UNUSED(state);			   /*                        */
+  if (stack) free(stack);			   /*                        */
+}						   /*------------------------*/
 
 /*-----------------------------------------------------------------------------
 ** Function:	push_string()
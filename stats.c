@@ -0,0 +1,241 @@
+/*** stats.c ******************************************************************
+**
+** This file is part of BibTool.
+** It is distributed under the GNU General Public License.
+** See the file COPYING for details.
+**
+** (c) 2020 Gerd Neugebauer
+**
+** Net: gene@gerd-neugebauer.de
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+**-----------------------------------------------------------------------------
+** Description:
+**	This module contains functions to measure the time spent in
+**	the phases of a run and to report it together with the
+**	counters of the current context. The counters are
+**	incremented by the modules with the macro |StatCount()|.
+**	See |stats.h| for details.
+**
+******************************************************************************/
+
+#include <bibtool/general.h>
+#include <bibtool/stats.h>
+#ifdef HAVE_TIME_H
+#include <time.h>
+#endif
+
+/*****************************************************************************/
+/* Internal Programs							     */
+/*===========================================================================*/
+
+#ifdef __STDC__
+#define _ARG(A) A
+#else
+#define _ARG(A) ()
+#endif
+ static double cpu_clock _ARG((void));		   /* stats.c                */
+
+/*****************************************************************************/
+/* External Programs							     */
+/*===========================================================================*/
+
+/*---------------------------------------------------------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Variable*:	stat_state0
+** Type:	SStats
+** Purpose:	The template for the state of the statistics module.
+**		No phase is running initially.
+**___________________________________________________			     */
+ static SStats stat_state0 =			   /*                        */
+ { 0L, 0L, 0L, 0L, 0L, 0L, 0L, 0L,		   /* st_records...st_bytes  */
+   0,						   /* st_phases              */
+   -1,						   /* st_current             */
+   { NULL },					   /* st_name                */
+   { 0.0 },					   /* st_wall                */
+   { 0.0 },					   /* st_cpu                 */
+   0.0,						   /* st_wall0               */
+   0.0						   /* st_cpu0                */
+ };						   /*                        */
+
+/*-----------------------------------------------------------------------------
+** Function:	stat_state()
+** Type:	SStats*
+** Purpose:	Create the state of the statistics module in the
+**		current context. This function is used by the macro
+**		|Stats| when the state does not exist yet.
+** Arguments:	none
+** Returns:	the state
+**___________________________________________________			     */
+SStats * stat_state()				   /*                        */
+{ return (SStats*)ctx_state(CTX_STATS,		   /*                        */
+			    (void*)&stat_state0,   /*                        */
+			    sizeof(stat_state0),   /*                        */
+			    NULL);		   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	stat_clock()
+** Type:	double
+** Purpose:	Read a monotonic clock. Only differences of the values
+**		are meaningful. If the system does not provide a
+**		monotonic clock then the calendar time is used.
+** Arguments:	none
+** Returns:	the time in seconds
+**___________________________________________________			     */
+double stat_clock()				   /*                        */
+{						   /*                        */
+#ifdef CLOCK_MONOTONIC
+  struct timespec ts;				   /*                        */
+ 						   /*                        */
+  if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0)	   /*                        */
+  { return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9; }/*                 */
+#endif
+#ifdef HAVE_TIME_H
+  return (double)time(NULL);			   /*                        */
+#else
+  return 0.0;					   /*                        */
+#endif
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	cpu_clock()
+** Type:	double
+** Purpose:	Read the processor time used by the program so far.
+** Arguments:	none
+** Returns:	the time in seconds
+**___________________________________________________			     */
+static double cpu_clock()			   /*                        */
+{						   /*                        */
+#ifdef HAVE_TIME_H
+  return (double)clock() / CLOCKS_PER_SEC;	   /*                        */
+#else
+  return 0.0;					   /*                        */
+#endif
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	stat_phase()
+** Type:	void
+** Purpose:	End the running phase and start a new one. The time
+**		since the start of the running phase is added to it.
+**		A phase may be entered several times. Its times are
+**		accumulated. The name is not copied. Thus it should be
+**		a constant string.
+** Arguments:
+**	name	the name of the new phase or |NULL| to end the running
+**		phase only
+** Returns:	nothing
+**___________________________________________________			     */
+void stat_phase(name)				   /*                        */
+  char	 *name;					   /*                        */
+{ SStats *st   = Stats;				   /*                        */
+  double wall  = stat_clock();			   /*                        */
+  double cpu   = cpu_clock();			   /*                        */
+  int	 i;					   /*                        */
+ 						   /*                        */
+  if (st->st_current >= 0)			   /*                        */
+  { st->st_wall[st->st_current] += wall - st->st_wall0;/*                    */
+    st->st_cpu[st->st_current]	+= cpu - st->st_cpu0;/*                      */
+    st->st_current = -1;			   /*                        */
+  }						   /*                        */
+  if (name == NULL) return;			   /*                        */
+ 						   /*                        */
+  for (i = 0; i < st->st_phases; i++)		   /*                        */
+  { if (strcmp(st->st_name[i], name) == 0) break; }/*                        */
+  if (i >= st->st_phases)			   /*                        */
+  { if (st->st_phases < STAT_PHASES)		   /*                        */
+    { i		     = st->st_phases++;		   /*                        */
+      st->st_name[i] = name;			   /*                        */
+      st->st_wall[i] = 0.0;			   /*                        */
+      st->st_cpu[i]  = 0.0;			   /*                        */
+    }						   /*                        */
+    else i = STAT_PHASES - 1;			   /*                        */
+  }						   /*                        */
+  st->st_current = i;				   /*                        */
+  st->st_wall0	 = wall;			   /*                        */
+  st->st_cpu0	 = cpu;				   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	stat_print()
+** Type:	void
+** Purpose:	Print the times of the phases and the counters of the
+**		current context. The running phase is ended before.
+**		The report is either a table for humans or a single
+**		line containing a JSON object for other programs.
+** Arguments:
+**	file	the output stream
+**	json	indicator whether JSON should be written
+** Returns:	nothing
+**___________________________________________________			     */
+void stat_print(file, json)			   /*                        */
+  FILE	 *file;					   /*                        */
+  bool	 json;					   /*                        */
+{ SStats *st;					   /*                        */
+  double wall = 0.0;				   /*                        */
+  double cpu  = 0.0;				   /*                        */
+  int	 i;					   /*                        */
+  static char *names[] =			   /*                        */
+  { "records", "fields", "symbols", "probes",	   /*                        */
+    "regex.searches", "rule.hits", "db.finds", "bytes.written" };/*          */
+  long	 cnt[8];				   /*                        */
+ 						   /*                        */
+  stat_phase(NULL);				   /*                        */
+  st	 = Stats;				   /*                        */
+  cnt[0] = st->st_records;			   /*                        */
+  cnt[1] = st->st_fields;			   /*                        */
+  cnt[2] = st->st_symbols;			   /*                        */
+  cnt[3] = st->st_probes;			   /*                        */
+  cnt[4] = st->st_regex;			   /*                        */
+  cnt[5] = st->st_hits;				   /*                        */
+  cnt[6] = st->st_finds;			   /*                        */
+  cnt[7] = st->st_bytes;			   /*                        */
+  for (i = 0; i < st->st_phases; i++)		   /*                        */
+  { wall += st->st_wall[i];			   /*                        */
+    cpu	 += st->st_cpu[i];			   /*                        */
+  }						   /*                        */
+ 						   /*                        */
+  if (json)					   /*                        */
+  { fputs("{\"phases\":[", file);		   /*                        */
+    for (i = 0; i < st->st_phases; i++)		   /*                        */
+    { fprintf(file,				   /*                        */
+	      "%s{\"name\":\"%s\",\"wall\":%.6f,\"cpu\":%.6f}",/*            */
+	      i ? "," : "",			   /*                        */
+	      st->st_name[i],			   /*                        */
+	      st->st_wall[i],			   /*                        */
+	      st->st_cpu[i]);			   /*                        */
+    }						   /*                        */
+    fprintf(file, "],\"wall\":%.6f,\"cpu\":%.6f,\"counters\":{", wall, cpu);/**/
+    for (i = 0; i < 8; i++)			   /*                        */
+    { fprintf(file, "%s\"%s\":%ld", i ? "," : "", names[i], cnt[i]); }/*     */
+    fputs("}}\n", file);			   /*                        */
+    return;					   /*                        */
+  }						   /*                        */
+ 						   /*                        */
+  fprintf(file, "\n---  %-15s %10s %10s\n", "phase", "wall [s]", "cpu [s]");/**/
+  for (i = 0; i < st->st_phases; i++)		   /*                        */
+  { fprintf(file, "---  %-15s %10.4f %10.4f\n",	   /*                        */
+	    st->st_name[i],			   /*                        */
+	    st->st_wall[i],			   /*                        */
+	    st->st_cpu[i]);			   /*                        */
+  }						   /*                        */
+  fprintf(file, "---  %-15s %10.4f %10.4f\n", "total", wall, cpu);/*         */
+  fputc('\n', file);				   /*                        */
+  for (i = 0; i < 8; i++)			   /*                        */
+  { fprintf(file, "---  %-15s %10ld\n", names[i], cnt[i]); }/*               */
+}						   /*------------------------*/
@@ -37,6 +37,7 @@
 #include <bibtool/general.h>
 #include <bibtool/symbols.h>
 #include <bibtool/error.h>
+#include <bibtool/stats.h>
 #include "config.h"
 
 /*-----------------------------------------------------------------------------
@@ -104,8 +105,14 @@
  Symbol  symbol _ARG((String s));	   	   /* symbols.c              */
  Symbol  sym_extract _ARG((String *sp, bool lowercase));/* symbols.c         */
  char * new_string _ARG((char * s));		   /* symbols.c              */
- static SymTab new_sym_tab _ARG((String value));   /* symbols.c              */
+ static SymTab new_sym_tab _ARG((String value, bool copy));/*                */
+ static Symbol sym_intern _ARG((String s, bool copy));/*                     */
+ Symbol sym_adopt _ARG((String s));		   /* symbols.c              */
  static int hashindex _ARG((String s));		   /* symbols.c              */
+ static void sym_tab_resize _ARG((int size));	   /* symbols.c              */
+ static void sym_free _ARG((void *state));	   /* symbols.c              */
+ SSymbols * sym_state _ARG((void));		   /* symbols.c              */
+ void sym_reserve _ARG((int n));		   /* symbols.c              */
  void init_symbols _ARG((void));		   /* symbols.c              */
  void sym_del _ARG((Symbol sym));		   /* symbols.c              */
 #ifdef SYMBOL_DUMP
@@ -128,20 +135,13 @@
 
  String s_empty		  = (String)"";
 
- Symbol sym_empty	  = NO_SYMBOL;		   /*			     */
- Symbol sym_space	  = NO_SYMBOL;		   /*			     */
- Symbol sym_star	  = NO_SYMBOL;		   /*			     */
- Symbol sym_crossref	  = NO_SYMBOL;		   /*			     */
- Symbol sym_xdata	  = NO_SYMBOL;		   /*			     */
- Symbol sym_xref	  = NO_SYMBOL;		   /*			     */
- Symbol sym_qqq		  = NO_SYMBOL;		   /*			     */
- Symbol sym_comma	  = NO_SYMBOL;		   /*			     */
- Symbol sym_double_quote  = NO_SYMBOL;		   /*			     */
- Symbol sym_open_brace	  = NO_SYMBOL;		   /*			     */
- Symbol sym_close_brace	  = NO_SYMBOL;		   /*			     */
- Symbol sym_et		  = NO_SYMBOL;		   /*			     */
- Symbol sym_key		  = NO_SYMBOL;		   /*			     */
- Symbol sym_sortkey	  = NO_SYMBOL;		   /*			     */
+/*-----------------------------------------------------------------------------
+** Variable*:	sym_state0
+** Type:	SSymbols
+** Purpose:	The initial state of the symbols module in a context.
+**		The symbol table is empty.
+**___________________________________________________			     */
+ static SSymbols sym_state0;			   /*                        */
 
 /*****************************************************************************/
 /***			Misc string allocation routine			   ***/
@@ -174,6 +174,15 @@ char * new_string(s)				   /*			     */
 /***			     Symbol Table Section			   ***/
 /*****************************************************************************/
 
+/*-----------------------------------------------------------------------------
+** Constant*:	SYM_PINNED
+** Type:	int
+** Purpose:	The initial use count of a symbol whose string is not
+**		owned by the symbol table. It is large enough that
+**		the garbage collector never releases such a symbol.
+**___________________________________________________			     */
+#define SYM_PINNED 0x3fffffff
+
 /*-----------------------------------------------------------------------------
 ** Function*:	new_sym_tab()
 ** Purpose:	Allocate a new |SymTab| structure and fill it with initial
@@ -183,10 +192,13 @@ char * new_string(s)				   /*			     */
 **		and the program is terminated.
 ** Arguments:
 **	value	String value of the |SymTab| node.
+**	copy	Indicator whether the string should be copied. If
+**		not then the symbol is pinned with |SYM_PINNED|.
 ** Returns:	Pointer to a new instance of a |SymTab|.
 **___________________________________________________			     */
-static SymTab new_sym_tab(value)		   /*			     */
+static SymTab new_sym_tab(value, copy)		   /*                        */
   String value;			   	   	   /*			     */
+  bool	 copy;					   /*                        */
 { register SymTab new_symtab;		   	   /*			     */
   Symbol sym;					   /*                        */
  						   /*			     */
@@ -197,37 +209,136 @@ static SymTab new_sym_tab(value)		   /*			     */
   if ((sym=(Symbol)malloc(sizeof(sSymbol)))	   /*                        */
       == NO_SYMBOL)				   /*                        */
   { OUT_OF_MEMORY("Symbol"); }   		   /*			     */
-  SymbolValue(sym) = newString(value);		   /*                        */
+  SymbolValue(sym) = (copy ? newString(value) : value);/*                    */
 #else
-  sym = newString(value);			   /*                        */
+  sym = (copy ? newString(value) : value);	   /*                        */
 #endif
   SymTabSymbol(new_symtab)  = sym;		   /*			     */
-  SymCount(sym, new_symtab) = 1;		   /*			     */
+  SymCount(sym, new_symtab) = (copy ? 1 : SYM_PINNED);/*                     */
   NextSymTab(new_symtab)    = (SymTab)NULL;	   /*			     */
   return new_symtab;			   	   /*			     */
 }						   /*------------------------*/
 
+/*-----------------------------------------------------------------------------
+** Variable*:	sym_tab
+** Purpose:	The buckets of the symbol table. The table starts
+**		with |HASHMAX| buckets and grows when it holds more
+**		than two symbols per bucket on average.
+**___________________________________________________			     */
+#define sym_tab	      (SymState->sym_tab)
+#define sym_tab_size  (SymState->sym_tab_size)
+#define sym_tab_count (SymState->sym_tab_count)
+
+/*-----------------------------------------------------------------------------
+** Function*:	sym_free()
+** Type:	void
+** Purpose:	Release the symbol table of a context. The strings of
+**		pinned symbols are not owned by the symbol table. Thus
+**		they are not released. This function is called when
+**		the context is released. It is the current context
+**		then.
+** Arguments:
+**	state	the state of the symbols module
+** Returns:	nothing
+**___________________________________________________			     */
+static void sym_free(state)			   /*                        */
+  void *state;					   /*                        */
+{ SymTab st, next;				   /*                        */
+  int	 i;					   /*                        */
+ 						   /*                        */
+  POSSIBLY_UNUSED(state);			   /*                        */
+  for (i = 0; i < sym_tab_size; i++)		   /*                        */
+  { for (st = sym_tab[i]; st != NULL; st = next)   /*                        */
+    { next = NextSymTab(st);			   /*                        */
+      if (SymTabCount(st) < SYM_PINNED / 2)	   /*                        */
+      { free(SymbolValue(SymTabSymbol(st))); }	   /*                        */
+      free(st);					   /*                        */
+    }						   /*                        */
+  }						   /*                        */
+  if (sym_tab) free(sym_tab);			   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	sym_state()
+** Type:	SSymbols*
+** Purpose:	Create the state of the symbols module in the current
+**		context. This function is used by the macro |SymState|
+**		when the state does not exist yet.
+** Arguments:	none
+** Returns:	the state
+**___________________________________________________			     */
+SSymbols * sym_state()				   /*                        */
+{ return (SSymbols*)ctx_state(CTX_SYMBOLS,	   /*                        */
+			      (void*)&sym_state0,  /*                        */
+			      sizeof(sym_state0),  /*                        */
+			      sym_free);	   /*                        */
+}						   /*------------------------*/
+
 /*-----------------------------------------------------------------------------
 ** Function*:	hashindex()
-** Purpose:	Compute the sum of ASCII values modulo |HASHMAX|
-**		to be used as an hash index.
+** Purpose:	Compute the FNV-1a hash of a string modulo the size
+**		of the symbol table to be used as an hash index.
 ** Arguments:
 **	s	string to be analyzed.
 ** Returns:	hash index
 **___________________________________________________			     */
 static int hashindex(s)				   /*                        */
   String s;					   /*                        */
-{ int	index = 0;				   /*                        */
-  while (*s) index = (index + *(s++)) % HASHMAX;   /*                        */
-  return ( index < 0 ? -index : index );	   /*                        */
+{ unsigned long h = 2166136261UL;		   /*                        */
+  while (*s) h = ((h ^ *(s++)) * 16777619UL) & 0xffffffffUL;/*               */
+  return (int)(h % (unsigned long)sym_tab_size);   /*                        */
 }						   /*------------------------*/
 
 /*-----------------------------------------------------------------------------
-** Variable*:	sym_tab
-** Purpose:	
-**		
+** Function*:	sym_tab_resize()
+** Purpose:	Allocate a new array of buckets for the symbol table
+**		and move all symbols there.
+**
+**		If no more memory is available then an error is raised
+**		and the program is terminated.
+** Arguments:
+**	size	the new number of buckets
+** Returns:	nothing
 **___________________________________________________			     */
- static SymTab sym_tab[HASHMAX];		   /*                        */
+static void sym_tab_resize(size)		   /*                        */
+  int	 size;					   /*                        */
+{ SymTab *old	   = sym_tab;			   /*                        */
+  int	 old_size  = sym_tab_size;		   /*                        */
+  SymTab st, next;				   /*                        */
+  int	 i, h;					   /*                        */
+ 						   /*                        */
+  if ((sym_tab = (SymTab*)malloc(size * sizeof(SymTab))) == NULL)/*          */
+  { OUT_OF_MEMORY("SymTab"); }			   /*                        */
+  sym_tab_size = size;				   /*                        */
+  for (i = 0; i < size; i++) sym_tab[i] = NULL;	   /*                        */
+ 						   /*                        */
+  for (i = 0; i < old_size; i++)		   /*                        */
+  { for (st = old[i]; st != NULL; st = next)	   /*                        */
+    { next	     = NextSymTab(st);		   /*                        */
+      h		     = hashindex(SymbolValue(SymTabSymbol(st)));/*           */
+      NextSymTab(st) = sym_tab[h];		   /*                        */
+      sym_tab[h]     = st;			   /*                        */
+    }						   /*                        */
+  }						   /*                        */
+  if (old) free(old);				   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	sym_reserve()
+** Purpose:	Prepare the symbol table for |n| more symbols. This
+**		avoids repeated growing when many symbols are
+**		interned in one go, e.g.\ when a database is loaded
+**		from a cache.
+** Arguments:
+**	n	the number of symbols expected
+** Returns:	nothing
+**___________________________________________________			     */
+void sym_reserve(n)				   /*                        */
+  int n;					   /*                        */
+{						   /*                        */
+  if (sym_tab_count + n > 2 * sym_tab_size)	   /*                        */
+  { sym_tab_resize(sym_tab_count + n); }	   /*                        */
+}						   /*------------------------*/
 
 /*-----------------------------------------------------------------------------
 ** Function:	init_symbols()
@@ -249,11 +360,9 @@ static int hashindex(s)				   /*                        */
 ** Returns:	nothing
 **___________________________________________________			     */
 void init_symbols()				   /*			     */
-{ register int i;				   /*			     */
-						   /*			     */
-  if (sym_empty) return;		   	   /*                        */
+{ if (sym_empty) return;		   	   /*                        */
  						   /*                        */
-  for (i = 0; i < HASHMAX; i++) sym_tab[i] = NULL; /*			     */
+  sym_tab_resize(HASHMAX);			   /*                        */
  						   /*                        */
   sym_empty        = symbol((String)s_empty);	   /*                        */
   sym_space        = symbol((String)" ");	   /*                        */
@@ -329,8 +438,66 @@ static SymTab* get_sym_tab(sym)			   /*			     */
 **___________________________________________________			     */
 Symbol symbol(s)			   	   /*			     */
   String  s;				   	   /*			     */
+{ return sym_intern(s, true);			   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	sym_adopt()
+** Purpose:	Add a symbol to the global symbol table without
+**		copying the string. If the string already has a
+**		symbol assigned to it then this symbol is returned.
+**		Otherwise the string itself becomes the symbol. Thus
+**		it has to stay unchanged as long as the symbol table
+**		exists. This is meant for strings in a read-only
+**		memory mapping.
+** Arguments:
+**	s	String which should be translated into a symbol.
+** Returns:	The symbol.
+**___________________________________________________			     */
+Symbol sym_adopt(s)				   /*                        */
+  String s;					   /*                        */
+{ return sym_intern(s, false);			   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	sym_lookup()
+** Purpose:	Look up a string in the symbol table without adding
+**		it. Thus strings from untrusted sources can be looked
+**		up without filling the symbol table. The use count is
+**		not changed.
+** Arguments:
+**	s	String which should be translated into a symbol.
+** Returns:	The symbol or |NO_SYMBOL| if it does not exist.
+**___________________________________________________			     */
+Symbol sym_lookup(s)				   /*                        */
+  String s;					   /*                        */
+{ register SymTab st;			   	   /*			     */
+ 						   /*                        */
+  if (s == StringNULL) return NO_SYMBOL;	   /* ignore dummies.	     */
+ 						   /*                        */
+  for (st = sym_tab[hashindex(s)]; st != NULL; st = NextSymTab(st))/*        */
+  { if (strcmp((char*)s,			   /*                        */
+	       (char*)SymbolValue(SymTabSymbol(st))) == 0)/*                 */
+    { return SymTabSymbol(st); }		   /*                        */
+  }						   /*			     */
+  return NO_SYMBOL;				   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	sym_intern()
+** Purpose:	Look up a string in the symbol table and add it if it
+**		is not found.
+** Arguments:
+**	s	String which should be translated into a symbol.
+**	copy	Indicator whether a new symbol gets a copy of |s|.
+** Returns:	The symbol.
+**___________________________________________________			     */
+static Symbol sym_intern(s, copy)		   /*                        */
+  String s;					   /*                        */
+  bool	 copy;					   /*                        */
 { register SymTab *stp;			   	   /*			     */
   Symbol sym;				   	   /*                        */
+  long	 probes = 0L;				   /*                        */
 						   /*			     */
   if (s == StringNULL) return NO_SYMBOL;	   /* ignore dummies.	     */
  						   /*                        */
@@ -340,6 +507,7 @@ Symbol symbol(s)			   	   /*			     */
        *stp != NULL;		   		   /*			     */
         stp = &NextSymTab(*stp) )		   /*			     */
   { sym	= SymTabSymbol(*stp);			   /*                        */
+    probes++;					   /*                        */
     DebugPrintF3("\tlooking at '%s' == '%s'\n",	   /*                        */
 	      (char*)s, (char*)SymbolValue(sym));  /*                        */
     if (strcmp((char*)s,			   /*                        */
@@ -347,14 +515,20 @@ Symbol symbol(s)			   	   /*			     */
     { DebugPrint2("Symbol found ",		   /*                        */
 		  SymbolValue(sym));  		   /*                        */
       SymCount(sym,*stp)++; 		   	   /*			     */
+      StatCount(st_probes, probes);		   /*                        */
       return sym;				   /*			     */
     }						   /*                        */
   }						   /*			     */
  						   /*                        */
-  *stp = new_sym_tab(s);  		   	   /*			     */
+  StatCount(st_probes, probes);			   /*                        */
+  StatCount(st_symbols, 1);			   /*                        */
+  *stp = new_sym_tab(s, copy);			   /*                        */
+  sym  = SymTabSymbol(*stp);			   /*                        */
   DebugPrint2("Symbol created ",		   /*                        */
-	      SymbolValue(SymTabSymbol(*stp)));	   /*                        */
-  return SymTabSymbol(*stp);			   /*			     */
+	      SymbolValue(sym));		   /*                        */
+  if (++sym_tab_count > 2 * sym_tab_size)	   /*                        */
+  { sym_tab_resize(2 * sym_tab_size + 1); }	   /*                        */
+  return sym;					   /*                        */
 }						   /*------------------------*/
 
 /*-----------------------------------------------------------------------------
@@ -432,6 +606,7 @@ void sym_del(sym)				   /*                        */
     st	 = *stp;				   /*                        */
     *stp = NextSymTab(st);			   /*                        */
     free(st);					   /*                        */
+    --sym_tab_count;				   /*                        */
     free(SymbolValue(sym));			   /*                        */
     free(sym);					   /*                        */
   }						   /*                        */
@@ -457,7 +632,7 @@ void sym_gc()					   /*                        */
   register SymTab st, st2;			   /*			     */
   register int i;				   /*                        */
   						   /*                        */
-  for ( i = 0; i < HASHMAX; i++ )		   /*			     */
+  for ( i = 0; i < sym_tab_size; i++ )		   /*			     */
   {						   /*                        */
     while (sym_tab[i] &&			   /*                        */
 	   SymTabCount(sym_tab[i]) <= 0)	   /*                        */
@@ -465,6 +640,7 @@ void sym_gc()					   /*                        */
       sym_tab[i] = NextSymTab(st);		   /*                        */
       free(SymTabSymbol(st));			   /*                        */
       free(st);					   /*                        */
+      --sym_tab_count;				   /*                        */
     }						   /*                        */
     st = sym_tab[i];				   /*                        */
     if ( st )					   /*                        */
@@ -474,6 +650,7 @@ void sym_gc()					   /*                        */
       { NextSymTab(st) = NextSymTab(st2);	   /*                        */
         free(SymTabSymbol(st2));		   /*                        */
 	free(st2);				   /*                        */
+	--sym_tab_count;			   /*                        */
       }						   /*                        */
     }						   /*                        */
   }						   /*			     */
@@ -544,7 +721,7 @@ void sym_dump()					   /*			     */
   register long	  cnt  = 0l;			   /*			     */
   register long	  used = 0l;			   /*			     */
 						   /*			     */
-  for ( i = 0; i < HASHMAX; i++ )		   /*			     */
+  for ( i = 0; i < sym_tab_size; i++ )		   /*			     */
   { for ( st = sym_tab[i]; st; st=NextSymTab(st) ) /*			     */
     { ErrPrintF2("--- BibTool symbol %4d %s\n",	   /*			     */
 		 SymTabCount(st),		   /*			     */
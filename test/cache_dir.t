@@ -0,0 +1,187 @@
+#!/usr/bin/env perl
+# =============================================================================
+#  
+#  This file is part of BibTool.
+#  It is distributed under the GNU General Public License.
+#  See the file COPYING for details.
+#  
+#  (c) 2020 Gerd Neugebauer
+#  
+#  Net: gene@gerd-neugebauer.de
+#  
+#  This program is free software; you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation; either version 2, or (at your option)
+#  any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software
+#  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+#
+#*=============================================================================
+
+=head1 NAME
+
+cache_dir.t - Test suite for BibTool cache.dir.
+
+=head1 SYNOPSIS
+
+cache_dir.t 
+
+=head1 DESCRIPTION
+
+This module contains some test cases. Running this module as program
+will run all test cases and print a summary for each. Optionally files
+*.out and *.err are left if the expected result does not match the
+actual result.
+
+=head1 OPTIONS
+
+none
+
+=head1 AUTHOR
+
+Gerd Neugebauer
+
+=cut
+
+use strict;
+use BUnit;use warnings;
+
+
+my $bib = <<__EOF__;
+stray text
+\@string{ acm = "ACM" }
+\@article{ b,
+  author  = "bb",
+  title	  = "the title",
+  crossref = "a"
+}
+
+\@book{ a,
+  title	  = "the title",
+  publisher = acm
+}
+__EOF__
+
+my $out = <<__EOF__;
+\@STRING{acm     = "ACM" }
+
+\@Article{	  b,
+  author        = "bb",
+  title	        = "the title",
+  crossref      = "a"
+}
+
+\@Book{		  a,
+  title	        = "the title",
+  publisher     = acm
+}
+__EOF__
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'cache_dir_1',
+    args         => "-- cache.dir=_cache",
+    prepare      => sub { mkdir('_cache'); },
+    bib	         => $bib,
+    expected_err => <<__EOF__,
+
+*** BibTool WARNING (line 2 in ./_test.bib): 9 non-space characters ignored.
+__EOF__
+    expected_out => $out);
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'cache_dir_2',
+    args         => "-- cache.dir=_cache",
+    bib	         => $bib,
+    expected_err => '',
+    expected_out => $out);
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'cache_dir_3',
+    args         => "-- cache.dir=_cache -- pass.comments=on",
+    bib	         => $bib,
+    expected_err => '',
+    expected_out => "stray text\n" . $out);
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'cache_dir_4',
+    args         => "-- cache.dir=_cache -x _xyzzy.aux",
+    prepare      => sub {
+      my $fd = new FileHandle("_xyzzy.aux",'w') || die "_xyzzy.aux: $!\n";
+      print $fd <<__EOF__;
+\\citation{b}
+\\bibdata{_xyzzy}
+__EOF__
+      $fd->close();
+      $fd = new FileHandle("_xyzzy.bib",'w') || die "_xyzzy.bib: $!\n";
+      print $fd $bib;
+      $fd->close();
+      `$BUnit::BIBTOOL -- cache.dir=_cache -o '' _xyzzy.bib 2>/dev/null`;
+	   },
+    post         => sub {
+      unlink('_xyzzy.aux');
+      unlink('_xyzzy.bib');
+      unlink(glob('_cache/*'));
+      rmdir('_cache');
+	   },
+    expected_err => '',
+    expected_out => <<__EOF__);
+\@STRING{acm     = "ACM" }
+
+\@Article{	  b,
+  author        = "bb",
+  title	        = "the title",
+  crossref      = "a"
+}
+
+\@Book{		  a,
+  title	        = "the title",
+  publisher     = acm
+}
+__EOF__
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'cache_dir_5',
+    args         => "-- cache.dir=_cache -- print.verbatim=on _xyzzy.bib",
+    prepare      => sub {
+      mkdir('_cache');
+      my $fd = new FileHandle("_xyzzy.bib",'w') || die "_xyzzy.bib: $!\n";
+      print $fd $bib;
+      $fd->close();
+      `$BUnit::BIBTOOL -- cache.dir=_cache -o '' _xyzzy.bib 2>/dev/null`;
+	   },
+    post         => sub {
+      unlink('_xyzzy.bib');
+      unlink(glob('_cache/*'));
+      rmdir('_cache');
+	   },
+    expected_err => <<__EOF__,
+
+*** BibTool WARNING (line 2 in ./_xyzzy.bib): 9 non-space characters ignored.
+__EOF__
+    expected_out => <<__EOF__);
+\@STRING{acm     = "ACM" }
+
+\@article{ b,
+  author  = "bb",
+  title	  = "the title",
+  crossref = "a"
+}
+
+\@book{ a,
+  title	  = "the title",
+  publisher = acm
+}
+__EOF__
+
+1;
+#------------------------------------------------------------------------------
+# Local Variables: 
+# mode: perl
+# End: 
@@ -0,0 +1,265 @@
+/*** context.c ****************************************************************
+**
+** This file is part of BibTool.
+** It is distributed under the GNU General Public License.
+** See the file COPYING for details.
+**
+** (c) 2020 Gerd Neugebauer
+**
+** Net: gene@gerd-neugebauer.de
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+**-----------------------------------------------------------------------------
+** Description:
+**	This program tests the contexts of the BibTool C library. It
+**	is used by the test suite |context.t|.
+**
+**	Usage: |context| \textit{resource}\dots{} \textit{file}
+**
+**	Each resource instruction defines a conversion of the \BibTeX{}
+**	file. Several instructions for one conversion are separated by
+**	newlines. At first the conversions are performed one after the
+**	other in a context of their own and the results are
+**	printed. Afterwards all conversions are repeated by several
+**	threads at the same time. Each thread uses its own context.
+**	The results have to be the same as before.
+**
+******************************************************************************/
+
+#include <bibtool/bibtool.h>
+#include <bibtool/database.h>
+#include <bibtool/context.h>
+#include <pthread.h>
+
+/*****************************************************************************/
+/* Internal Programs							     */
+/*===========================================================================*/
+
+#ifdef __STDC__
+#define _ARG(A) A
+#else
+#define _ARG(A) ()
+#endif
+ int main _ARG((int argc,char *argv[]));	   /* context.c              */
+ static bool do_keys _ARG((DB db,Record rec));	   /* context.c              */
+ static bool do_no_keys _ARG((DB db,Record rec));  /* context.c              */
+ static bool keep_selected _ARG((DB db,Record rec));/* context.c             */
+ static char * convert _ARG((char *rsc,char *file));/* context.c             */
+ static int rec_gt _ARG((Record r1,Record r2));	   /* context.c              */
+ static void * worker _ARG((void *arg));	   /* context.c              */
+
+/*****************************************************************************/
+/* External Programs							     */
+/*===========================================================================*/
+
+/*---------------------------------------------------------------------------*/
+
+#define THREADS 8
+#define ROUNDS	4
+
+ typedef struct jOB				   /*                        */
+ { char *jb_rsc;				   /* the resources          */
+   char *jb_file;				   /* the input file         */
+   char *jb_expected;				   /* the sequential result  */
+   int	jb_failures;				   /* the differing results  */
+ } SJob, *Job;					   /*                        */
+
+/*-----------------------------------------------------------------------------
+** Function*:	keep_selected()
+** Purpose:	Mark the records which are not selected as deleted.
+** Arguments:
+**	db	the database
+**	rec	the record
+** Returns:	|false|
+**___________________________________________________			     */
+static bool keep_selected(db, rec)		   /*                        */
+  DB	 db;					   /*                        */
+  Record rec;					   /*                        */
+{ if (!is_selected(db, rec)) { SetRecordDELETED(rec); }/*                    */
+  return false;					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	do_keys()
+** Purpose:	Rewrite a record and generate its key.
+** Arguments:
+**	db	the database
+**	rec	the record
+** Returns:	|false|
+**___________________________________________________			     */
+static bool do_keys(db, rec)			   /*                        */
+  DB	 db;					   /*                        */
+  Record rec;					   /*                        */
+{ rewrite_record(db, rec);			   /*                        */
+  sort_record(rec);				   /*                        */
+  make_key(db, rec);				   /*                        */
+  make_sort_key(db, rec);			   /*                        */
+  return false;					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	do_no_keys()
+** Purpose:	Rewrite a record and keep its key.
+** Arguments:
+**	db	the database
+**	rec	the record
+** Returns:	|false|
+**___________________________________________________			     */
+static bool do_no_keys(db, rec)			   /*                        */
+  DB	 db;					   /*                        */
+  Record rec;					   /*                        */
+{ rewrite_record(db, rec);			   /*                        */
+  sort_record(rec);				   /*                        */
+  mark_key(db, rec);				   /*                        */
+  make_sort_key(db, rec);			   /*                        */
+  return false;					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	rec_gt()
+** Purpose:	Compare the sort keys of two records.
+** Arguments:
+**	r1	the first record
+**	r2	the second record
+** Returns:	the comparison result
+**___________________________________________________			     */
+static int rec_gt(r1, r2)			   /*                        */
+  Record r1;					   /*                        */
+  Record r2;					   /*                        */
+{ return symcmp(RecordSortkey(r1), RecordSortkey(r2)) < 0;/*                 */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	convert()
+** Purpose:	Convert a \BibTeX{} file in a new context. The
+**		resource instructions are separated by newlines. The
+**		context is released afterwards.
+** Arguments:
+**	rsc	the resource instructions
+**	file	the name of the \BibTeX{} file
+** Returns:	the result of the conversion in newly allocated memory
+**___________________________________________________			     */
+static char * convert(rsc, file)		   /*                        */
+  char	  *rsc;					   /*                        */
+  char	  *file;				   /*                        */
+{ Context ctx = ctx_new();			   /*                        */
+  Context old = ctx_use(ctx);			   /*                        */
+  DB	  db;					   /*                        */
+  FILE	  *out;					   /*                        */
+  char	  *s, *cp, *next, *result;		   /*                        */
+  long	  len;					   /*                        */
+ 						   /*                        */
+  init_bibtool("context");			   /*                        */
+  rsc_quiet = true;				   /*                        */
+  s = new_string(rsc);				   /*                        */
+  for (cp = s; cp; cp = next)			   /*                        */
+  { if ((next = strchr(cp, '\n')) != NULL) *next++ = '\0';/*                 */
+    if (*cp) (void)use_rsc((String)cp);		   /*                        */
+  }						   /*                        */
+  free(s);					   /*                        */
+ 						   /*                        */
+  db = new_db();				   /*                        */
+  (void)read_db(db, (String)file, false);	   /*                        */
+  db_forall(db, keep_selected);			   /*                        */
+  start_key_gen();				   /*                        */
+  db_forall(db, rsc_make_key ? do_keys : do_no_keys);/*                      */
+  end_key_gen();				   /*                        */
+  if (rsc_sort) db_sort(db, rec_gt);		   /*                        */
+ 						   /*                        */
+  if (rsc_select) rsc_del_q = false;		   /*                        */
+  if ((out = tmpfile()) == NULL)		   /*                        */
+  { OUT_OF_MEMORY("output"); }			   /*                        */
+  print_db(out, db, (char*)rsc_print_et);	   /*                        */
+  len = ftell(out);				   /*                        */
+  rewind(out);					   /*                        */
+  if ((result = malloc(len + 1)) == NULL)	   /*                        */
+  { OUT_OF_MEMORY("output"); }			   /*                        */
+  result[fread(result, 1, len, out)] = '\0';	   /*                        */
+  (void)fclose(out);				   /*                        */
+ 						   /*                        */
+  free_db(db);					   /*                        */
+  ctx_free(ctx);				   /*                        */
+  (void)ctx_use(old);				   /*                        */
+  return result;				   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	worker()
+** Purpose:	Thread function repeating a conversion and comparing
+**		the results with the expected one.
+** Arguments:
+**	arg	the job
+** Returns:	|NULL|
+**___________________________________________________			     */
+static void * worker(arg)			   /*                        */
+  void *arg;					   /*                        */
+{ Job  job = (Job)arg;				   /*                        */
+  char *s;					   /*                        */
+  int  i;					   /*                        */
+ 						   /*                        */
+  for (i = 0; i < ROUNDS; i++)			   /*                        */
+  { s = convert(job->jb_rsc, job->jb_file);	   /*                        */
+    if (strcmp(s, job->jb_expected) != 0) job->jb_failures++;/*              */
+    free(s);					   /*                        */
+  }						   /*                        */
+  return NULL;					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	main()
+** Purpose:	Main function of the test program.
+** Arguments:
+**	argc	the number of arguments
+**	argv	the arguments
+** Returns:	|0| upon success and |1| otherwise
+**___________________________________________________			     */
+int main(argc, argv)				   /*                        */
+  int	    argc;				   /*                        */
+  char	    *argv[];				   /*                        */
+{ SJob	    jobs[THREADS];			   /*                        */
+  SJob	    work[THREADS];			   /*                        */
+  pthread_t tids[THREADS];			   /*                        */
+  int	    n, i, failures;			   /*                        */
+ 						   /*                        */
+  n = argc - 2;					   /*                        */
+  if (n < 1 || n > THREADS)			   /*                        */
+  { fprintf(stderr, "Usage: %s resource... file\n", argv[0]);/*              */
+    return 1;					   /*                        */
+  }						   /*                        */
+ 						   /*                        */
+  for (i = 0; i < n; i++)			   /* Convert one after the  */
+  { jobs[i].jb_rsc	= argv[i + 1];		   /*  other.                */
+    jobs[i].jb_file	= argv[argc - 1];	   /*                        */
+    jobs[i].jb_expected = convert(jobs[i].jb_rsc, jobs[i].jb_file);/*        */
+    jobs[i].jb_failures = 0;			   /*                        */
+    printf("%%%%%% %d\n%s", i + 1, jobs[i].jb_expected);/*                   */
+  }						   /*                        */
+ 						   /*                        */
+  for (i = 0; i < THREADS; i++)			   /* Convert in parallel.   */
+  { work[i] = jobs[i % n];			   /* Several threads work   */
+    if (pthread_create(&tids[i], NULL, worker, &work[i]) != 0)/*  on the   */
+    { fprintf(stderr, "*** thread %d not started\n", i);/* same job.        */
+      return 1;					   /*                        */
+    }						   /*                        */
+  }						   /*                        */
+  for (failures = 0, i = 0; i < THREADS; i++)	   /*                        */
+  { (void)pthread_join(tids[i], NULL);		   /*                        */
+    failures += work[i].jb_failures;		   /*                        */
+  }						   /*                        */
+  for (i = 0; i < n; i++) { free(jobs[i].jb_expected); }/*                   */
+  printf("%%%%%% %d differences\n", failures);	   /*                        */
+  return failures ? 1 : 0;			   /*                        */
+}						   /*------------------------*/
@@ -0,0 +1,196 @@
+#!/usr/bin/env perl
+# =============================================================================
+#  
+#  This file is part of BibTool.
+#  It is distributed under the GNU General Public License.
+#  See the file COPYING for details.
+#  
+#  (c) 2020 Gerd Neugebauer
+#  
+#  Net: gene@gerd-neugebauer.de
+#  
+#  This program is free software; you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation; either version 2, or (at your option)
+#  any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software
+#  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+#
+#*=============================================================================
+
+=head1 NAME
+
+context.t - Test suite for the contexts of the BibTool library.
+
+=head1 SYNOPSIS
+
+context.t 
+
+=head1 DESCRIPTION
+
+This module contains some test cases. Running this module as program
+will run all test cases and print a summary for each. Optionally files
+*.out and *.err are left if the expected result does not match the
+actual result.
+
+The test cases use the program F<context> instead of BibTool. It
+converts the input once for each argument in a context of its own.
+Afterwards the conversions are repeated by several threads at the same
+time and the results are compared.
+
+=head1 OPTIONS
+
+none
+
+=head1 AUTHOR
+
+Gerd Neugebauer
+
+=cut
+
+use strict;
+use BUnit;
+use warnings;
+
+local $BUnit::BIBTOOL = './context';
+
+my $BIB = <<__EOF__;
+\@Article{ x,
+  author = {Zoe Zimmermann},
+  title = {The last},
+  year = 2001
+}
+\@Book{ y,
+  author = {Anna Adams and Bert Brown},
+  title = {The first},
+  publisher = {Pub},
+  year = 1999
+}
+\@Misc{ z,
+  author = {Mia M\\"uller},
+  title = {In between},
+  year = 2020
+}
+__EOF__
+
+#------------------------------------------------------------------------------
+BUnit::run(name		=> 'context_1',
+	   args		=> q{'sort=on' 'delete.field={year}'},
+	   bib		=> $BIB,
+	   expected_out => <<__EOF__);
+%%% 1
+
+\@Article{	  x,
+  author        = {Zoe Zimmermann},
+  title	        = {The last},
+  year	        = 2001
+}
+
+\@Book{		  y,
+  author        = {Anna Adams and Bert Brown},
+  title	        = {The first},
+  publisher     = {Pub},
+  year	        = 1999
+}
+
+\@Misc{		  z,
+  author        = {Mia M\\"uller},
+  title	        = {In between},
+  year	        = 2020
+}
+%%% 2
+
+\@Article{	  x,
+  author        = {Zoe Zimmermann},
+  title	        = {The last}
+}
+
+\@Book{		  y,
+  author        = {Anna Adams and Bert Brown},
+  title	        = {The first},
+  publisher     = {Pub}
+}
+
+\@Misc{		  z,
+  author        = {Mia M\\"uller},
+  title	        = {In between}
+}
+%%% 0 differences
+__EOF__
+
+#------------------------------------------------------------------------------
+BUnit::run(name		=> 'context_2',
+	   args		=> q{'key.generation=on
+key.format=short
+sort=on' 'select={year "20"}
+rewrite.rule={title "The" "A"}' 'rename.field={title=headline}'},
+	   bib		=> $BIB,
+	   expected_out => <<__EOF__);
+%%% 1
+
+\@Book{		  adams.brown:first,
+  author        = {Anna Adams and Bert Brown},
+  title	        = {The first},
+  publisher     = {Pub},
+  year	        = 1999
+}
+
+\@Misc{		  muller:in,
+  author        = {Mia M\\"uller},
+  title	        = {In between},
+  year	        = 2020
+}
+
+\@Article{	  zimmermann:last,
+  author        = {Zoe Zimmermann},
+  title	        = {The last},
+  year	        = 2001
+}
+%%% 2
+
+\@Article{	  x,
+  author        = {Zoe Zimmermann},
+  title	        = {A last},
+  year	        = 2001
+}
+
+\@Misc{		  z,
+  author        = {Mia M\\"uller},
+  title	        = {In between},
+  year	        = 2020
+}
+%%% 3
+
+\@Article{	  x,
+  author        = {Zoe Zimmermann},
+  headline      = {The last},
+  year	        = 2001
+}
+
+\@Book{		  y,
+  author        = {Anna Adams and Bert Brown},
+  headline      = {The first},
+  publisher     = {Pub},
+  year	        = 1999
+}
+
+\@Misc{		  z,
+  author        = {Mia M\\"uller},
+  headline      = {In between},
+  year	        = 2020
+}
+%%% 0 differences
+__EOF__
+
+1;
+#------------------------------------------------------------------------------
+# Local Variables: 
+# mode: perl
+# End: 
@@ -0,0 +1,165 @@
+#!/usr/bin/env perl
+# =============================================================================
+#  
+#  This file is part of BibTool.
+#  It is distributed under the GNU General Public License.
+#  See the file COPYING for details.
+#
+#  (c) 2016-2020 Gerd Neugebauer
+#
+#  Net: gene@gerd-neugebauer.de
+#  
+#  This program is free software; you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation; either version 2, or (at your option)
+#  any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software
+#  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+#
+#*=============================================================================
+
+=head1 NAME
+
+expand_crossref.t - Test suite for BibTool expand.crossref.
+
+=head1 SYNOPSIS
+
+expand_crossref.t 
+
+=head1 DESCRIPTION
+
+This module contains some test cases. Running this module as program
+will run all test cases and print a summary for each. Optionally files
+*.out and *.err are left if the expected result does not match the
+actual result.
+
+=head1 OPTIONS
+
+none 
+
+=head1 AUTHOR
+
+Gerd Neugebauer
+
+=cut
+
+use strict;
+use BUnit;use warnings;
+
+
+#------------------------------------------------------------------------------
+BUnit::run(name => 'expand_crossref_1',
+    args	 => '-- expand.crossref=on',
+    bib		 => <<__EOF__,
+\@Article{a,
+  author = "aa",
+  crossref = "b"
+}
+\@InProceedings{b,
+  title = "bb",
+  crossref = "c"
+}
+\@Proceedings{c,
+  title = "cc",
+  year = 2000
+}
+__EOF__
+    expected_out => <<__EOF__,
+
+\@Article{	  a,
+  author        = "aa",
+  title	        = "bb",
+  year	        = 2000
+}
+
+\@InProceedings{	  b,
+  title	        = "bb",
+  year	        = 2000
+}
+
+\@Proceedings{	  c,
+  title	        = "cc",
+  year	        = 2000
+}
+__EOF__
+    expected_err => '' );
+
+#------------------------------------------------------------------------------
+BUnit::run(name => 'expand_crossref_2',
+    args	 => '-- expand.crossref=on',
+    bib		 => <<__EOF__,
+\@Article{a,
+  author = "aa",
+  crossref = "b"
+}
+\@Book{b,
+  title = "bb",
+  crossref = "c"
+}
+\@Book{c,
+  year = 2000,
+  crossref = "b"
+}
+__EOF__
+    expected_out => <<__EOF__,
+
+\@Article{	  a,
+  author        = "aa",
+  title	        = "bb",
+  year	        = 2000
+}
+
+\@Book{		  b,
+  title	        = "bb",
+  year	        = 2000
+}
+
+\@Book{		  c,
+  year	        = 2000,
+  title	        = "bb"
+}
+__EOF__
+    expected_err => <<__EOF__);
+
+*** BibTool ERROR: Crossref cycle: c -> b -> c
+__EOF__
+
+#------------------------------------------------------------------------------
+BUnit::run(name => 'expand_crossref_3',
+    args	 => '-- expand.crossref=on',
+    bib		 => <<__EOF__,
+\@Article{d,
+  crossref = {e}
+}
+\@Article{e,
+  crossref = {d},
+  note = {N}
+}
+__EOF__
+    expected_out => <<__EOF__,
+
+\@Article{	  d,
+  note	        = {N}
+}
+
+\@Article{	  e,
+  note	        = {N}
+}
+__EOF__
+    expected_err => <<__EOF__);
+
+*** BibTool ERROR: Crossref cycle: e -> d -> e
+__EOF__
+
+1;
+#------------------------------------------------------------------------------
+# Local Variables: 
+# mode: perl
+# End: 
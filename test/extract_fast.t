@@ -0,0 +1,274 @@
+#!/usr/bin/env perl
+# =============================================================================
+#  
+#  This file is part of BibTool.
+#  It is distributed under the GNU General Public License.
+#  See the file COPYING for details.
+#  
+#  (c) 2020 Gerd Neugebauer
+#  
+#  Net: gene@gerd-neugebauer.de
+#  
+#  This program is free software; you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation; either version 2, or (at your option)
+#  any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software
+#  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+#
+#*=============================================================================
+
+=head1 NAME
+
+extract_fast.t - Test suite for BibTool extract.fast.
+
+=head1 SYNOPSIS
+
+extract_fast.t 
+
+=head1 DESCRIPTION
+
+This module contains some test cases. Running this module as program
+will run all test cases and print a summary for each. Optionally files
+*.out and *.err are left if the expected result does not match the
+actual result.
+
+=head1 OPTIONS
+
+none
+
+=head1 AUTHOR
+
+Gerd Neugebauer
+
+=cut
+
+use strict;
+use BUnit;use warnings;
+
+
+#------------------------------------------------------------------------------
+BUnit::run(name => 'extract_fast_1',
+    args     => '-- extract.fast=on -x _xyzzy.aux',
+    prepare  => sub {
+      my $fd = new FileHandle("_xyzzy.aux",'w') || die "_xyzzy.aux: $!\n";
+      print $fd <<__EOF__;
+\\citation{c}
+\\bibdata{_xyzzy.bib}
+__EOF__
+      $fd->close();
+      $fd = new FileHandle("_xyzzy.bib",'w') || die "_xyzzy.bib: $!\n";
+      print $fd <<__EOF__;
+\@Book{b,
+  title = {B}
+}
+\@Article{skip1,
+  title = "A {quoted} title, with (parens)",
+  note = {nested {braces} here}
+}
+\@Article{a,
+  title = {A},
+  crossref = {b}
+}
+\@Misc(skip2,
+  title = {paren entry}
+)
+\@Article{c,
+  title = {C},
+  crossref = {d}
+}
+\@Book{d,
+  title = {D}
+}
+__EOF__
+      $fd->close();
+	   },
+    post         => sub {
+      unlink('_xyzzy.aux');
+      unlink('_xyzzy.bib');
+	   },
+    expected_err => '',
+    expected_out => <<__EOF__,
+
+\@Article{	  c,
+  title	        = {C},
+  crossref      = {d}
+}
+
+\@Book{		  d,
+  title	        = {D}
+}
+__EOF__
+    );
+
+#------------------------------------------------------------------------------
+BUnit::run(name => 'extract_fast_2',
+    args     => '-- extract.fast=on -x _xyzzy.aux',
+    prepare  => sub {
+      my $fd = new FileHandle("_xyzzy.aux",'w') || die "_xyzzy.aux: $!\n";
+      print $fd <<__EOF__;
+\\citation{a}
+\\citation{C}
+\\bibdata{_xyzzy.bib}
+__EOF__
+      $fd->close();
+      $fd = new FileHandle("_xyzzy.bib",'w') || die "_xyzzy.bib: $!\n";
+      print $fd <<__EOF__;
+\@Book{b,
+  title = {B}
+}
+\@Article{skip1,
+  title = "A {quoted} title, with (parens)",
+  note = {nested {braces} here}
+}
+\@Article{a,
+  title = {A},
+  crossref = {b}
+}
+\@Misc(skip2,
+  title = {paren entry}
+)
+\@Article{c,
+  title = {C},
+  crossref = {d}
+}
+\@Book{d,
+  title = {D}
+}
+__EOF__
+      $fd->close();
+	   },
+    post         => sub {
+      unlink('_xyzzy.aux');
+      unlink('_xyzzy.bib');
+	   },
+    expected_err => '',
+    expected_out => <<__EOF__,
+
+\@Article{	  a,
+  title	        = {A},
+  crossref      = {b}
+}
+
+\@Article{	  c,
+  title	        = {C},
+  crossref      = {d}
+}
+
+\@Book{		  d,
+  title	        = {D}
+}
+
+\@Book{		  b,
+  title	        = {B}
+}
+__EOF__
+    );
+
+#------------------------------------------------------------------------------
+BUnit::run(name => 'extract_fast_3',
+    args     => '-s -- extract.fast=on -x _xyzzy.aux',
+    prepare  => sub {
+      my $fd = new FileHandle("_xyzzy.aux",'w') || die "_xyzzy.aux: $!\n";
+      print $fd <<__EOF__;
+\\citation{skip2}
+\\bibdata{_xyzzy.bib}
+__EOF__
+      $fd->close();
+      $fd = new FileHandle("_xyzzy.bib",'w') || die "_xyzzy.bib: $!\n";
+      print $fd <<__EOF__;
+\@Book{b,
+  title = {B}
+}
+\@Article{skip1,
+  title = "A {quoted} title, with (parens)",
+  note = {nested {braces} here}
+}
+\@Article{a,
+  title = {A},
+  crossref = {b}
+}
+\@Misc(skip2,
+  title = {paren entry}
+)
+\@Article{c,
+  title = {C},
+  crossref = {d}
+}
+\@Book{d,
+  title = {D}
+}
+__EOF__
+      $fd->close();
+	   },
+    post         => sub {
+      unlink('_xyzzy.aux');
+      unlink('_xyzzy.bib');
+	   },
+    expected_err => '',
+    expected_out => <<__EOF__,
+
+\@Misc{		  skip2,
+  title	        = {paren entry}
+}
+__EOF__
+    );
+
+#------------------------------------------------------------------------------
+BUnit::run(name => 'extract_fast_4',
+    args     => '-- extract.fast=on -x _xyzzy.aux',
+    prepare  => sub {
+      my $fd = new FileHandle("_xyzzy.aux",'w') || die "_xyzzy.aux: $!\n";
+      print $fd <<__EOF__;
+\\citation{a}
+\\bibdata{_xyzzy.bib}
+__EOF__
+      $fd->close();
+      $fd = new FileHandle("_xyzzy.bib",'w') || die "_xyzzy.bib: $!\n";
+      print $fd <<__EOF__;
+\@PREAMBLE{"\\newcommand{\\noop}[1]{}"}
+\@STRING{pub = {Publisher}}
+\@Book{b,
+  title = {B},
+  publisher = pub
+}
+\@Article{a,
+  title = {A},
+  crossref = {b}
+}
+__EOF__
+      $fd->close();
+	   },
+    post         => sub {
+      unlink('_xyzzy.aux');
+      unlink('_xyzzy.bib');
+	   },
+    expected_err => '',
+    expected_out => <<__EOF__,
+\@PREAMBLE{ "\\newcommand{\\noop}[1]{}" }
+\@STRING{pub     = {Publisher} }
+
+\@Article{	  a,
+  title	        = {A},
+  crossref      = {b}
+}
+
+\@Book{		  b,
+  title	        = {B},
+  publisher     = pub
+}
+__EOF__
+    );
+
+1;
+#------------------------------------------------------------------------------
+# Local Variables: 
+# mode: perl
+# End: 
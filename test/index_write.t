@@ -0,0 +1,168 @@
+#!/usr/bin/env perl
+# =============================================================================
+#  
+#  This file is part of BibTool.
+#  It is distributed under the GNU General Public License.
+#  See the file COPYING for details.
+#  
+#  (c) 2020 Gerd Neugebauer
+#  
+#  Net: gene@gerd-neugebauer.de
+#  
+#  This program is free software; you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation; either version 2, or (at your option)
+#  any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software
+#  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+#
+#*=============================================================================
+
+=head1 NAME
+
+index_write.t - Test suite for BibTool index.write.
+
+=head1 SYNOPSIS
+
+index_write.t 
+
+=head1 DESCRIPTION
+
+This module contains some test cases. Running this module as program
+will run all test cases and print a summary for each. Optionally files
+*.out and *.err are left if the expected result does not match the
+actual result.
+
+=head1 OPTIONS
+
+none
+
+=head1 AUTHOR
+
+Gerd Neugebauer
+
+=cut
+
+use strict;
+use BUnit;use warnings;
+
+
+my $bib = <<__EOF__;
+stray text
+\@string{ acm = "ACM" }
+\@book{ a,
+  title	  = "the title",
+  publisher = acm
+}
+\@misc{ c,
+  title	  = "not cited"
+}
+\@article{ b,
+  author  = "bb",
+  title	  = "the title",
+  crossref = "a"
+}
+__EOF__
+
+sub prepare_xyzzy {
+  my $fd = new FileHandle("_xyzzy.aux",'w') || die "_xyzzy.aux: $!\n";
+  print $fd <<__EOF__;
+\\citation{b}
+\\bibdata{_xyzzy}
+__EOF__
+  $fd->close();
+  $fd = new FileHandle("_xyzzy.bib",'w') || die "_xyzzy.bib: $!\n";
+  print $fd $bib;
+  $fd->close();
+}
+
+sub post_xyzzy {
+  unlink('_xyzzy.aux');
+  unlink('_xyzzy.bib');
+  unlink('_xyzzy.bib.idx');
+}
+
+my $out = <<__EOF__;
+\@STRING{acm     = "ACM" }
+
+\@Article{	  b,
+  author        = "bb",
+  title	        = "the title",
+  crossref      = "a"
+}
+
+\@Book{		  a,
+  title	        = "the title",
+  publisher     = acm
+}
+__EOF__
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'index_write_1',
+    args         => "-- index.write=on _xyzzy.bib",
+    prepare      => sub { prepare_xyzzy(); },
+    post         => sub { post_xyzzy(); },
+    expected_err => <<__EOF__,
+
+*** BibTool WARNING (line 2 in ./_xyzzy.bib): 9 non-space characters ignored.
+__EOF__
+    expected_out => <<__EOF__);
+\@STRING{acm     = "ACM" }
+
+\@Book{		  a,
+  title	        = "the title",
+  publisher     = acm
+}
+
+\@Misc{		  c,
+  title	        = "not cited"
+}
+
+\@Article{	  b,
+  author        = "bb",
+  title	        = "the title",
+  crossref      = "a"
+}
+__EOF__
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'index_write_2',
+    args         => "-- extract.fast=on -x _xyzzy.aux",
+    prepare      => sub {
+      prepare_xyzzy();
+      `$BUnit::BIBTOOL -- index.write=on -o '' _xyzzy.bib 2>/dev/null`;
+	   },
+    post         => sub { post_xyzzy(); },
+    expected_err => '',
+    expected_out => $out);
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'index_write_3',
+    args         => "-- extract.fast=on -x _xyzzy.aux",
+    prepare      => sub {
+      prepare_xyzzy();
+      my $fd = new FileHandle("_xyzzy.bib.idx",'w') || die "_xyzzy.bib.idx: $!\n";
+      print $fd "% BibTool index 1 0 0 0\n";
+      $fd->close();
+	   },
+    post         => sub { post_xyzzy(); },
+    expected_err => <<__EOF__,
+
+*** BibTool WARNING (line 2 in ./_xyzzy.bib): 9 non-space characters ignored.
+
+*** BibTool WARNING (line 2 in ./_xyzzy.bib): 9 non-space characters ignored.
+__EOF__
+    expected_out => $out);
+
+1;
+#------------------------------------------------------------------------------
+# Local Variables: 
+# mode: perl
+# End: 
@@ -354,6 +354,44 @@ __EOF__
 __EOF__
     expected_err => '' );
 
+#------------------------------------------------------------------------------
+BUnit::run(name => 'keep_field_24',
+    resource	=> <<__EOF__,
+keep.field{title}
+keep.field{author if \$type = article}
+keep.field{note if year = 2018}
+keep.field{year if note = y}
+__EOF__
+    bib		 => <<__EOF__,
+\@Article{	  bibtool,
+  title		= {The BibTool Manual},
+  author	= {Gerd Neugebauer},
+  year		= 2018,
+  note		= {x}
+}
+
+\@Manual{	  bibtool2,
+  title		= {The BibTool Manual},
+  author	= {Gerd Neugebauer},
+  year		= 2018,
+  note		= {y}
+}
+__EOF__
+    expected_out => <<__EOF__,
+
+\@Article{	  bibtool,
+  title	        = {The BibTool Manual},
+  author        = {Gerd Neugebauer}
+}
+
+\@Manual{	  bibtool2,
+  title	        = {The BibTool Manual},
+  year	        = 2018,
+  note	        = {y}
+}
+__EOF__
+    expected_err => '' );
+
 1;
 #------------------------------------------------------------------------------
 # Local Variables: 
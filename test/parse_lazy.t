@@ -0,0 +1,143 @@
+#!/usr/bin/env perl
+# =============================================================================
+#  
+#  This file is part of BibTool.
+#  It is distributed under the GNU General Public License.
+#  See the file COPYING for details.
+#  
+#  (c) 2020 Gerd Neugebauer
+#  
+#  Net: gene@gerd-neugebauer.de
+#  
+#  This program is free software; you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation; either version 2, or (at your option)
+#  any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software
+#  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+#
+#*=============================================================================
+
+=head1 NAME
+
+parse_lazy.t - Test suite for BibTool parse.lazy.
+
+=head1 SYNOPSIS
+
+parse_lazy.t 
+
+=head1 DESCRIPTION
+
+This module contains some test cases. Running this module as program
+will run all test cases and print a summary for each. Optionally files
+*.out and *.err are left if the expected result does not match the
+actual result.
+
+=head1 OPTIONS
+
+none
+
+=head1 AUTHOR
+
+Gerd Neugebauer
+
+=cut
+
+
+use strict;
+use BUnit;use warnings;
+
+
+my $bib = <<__EOF__;
+\@Manual{BibTool-a,
+  title =	 {BibTool},
+  author =	 {Gerd Neugebauer},
+  abstract =	 {A tool for {\\BibTeX} files.},
+  year =	 "2019"
+}
+\@Manual{BibTool-b,
+  title =	 {BibTool},
+  author =	 {Gerd Neugebauer},
+  abstract =	 {A tool for {\\BibTeX} files.},
+  year =	 "2019"
+}
+__EOF__
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'parse_lazy_1',
+    args         => "-- parse.lazy=on",
+    bib	         => $bib,
+    expected_err => '',
+    expected_out => <<__EOF__);
+
+\@Manual{	  bibtool-a,
+  title	        = {BibTool},
+  author        = {Gerd Neugebauer},
+  abstract      = {A tool for {\\BibTeX} files.},
+  year	        = "2019"
+}
+
+\@Manual{	  bibtool-b,
+  title	        = {BibTool},
+  author        = {Gerd Neugebauer},
+  abstract      = {A tool for {\\BibTeX} files.},
+  year	        = "2019"
+}
+__EOF__
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'parse_lazy_2',
+    args         => "-f '%n(author):%2d(year)' -- parse.lazy=on",
+    bib	         => $bib,
+    expected_err => '',
+    expected_out => <<__EOF__);
+
+\@Manual{	  Neugebauer:19,
+  title	        = {BibTool},
+  author        = {Gerd Neugebauer},
+  abstract      = {A tool for {\\BibTeX} files.},
+  year	        = "2019"
+}
+
+\@Manual{	  Neugebauer:19*1,
+  title	        = {BibTool},
+  author        = {Gerd Neugebauer},
+  abstract      = {A tool for {\\BibTeX} files.},
+  year	        = "2019"
+}
+__EOF__
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'parse_lazy_3',
+    args         => "-- parse.lazy=on -- 'unique.field{abstract}'",
+    bib	         => $bib,
+    expected_err => "*** BibTool WARNING (line 1 in _test.bib) and (line 7 in _test.bib): field `abstract' is not unique: {A tool for {\\BibTeX} files.}\n",
+    expected_out => <<__EOF__);
+
+\@Manual{	  bibtool-a,
+  title	        = {BibTool},
+  author        = {Gerd Neugebauer},
+  abstract      = {A tool for {\\BibTeX} files.},
+  year	        = "2019"
+}
+
+\@Manual{	  bibtool-b,
+  title	        = {BibTool},
+  author        = {Gerd Neugebauer},
+  abstract      = {A tool for {\\BibTeX} files.},
+  year	        = "2019"
+}
+__EOF__
+
+1;
+#------------------------------------------------------------------------------
+# Local Variables: 
+# mode: perl
+# End: 
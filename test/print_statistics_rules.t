@@ -0,0 +1,104 @@
+#!/usr/bin/env perl
+# =============================================================================
+#  
+#  This file is part of BibTool.
+#  It is distributed under the GNU General Public License.
+#  See the file COPYING for details.
+#  
+#  (c) 2020 Gerd Neugebauer
+#  
+#  Net: gene@gerd-neugebauer.de
+#  
+#  This program is free software; you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation; either version 2, or (at your option)
+#  any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software
+#  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+#
+#*=============================================================================
+
+=head1 NAME
+
+print_statistics_rules.t - Test suite for BibTool print.statistics.rules.
+
+=head1 SYNOPSIS
+
+print_statistics_rules.t 
+
+=head1 DESCRIPTION
+
+This module contains some test cases. Running this module as program
+will run all test cases and print a summary for each. Optionally files
+*.out and *.err are left if the expected result does not match the
+actual result.
+
+The times measured differ from run to run. Thus they are replaced by
+C<x> and the rules are sorted before the comparison.
+
+=head1 OPTIONS
+
+none
+
+=head1 AUTHOR
+
+Gerd Neugebauer
+
+=cut
+
+use strict;
+use BUnit;use warnings;
+
+#------------------------------------------------------------------------------
+# Function:	no_times
+# Arguments:	the error output
+# Description:	Replace the times in the profile by x and sort the rules.
+#
+sub no_times {
+  local $_ = shift;
+  s/ +[0-9]+\.[0-9]+  / x  /mg;
+  my ($head, @rules) = grep { $_ ne '' } split(/\n/);
+  return join("\n", $head, sort(@rules)) . "\n";
+}
+
+#------------------------------------------------------------------------------
+BUnit::run(name => 'print_statistics_rules_1',
+	 args	      => 'bib/x1 -- "rewrite.rule {year # \"18\" # \"19\"}"',
+	 resource     => <<__EOF__,
+print.statistics.rules = 9
+rewrite.rule {title "Bib" "Bub"}
+select {author "Gerd"}
+check.rule {year "^20"}
+rename.field {author = editor}
+keep.field {title}
+__EOF__
+	 fct_err      => \&no_times,
+	 expected_err => <<__EOF__);
+---  rule      attempts    matches   replaced   time [s]  source
+---  check            1          1          1 x  ./_test.rsc:4 year "^20"
+---  keep             0          0          0 x  ./_test.rsc:6 title
+---  rename           1          1          1 x  ./_test.rsc:5 author
+---  rewrite          2          1          1 x  - year "18"
+---  rewrite          2          1          1 x  ./_test.rsc:2 title "Bib"
+---  select           1          1          0 x  ./_test.rsc:3 author "Gerd"
+__EOF__
+
+#------------------------------------------------------------------------------
+BUnit::run(name => 'print_statistics_rules_2',
+	 args	      => '-- print.statistics.rules=0'
+	 . ' -- "rewrite.rule{title \"Bib\" \"Bub\"}"'
+	 . ' bib/x1',
+	 expected_err => '');
+
+1;
+#------------------------------------------------------------------------------
+# Local Variables: 
+# mode: perl
+# End: 
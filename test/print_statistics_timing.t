@@ -0,0 +1,149 @@
+#!/usr/bin/env perl
+# =============================================================================
+#  
+#  This file is part of BibTool.
+#  It is distributed under the GNU General Public License.
+#  See the file COPYING for details.
+#  
+#  (c) 2020 Gerd Neugebauer
+#  
+#  Net: gene@gerd-neugebauer.de
+#  
+#  This program is free software; you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation; either version 2, or (at your option)
+#  any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software
+#  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+#
+#*=============================================================================
+
+=head1 NAME
+
+print_statistics_timing.t - Test suite for BibTool print.statistics.timing.
+
+=head1 SYNOPSIS
+
+print_statistics_timing.t 
+
+=head1 DESCRIPTION
+
+This module contains some test cases. Running this module as program
+will run all test cases and print a summary for each. Optionally files
+*.out and *.err are left if the expected result does not match the
+actual result.
+
+The times measured differ from run to run. Thus they are replaced by
+C<x> before the comparison. The same holds for the numbers of symbols
+and probes since they depend on the symbols predefined by BibTool.
+
+=head1 OPTIONS
+
+none
+
+=head1 AUTHOR
+
+Gerd Neugebauer
+
+=cut
+
+use strict;
+use BUnit;use warnings;
+
+#------------------------------------------------------------------------------
+# Function:	no_times
+# Arguments:	the error output
+# Description:	Replace the times and the counters of the symbol table in
+#		a table or a JSON object by x.
+#
+sub no_times {
+  local $_ = shift;
+  s/ +[0-9]+\.[0-9]+ +[0-9]+\.[0-9]+$/ x x/mg;
+  s/"(wall|cpu)":[0-9.]+/"$1":x/g;
+  s/^(---  (symbols|probes)) +[0-9]+$/$1 x/mg;
+  s/"(symbols|probes)":[0-9]+/"$1":x/g;
+  return $_;
+}
+
+#------------------------------------------------------------------------------
+BUnit::run(name => 'print_statistics_timing_1',
+	 args	      => '-- print.statistics.timing=on bib/x1',
+	 fct_err      => \&no_times,
+	 expected_err => <<__EOF__);
+
+---  phase             wall [s]    cpu [s]
+---  init x x
+---  read x x
+---  select x x
+---  aux x x
+---  crossref x x
+---  keys x x
+---  sort x x
+---  check x x
+---  write x x
+---  total x x
+
+---  records                  1
+---  fields                   3
+---  symbols x
+---  probes x
+---  regex.searches           0
+---  rule.hits                0
+---  db.finds                 0
+---  bytes.written          111
+__EOF__
+
+#------------------------------------------------------------------------------
+BUnit::run(name => 'print_statistics_timing_2',
+	 args	      => '-- print.statistics.timing=json bib/x1',
+	 fct_err      => \&no_times,
+	 expected_err => '{"phases":[{"name":"init","wall":x,"cpu":x},'
+	 . '{"name":"read","wall":x,"cpu":x},'
+	 . '{"name":"select","wall":x,"cpu":x},'
+	 . '{"name":"aux","wall":x,"cpu":x},'
+	 . '{"name":"crossref","wall":x,"cpu":x},'
+	 . '{"name":"keys","wall":x,"cpu":x},'
+	 . '{"name":"sort","wall":x,"cpu":x},'
+	 . '{"name":"check","wall":x,"cpu":x},'
+	 . '{"name":"write","wall":x,"cpu":x}],'
+	 . '"wall":x,"cpu":x,"counters":{"records":1,"fields":3,'
+	 . '"symbols":x,"probes":x,"regex.searches":0,"rule.hits":0,'
+	 . '"db.finds":0,"bytes.written":111}}' . "\n");
+
+#------------------------------------------------------------------------------
+BUnit::run(name => 'print_statistics_timing_3',
+	 args	      => '-- print.statistics.timing=off bib/x1',
+	 expected_err => '');
+
+#------------------------------------------------------------------------------
+BUnit::run(name => 'print_statistics_timing_4',
+	 args	      => '-- print.statistics.timing=on'
+	 . ' -- "rewrite.rule{title \"Bib\" \"Bub\"}"'
+	 . ' -- "select{author \"Gerd\"}"'
+	 . ' bib/x1',
+	 fct_err      => sub { local $_ = no_times(shift);
+			       s/^.*---  records/---  records/s;
+			       return $_; },
+	 expected_err => <<__EOF__);
+---  records                  1
+---  fields                   3
+---  symbols x
+---  probes x
+---  regex.searches           3
+---  rule.hits                1
+---  db.finds                 0
+---  bytes.written          111
+__EOF__
+
+1;
+#------------------------------------------------------------------------------
+# Local Variables: 
+# mode: perl
+# End: 
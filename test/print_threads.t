@@ -0,0 +1,109 @@
+#!/usr/bin/env perl
+# =============================================================================
+#  
+#  This file is part of BibTool.
+#  It is distributed under the GNU General Public License.
+#  See the file COPYING for details.
+#  
+#  (c) 2020 Gerd Neugebauer
+#  
+#  Net: gene@gerd-neugebauer.de
+#  
+#  This program is free software; you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation; either version 2, or (at your option)
+#  any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software
+#  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+#
+#*=============================================================================
+
+=head1 NAME
+
+print_threads.t - Test suite for BibTool print.threads.
+
+=head1 SYNOPSIS
+
+print_threads.t 
+
+=head1 DESCRIPTION
+
+This module contains some test cases. Running this module as program
+will run all test cases and print a summary for each. Optionally files
+*.out and *.err are left if the expected result does not match the
+actual result.
+
+=head1 OPTIONS
+
+none
+
+=head1 AUTHOR
+
+Gerd Neugebauer
+
+=cut
+
+use strict;
+use BUnit;use warnings;
+
+
+my $bib = '';
+my $out = '';
+for my $i (1..150) {
+  $bib .= <<__EOF__;
+\@article{ k$i,
+  author  = "A. Author$i and B. Author",
+  title	  = "A rather long title which has to be broken into two lines number $i",
+  year	  = 2000 # "$i"
+}
+__EOF__
+  $out .= <<__EOF__;
+
+\@Article{	  k$i,
+  author = "A. Author$i and B. Author",
+  title	 = "A rather long title which has to be broken into two lines number
+	   $i",
+  year	 = 2000 # "$i"
+}
+__EOF__
+}
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'print_threads_1',
+    args         => '-- print.threads=4 -- print.align=auto',
+    expected_err =>'',
+    bib	         => $bib,
+    expected_out => $out);
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'print_threads_2',
+    args         => '-- print.threads=4 -- suppress.initial.newline=on',
+    expected_err =>'',
+    bib	         => <<__EOF__,
+\@article{ a,
+  author  = "aa",
+  title	  = "the title"
+}
+\@preamble{ "x" }
+__EOF__
+    expected_out => <<__EOF__);
+\@PREAMBLE{ "x" }
+
+\@Article{	  a,
+  author        = "aa",
+  title	        = "the title"
+}
+__EOF__
+
+1;
+#------------------------------------------------------------------------------
+# Local Variables: 
+# mode: perl
+# End:
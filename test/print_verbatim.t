@@ -0,0 +1,133 @@
+#!/usr/bin/env perl
+# =============================================================================
+#  
+#  This file is part of BibTool.
+#  It is distributed under the GNU General Public License.
+#  See the file COPYING for details.
+#  
+#  (c) 2020 Gerd Neugebauer
+#  
+#  Net: gene@gerd-neugebauer.de
+#  
+#  This program is free software; you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation; either version 2, or (at your option)
+#  any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software
+#  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+#
+#*=============================================================================
+
+=head1 NAME
+
+print_verbatim.t - Test suite for BibTool print.verbatim.
+
+=head1 SYNOPSIS
+
+print_verbatim.t 
+
+=head1 DESCRIPTION
+
+This module contains some test cases. Running this module as program
+will run all test cases and print a summary for each. Optionally files
+*.out and *.err are left if the expected result does not match the
+actual result.
+
+=head1 OPTIONS
+
+none
+
+=head1 AUTHOR
+
+Gerd Neugebauer
+
+=cut
+
+use strict;
+use BUnit;use warnings;
+
+
+my $bib = <<__EOF__;
+\@Article{ Key1,
+     author = {A. Uthor},   title="Odd   spacing"
+}
+
+\@book{k2, title = {Other}, year = 2000}
+__EOF__
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'print_verbatim_1',
+    args         => "-- print.verbatim=on",
+    bib	         => $bib,
+    expected_err => '',
+    expected_out => <<__EOF__);
+
+\@Article{ Key1,
+     author = {A. Uthor},   title="Odd   spacing"
+}
+
+\@book{k2, title = {Other}, year = 2000}
+__EOF__
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'print_verbatim_2',
+    args         => "-- print.verbatim=on -- 'rewrite.rule={year # \"2000\" # \"2001\"}'",
+    bib	         => $bib,
+    expected_err => '',
+    expected_out => <<__EOF__);
+
+\@Article{ Key1,
+     author = {A. Uthor},   title="Odd   spacing"
+}
+
+\@Book{		  k2,
+  title	        = {Other},
+  year	        = 2001
+}
+__EOF__
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'print_verbatim_3',
+    args         => "-- print.verbatim=on -- delete.field=author",
+    bib	         => $bib,
+    expected_err => '',
+    expected_out => <<__EOF__);
+
+\@Article{	  key1,
+  title	        = "Odd spacing"
+}
+
+\@book{k2, title = {Other}, year = 2000}
+__EOF__
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'print_verbatim_4',
+    args         => "-- print.verbatim=on",
+    bib	         => $bib,
+    stdin        => 1,
+    expected_err => '',
+    expected_out => <<__EOF__);
+
+\@Article{	  key1,
+  author        = {A. Uthor},
+  title	        = "Odd spacing"
+}
+
+\@Book{		  k2,
+  title	        = {Other},
+  year	        = 2000
+}
+__EOF__
+
+1;
+#------------------------------------------------------------------------------
+# Local Variables: 
+# mode: perl
+# End: 
@@ -0,0 +1,154 @@
+#!/usr/bin/env perl
+# =============================================================================
+#  
+#  This file is part of BibTool.
+#  It is distributed under the GNU General Public License.
+#  See the file COPYING for details.
+#  
+#  (c) 2020 Gerd Neugebauer
+#  
+#  Net: gene@gerd-neugebauer.de
+#  
+#  This program is free software; you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation; either version 2, or (at your option)
+#  any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software
+#  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+#
+#*=============================================================================
+
+=head1 NAME
+
+resource_bundle.t - Test suite for BibTool resource.bundle.
+
+=head1 SYNOPSIS
+
+resource_bundle.t 
+
+=head1 DESCRIPTION
+
+This module contains some test cases. Running this module as program
+will run all test cases and print a summary for each. Optionally files
+*.out and *.err are left if the expected result does not match the
+actual result.
+
+=head1 OPTIONS
+
+none
+
+=head1 AUTHOR
+
+Gerd Neugebauer
+
+=cut
+
+use strict;
+use BUnit;use warnings;
+
+
+my $rsc = <<__EOF__;
+new.entry.type{Online}
+rewrite.rule{title # "[Tt]he " # ""}
+keep.field{{author title year} if \$type = "article"}
+keep.field{{title url} if \$type = "online"}
+__EOF__
+
+my $bib = <<__EOF__;
+\@article{ a,
+  author  = "A. U. Thor",
+  title	  = "The Title",
+  year	  = 2020,
+  pages	  = 42
+}
+\@online{ b,
+  title	  = "the page",
+  url	  = "https://example.org",
+  year	  = 2020
+}
+__EOF__
+
+my $out = <<__EOF__;
+
+\@Article{	  a,
+  author        = "A. U. Thor",
+  title	        = "Title",
+  year	        = 2020
+}
+
+\@Online{	  b,
+  title	        = "page",
+  url	        = "https://example.org"
+}
+__EOF__
+
+sub write_rsc {
+  my $fd = new FileHandle("_bundle.rsc",'w') || die "_bundle.rsc: $!\n";
+  print $fd $rsc, @_;
+  $fd->close();
+}
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'resource_bundle_1',
+    args         => "-- resource.bundle=_bundle.rbt -r _bundle",
+    prepare      => sub { write_rsc(); },
+    bib	         => $bib,
+    expected_err => '',
+    expected_out => $out);
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'resource_bundle_2',
+    args         => "-r _bundle.rbt",
+    bib	         => $bib,
+    expected_err => '',
+    expected_out => $out);
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'resource_bundle_3',
+    args         => "-r _bundle.rbt",
+    prepare      => sub { write_rsc("% changed\n"); },
+    post         => sub { unlink('_bundle.rsc', '_bundle.rbt'); },
+    bib	         => $bib,
+    expected_err => <<__EOF__,
+
+*** BibTool WARNING: Resource bundle is out of date: ./_bundle.rbt
+__EOF__
+    expected_out => $out);
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'resource_bundle_4',
+    args         => "-r _bundle.rbt",
+    prepare      => sub {
+      my $fd = new FileHandle("_bundle.rbt",'w') || die "_bundle.rbt: $!\n";
+      print $fd "\177BibTool bundle\n\0\0\0\1";
+      $fd->close();
+	   },
+    post         => sub { unlink('_bundle.rbt'); },
+    bib	         => <<__EOF__,
+\@article{ a,
+  title	  = "The Title"
+}
+__EOF__
+    expected_err => <<__EOF__,
+
+*** BibTool ERROR: Resource bundle is corrupt: ./_bundle.rbt
+__EOF__
+    expected_out => <<__EOF__);
+
+\@Article{	  a,
+  title	        = "The Title"
+}
+__EOF__
+
+1;
+#------------------------------------------------------------------------------
+# Local Variables: 
+# mode: perl
+# End: 
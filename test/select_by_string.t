@@ -236,6 +236,45 @@ __EOF__
 #__EOF__
 
 
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'select_by_string_13',
+    args	 => '--select.by.string=\'{note "minimal misc"}\' bib/xampl.bib',
+    expected_out => <<__EOF__);
+\@PREAMBLE{ "\\newcommand{\\noopsort}[1]{} "
+	 # "\\newcommand{\\printfirst}[2]{#1} "
+	 # "\\newcommand{\\singleletter}[1]{#1} "
+	 # "\\newcommand{\\switchargs}[2]{#2#1} " }
+\@STRING{acm     = "The OX Association for Computing Machinery" }
+\@STRING{stoc    = " Symposium on the Theory of Computing" }
+\@STRING{stoc-key = "OX{\\singleletter{stoc}}" }
+
+\@Misc{		  misc-minimal,
+  key	        = "Missilany",
+  note	        = "This is a minimal MISC entry"
+}
+__EOF__
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'select_by_string_14',
+    args	 => '--select.by.string=\'{"José"}\'',
+    bib		 => <<__EOF__,
+\@article{ a,
+  author = "José García",
+  title	 = "the title"
+}
+\@article{ b,
+  author = "Jose Garcia",
+  title	 = "the title"
+}
+__EOF__
+    expected_out => <<__EOF__);
+
+\@Article{	  a,
+  author        = "José García",
+  title	        = "the title"
+}
+__EOF__
+
 1;
 #------------------------------------------------------------------------------
 # Local Variables: 
@@ -147,6 +147,45 @@ __EOF__
 }
 __EOF__
 
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'select_crossrefs_3',
+    args         => '--select\'{"aa"}\' -- select.crossrefs=on',
+    bib	         => <<__EOF__,
+\@Article{a,
+  author = "aa",
+  crossref = "b"
+}
+\@Book{b,
+  title = "bb",
+  crossref = "c"
+}
+\@Book{c,
+  year = 2000,
+  crossref = "b"
+}
+__EOF__
+    expected_out => <<__EOF__,
+
+\@Article{	  a,
+  author        = "aa",
+  crossref      = "b"
+}
+
+\@Book{		  b,
+  title	        = "bb",
+  crossref      = "c"
+}
+
+\@Book{		  c,
+  year	        = 2000,
+  crossref      = "b"
+}
+__EOF__
+    expected_err => <<__EOF__);
+
+*** BibTool ERROR: Crossref cycle: b -> c -> b
+__EOF__
+
 #------------------------------------------------------------------------------
 BUnit::run(name  => '_X_c_1',
     args         => '-X aa -c',
@@ -0,0 +1,182 @@
+#!/usr/bin/env perl
+# =============================================================================
+#  
+#  This file is part of BibTool.
+#  It is distributed under the GNU General Public License.
+#  See the file COPYING for details.
+#  
+#  (c) 2020 Gerd Neugebauer
+#  
+#  Net: gene@gerd-neugebauer.de
+#  
+#  This program is free software; you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation; either version 2, or (at your option)
+#  any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software
+#  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+#
+#*=============================================================================
+
+=head1 NAME
+
+select_threads.t - Test suite for BibTool select.threads.
+
+=head1 SYNOPSIS
+
+select_threads.t 
+
+=head1 DESCRIPTION
+
+This module contains some test cases. Running this module as program
+will run all test cases and print a summary for each. Optionally files
+*.out and *.err are left if the expected result does not match the
+actual result.
+
+=head1 OPTIONS
+
+none
+
+=head1 AUTHOR
+
+Gerd Neugebauer
+
+=cut
+
+use strict;
+use BUnit;use warnings;
+
+
+my $bib = '';
+my $out = '';
+for my $i (1..500) {
+  my $who = ($i % 3 == 0 ? 'aa' : 'bb');
+  $bib .= <<__EOF__;
+\@article{ k$i,
+  author  = "$who and cc$i",
+  title	  = "Title $i"
+}
+__EOF__
+  $out .= <<__EOF__ if $who eq 'aa';
+
+\@Article{	  k$i,
+  author        = "$who and cc$i",
+  title	        = "Title $i"
+}
+__EOF__
+}
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'select_threads_1',
+    args         => '--select\'{author "aa"}\' -- select.threads=4',
+    expected_err =>'',
+    bib	         => <<__EOF__,
+\@article{ a,
+  author  = "aa",
+  title	  = "the title"
+}
+\@article{ b,
+  author = "bb",
+  title	 = "THE TITLE"
+}
+\@article{ c,
+  author = "aa and bb",
+  title	 = "Another Title"
+}
+__EOF__
+    expected_out => <<__EOF__);
+
+\@Article{	  a,
+  author        = "aa",
+  title	        = "the title"
+}
+
+\@Article{	  c,
+  author        = "aa and bb",
+  title	        = "Another Title"
+}
+__EOF__
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'select_threads_2',
+    args         => '--select.by.string\'{title "another"}\' -- select.threads=4',
+    expected_err =>'',
+    bib	         => <<__EOF__,
+\@article{ a,
+  author  = "aa",
+  title	  = "the title"
+}
+\@article{ b,
+  author = "bb",
+  title	 = "THE TITLE"
+}
+\@article{ c,
+  author = "aa and bb",
+  title	 = "Another Title"
+}
+__EOF__
+    expected_out => <<__EOF__);
+
+\@Article{	  c,
+  author        = "aa and bb",
+  title	        = "Another Title"
+}
+__EOF__
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'select_threads_3',
+    args         => '--select\'{author "aa"}\' -- select.threads=0',
+    expected_err =>'',
+    bib	         => <<__EOF__,
+\@article{ a,
+  author  = "aa",
+  title	  = "the title"
+}
+\@article{ b,
+  author = "bb",
+  title	 = "THE TITLE"
+}
+\@article{ c,
+  author = "aa and bb",
+  title	 = "Another Title"
+}
+__EOF__
+    expected_out => <<__EOF__);
+
+\@Article{	  a,
+  author        = "aa",
+  title	        = "the title"
+}
+
+\@Article{	  c,
+  author        = "aa and bb",
+  title	        = "Another Title"
+}
+__EOF__
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'select_threads_4',
+    args         => '--select\'{author "aa"}\' -- select.threads=4',
+    expected_err =>'',
+    bib	         => $bib,
+    expected_out => $out);
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'select_threads_5',
+    args         => '--select\'{author "aa"}\' -- select.threads=1',
+    expected_err =>'',
+    bib	         => $bib,
+    expected_out => $out);
+
+1;
+#------------------------------------------------------------------------------
+# Local Variables: 
+# mode: perl
+# End: 
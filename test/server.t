@@ -0,0 +1,307 @@
+#!/usr/bin/env perl
+# =============================================================================
+#  
+#  This file is part of BibTool.
+#  It is distributed under the GNU General Public License.
+#  See the file COPYING for details.
+#  
+#  (c) 2020 Gerd Neugebauer
+#  
+#  Net: gene@gerd-neugebauer.de
+#  
+#  This program is free software; you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation; either version 2, or (at your option)
+#  any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software
+#  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+#
+#*=============================================================================
+
+=head1 NAME
+
+server.t - Test suite for BibTool server.
+
+=head1 SYNOPSIS
+
+server.t 
+
+=head1 DESCRIPTION
+
+This module contains some test cases. Running this module as program
+will run all test cases and print a summary for each. Optionally files
+*.out and *.err are left if the expected result does not match the
+actual result.
+
+=head1 OPTIONS
+
+none
+
+=head1 AUTHOR
+
+Gerd Neugebauer
+
+=cut
+
+
+use strict;
+use BUnit;use warnings;
+use FileHandle;
+
+my $db = <<__EOF__;
+\@Misc{b, title = {Beta}}
+\@Article{a, title = {Alpha}, year = 2001}
+\@Book{c, title = {Gamma}}
+__EOF__
+
+#------------------------------------------------------------------------------
+# Function:	prepare
+# Arguments:	
+# Description:	Write the database served in the tests.
+#
+sub prepare {
+  my $fd = new FileHandle("_server.bib",'w') || die "_server.bib: $!\n";
+  print $fd $db;
+  $fd->close();
+  $fd = new FileHandle("_server.aux",'w') || die "_server.aux: $!\n";
+  print $fd <<__EOF__;
+\\citation{c}
+\\citation{a}
+\\bibdata{_server}
+__EOF__
+  $fd->close();
+}
+
+#------------------------------------------------------------------------------
+# Function:	post
+# Arguments:	
+# Description:	Remove the files written by prepare.
+#
+sub post {
+  unlink('_server.bib', '_server.aux');
+}
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'server_1',
+    args         => "-- server=- _server.bib",
+    stdin        => 1,
+    prepare      => \&prepare,
+    post         => \&post,
+    bib	         => <<__EOF__,
+key b zz
+select ^[ac]\$
+__EOF__
+    expected_err => '',
+    expected_out => <<__EOF__);
+
+\@Misc{		  b,
+  title	        = {Beta}
+}
+? zz not found
+.
+
+\@Article{	  a,
+  title	        = {Alpha},
+  year	        = 2001
+}
+
+\@Book{		  c,
+  title	        = {Gamma}
+}
+.
+__EOF__
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'server_2',
+    args         => "-- server=- _server.bib",
+    stdin        => 1,
+    prepare      => \&prepare,
+    post         => \&post,
+    bib	         => <<__EOF__,
+aux _server
+bogus
+__EOF__
+    expected_err => '',
+    expected_out => <<__EOF__);
+
+\@Article{	  a,
+  title	        = {Alpha},
+  year	        = 2001
+}
+
+\@Book{		  c,
+  title	        = {Gamma}
+}
+.
+? unknown request bogus
+.
+__EOF__
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'server_3',
+    args         => "-- server=- _server.bib",
+    stdin        => 1,
+    prepare      => \&prepare,
+    post         => \&post,
+    bib	         => <<__EOF__,
+format
+\@misc{  x ,title="X",  author={Me}}
+.
+quit
+key a
+__EOF__
+    expected_err => '',
+    expected_out => <<__EOF__);
+
+\@Misc{		  x,
+  title	        = "X",
+  author        = {Me}
+}
+.
+__EOF__
+
+#------------------------------------------------------------------------------
+# Function:	prepare_socket
+# Arguments:	
+# Description:	Write the database served and a Perl script which starts the
+#		server given as arguments in the background. The script
+#		connects the clients to the socket, prints the requests
+#		named in the environment variable SERVER_REQUESTS and the
+#		responses, and terminates the server. Each request is
+#		preceded by the client sending it, i.e. a letter. A
+#		client is connected when it is named first and
+#		disconnected by the request quit.
+#
+sub prepare_socket {
+  prepare();
+  unlink('_server.sock');
+  my $fd = new FileHandle("_server.pl",'w') || die "_server.pl: $!\n";
+  print $fd <<'__EOF__';
+use strict;
+use IO::Socket::UNIX;
+my $pid = fork();
+if ($pid == 0) { exec(@ARGV); exit(1); }
+for (my $i = 0; $i < 100 && ! -S '_server.sock'; $i++) {
+  select(undef, undef, undef, 0.1);
+}
+my %client;
+foreach (split(/;/, $ENV{'SERVER_REQUESTS'})) {
+  my ($c, $request) = m/^(.) (.*)$/s;
+  $client{$c} = IO::Socket::UNIX->new(Type => SOCK_STREAM(),
+				      Peer => '_server.sock')
+      || die "_server.sock: $!\n" if not $client{$c};
+  my $fd = $client{$c};
+  print "$c: $request\n";
+  print $fd "$request\n";
+  $fd->flush();
+  if ($request eq 'quit') {
+    close($fd);
+    delete $client{$c};
+    next;
+  }
+  while (defined($_ = <$fd>)) {
+    print $_;
+    last if $_ eq ".\n";
+  }
+}
+close($_) foreach (values %client);
+kill('TERM', $pid);
+waitpid($pid, 0);
+__EOF__
+  $fd->close();
+}
+
+#------------------------------------------------------------------------------
+# Function:	post_socket
+# Arguments:	
+# Description:	Remove the files written by prepare_socket and the socket.
+#
+sub post_socket {
+  post();
+  unlink('_server.pl', '_server.sock');
+}
+
+#------------------------------------------------------------------------------
+{ local $BUnit::BIBTOOL = "perl _server.pl $BUnit::BIBTOOL";
+  local $ENV{'SERVER_REQUESTS'} = 'a key c;a quit;b key zz a';
+  BUnit::run(name  => 'server_4',
+    args         => "-- server=_server.sock _server.bib",
+    prepare      => \&prepare_socket,
+    post         => \&post_socket,
+    expected_err => '',
+    expected_out => <<__EOF__);
+a: key c
+
+\@Book{		  c,
+  title	        = {Gamma}
+}
+.
+a: quit
+b: key zz a
+? zz not found
+
+\@Article{	  a,
+  title	        = {Alpha},
+  year	        = 2001
+}
+.
+__EOF__
+}
+
+#------------------------------------------------------------------------------
+{ local $BUnit::BIBTOOL = "perl _server.pl $BUnit::BIBTOOL";
+  local $ENV{'SERVER_REQUESTS'} = 'a key b;b key c;a aux _server;b quit;'
+      . "a format\n\@misc{x, title={X}}\n.";
+  BUnit::run(name  => 'server_5',
+    args         => "-- server=_server.sock _server.bib",
+    prepare      => \&prepare_socket,
+    post         => \&post_socket,
+    expected_err => '',
+    expected_out => <<__EOF__);
+a: key b
+
+\@Misc{		  b,
+  title	        = {Beta}
+}
+.
+b: key c
+
+\@Book{		  c,
+  title	        = {Gamma}
+}
+.
+a: aux _server
+
+\@Article{	  a,
+  title	        = {Alpha},
+  year	        = 2001
+}
+
+\@Book{		  c,
+  title	        = {Gamma}
+}
+.
+b: quit
+a: format
+\@misc{x, title={X}}
+.
+
+\@Misc{		  x,
+  title	        = {X}
+}
+.
+__EOF__
+}
+
+1;
+#------------------------------------------------------------------------------
+# Local Variables: 
+# mode: perl
+# End: 
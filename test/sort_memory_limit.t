@@ -0,0 +1,238 @@
+#!/usr/bin/env perl
+# =============================================================================
+#  
+#  This file is part of BibTool.
+#  It is distributed under the GNU General Public License.
+#  See the file COPYING for details.
+#  
+#  (c) 2020 Gerd Neugebauer
+#  
+#  Net: gene@gerd-neugebauer.de
+#  
+#  This program is free software; you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation; either version 2, or (at your option)
+#  any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software
+#  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+#
+#*=============================================================================
+
+=head1 NAME
+
+sort_memory_limit.t - Test suite for BibTool sort.memory.limit.
+
+=head1 SYNOPSIS
+
+sort_memory_limit.t 
+
+=head1 DESCRIPTION
+
+This module contains some test cases. Running this module as program
+will run all test cases and print a summary for each. Optionally files
+*.out and *.err are left if the expected result does not match the
+actual result.
+
+=head1 OPTIONS
+
+none
+
+=head1 AUTHOR
+
+Gerd Neugebauer
+
+=cut
+
+
+use strict;
+use BUnit;use warnings;
+
+
+my $bib = <<__EOF__;
+\@preamble{"\\newcommand{\\x}{x}"}
+\@string{jgg = {Journal of Gnats and Gnus}}
+\@Article{d, author = {D. Four}, title = {Delta}, journal = jgg, year = 2004}
+\@Article{b, author = {B. Two}, title = {Beta}, journal = jgg, year = 2002}
+\@Book{e, author = {E. Five}, title = {Epsilon}, year = 2005}
+\@Misc{a, author = {A. One}, title = {Alpha}, year = 2001}
+\@string{other = {Other}}
+\@Misc{c, author = {C. Three}, title = {Gamma}, note = other, year = 2003}
+__EOF__
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'sort_memory_limit_1',
+    args         => "-s -- sort.memory.limit=1",
+    bib	         => $bib,
+    expected_err => '',
+    expected_out => <<__EOF__);
+\@PREAMBLE{ "\\newcommand{\\x}{x}" }
+\@STRING{jgg     = {Journal of Gnats and Gnus} }
+\@STRING{other   = {Other} }
+
+\@Misc{		  a,
+  author        = {A. One},
+  title	        = {Alpha},
+  year	        = 2001
+}
+
+\@Article{	  b,
+  author        = {B. Two},
+  title	        = {Beta},
+  journal       = jgg,
+  year	        = 2002
+}
+
+\@Misc{		  c,
+  author        = {C. Three},
+  title	        = {Gamma},
+  note	        = other,
+  year	        = 2003
+}
+
+\@Article{	  d,
+  author        = {D. Four},
+  title	        = {Delta},
+  journal       = jgg,
+  year	        = 2004
+}
+
+\@Book{		  e,
+  author        = {E. Five},
+  title	        = {Epsilon},
+  year	        = 2005
+}
+__EOF__
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'sort_memory_limit_2',
+    args         => "-S -- sort.memory.limit=1",
+    bib	         => $bib,
+    expected_err => '',
+    expected_out => <<__EOF__);
+\@PREAMBLE{ "\\newcommand{\\x}{x}" }
+\@STRING{jgg     = {Journal of Gnats and Gnus} }
+\@STRING{other   = {Other} }
+
+\@Book{		  e,
+  author        = {E. Five},
+  title	        = {Epsilon},
+  year	        = 2005
+}
+
+\@Article{	  d,
+  author        = {D. Four},
+  title	        = {Delta},
+  journal       = jgg,
+  year	        = 2004
+}
+
+\@Misc{		  c,
+  author        = {C. Three},
+  title	        = {Gamma},
+  note	        = other,
+  year	        = 2003
+}
+
+\@Article{	  b,
+  author        = {B. Two},
+  title	        = {Beta},
+  journal       = jgg,
+  year	        = 2002
+}
+
+\@Misc{		  a,
+  author        = {A. One},
+  title	        = {Alpha},
+  year	        = 2001
+}
+__EOF__
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'sort_memory_limit_3',
+    args         => "-s -F -- sort.memory.limit=1",
+    bib	         => $bib,
+    expected_err => <<__EOF__,
+
+*** BibTool WARNING: Sorting in memory: key.generation needs all records.
+__EOF__
+    expected_out => <<__EOF__);
+\@PREAMBLE{ "\\newcommand{\\x}{x}" }
+\@STRING{jgg     = {Journal of Gnats and Gnus} }
+\@STRING{other   = {Other} }
+
+\@Article{,
+  author        = {D. Four},
+  title	        = {Delta},
+  journal       = jgg,
+  year	        = 2004
+}
+
+\@Article{,
+  author        = {B. Two},
+  title	        = {Beta},
+  journal       = jgg,
+  year	        = 2002
+}
+
+\@Book{,
+  author        = {E. Five},
+  title	        = {Epsilon},
+  year	        = 2005
+}
+
+\@Misc{,
+  author        = {A. One},
+  title	        = {Alpha},
+  year	        = 2001
+}
+
+\@Misc{,
+  author        = {C. Three},
+  title	        = {Gamma},
+  note	        = other,
+  year	        = 2003
+}
+__EOF__
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'sort_memory_limit_4',
+    args         => "-s -- 'sort.format={%N(author)}' -- sort.memory.limit=1",
+    bib	         => <<__EOF__,
+\@Book{p, author = {M. Zeta}, title = {Parent}}
+\@InBook{c, crossref = {p}, chapter = {1}}
+\@Book{q, author = {A. Alpha}, title = {Other}}
+__EOF__
+    expected_err => <<__EOF__,
+
+*** BibTool WARNING: Sorting in memory: sort.format needs all records.
+__EOF__
+    expected_out => <<__EOF__);
+
+\@Book{		  q,
+  author        = {A. Alpha},
+  title	        = {Other}
+}
+
+\@Book{		  p,
+  author        = {M. Zeta},
+  title	        = {Parent}
+}
+
+\@InBook{	  c,
+  crossref      = {p},
+  chapter       = {1}
+}
+__EOF__
+
+1;
+#------------------------------------------------------------------------------
+# Local Variables: 
+# mode: perl
+# End: 
@@ -0,0 +1,259 @@
+#!/usr/bin/env perl
+# =============================================================================
+#  
+#  This file is part of BibTool.
+#  It is distributed under the GNU General Public License.
+#  See the file COPYING for details.
+#  
+#  (c) 2020 Gerd Neugebauer
+#  
+#  Net: gene@gerd-neugebauer.de
+#  
+#  This program is free software; you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation; either version 2, or (at your option)
+#  any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software
+#  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+#
+#*=============================================================================
+
+=head1 NAME
+
+sort_merge.t - Test suite for BibTool sort.merge.
+
+=head1 SYNOPSIS
+
+sort_merge.t 
+
+=head1 DESCRIPTION
+
+This module contains some test cases. Running this module as program
+will run all test cases and print a summary for each. Optionally files
+*.out and *.err are left if the expected result does not match the
+actual result.
+
+=head1 OPTIONS
+
+none
+
+=head1 AUTHOR
+
+Gerd Neugebauer
+
+=cut
+
+
+use strict;
+use BUnit;use warnings;
+use FileHandle;
+
+
+my $bib = <<__EOF__;
+\@string{jgg = {Journal of Gnats and Gnus}}
+\@Article{a, author = {A. One}, title = {Alpha}, journal = jgg, year = 2001}
+\@Misc{c, author = {C. Three}, title = {Gamma}, year = 2003}
+\@Book{e, author = {E. Five}, title = {Epsilon}, year = 2005}
+__EOF__
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'sort_merge_1',
+    args         => "-s -- sort.merge=on _merge.bib",
+    prepare      => sub {
+      my $fd = new FileHandle("_merge.bib",'w') || die "_merge.bib: $!\n";
+      print $fd <<__EOF__;
+\@Misc{b, author = {B. Two}, title = {Beta}, year = 2002}
+\@Article{d, author = {D. Four}, title = {Delta}, journal = jgg, year = 2004}
+__EOF__
+      $fd->close();
+	   },
+    post         => sub { unlink('_merge.bib'); },
+    bib	         => $bib,
+    expected_err => '',
+    expected_out => <<__EOF__);
+\@STRING{jgg     = {Journal of Gnats and Gnus} }
+
+\@Article{	  a,
+  author        = {A. One},
+  title	        = {Alpha},
+  journal       = jgg,
+  year	        = 2001
+}
+
+\@Misc{		  b,
+  author        = {B. Two},
+  title	        = {Beta},
+  year	        = 2002
+}
+
+\@Misc{		  c,
+  author        = {C. Three},
+  title	        = {Gamma},
+  year	        = 2003
+}
+
+\@Article{	  d,
+  author        = {D. Four},
+  title	        = {Delta},
+  journal       = jgg,
+  year	        = 2004
+}
+
+\@Book{		  e,
+  author        = {E. Five},
+  title	        = {Epsilon},
+  year	        = 2005
+}
+__EOF__
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'sort_merge_2',
+    args         => "-s -d -- sort.merge=on _merge.bib",
+    prepare      => sub {
+      my $fd = new FileHandle("_merge.bib",'w') || die "_merge.bib: $!\n";
+      print $fd <<__EOF__;
+\@Misc{b, author = {B. Two}, title = {Beta}, year = 2002}
+\@Misc{c, author = {C. Three}, title = {Gamma}, year = 2003}
+\@Article{d, author = {D. Four}, title = {Delta}, journal = jgg, year = 2004}
+__EOF__
+      $fd->close();
+	   },
+    post         => sub { unlink('_merge.bib'); },
+    bib	         => $bib,
+    expected_err => <<__EOF__,
+*** BibTool WARNING (line 3 in _test.bib): Possible double entry discovered to (line 2 in _merge.bib) `c'
+__EOF__
+    expected_out => <<__EOF__);
+\@STRING{jgg     = {Journal of Gnats and Gnus} }
+
+\@Article{	  a,
+  author        = {A. One},
+  title	        = {Alpha},
+  journal       = jgg,
+  year	        = 2001
+}
+
+\@Misc{		  b,
+  author        = {B. Two},
+  title	        = {Beta},
+  year	        = 2002
+}
+
+\@Misc{		  c,
+  author        = {C. Three},
+  title	        = {Gamma},
+  year	        = 2003
+}
+
+###Misc{	  c,
+  author        = {C. Three},
+  title	        = {Gamma},
+  year	        = 2003
+}
+
+\@Article{	  d,
+  author        = {D. Four},
+  title	        = {Delta},
+  journal       = jgg,
+  year	        = 2004
+}
+
+\@Book{		  e,
+  author        = {E. Five},
+  title	        = {Epsilon},
+  year	        = 2005
+}
+__EOF__
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'sort_merge_3',
+    args         => "-s -- sort.merge=on _merge.bib",
+    prepare      => sub {
+      my $fd = new FileHandle("_merge.bib",'w') || die "_merge.bib: $!\n";
+      print $fd <<__EOF__;
+\@Article{d, author = {D. Four}, title = {Delta}, journal = jgg, year = 2004}
+\@Misc{b, author = {B. Two}, title = {Beta}, year = 2002}
+__EOF__
+      $fd->close();
+	   },
+    post         => sub { unlink('_merge.bib'); },
+    bib	         => $bib,
+    expected_err => '',
+    expected_out => <<__EOF__);
+\@STRING{jgg     = {Journal of Gnats and Gnus} }
+
+\@Article{	  a,
+  author        = {A. One},
+  title	        = {Alpha},
+  journal       = jgg,
+  year	        = 2001
+}
+
+\@Misc{		  b,
+  author        = {B. Two},
+  title	        = {Beta},
+  year	        = 2002
+}
+
+\@Misc{		  c,
+  author        = {C. Three},
+  title	        = {Gamma},
+  year	        = 2003
+}
+
+\@Article{	  d,
+  author        = {D. Four},
+  title	        = {Delta},
+  journal       = jgg,
+  year	        = 2004
+}
+
+\@Book{		  e,
+  author        = {E. Five},
+  title	        = {Epsilon},
+  year	        = 2005
+}
+__EOF__
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'sort_merge_4',
+    args         => "-s -- 'sort.format={%N(author)}' -- sort.merge=on",
+    bib	         => <<__EOF__,
+\@Book{p, author = {M. Zeta}, title = {Parent}}
+\@InBook{c, crossref = {p}, chapter = {1}}
+\@Book{q, author = {A. Alpha}, title = {Other}}
+__EOF__
+    expected_err => <<__EOF__,
+
+*** BibTool WARNING: Sorting in memory: sort.format needs all records.
+__EOF__
+    expected_out => <<__EOF__);
+
+\@Book{		  q,
+  author        = {A. Alpha},
+  title	        = {Other}
+}
+
+\@Book{		  p,
+  author        = {M. Zeta},
+  title	        = {Parent}
+}
+
+\@InBook{	  c,
+  crossref      = {p},
+  chapter       = {1}
+}
+__EOF__
+
+1;
+#------------------------------------------------------------------------------
+# Local Variables: 
+# mode: perl
+# End: 
@@ -0,0 +1,138 @@
+#!/usr/bin/env perl
+# =============================================================================
+#  
+#  This file is part of BibTool.
+#  It is distributed under the GNU General Public License.
+#  See the file COPYING for details.
+#  
+#  (c) 2020 Gerd Neugebauer
+#  
+#  Net: gene@gerd-neugebauer.de
+#  
+#  This program is free software; you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation; either version 2, or (at your option)
+#  any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software
+#  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+#
+#*=============================================================================
+
+=head1 NAME
+
+stream.t - Test suite for BibTool stream.
+
+=head1 SYNOPSIS
+
+stream.t 
+
+=head1 DESCRIPTION
+
+This module contains some test cases. Running this module as program
+will run all test cases and print a summary for each. Optionally files
+*.out and *.err are left if the expected result does not match the
+actual result.
+
+=head1 OPTIONS
+
+none
+
+=head1 AUTHOR
+
+Gerd Neugebauer
+
+=cut
+
+use strict;
+use BUnit;use warnings;
+
+
+my $bib = <<__EOF__;
+\@string{ acm = "ACM" }
+\@article{ b,
+  author  = "bb",
+  title	  = "the title",
+  note	  = "xx"
+}
+\@preamble{ "x" }
+\@book{ a,
+  title	  = "the title",
+  author  = "aa",
+  publisher = acm
+}
+__EOF__
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'stream_1',
+    args         => "-- stream=on -- 'delete.field={note}' -- 'sort.order={*=author#title}'",
+    bib	         => $bib,
+    expected_err => '',
+    expected_out => <<__EOF__);
+\@STRING{acm     = "ACM" }
+
+\@Article{	  b,
+  author        = "bb",
+  title	        = "the title"
+}
+\@PREAMBLE{ "x" }
+
+\@Book{		  a,
+  author        = "aa",
+  title	        = "the title",
+  publisher     = acm
+}
+__EOF__
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'stream_2',
+    args         => "-- stream=on -- 'select={author \"a\"}'",
+    bib	         => $bib,
+    expected_err => '',
+    expected_out => <<__EOF__);
+\@STRING{acm     = "ACM" }
+\@PREAMBLE{ "x" }
+
+\@Book{		  a,
+  title	        = "the title",
+  author        = "aa",
+  publisher     = acm
+}
+__EOF__
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'stream_3',
+    args         => "-- stream=on -s",
+    bib	         => $bib,
+    expected_err => <<__EOF__,
+
+*** BibTool WARNING: Streaming disabled: sort needs all records.
+__EOF__
+    expected_out => <<__EOF__);
+\@PREAMBLE{ "x" }
+\@STRING{acm     = "ACM" }
+
+\@Book{		  a,
+  title	        = "the title",
+  author        = "aa",
+  publisher     = acm
+}
+
+\@Article{	  b,
+  author        = "bb",
+  title	        = "the title",
+  note	        = "xx"
+}
+__EOF__
+
+1;
+#------------------------------------------------------------------------------
+# Local Variables: 
+# mode: perl
+# End:
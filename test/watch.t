@@ -0,0 +1,194 @@
+#!/usr/bin/env perl
+# =============================================================================
+#  
+#  This file is part of BibTool.
+#  It is distributed under the GNU General Public License.
+#  See the file COPYING for details.
+#  
+#  (c) 2020 Gerd Neugebauer
+#  
+#  Net: gene@gerd-neugebauer.de
+#  
+#  This program is free software; you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation; either version 2, or (at your option)
+#  any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program; if not, write to the Free Software
+#  Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+#
+#*=============================================================================
+
+=head1 NAME
+
+watch.t - Test suite for BibTool watch.
+
+=head1 SYNOPSIS
+
+watch.t 
+
+=head1 DESCRIPTION
+
+This module contains some test cases. Running this module as program
+will run all test cases and print a summary for each. Optionally files
+*.out and *.err are left if the expected result does not match the
+actual result.
+
+=head1 OPTIONS
+
+none
+
+=head1 AUTHOR
+
+Gerd Neugebauer
+
+=cut
+
+
+use strict;
+use BUnit;use warnings;
+use FileHandle;
+
+
+my $bib = <<__EOF__;
+\@Misc{b, title = {Beta}}
+\@Article{a, title = {Alpha}, year = 2001}
+__EOF__
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'watch_1',
+    args         => "-s -- watch=on",
+    stdin        => 1,
+    bib	         => $bib,
+    expected_err => <<__EOF__,
+
+*** BibTool WARNING: Watching disabled: the standard input can not be watched.
+__EOF__
+    expected_out => <<__EOF__);
+
+\@Article{	  a,
+  title	        = {Alpha},
+  year	        = 2001
+}
+
+\@Misc{		  b,
+  title	        = {Beta}
+}
+__EOF__
+
+#------------------------------------------------------------------------------
+BUnit::run(name  => 'watch_2',
+    args         => "-- watch=on -o _test.bib",
+    bib	         => $bib,
+    expected_err => <<__EOF__,
+
+*** BibTool WARNING: Watching disabled: the output file is an input file.
+__EOF__
+    expected_out => '');
+
+#------------------------------------------------------------------------------
+# Function:	prepare_edit
+# Arguments:	
+# Description:	Write the file watched and a script which starts BibTool in
+#		the background, waits for the output, changes the file,
+#		waits for the new output, and stops BibTool. The first
+#		argument of the script tells whether the file is written in
+#		place or replaced by renaming a new file. The output is
+#		printed before and after the change.
+#
+sub prepare_edit {
+  my $fd = new FileHandle("_watch.bib",'w') || die "_watch.bib: $!\n";
+  print $fd $bib;
+  $fd->close();
+  $fd = new FileHandle("_watch.sh",'w') || die "_watch.sh: $!\n";
+  print $fd <<'__EOF__';
+mode=$1; shift
+"$@" -o _watch.out &
+pid=$!
+wait_for () {
+  for i in 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17 18 19 20; do
+    grep -q "$1" _watch.out 2>/dev/null && break
+    sleep 0.5
+  done
+  sleep 0.5
+}
+wait_for Beta
+cat _watch.out
+echo '@Book{c, title = {Gamma}}' >_watch.new
+cat _watch.bib >>_watch.new
+if [ "$mode" = mv ]; then mv _watch.new _watch.bib
+else cat _watch.new >_watch.bib; rm -f _watch.new
+fi
+wait_for Gamma
+kill $pid
+wait $pid 2>/dev/null
+cat _watch.out
+__EOF__
+  $fd->close();
+}
+
+#------------------------------------------------------------------------------
+# Function:	post_edit
+# Arguments:	
+# Description:	Remove the files written by prepare_edit and the script.
+#
+sub post_edit {
+  unlink('_watch.bib', '_watch.sh', '_watch.out', '_watch.new');
+}
+
+my $edited = <<__EOF__;
+
+\@Article{	  a,
+  title	        = {Alpha},
+  year	        = 2001
+}
+
+\@Misc{		  b,
+  title	        = {Beta}
+}
+
+\@Article{	  a,
+  title	        = {Alpha},
+  year	        = 2001
+}
+
+\@Misc{		  b,
+  title	        = {Beta}
+}
+
+\@Book{		  c,
+  title	        = {Gamma}
+}
+__EOF__
+
+#------------------------------------------------------------------------------
+{ local $BUnit::BIBTOOL = "sh _watch.sh cat $BUnit::BIBTOOL";
+  BUnit::run(name  => 'watch_3',
+    args         => "-s -- watch=on _watch.bib",
+    prepare      => \&prepare_edit,
+    post         => \&post_edit,
+    expected_err => '',
+    expected_out => $edited);
+}
+
+#------------------------------------------------------------------------------
+{ local $BUnit::BIBTOOL = "sh _watch.sh mv $BUnit::BIBTOOL";
+  BUnit::run(name  => 'watch_4',
+    args         => "-s -- watch=on _watch.bib",
+    prepare      => \&prepare_edit,
+    post         => \&post_edit,
+    expected_err => '',
+    expected_out => $edited);
+}
+
+1;
+#------------------------------------------------------------------------------
+# Local Variables: 
+# mode: perl
+# End: 
@@ -32,7 +32,7 @@
 #include <bibtool/key.h>
 #include <bibtool/symbols.h>
 #include <bibtool/sbuffer.h>
-#include <bibtool/wordlist.h>
+#include <bibtool/record.h>
 
 /*****************************************************************************/
 /* Internal Programs                                                         */
@@ -46,6 +46,8 @@
 #define _ARG(A) ()
 #endif
  static void save_ref _ARG((String s));
+ static void aux_follow_1 _ARG((DB db,Symbol value,bool listp));/*           */
+ static void aux_free _ARG((void *state));	   /*                        */
 
 /*****************************************************************************/
 /* External Programs                                                         */
@@ -53,20 +55,64 @@
 
 /*---------------------------------------------------------------------------*/
 
- static StringBuffer* aux_sb = (StringBuffer*)0;
+/*-----------------------------------------------------------------------------
+** Typedef*:	SAuxState
+** Purpose:	The state of the tex_aux module in a context. It
+**		contains the keys cited, the keys referenced as
+**		crossref or xdata targets, and the keys seen.
+**___________________________________________________			     */
+ typedef struct					   /*                        */
+ { StringBuffer *aux_sb;			   /*                        */
+   bool		cite_star;			   /* all keys are cited     */
+   SKeySet	cite;				   /* the cited keys         */
+   SKeySet	xref;				   /* the referenced keys    */
+   SKeySet	seen;				   /* the keys seen          */
+   int		rescan;				   /*                        */
+ } SAuxState;					   /*                        */
+
+/*-----------------------------------------------------------------------------
+** Variable*:	aux_state0
+** Type:	SAuxState
+** Purpose:	The initial state of the tex_aux module in a context.
+**___________________________________________________			     */
+ static SAuxState aux_state0 =			   /*                        */
+ { (StringBuffer*)0,				   /*                        */
+   true,					   /*                        */
+   { (Symbol*)NULL, 0, 0 },			   /*                        */
+   { (Symbol*)NULL, 0, 0 },			   /*                        */
+   { (Symbol*)NULL, 0, 0 },			   /*                        */
+   -1						   /*                        */
+ };						   /*                        */
 
- static bool cite_star       = true;
+#define AuxState ((SAuxState*)CtxGet(CTX_TEX_AUX,			\
+				     ctx_state(CTX_TEX_AUX,		\
+					       (void*)&aux_state0,	\
+					       sizeof(aux_state0),	\
+					       aux_free)))
 
- static WordList cite[32]    = 
- { WordNULL, WordNULL, WordNULL, WordNULL,
-   WordNULL, WordNULL, WordNULL, WordNULL,
-   WordNULL, WordNULL, WordNULL, WordNULL,
-   WordNULL, WordNULL, WordNULL, WordNULL,
-   WordNULL, WordNULL, WordNULL, WordNULL,
-   WordNULL, WordNULL, WordNULL, WordNULL,
-   WordNULL, WordNULL, WordNULL, WordNULL,
-   WordNULL, WordNULL, WordNULL, WordNULL
- };
+#define aux_sb	  (AuxState->aux_sb)
+#define cite_star (AuxState->cite_star)
+#define cite	  (AuxState->cite)
+#define xref	  (AuxState->xref)
+#define seen	  (AuxState->seen)
+#define rescan	  (AuxState->rescan)
+
+/*-----------------------------------------------------------------------------
+** Function*:	aux_free()
+** Purpose:	Release the key sets when a context is released.
+** Arguments:
+**	state	the state
+** Returns:	nothing
+**___________________________________________________			     */
+static void aux_free(state)			   /*                        */
+  void *state;					   /*                        */
+{ POSSIBLY_UNUSED(state);			   /*                        */
+  clear_aux();					   /*                        */
+  if (cite.ks_tab) free(cite.ks_tab);		   /*                        */
+  if (xref.ks_tab) free(xref.ks_tab);		   /*                        */
+  if (seen.ks_tab) free(seen.ks_tab);		   /*                        */
+  if (aux_sb) (void)sbclose(aux_sb);		   /*                        */
+}						   /*------------------------*/
 
 /*-----------------------------------------------------------------------------
 ** Function:	clear_aux()
@@ -75,10 +121,23 @@
 ** Returns:	nothing
 **___________________________________________________			     */
 void clear_aux()				   /*                        */
-{ int i;					   /*                        */
-  cite_star = true;				   /*                        */
-  for (i = 0; i < 32; i++)			   /*                        */
-  { free_words(&cite[i], sym_unlink); }		   /*                        */
+{ cite_star = true;				   /*                        */
+  ks_clear(&cite);				   /*                        */
+  ks_clear(&xref);				   /*                        */
+  ks_clear(&seen);				   /*                        */
+  rescan = -1;					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	aux_selecting()
+** Type:	bool
+** Purpose:	Check whether an aux file restricts the entries to
+**		the ones cited.
+** Arguments:	none
+** Returns:	|true| iff not all entries are cited.
+**___________________________________________________			     */
+bool aux_selecting()				   /*                        */
+{ return !cite_star;				   /*                        */
 }						   /*------------------------*/
 
 /*-----------------------------------------------------------------------------
@@ -92,8 +151,10 @@ void clear_aux()				   /*                        */
 bool foreach_aux(fct)				   /*                        */
   bool (fct)_ARG((Symbol));			   /*                        */
 { int i;					   /*                        */
-  for (i = 0; i < 32; i++)			   /*                        */
-  { foreach_word(cite[i], fct); }		   /*                        */
+  for (i = 0; i < cite.ks_size; i++)		   /*                        */
+  { if (cite.ks_tab[i] != NO_SYMBOL)		   /*                        */
+    { (void)(*fct)(cite.ks_tab[i]); }		   /*                        */
+  }						   /*                        */
   return cite_star;				   /*                        */
 }						   /*------------------------*/
 
@@ -113,7 +174,7 @@ static void save_ref(key)			   /*                        */
  						   /*                        */
   if (*key == '*' && *(key+1) == '\0')		   /*                        */
   { clear_aux(); }				   /*                        */
-  else { add_word(symbol(key), &cite[*key&31]); }  /*                        */
+  else { ks_add(&cite, symbol(key)); }		   /*                        */
 }						   /*------------------------*/
 
 /*-----------------------------------------------------------------------------
@@ -129,8 +190,148 @@ bool aux_used(s)				   /*                        */
   Symbol s;					   /*                        */
 {						   /*                        */
   return cite_star				   /*                        */
-    || find_word(SymbolValue(s),		   /*                        */
-		 cite[*SymbolValue(s)&31]);	   /*                        */
+    || ks_find(&cite, SymbolValue(s));		   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	aux_skipping()
+** Type:	bool
+** Purpose:	Check whether records which are not requested by the
+**		aux file can be skipped while reading the \BibTeX{}
+**		files. This is the case if the resource |extract.fast|
+**		is on and the aux file does not request all entries.
+** Arguments:	none
+** Returns:	|true| iff the records can be skipped.
+**___________________________________________________			     */
+bool aux_skipping()				   /*                        */
+{ return rsc_extract_fast && !cite_star;	   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	aux_wanted()
+** Type:	bool
+** Purpose:	Check whether a record with the given key has to be
+**		read. This is the case if the key is cited or it is
+**		the target of a crossref or xdata field of a record
+**		read before.
+** Arguments:
+**	key	the reference key
+** Returns:	|true| iff the record is required.
+**___________________________________________________			     */
+bool aux_wanted(key)				   /*                        */
+  Symbol key;					   /*                        */
+{ if (rescan >= 0)				   /* Only missing targets   */
+  { return ks_find(&xref, SymbolValue(key))	   /*  are read again        */
+      && !ks_find(&seen, SymbolValue(key));	   /*                        */
+  }						   /*                        */
+  return cite_star				   /*                        */
+    || ks_find(&cite, SymbolValue(key))		   /*                        */
+    || ks_find(&xref, SymbolValue(key));	   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	aux_rescan()
+** Type:	bool
+** Purpose:	Check whether the \BibTeX{} files have to be read
+**		again since some crossref or xdata targets have been
+**		skipped. This happens if a target precedes the record
+**		referring to it. In this case the following reading
+**		passes only read the records still missing. No further
+**		pass is requested if the previous one has not found
+**		any new record.
+** Arguments:	none
+** Returns:	|true| iff another reading pass is required.
+**___________________________________________________			     */
+bool aux_rescan()				   /*                        */
+{ int i;					   /*                        */
+ 						   /*                        */
+  if (!aux_skipping()				   /*                        */
+      || seen.ks_used == rescan) return false;	   /* No progress            */
+ 						   /*                        */
+  for (i = 0; i < xref.ks_size; i++)		   /*                        */
+  { if (xref.ks_tab[i] != NO_SYMBOL &&		   /*                        */
+	!ks_find(&seen, SymbolValue(xref.ks_tab[i])))/*                      */
+    { rescan = seen.ks_used;			   /*                        */
+      return true;				   /*                        */
+    }						   /*                        */
+  }						   /*                        */
+  return false;					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	aux_rescanning()
+** Type:	bool
+** Purpose:	Check whether the \BibTeX{} files are read again to
+**		pick up skipped crossref or xdata targets. In this
+**		case only the missing normal records are wanted. All
+**		other records have been taken from the first pass.
+** Arguments:	none
+** Returns:	|true| iff a rescan pass is in progress.
+**___________________________________________________			     */
+bool aux_rescanning()				   /*                        */
+{ return aux_skipping() && rescan >= 0;		   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	aux_follow_1()
+** Purpose:	Remember the keys contained in the value of a crossref
+**		or xdata field as required.
+** Arguments:
+**	db	the database
+**	value	the field value
+**	listp	indicator that the value is a comma separated list
+** Returns:	nothing
+**___________________________________________________			     */
+static void aux_follow_1(db, value, listp)	   /*                        */
+  DB     db;					   /*                        */
+  Symbol value;					   /*                        */
+  bool   listp;					   /*                        */
+{ String s;					   /*                        */
+  Symbol key;					   /*                        */
+ 						   /*                        */
+  if (value == NO_SYMBOL) return;		   /*                        */
+  if (aux_sb == (StringBuffer*)0)		   /*                        */
+  { aux_sb = sbopen(); }			   /*                        */
+ 						   /*                        */
+  value = expand_rhs(value, sym_empty, sym_empty, db, true);/*               */
+  for (s = SymbolValue(value); ; s++)		   /*                        */
+  { if (*s == '\0' || (listp && *s == ','))	   /*                        */
+    { key = symbol((String)sbflush(aux_sb));	   /*                        */
+      sbrewind(aux_sb);				   /*                        */
+      if (*SymbolValue(key)) ks_add(&xref, key);   /*                        */
+      if (*s == '\0') break;			   /*                        */
+    }						   /*                        */
+    else if (!is_space(*s))			   /*                        */
+    { (void)sbputchar(*s, aux_sb); }		   /*                        */
+  }						   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	aux_follow()
+** Type:	void
+** Purpose:	Register the targets of the crossref and xdata fields
+**		of a record which has been read while skipping records.
+**		Records with these keys are kept when they are
+**		encountered later on. Targets which have already been
+**		skipped are picked up by |aux_rescan()|.
+** Arguments:
+**	db	the database
+**	rec	the record
+** Returns:	nothing
+**___________________________________________________			     */
+void aux_follow(db, rec)			   /*                        */
+  DB     db;					   /*                        */
+  Record rec;					   /*                        */
+{ Symbol *hp;					   /*                        */
+  int    i;					   /*                        */
+ 						   /*                        */
+  if (*RecordHeap(rec)) ks_add(&seen, *RecordHeap(rec));/*                   */
+  for (i = RecordFree(rec), hp = RecordHeap(rec); i > 0; i -= 2, hp += 2)/*  */
+  { if (*hp == sym_crossref)			   /*                        */
+    { aux_follow_1(db, hp[1], false); }		   /*                        */
+    else if (*hp == sym_xdata)			   /*                        */
+    { aux_follow_1(db, hp[1], true); }		   /*                        */
+  }						   /*                        */
 }						   /*------------------------*/
 
 /*-----------------------------------------------------------------------------
@@ -247,15 +448,11 @@ bool read_aux(fname, fct, verbose)		   /*                        */
 						   /*                        */
 #ifdef DEBUG
   { register int i;				   /*                        */
-    WordList wl;				   /*			     */
 						   /*			     */
-    for (i = 0; i < 32; ++i)			   /*                        */
-    { ErrPrintF("--- BibTool: %d\n", i);	   /*                        */
-      for (wl = cite[i];			   /*                        */
-	   wl != WordNULL;			   /*                        */
-	   wl = NextWord(wl) )			   /*		             */
+    for (i = 0; i < cite.ks_size; ++i)		   /*                        */
+    { if (cite.ks_tab[i] != NO_SYMBOL)		   /*                        */
       { ErrPrintF("%s\n",			   /*                        */
-		  SymbolValue(ThisWord(wl))); }	   /*			     */
+		  SymbolValue(cite.ks_tab[i])); }  /*			     */
     }		   	   			   /*                        */
   }						   /*                        */
 #endif
@@ -297,8 +494,8 @@ bool apply_aux(db)				   /*                        */
 	rec != RecordNULL;			   /*  Mark all entries      */
 	rec = NextRecord(rec) )			   /*  contained in the aux  */
   { if (*RecordHeap(rec) &&		   	   /*  file and unmark the   */
-	find_word(SymbolValue(*RecordHeap(rec)),   /*  others.               */
-		  cite[(*SymbolValue(*RecordHeap(rec)))&31]) )/*             */
+	ks_find(&cite,				   /*  others.               */
+		SymbolValue(*RecordHeap(rec))) )   /*                        */
     { SetRecordMARK(rec); }			   /*                        */
     else					   /*                        */
     { ClearRecordMARK(rec); }			   /*                        */
@@ -114,6 +114,9 @@
  void TeX_open_file _ARG((FILE * file));	   /* tex_read.c             */
  void TeX_open_string _ARG((String s));		   /* tex_read.c             */
  void TeX_reset _ARG((void));			   /* tex_read.c             */
+#ifndef STANDALONE
+ static void tex_free _ARG((void *state));	   /* tex_read.c             */
+#endif
 
 #ifdef STANDALONE
  int main _ARG((int argc,char *argv[]));	   /* tex_read.c             */
@@ -161,10 +164,78 @@
 
 #define CATCODE_MASK		0x0F00
 
- static short int catcode[256];
+/*-----------------------------------------------------------------------------
+** Typedef*:	STexState
+** Purpose:	The state of the tex_read module in a context. It
+**		contains the catcodes, the macros, the tokens, and the
+**		source read.
+**___________________________________________________			     */
+ typedef struct					   /*                        */
+ { short int catcode[256];			   /*                        */
+   MacDef    macro;				   /* the macros             */
+   MacDef    active[256];			   /* the active characters  */
+   bool	     tex_initialized;			   /*                        */
+   Token     token_free_list;			   /*                        */
+   int	     tex_state;				   /*                        */
+   Token     tex_line;				   /*                        */
+   String    g_s;				   /*                        */
+   String    g_p;				   /*                        */
+   FILE	     *src_file;				   /*                        */
+   String    src_string;			   /*                        */
+   String    src_ptr;				   /*                        */
+   int	     (*src_get)();			   /*                        */
+   Token     tr_t;				   /* used in TeX_read()     */
+   Token     tr_old_t;				   /* used in TeX_read()     */
+   Token     tr_arg[10];			   /* used in TeX_read()     */
+ } STexState;					   /*                        */
+
+/*-----------------------------------------------------------------------------
+** Variable*:	tex_state0
+** Type:	STexState
+** Purpose:	The initial state of the tex_read module in a context.
+**		The state is initialized by |init_TeX()|.
+**___________________________________________________			     */
+ static STexState tex_state0 =			   /*                        */
+ { { 0 },					   /*                        */
+   MacDefNULL,					   /*                        */
+   { MacDefNULL },				   /*                        */
+   false,					   /*                        */
+   TokenNULL,					   /*                        */
+   0,						   /*                        */
+   TokenNULL,					   /*                        */
+   StringNULL,					   /*                        */
+   StringNULL,					   /*                        */
+   NULL,					   /*                        */
+   StringNULL,					   /*                        */
+   StringNULL,					   /*                        */
+   get_EOF,					   /*                        */
+   TokenNULL,					   /*                        */
+   TokenNULL,					   /*                        */
+   { TokenNULL }				   /*                        */
+ };						   /*                        */
+
+#ifdef STANDALONE
+#define TexState (&tex_state0)
+#else
+#define TexState ((STexState*)CtxGet(CTX_TEX_READ,			\
+				     ctx_state(CTX_TEX_READ,		\
+					       (void*)&tex_state0,	\
+					       sizeof(tex_state0),	\
+					       tex_free)))
+#endif
 
- static MacDef macro	   = MacDefNULL;
- static MacDef active[256];
+#define catcode		(TexState->catcode)
+#define macro		(TexState->macro)
+#define active		(TexState->active)
+#define token_free_list	(TexState->token_free_list)
+#define tex_state	(TexState->tex_state)
+#define tex_line	(TexState->tex_line)
+#define g_s		(TexState->g_s)
+#define g_p		(TexState->g_p)
+#define src_file	(TexState->src_file)
+#define src_string	(TexState->src_string)
+#define src_ptr		(TexState->src_ptr)
+#define src_get		(TexState->src_get)
 
 #define EnsureInit init_TeX()
 
@@ -181,10 +252,9 @@
 **___________________________________________________			     */
 static void init_TeX()				   /*			     */
 { register int i;				   /*			     */
-  static bool  initialized = false;		   /*			     */
 						   /*			     */
-  if (initialized) return;			   /*			     */
-  initialized = true;				   /*			     */
+  if (TexState->tex_initialized) return;	   /*                        */
+  TexState->tex_initialized = true;		   /*                        */
 						   /*			     */
   for (i = 0; i < 256; ++i)			   /*			     */
   { active[i]  = MacDefNULL;			   /*			     */
@@ -211,7 +281,6 @@ static void init_TeX()				   /*			     */
 /*** Token Management.							   ***/
 /*****************************************************************************/
 
- static Token token_free_list = TokenNULL;
 
 /*-----------------------------------------------------------------------------
 ** Function*:	new_token()
@@ -365,8 +434,6 @@ static String tokens_to_string(t)		   /*			     */
 #define StateM 1
 #define StateS 2
 
- static int   tex_state = StateN;		   /*			     */
- static Token tex_line	= TokenNULL;		   /*			     */
 
 #define tex_clear tex_state = StateN; tex_line = TokenNULL
 
@@ -499,8 +566,6 @@ static Token TeX_get_token(get_fct)		   /*			     */
   }						   /*			     */
 }						   /*------------------------*/
 
- static String g_s;				   /*			     */
- static String g_p;				   /*			     */
 
 /*-----------------------------------------------------------------------------
 ** Function:	init_get()
@@ -763,10 +828,6 @@ static int get_EOF()				   /*			     */
 { return EOF;					   /*			     */
 }						   /*------------------------*/
 
- static FILE  *src_file;			   /*			     */
- static String src_string;			   /*			     */
- static String src_ptr;				   /*			     */
- static int  (*src_get)() = get_EOF;		   /*			     */
 
 /*-----------------------------------------------------------------------------
 ** Function:	get_string()
@@ -854,6 +915,10 @@ static bool fill_token(tp)			   /*			     */
 #define UnlinkToken(T,T2)		T2 = T; T = NextToken(T)
 #define UnlinkAndFreeToken(T,T2)	UnlinkToken(T,T2); free_1_token(T2)
 
+#define t     (TexState->tr_t)
+#define old_t (TexState->tr_old_t)
+#define arg   (TexState->tr_arg)
+
 /*-----------------------------------------------------------------------------
 ** Function:	TeX_read()
 ** Purpose:	Read a single Token and return it as a pair consisting
@@ -867,10 +932,7 @@ static bool fill_token(tp)			   /*			     */
 bool TeX_read(cp, sp)				   /*			     */
   String	cp;				   /*			     */
   String	*sp;				   /*			     */
-{ static Token	t     = TokenNULL;		   /*			     */
-  static Token	old_t = TokenNULL;		   /*			     */
-  static Token	arg[10];			   /*			     */
-  Token		t2, tp;				   /*			     */
+{ Token		t2, tp;				   /*			     */
   int		i, d;				   /*			     */
 						   /*			     */
   EnsureInit;					   /*			     */
@@ -943,6 +1005,32 @@ bool TeX_read(cp, sp)				   /*			     */
   return false;					   /*			     */
 }						   /*------------------------*/
 
+#undef t
+#undef old_t
+#undef arg
+
+#ifndef STANDALONE
+/*-----------------------------------------------------------------------------
+** Function*:	tex_free()
+** Purpose:	Release the macros and tokens when a context is
+**		released.
+** Arguments:
+**	state	the state
+** Returns:	nothing
+**___________________________________________________			     */
+static void tex_free(state)			   /*                        */
+  void	*state;					   /*                        */
+{ Token tok;					   /*                        */
+  POSSIBLY_UNUSED(state);			   /*                        */
+ 						   /*                        */
+  TeX_reset();					   /*                        */
+  while ( (tok = token_free_list) != TokenNULL )   /*                        */
+  { token_free_list = NextToken(tok);		   /*                        */
+    free(tok);					   /*                        */
+  }						   /*                        */
+}						   /*------------------------*/
+#endif
+
 
 /*****************************************************************************/
 /***			 Stand alone version     			   ***/
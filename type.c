@@ -43,6 +43,16 @@
 #define INIT_TYPE
 #include <bibtool/general.h>
 #include <bibtool/type.h>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif
+
+#ifdef __STDC__
+#define _ARG(A) A
+#else
+#define _ARG(A) ()
+#endif
+ static void init_trans _ARG((void));		   /*                        */
 
 /*****************************************************************************/
 /* External Programs                                                         */
@@ -53,12 +63,64 @@
 #define to_lower(C)           ((C) + 'a'-'A')
 #define to_upper(C)           ((C) + 'A'-'a')
 
+/*-----------------------------------------------------------------------------
+** Variable*:	type_state0
+** Type:	STypeState
+** Purpose:	The initial state of the type module in a context. No
+**		additional word separators are declared.
+**___________________________________________________			     */
+ static STypeState type_state0;			   /*                        */
+
+/*-----------------------------------------------------------------------------
+** Function:	type_state()
+** Type:	STypeState*
+** Purpose:	Create the state of the type module in the current
+**		context. This function is used by the macro
+**		|TypeState| when the state does not exist yet.
+** Arguments:	none
+** Returns:	the state
+**___________________________________________________			     */
+STypeState * type_state()			   /*                        */
+{ return (STypeState*)ctx_state(CTX_TYPE,	   /*                        */
+				(void*)&type_state0,/*                       */
+				sizeof(type_state0),/*                       */
+				NULL);		   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	init_trans()
+** Purpose:	Fill the translation tables. They are shared by all
+**		contexts.
+** Arguments:	none
+** Returns:	nothing
+**___________________________________________________			     */
+static void init_trans()			   /*                        */
+{ register unsigned short int i;		   /*                        */
+ 						   /*                        */
+  for ( i = 0; i < 256; ++i )			   /*                        */
+  { trans_lower[i] = is_upper(i) ? to_lower(i) : i;/*                        */
+    trans_upper[i] = is_lower(i) ? to_upper(i) : i;/*                        */
+    trans_id[i] = i;				   /*                        */
+  }						   /*                        */
+}						   /*------------------------*/
+
+#ifdef HAVE_PTHREAD_H
+/*-----------------------------------------------------------------------------
+** Variable*:	type_once
+** Type:	pthread_once_t
+** Purpose:	The guard ensuring that the translation tables are
+**		filled once only, even if several threads initialize
+**		their contexts at the same time.
+**___________________________________________________			     */
+ static pthread_once_t type_once = PTHREAD_ONCE_INIT;/*                      */
+#endif
+
 /*-----------------------------------------------------------------------------
 ** Function:	init_type()
 ** Purpose:	This is the initialization routine for this file. This
 **		has to be called before some of the macros in |type.h|
 **		will work as described. It does no harm to call this
-**		initialization more than once. It just takes some time.
+**		initialization more than once.
 **
 **		Note that this function is for internal purposes
 **		only. The normal user should call |init_bibtool()|
@@ -67,20 +129,20 @@
 ** Returns:	nothing
 **___________________________________________________			     */
 void init_type()				   /*                        */
-{ register unsigned short int i;		   /*                        */
- 						   /*                        */
-  for ( i = 0; i < 256; ++i )			   /*                        */
-  { trans_lower[i] = is_upper(i) ? to_lower(i) : i;/*                        */
-    trans_upper[i] = is_lower(i) ? to_upper(i) : i;/*                        */
-    trans_id[i] = i;				   /*                        */
-  }						   /*                        */
+{						   /*                        */
+#ifdef HAVE_PTHREAD_H
+  (void)pthread_once(&type_once, init_trans);	   /*                        */
+#else
+  init_trans();					   /*                        */
+#endif
 }						   /*------------------------*/
 
 /*-----------------------------------------------------------------------------
 ** Function:	add_word_sep()
 ** Type:	void
 ** Purpose:	
-**		Mark some characters as word separator.
+**		Mark some characters as word separator. The
+**		separators belong to the current context.
 ** Arguments:
 **	s	the allowed word separator characters
 ** Returns:	nothing
@@ -90,7 +152,7 @@ void add_word_sep(s)				   /*                        */
 {						   /*                        */
   if ( s == StringNULL ) return;		   /*                        */
   for ( ; *s ; s++ )				   /*                        */
-  { type__allowed[*s] |= T__WordSep; }		   /*                        */
+  { TypeState->ty_wordsep[*s] = 1; }		   /*                        */
 }						   /*------------------------*/
 
 #ifdef DEBUG
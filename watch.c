@@ -0,0 +1,298 @@
+/*** watch.c ******************************************************************
+**
+** This file is part of BibTool.
+** It is distributed under the GNU General Public License.
+** See the file COPYING for details.
+**
+** (c) 2020 Gerd Neugebauer
+**
+** Net: gene@gerd-neugebauer.de
+**
+** This program is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation; either version 2, or (at your option)
+** any later version.
+**
+** This program is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with this program; if not, write to the Free Software
+** Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+**
+**-----------------------------------------------------------------------------
+** Description:
+**	This module contains the watch mode of \BibTool{}. The input
+**	files are read and processed. Then the output is written
+**	anew whenever one of the input files changes. The
+**	processing itself is left to the caller.
+**
+******************************************************************************/
+
+#include <bibtool/general.h>
+#include <bibtool/error.h>
+#include <bibtool/database.h>
+#include <bibtool/symbols.h>
+#include <bibtool/parse.h>
+#include <bibtool/tex_aux.h>
+#include <bibtool/rsc.h>
+#include <bibtool/io.h>
+#include <bibtool/watch.h>
+#include "config.h"
+#ifdef HAVE_SYS_INOTIFY_H
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+/*****************************************************************************/
+/* Internal Programs							     */
+/*===========================================================================*/
+
+#ifdef __STDC__
+#define _ARG(A) A
+#else
+#define _ARG(A) ()
+#endif
+#ifdef HAVE_SYS_INOTIFY_H
+ static void watch_record _ARG((DB db));	   /* watch.c                */
+#endif
+
+/*****************************************************************************/
+/* External Programs and Variables					     */
+/*===========================================================================*/
+
+/*---------------------------------------------------------------------------*/
+
+#define NoFileError(X)	      WARNING3("File ", SymbolValue(X), " not found.")
+
+#ifdef HAVE_SYS_INOTIFY_H
+/*-----------------------------------------------------------------------------
+** Function:	watch_possible()
+** Type:	bool
+** Purpose:	Check whether the input files can be watched. This is
+**		not the case for the standard input, if an aux file
+**		selects the entries, or if writing the output would
+**		trigger another pass. Then a warning is issued.
+** Arguments:	none
+** Returns:	|true| iff watching is possible.
+**___________________________________________________			     */
+bool watch_possible()			   /*                        */
+{ char *why = NULL;				   /*                        */
+  int  i;					   /*                        */
+ 						   /*                        */
+  if (aux_selecting())				   /*                        */
+  { why = "the entries are selected by an aux file."; }/*                    */
+  for (i = 0; why == NULL && i < get_no_inputs(); i++)/*                     */
+  { if (get_input_file(i) == NO_SYMBOL)		   /*                        */
+    { why = "the standard input can not be watched."; }/*                    */
+    else if (get_input_file(i) == get_output_file())/*                       */
+    { why = "the output file is an input file."; } /*                        */
+  }						   /*                        */
+  if (why == NULL) return true;			   /*                        */
+  WARNING2("Watching disabled: ", why);		   /*                        */
+  return false;					   /*                        */
+}						   /*------------------------*/
+
+#define WATCH_DELAY  100
+#define WATCH_EVENTS (IN_CLOSE_WRITE | IN_MOVED_TO)
+
+ static Record watch_last = RecordNULL;
+ static bool (*watch_fct)_ARG((DB db, Record rec)) = NULL;
+
+/*-----------------------------------------------------------------------------
+** Function*:	watch_record()
+** Type:	void
+** Purpose:	Process a normal record just read into the database of
+**		its file with the function given to |watch_in_files()|.
+**		Thus only the records of a changed file are processed
+**		again. This function is installed as record hook of
+**		|read_db()|.
+** Arguments:
+**	db	the database
+** Returns:	nothing
+**___________________________________________________			     */
+static void watch_record(db)			   /*                        */
+  DB db;					   /*                        */
+{ Record rec = DBnormal(db);			   /*                        */
+ 						   /*                        */
+  if (rec == RecordNULL || rec == watch_last) return;/*                      */
+  watch_last = rec;				   /*                        */
+ 						   /*                        */
+  (void)(*watch_fct)(db, rec);			   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	watch_in_files()
+** Type:	bool
+** Purpose:	Read each input file into a database of its own and
+**		process the records of all files. Then wait for changes
+**		of the input files. Only a changed file is read again.
+**		The records of all files are copied and processed again
+**		and the output is written anew.
+**
+**		If a function |fct| is given then it is applied to each
+**		normal record while its file is read, e.g.\ to select
+**		and rewrite it. The records of each file are sorted as
+**		well if sorting is requested. Then |process| only has
+**		to merge the sorted records of all files and to check
+**		them.
+**
+**		The directories of the files are watched with inotify,
+**		since editors often replace a file instead of writing
+**		it. The events arriving within |WATCH_DELAY|
+**		milliseconds are collected before the files are read.
+**		Thus a file saved in several steps is read only once.
+** Arguments:
+**	fct	the function applied to each record read or |NULL|
+**	less	the comparison for sorting
+**	process	the function processing and writing the copies of
+**		the records of all files
+** Returns:	|false| if inotify is not available. Otherwise it only
+**		returns |true| when waiting fails.
+**___________________________________________________			     */
+bool watch_in_files(fct, less, process)		   /*                        */
+  bool	 (*fct)_ARG((DB db, Record rec));	   /*                        */
+  int	 (*less)_ARG((Record, Record));		   /*                        */
+  void	 (*process)_ARG((DB db,			   /*                        */
+			 int (*less)_ARG((Record, Record))));/*              */
+{ int	 n = get_no_inputs();			   /*                        */
+  DB	 *dbs;					   /* the records of a file  */
+  Symbol *base;					   /* its name in the dir    */
+  int	 *wd;					   /* the watch of the dir   */
+  bool	 *changed;				   /*                        */
+  int	 fd, i, k, timeout;			   /*                        */
+  long	 buf[1024];				   /* the events; aligned    */
+  char	 *p, *dir;				   /*                        */
+  ssize_t len;					   /*                        */
+  struct inotify_event *ev;			   /*                        */
+  struct pollfd pfd;				   /*                        */
+  DB	 db;					   /*                        */
+  bool	 watching = true;			   /*                        */
+  bool	 per_record = (fct != NULL);		   /*                        */
+ 						   /*                        */
+  if ((fd = inotify_init()) < 0)		   /*                        */
+  { WARNING("Watching disabled: inotify is not available.");/*               */
+    return false;				   /*                        */
+  }						   /*                        */
+  dbs	  = (DB*)malloc(n * sizeof(DB));	   /*                        */
+  base	  = (Symbol*)malloc(n * sizeof(Symbol));   /*                        */
+  wd	  = (int*)malloc(n * sizeof(int));	   /*                        */
+  changed = (bool*)malloc(n * sizeof(bool));	   /*                        */
+  if (dbs == NULL || base == NULL || wd == NULL || changed == NULL)/*        */
+  { OUT_OF_MEMORY("watch"); }			   /*                        */
+  if (per_record)				   /*                        */
+  { watch_fct = fct;				   /*                        */
+    set_record_hook(watch_record);		   /*                        */
+  }						   /*                        */
+ 						   /*                        */
+  for (i = 0; i < n; i++)			   /*                        */
+  { dbs[i] = new_db();				   /*                        */
+    wd[i]  = -1;				   /*                        */
+    watch_last = RecordNULL;			   /*                        */
+    if (read_db(dbs[i], SymbolValue(get_input_file(i)), rsc_verbose))/*      */
+    { NoFileError(get_input_file(i));		   /*                        */
+      continue;					   /*                        */
+    }						   /*                        */
+    if (per_record && rsc_sort) { db_sort(dbs[i], less); }/*                 */
+    dir = new_string((char*)seen_bib_file());	   /*                        */
+    if ((p = strrchr(dir, '/')) == NULL)	   /*                        */
+    { base[i] = symbol((String)dir);		   /*                        */
+      wd[i]   = inotify_add_watch(fd, ".", WATCH_EVENTS);/*                  */
+    }						   /*                        */
+    else					   /*                        */
+    { base[i] = symbol((String)(p + 1));	   /*                        */
+      if (p == dir) p++;			   /* keep the root /        */
+      *p      = '\0';				   /*                        */
+      wd[i]   = inotify_add_watch(fd, dir, WATCH_EVENTS);/*                  */
+    }						   /*                        */
+    free(dir);					   /*                        */
+  }						   /*                        */
+ 						   /*                        */
+  pfd.fd     = fd;				   /*                        */
+  pfd.events = POLLIN;				   /*                        */
+  while (watching)				   /*                        */
+  { db = new_db();				   /*                        */
+    for (i = 0; i < n; i++) { db_copy(db, dbs[i]); }/*                       */
+    (*process)(db, less);			   /*                        */
+    free_db(db);				   /*                        */
+    if (rsc_verbose) { VerbosePrint1("Waiting for changes"); }/*             */
+ 						   /*                        */
+    for (i = 0; i < n; i++) { changed[i] = false; }/*                        */
+    timeout = -1;				   /* wait for the first one */
+    while ((k = poll(&pfd, 1, timeout)) > 0 &&	   /*                        */
+	   (len = read(fd, (char*)buf, sizeof(buf))) > 0)/*                  */
+    { for (p = (char*)buf; p < (char*)buf + len;   /*                        */
+	   p += sizeof(struct inotify_event) + ev->len)/*                    */
+      { ev = (struct inotify_event*)p;		   /*                        */
+	for (i = 0; i < n; i++)			   /*                        */
+	{ if (ev->wd == wd[i] && ev->len > 0 &&	   /*                        */
+	      strcmp(ev->name, (char*)SymbolValue(base[i])) == 0)/*          */
+	  { changed[i] = true;			   /*                        */
+	    timeout    = WATCH_DELAY;		   /*                        */
+	  }					   /*                        */
+	}					   /*                        */
+      }						   /*                        */
+    }						   /*                        */
+    if (k != 0) watching = false;		   /* waiting failed         */
+ 						   /*                        */
+    for (i = 0; watching && i < n; i++)		   /*                        */
+    { if (changed[i])				   /*                        */
+      { db_clear(dbs[i]);			   /*                        */
+	watch_last = RecordNULL;		   /*                        */
+	if (read_db(dbs[i], SymbolValue(get_input_file(i)), rsc_verbose))/*  */
+	{ NoFileError(get_input_file(i)); }	   /*                        */
+	else if (per_record && rsc_sort)	   /*                        */
+	{ db_sort(dbs[i], less); }		   /*                        */
+      }						   /*                        */
+    }						   /*                        */
+  }						   /*                        */
+ 						   /*                        */
+  (void)close(fd);				   /*                        */
+  if (per_record) { set_record_hook(NULL); }	   /*                        */
+  for (i = 0; i < n; i++) { free_db(dbs[i]); }	   /*                        */
+  free(dbs);					   /*                        */
+  free(base);					   /*                        */
+  free(wd);					   /*                        */
+  free(changed);				   /*                        */
+  return true;					   /*                        */
+}						   /*------------------------*/
+#else
+
+/*-----------------------------------------------------------------------------
+** Function:	watch_possible()
+** Type:	bool
+** Purpose:	Check whether the input files can be watched. Without
+**		inotify this is never the case and a warning is
+**		issued.
+** Arguments:	none
+** Returns:	|false|
+**___________________________________________________			     */
+bool watch_possible()				   /*                        */
+{ WARNING("Watching disabled: inotify is not available.");/*                 */
+  return false;					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	watch_in_files()
+** Type:	bool
+** Purpose:	Dummy for systems without inotify.
+** Arguments:
+**	fct	the function applied to each record read or |NULL|
+**	less	the comparison for sorting
+**	process	the function processing and writing the records
+** Returns:	|false|
+**___________________________________________________			     */
+bool watch_in_files(fct, less, process)		   /*                        */
+  bool	 (*fct)_ARG((DB db, Record rec));	   /*                        */
+  int	 (*less)_ARG((Record, Record));		   /*                        */
+  void	 (*process)_ARG((DB db,			   /*                        */
+			 int (*less)_ARG((Record, Record))));/*              */
+{ (void)fct;					   /*                        */
+  (void)less;					   /*                        */
+  (void)process;				   /*                        */
+  return false;					   /*                        */
+}						   /*------------------------*/
+#endif
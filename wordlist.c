@@ -40,6 +40,13 @@
 /* Internal Programs							     */
 /*===========================================================================*/
 
+#ifdef __STDC__
+#define _ARG(A) A
+#else
+#define _ARG(A) ()
+#endif
+ static int ks_hash _ARG((String s));		   /*                        */
+
 /*****************************************************************************/
 /* External Programs							     */
 /*===========================================================================*/
@@ -201,3 +208,102 @@ bool find_word(s, wl)				   /*			     */
 					   	   /*			     */
   return false;				   	   /*			     */
 }						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function*:	ks_hash()
+** Purpose:	Compute the hash value of a key. Upper and lower case
+**		letters are not distinguished.
+** Arguments:
+**	s	the key
+** Returns:	the hash value
+**___________________________________________________			     */
+static int ks_hash(s)				   /*                        */
+  register String s;				   /*                        */
+{ register unsigned int h = 0;			   /*                        */
+  while (*s) { h = h * 33 + ToLower(*s++); }	   /*                        */
+  return (int)(h & 0x7fffffff);			   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	ks_find()
+** Purpose:	Check whether a key is contained in a key set. The
+**		comparison is not case sensitive.
+** Arguments:
+**	ks	the key set
+**	s	the key
+** Returns:	|true| iff the key is contained.
+**___________________________________________________			     */
+bool ks_find(ks, s)				   /*                        */
+  KeySet ks;					   /*                        */
+  String s;					   /*                        */
+{ register int i;				   /*                        */
+ 						   /*                        */
+  if (ks->ks_used == 0) return false;		   /*                        */
+ 						   /*                        */
+  for (i = ks_hash(s) & (ks->ks_size - 1);	   /*                        */
+       ks->ks_tab[i] != NO_SYMBOL;		   /*                        */
+       i = (i + 1) & (ks->ks_size - 1))		   /*                        */
+  { if (case_eq(SymbolValue(ks->ks_tab[i]), s)) return true; }/*             */
+  return false;					   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	ks_add()
+** Purpose:	Add a key to a key set unless it is already contained.
+**		The table is doubled when it becomes half full.
+** Arguments:
+**	ks	the key set
+**	sym	the key
+** Returns:	nothing
+**___________________________________________________			     */
+void ks_add(ks, sym)				   /*                        */
+  KeySet ks;					   /*                        */
+  Symbol sym;					   /*                        */
+{ register int i;				   /*                        */
+ 						   /*                        */
+  if (ks_find(ks, SymbolValue(sym))) return;	   /*                        */
+ 						   /*                        */
+  if (2 * (ks->ks_used + 1) > ks->ks_size)	   /* Grow the table         */
+  { Symbol *old  = ks->ks_tab;			   /*                        */
+    int    size  = ks->ks_size;			   /*                        */
+ 						   /*                        */
+    ks->ks_size = (size ? 2 * size : 64);	   /*                        */
+    if ((ks->ks_tab = (Symbol*)calloc(ks->ks_size, sizeof(Symbol)))/*        */
+	== (Symbol*)NULL)			   /*                        */
+    { OUT_OF_MEMORY("KeySet"); }		   /*                        */
+    while (size-- > 0)				   /*                        */
+    { if (old[size] == NO_SYMBOL) continue;	   /*                        */
+      for (i = ks_hash(SymbolValue(old[size])) & (ks->ks_size - 1);/*        */
+	   ks->ks_tab[i] != NO_SYMBOL;		   /*                        */
+	   i = (i + 1) & (ks->ks_size - 1)) {}	   /*                        */
+      ks->ks_tab[i] = old[size];		   /*                        */
+    }						   /*                        */
+    if (old) free(old);				   /*                        */
+  }						   /*                        */
+ 						   /*                        */
+  for (i = ks_hash(SymbolValue(sym)) & (ks->ks_size - 1);/*                  */
+       ks->ks_tab[i] != NO_SYMBOL;		   /*                        */
+       i = (i + 1) & (ks->ks_size - 1)) {}	   /*                        */
+  LinkSymbol(sym);				   /*                        */
+  ks->ks_tab[i] = sym;				   /*                        */
+  ks->ks_used++;				   /*                        */
+}						   /*------------------------*/
+
+/*-----------------------------------------------------------------------------
+** Function:	ks_clear()
+** Purpose:	Remove all keys from a key set.
+** Arguments:
+**	ks	the key set
+** Returns:	nothing
+**___________________________________________________			     */
+void ks_clear(ks)				   /*                        */
+  KeySet ks;					   /*                        */
+{ int i;					   /*                        */
+  for (i = 0; i < ks->ks_size; i++)		   /*                        */
+  { if (ks->ks_tab[i] != NO_SYMBOL)		   /*                        */
+    { UnlinkSymbol(ks->ks_tab[i]);		   /*                        */
+      ks->ks_tab[i] = NO_SYMBOL;		   /*                        */
+    }						   /*                        */
+  }						   /*                        */
+  ks->ks_used = 0;				   /*                        */
+}						   /*------------------------*/